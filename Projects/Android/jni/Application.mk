@@ -8,6 +8,15 @@ APP_PLATFORM := android-19
 
 APP_CFLAGS += -Wl,--no-undefined, -march=armv8+crc
 
+# Renderer features that need matching engine support, off unless given on the
+# ndk-build command line (e.g. ndk-build ENGINE_MULTIVIEW=1):
+# ENGINE_MULTIVIEW		honour --multiview, the engine draws both eyes in one pass
+# ENGINE_DYNAMIC_RESOLUTION	honour --dynres, the engine sizes its viewport from
+#				QzDoom_GetRenderRes
+ENGINE_MULTIVIEW ?= 0
+ENGINE_DYNAMIC_RESOLUTION ?= 0
+APP_CFLAGS += -DENGINE_MULTIVIEW=$(ENGINE_MULTIVIEW) -DENGINE_DYNAMIC_RESOLUTION=$(ENGINE_DYNAMIC_RESOLUTION)
+
 APPLICATIONMK_PATH = $(call my-dir)
 
 TOP_DIR			:= $(APPLICATIONMK_PATH)
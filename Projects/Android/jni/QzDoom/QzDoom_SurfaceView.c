@@ -18,6 +18,7 @@ Copyright	:	Copyright 2015 Oculus VR, LLC. All Rights reserved.
 #include <time.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <sys/prctl.h>					// for prctl( PR_SET_NAME )
 #include <android/log.h>
 #include <android/native_window_jni.h>	// for native window JNI
@@ -25,6 +26,7 @@ Copyright	:	Copyright 2015 Oculus VR, LLC. All Rights reserved.
 
 #include "argtable3.h"
 #include "VrInput.h"
+#include "VrDynamicResolution.h"
 
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
@@ -122,6 +124,23 @@ PFNEGLSIGNALSYNCKHRPROC			eglSignalSyncKHR;
 PFNEGLGETSYNCATTRIBKHRPROC		eglGetSyncAttribKHR;
 #endif
 
+//--multiview renders both eyes into one layered swap chain, which only works
+//once the engine draws them in a single pass with multiview shaders (checking
+//QzDoom_isMultiview). It does not yet, so the switch is only honoured when
+//ndk-build is run with ENGINE_MULTIVIEW=1 (see Application.mk)
+#ifndef ENGINE_MULTIVIEW
+#define ENGINE_MULTIVIEW 0
+#endif
+
+//--dynres renders into a scaled down sub-rectangle of the eye buffers, which
+//only works once the engine sizes its viewport from QzDoom_GetRenderRes. It
+//does not yet, and would render the full size image that is then cropped, so
+//the switch is only honoured when ndk-build is run with
+//ENGINE_DYNAMIC_RESOLUTION=1 (see Application.mk)
+#ifndef ENGINE_DYNAMIC_RESOLUTION
+#define ENGINE_DYNAMIC_RESOLUTION 0
+#endif
+
 //Let's go to the maximum!
 int CPU_LEVEL			= 4;
 int GPU_LEVEL			= 4;
@@ -129,6 +148,8 @@ int NUM_MULTI_SAMPLES	= 1;
 int FFR					= 0;
 float SS_MULTIPLIER    = 1.0f;
 int DISPLAY_REFRESH		= -1;
+bool USE_MULTIVIEW		= false;
+float DYNRES_MIN_SCALE	= 1.0f;
 
 jclass clazz;
 
@@ -147,6 +168,9 @@ struct arg_int *gpu;
 struct arg_int *msaa;
 struct arg_int *ffr;
 struct arg_int *refresh;
+struct arg_file *frametrace;
+struct arg_lit *multiview;
+struct arg_dbl *dynres;
 struct arg_end *end;
 
 char **argv;
@@ -177,6 +201,54 @@ double GetTimeInMilliSeconds()
 	return ( now.tv_sec * 1e9 + now.tv_nsec ) * (double)(1e-6);
 }
 
+//The frame timing recorder is kept free of VrApi, EGL and android dependencies
+//so that frametimingtest can build it on a desktop. Like VrMessageQueue.c it is
+//compiled as part of this file, the one the engine makefile lists.
+#include "VrFrameTiming.c"
+
+static ovrFrameTiming gFrameTiming;
+
+void QzDoom_GetFrameTimingStats( ovrFrameTimingStats * stats )
+{
+	ovrFrameTiming_GetStats( &gFrameTiming, stats );
+}
+
+bool QzDoom_DumpFrameTimings( const char * path )
+{
+	if ( !ovrFrameTiming_Dump( &gFrameTiming, path ) )
+	{
+		ALOGE( "Unable to write frame timing trace %s", path );
+		return false;
+	}
+	return true;
+}
+
+static void ovrFrameTiming_LogStats()
+{
+	ovrFrameTimingStats stats;
+	QzDoom_GetFrameTimingStats( &stats );
+	if ( stats.Frames == 0 )
+	{
+		return;
+	}
+
+	ALOGV( "        Frame time p50/p95/p99: %.2f/%.2f/%.2f ms, missed vsyncs: %d over %d frames",
+		   stats.FrameTimeP50, stats.FrameTimeP95, stats.FrameTimeP99, stats.MissedVsyncs, stats.Frames );
+	ALOGV( "        Pose %.2f ms, eyes %.2f/%.2f ms, resolve %.2f/%.2f ms, submit %.2f ms",
+		   stats.PoseMs, stats.EyeRenderMs[0], stats.EyeRenderMs[1], stats.ResolveMs[0], stats.ResolveMs[1], stats.SubmitMs );
+
+	if ( gFrameTiming.TracePath != NULL )
+	{
+		QzDoom_DumpFrameTimings( gFrameTiming.TracePath );
+	}
+}
+
+//Like the frame timing recorder, the controller is free of VrApi and GL so that
+//dynrestest can drive it on a desktop, and is compiled as part of this file.
+#include "VrDynamicResolution.c"
+
+static ovrDynamicResolution gDynamicResolution;	// eye buffer viewport scale, fed from QzDoom_submitFrame
+
 /*
 ================================================================================
 
@@ -281,7 +353,6 @@ OpenGL-ES Utility Functions
 
 typedef struct
 {
-	bool multi_view;						// GL_OVR_multiview, GL_OVR_multiview2
 	bool EXT_texture_border_clamp;			// GL_EXT_texture_border_clamp, GL_OES_texture_border_clamp
 } OpenGLExtensions_t;
 
@@ -300,9 +371,6 @@ static void EglInitExtensions()
 	const char * allExtensions = (const char *)glGetString( GL_EXTENSIONS );
 	if ( allExtensions != NULL )
 	{
-		glExtensions.multi_view = strstr( allExtensions, "GL_OVR_multiview2" ) &&
-								  strstr( allExtensions, "GL_OVR_multiview_multisampled_render_to_texture" );
-
 		glExtensions.EXT_texture_border_clamp = false;//strstr( allExtensions, "GL_EXT_texture_border_clamp" ) ||
 												//strstr( allExtensions, "GL_OES_texture_border_clamp" );
 	}
@@ -331,20 +399,6 @@ static const char * EglErrorString( const EGLint error )
 	}
 }
 
-static const char * GlFrameBufferStatusString( GLenum status )
-{
-	switch ( status )
-	{
-		case GL_FRAMEBUFFER_UNDEFINED:						return "GL_FRAMEBUFFER_UNDEFINED";
-		case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT:			return "GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT";
-		case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:	return "GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT";
-		case GL_FRAMEBUFFER_UNSUPPORTED:					return "GL_FRAMEBUFFER_UNSUPPORTED";
-		case GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE:			return "GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE";
-		default:											return "unknown";
-	}
-}
-
-
 /*
 ================================================================================
 
@@ -523,180 +577,10 @@ static void ovrEgl_DestroyContext( ovrEgl * egl )
 	}
 }
 
-/*
-================================================================================
-
-ovrFramebuffer
-
-================================================================================
-*/
-
-
-static void ovrFramebuffer_Clear( ovrFramebuffer * frameBuffer )
-{
-	frameBuffer->Width = 0;
-	frameBuffer->Height = 0;
-	frameBuffer->Multisamples = 0;
-	frameBuffer->TextureSwapChainLength = 0;
-	frameBuffer->ProcessingTextureSwapChainIndex = 0;
-	frameBuffer->ReadyTextureSwapChainIndex = 0;
-	frameBuffer->ColorTextureSwapChain = NULL;
-	frameBuffer->DepthBuffers = NULL;
-	frameBuffer->FrameBuffers = NULL;
-}
-
-typedef void (GL_APIENTRYP PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXTPROC) (GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
-typedef void (GL_APIENTRYP PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC) (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples);
-
-
-static bool ovrFramebuffer_Create( ovrFramebuffer * frameBuffer, const GLenum colorFormat, const int width, const int height, const int multisamples )
-{
-    frameBuffer->Width = width;
-	frameBuffer->Height = height;
-	frameBuffer->Multisamples = multisamples;
-
-	frameBuffer->ColorTextureSwapChain = vrapi_CreateTextureSwapChain3( VRAPI_TEXTURE_TYPE_2D, colorFormat, frameBuffer->Width, frameBuffer->Height, 1, 3 );
-	frameBuffer->TextureSwapChainLength = vrapi_GetTextureSwapChainLength( frameBuffer->ColorTextureSwapChain );
-	frameBuffer->DepthBuffers = (GLuint *)malloc( frameBuffer->TextureSwapChainLength * sizeof( GLuint ) );
-	frameBuffer->FrameBuffers = (GLuint *)malloc( frameBuffer->TextureSwapChainLength * sizeof( GLuint ) );
-
-    PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXTPROC glRenderbufferStorageMultisampleEXT =
-            (PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXTPROC)eglGetProcAddress("glRenderbufferStorageMultisampleEXT");
-    PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC glFramebufferTexture2DMultisampleEXT =
-            (PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC)eglGetProcAddress("glFramebufferTexture2DMultisampleEXT");
-
-	for ( int i = 0; i < frameBuffer->TextureSwapChainLength; i++ )
-	{
-		// Create the color buffer texture.
-		const GLuint colorTexture = vrapi_GetTextureSwapChainHandle( frameBuffer->ColorTextureSwapChain, i );
-		GLenum colorTextureTarget = GL_TEXTURE_2D;
-		GL( glBindTexture( colorTextureTarget, colorTexture ) );
-        // Just clamp to edge. However, this requires manually clearing the border
-        // around the layer to clear the edge texels.
-        GL( glTexParameteri( colorTextureTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE ) );
-        GL( glTexParameteri( colorTextureTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE ) );
-
-		GL( glTexParameteri( colorTextureTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR ) );
-		GL( glTexParameteri( colorTextureTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR ) );
-		GL( glBindTexture( colorTextureTarget, 0 ) );
-
-        if (multisamples > 1 && glRenderbufferStorageMultisampleEXT != NULL && glFramebufferTexture2DMultisampleEXT != NULL)
-        {
-
-            // Create multisampled depth buffer.
-            GL(glGenRenderbuffers(1, &frameBuffer->DepthBuffers[i]));
-            GL(glBindRenderbuffer(GL_RENDERBUFFER, frameBuffer->DepthBuffers[i]));
-            GL(glRenderbufferStorageMultisampleEXT(GL_RENDERBUFFER, multisamples, GL_DEPTH_COMPONENT24, width, height));
-            GL(glBindRenderbuffer(GL_RENDERBUFFER, 0));
-
-            // Create the frame buffer.
-            GL(glGenFramebuffers(1, &frameBuffer->FrameBuffers[i]));
-            GL(glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer->FrameBuffers[i]));
-            GL(glFramebufferTexture2DMultisampleEXT(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0, multisamples));
-            GL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, frameBuffer->DepthBuffers[i]));
-            GL(GLenum renderFramebufferStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER));
-            GL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
-            if (renderFramebufferStatus != GL_FRAMEBUFFER_COMPLETE)
-            {
-                ALOGE("OVRHelper::Incomplete frame buffer object: %s", GlFrameBufferStatusString(renderFramebufferStatus));
-                return false;
-            }
-        }
-        else
-        {
-            {
-                // Create depth buffer.
-                GL( glGenRenderbuffers( 1, &frameBuffer->DepthBuffers[i] ) );
-                GL( glBindRenderbuffer( GL_RENDERBUFFER, frameBuffer->DepthBuffers[i] ) );
-                GL( glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, frameBuffer->Width, frameBuffer->Height ) );
-                GL( glBindRenderbuffer( GL_RENDERBUFFER, 0 ) );
-
-                // Create the frame buffer.
-                GL( glGenFramebuffers( 1, &frameBuffer->FrameBuffers[i] ) );
-                GL( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, frameBuffer->FrameBuffers[i] ) );
-                GL( glFramebufferRenderbuffer( GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, frameBuffer->DepthBuffers[i] ) );
-                GL( glFramebufferTexture2D( GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0 ) );
-                GL( GLenum renderFramebufferStatus = glCheckFramebufferStatus( GL_DRAW_FRAMEBUFFER ) );
-                GL( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, 0 ) );
-                if ( renderFramebufferStatus != GL_FRAMEBUFFER_COMPLETE )
-                {
-                    ALOGE( "Incomplete frame buffer object: %s", GlFrameBufferStatusString( renderFramebufferStatus ) );
-                    return false;
-                }
-            }
-        }
-	}
-
-	return true;
-}
-
-void ovrFramebuffer_Destroy( ovrFramebuffer * frameBuffer )
-{
-	GL( glDeleteFramebuffers( frameBuffer->TextureSwapChainLength, frameBuffer->FrameBuffers ) );
-	GL( glDeleteRenderbuffers( frameBuffer->TextureSwapChainLength, frameBuffer->DepthBuffers ) );
-
-	vrapi_DestroyTextureSwapChain( frameBuffer->ColorTextureSwapChain );
-
-	free( frameBuffer->DepthBuffers );
-	free( frameBuffer->FrameBuffers );
-
-	ovrFramebuffer_Clear( frameBuffer );
-}
-
-void ovrFramebuffer_SetCurrent( ovrFramebuffer * frameBuffer )
-{
-	GL( glBindFramebuffer( GL_FRAMEBUFFER, frameBuffer->FrameBuffers[frameBuffer->ProcessingTextureSwapChainIndex] ) );
-}
-
-void ovrFramebuffer_SetNone()
-{
-	GL( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, 0 ) );
-}
-
-void ovrFramebuffer_Resolve( ovrFramebuffer * frameBuffer )
-{
-	// Discard the depth buffer, so the tiler won't need to write it back out to memory.
-	const GLenum depthAttachment[1] = { GL_DEPTH_ATTACHMENT };
-	glInvalidateFramebuffer( GL_DRAW_FRAMEBUFFER, 1, depthAttachment );
-
-    // Flush this frame worth of commands.
-    glFlush();
-}
-
-void ovrFramebuffer_Advance( ovrFramebuffer * frameBuffer )
-{
-	// Advance to the next texture from the set.
-    frameBuffer->ReadyTextureSwapChainIndex = frameBuffer->ProcessingTextureSwapChainIndex;
-	frameBuffer->ProcessingTextureSwapChainIndex = ( frameBuffer->ProcessingTextureSwapChainIndex + 1 ) % frameBuffer->TextureSwapChainLength;
-}
-
-
-void ovrFramebuffer_ClearEdgeTexels( ovrFramebuffer * frameBuffer )
-{
-	GL( glEnable( GL_SCISSOR_TEST ) );
-	GL( glViewport( 0, 0, frameBuffer->Width, frameBuffer->Height ) );
-
-	// Explicitly clear the border texels to black because OpenGL-ES does not support GL_CLAMP_TO_BORDER.
-	// Clear to fully opaque black.
-	GL( glClearColor( 0.0f, 0.0f, 0.0f, 1.0f ) );
-
-	// bottom
-	GL( glScissor( 0, 0, frameBuffer->Width, 1 ) );
-	GL( glClear( GL_COLOR_BUFFER_BIT ) );
-	// top
-	GL( glScissor( 0, frameBuffer->Height - 1, frameBuffer->Width, 1 ) );
-	GL( glClear( GL_COLOR_BUFFER_BIT ) );
-	// left
-	GL( glScissor( 0, 0, 1, frameBuffer->Height ) );
-	GL( glClear( GL_COLOR_BUFFER_BIT ) );
-	// right
-	GL( glScissor( frameBuffer->Width - 1, 0, 1, frameBuffer->Height ) );
-	GL( glClear( GL_COLOR_BUFFER_BIT ) );
-
-
-	GL( glScissor( 0, 0, 0, 0 ) );
-	GL( glDisable( GL_SCISSOR_TEST ) );
-}
+//The frame buffers only take the swap chain type from VrApi, so that
+//framebuffertest can create them on a desktop with a stub swap chain. Like
+//VrFrameTiming.c they are compiled as part of this file.
+#include "VrFramebuffer.c"
 
 
 /*
@@ -720,13 +604,30 @@ void ovrRenderer_Clear( ovrRenderer * renderer )
 
 float QzDoom_GetFOV();
 
-void ovrRenderer_Create( int width, int height, ovrRenderer * renderer, const ovrJava * java )
+void ovrRenderer_Create( int width, int height, ovrRenderer * renderer, const ovrJava * java, const bool useMultiview )
 {
-	renderer->NumBuffers = VRAPI_FRAME_LAYER_EYE_MAX;
-
 	//Now using a symmetrical render target, based on the horizontal FOV
 	//QzDoom_GetFOV();
 
+	if ( useMultiview )
+	{
+		// One layered swap chain, both eyes rendered in a single pass
+		if ( ovrFramebuffer_CreateMultiview( &renderer->FrameBuffer[0], GL_RGBA8, width, height, NUM_MULTI_SAMPLES ) )
+		{
+			renderer->NumBuffers = 1;
+			return;
+		}
+
+		ALOGE( "Multiview framebuffer creation failed, falling back to one buffer per eye" );
+		if ( renderer->FrameBuffer[0].ColorTextureSwapChain != NULL )
+		{
+			ovrFramebuffer_Destroy( &renderer->FrameBuffer[0] );
+		}
+		ovrFramebuffer_Clear( &renderer->FrameBuffer[0] );
+	}
+
+	renderer->NumBuffers = VRAPI_FRAME_LAYER_EYE_MAX;
+
 	// Create the render Textures.
 	for ( int eye = 0; eye < VRAPI_FRAME_LAYER_EYE_MAX; eye++ )
 	{
@@ -779,45 +680,21 @@ void NormalizeAngles(vec3_t angles)
 
 void GetAnglesFromVectors(const ovrVector3f forward, const ovrVector3f right, const ovrVector3f up, vec3_t angles)
 {
-	float sr, sp, sy, cr, cp, cy;
-
-	sp = -forward.z;
+	float sp = -forward.z;
 
 	float cp_x_cy = forward.x;
 	float cp_x_sy = forward.y;
 	float cp_x_sr = -right.z;
 	float cp_x_cr = up.z;
 
-	float yaw = atan2(cp_x_sy, cp_x_cy);
-	float roll = atan2(cp_x_sr, cp_x_cr);
+	float yaw = atan2f(cp_x_sy, cp_x_cy);
+	float roll = atan2f(cp_x_sr, cp_x_cr);
 
-	cy = cos(yaw);
-	sy = sin(yaw);
-	cr = cos(roll);
-	sr = sin(roll);
+	//cos(pitch) is never negative for pitch in [-90, 90], so it is the length of the
+	//forward vector's xy projection, no need to divide back out by sin/cos of yaw or roll
+	float cp = sqrtf(cp_x_cy * cp_x_cy + cp_x_sy * cp_x_sy);
 
-	if (fabs(cy) > EPSILON)
-	{
-	cp = cp_x_cy / cy;
-	}
-	else if (fabs(sy) > EPSILON)
-	{
-	cp = cp_x_sy / sy;
-	}
-	else if (fabs(sr) > EPSILON)
-	{
-	cp = cp_x_sr / sr;
-	}
-	else if (fabs(cr) > EPSILON)
-	{
-	cp = cp_x_cr / cr;
-	}
-	else
-	{
-	cp = cos(asin(sp));
-	}
-
-	float pitch = atan2(sp, cp);
+	float pitch = atan2f(sp, cp);
 
 	angles[0] = pitch / (M_PI*2.f / 360.f);
 	angles[1] = yaw / (M_PI*2.f / 360.f);
@@ -836,17 +713,10 @@ void QuatToYawPitchRoll(ovrQuatf q, vec3_t rotation, vec3_t out) {
 		mat = ovrMatrix4f_Multiply(&mat, &rot);
 	}
 
-    ovrVector4f v1 = {0, 0, -1, 0};
-    ovrVector4f v2 = {1, 0, 0, 0};
-    ovrVector4f v3 = {0, 1, 0, 0};
-
-    ovrVector4f forwardInVRSpace = ovrVector4f_MultiplyMatrix4f(&mat, &v1);
-    ovrVector4f rightInVRSpace = ovrVector4f_MultiplyMatrix4f(&mat, &v2);
-    ovrVector4f upInVRSpace = ovrVector4f_MultiplyMatrix4f(&mat, &v3);
-
-	ovrVector3f forward = {-forwardInVRSpace.z, -forwardInVRSpace.x, forwardInVRSpace.y};
-	ovrVector3f right = {-rightInVRSpace.z, -rightInVRSpace.x, rightInVRSpace.y};
-	ovrVector3f up = {-upInVRSpace.z, -upInVRSpace.x, upInVRSpace.y};
+    //Forward (-Z), right (+X) and up (+Y) in VR space are just columns of the matrix
+	ovrVector3f forward = {mat.M[2][2], mat.M[0][2], -mat.M[1][2]};
+	ovrVector3f right = {-mat.M[2][0], -mat.M[0][0], mat.M[1][0]};
+	ovrVector3f up = {-mat.M[2][1], -mat.M[0][1], mat.M[1][1]};
 
 	ovrVector3f forwardNormal = normalizeVec(forward);
 	ovrVector3f rightNormal = normalizeVec(right);
@@ -1094,184 +964,11 @@ static void ovrApp_HandleVrModeChanges( ovrApp * app )
 	}
 }
 
-
-/*
-================================================================================
-
-ovrMessageQueue
-
-================================================================================
-*/
-
-typedef enum
-{
-	MQ_WAIT_NONE,		// don't wait
-	MQ_WAIT_RECEIVED,	// wait until the consumer thread has received the message
-	MQ_WAIT_PROCESSED	// wait until the consumer thread has processed the message
-} ovrMQWait;
-
-#define MAX_MESSAGE_PARMS	8
-#define MAX_MESSAGES		1024
-
-typedef struct
-{
-	int			Id;
-	ovrMQWait	Wait;
-	long long	Parms[MAX_MESSAGE_PARMS];
-} ovrMessage;
-
-static void ovrMessage_Init( ovrMessage * message, const int id, const int wait )
-{
-	message->Id = id;
-	message->Wait = wait;
-	memset( message->Parms, 0, sizeof( message->Parms ) );
-}
-
-static void		ovrMessage_SetPointerParm( ovrMessage * message, int index, void * ptr ) { *(void **)&message->Parms[index] = ptr; }
-static void *	ovrMessage_GetPointerParm( ovrMessage * message, int index ) { return *(void **)&message->Parms[index]; }
-static void		ovrMessage_SetIntegerParm( ovrMessage * message, int index, int value ) { message->Parms[index] = value; }
-static int		ovrMessage_GetIntegerParm( ovrMessage * message, int index ) { return (int)message->Parms[index]; }
-static void		ovrMessage_SetFloatParm( ovrMessage * message, int index, float value ) { *(float *)&message->Parms[index] = value; }
-static float	ovrMessage_GetFloatParm( ovrMessage * message, int index ) { return *(float *)&message->Parms[index]; }
-
-// Cyclic queue with messages.
-typedef struct
-{
-	ovrMessage	 		Messages[MAX_MESSAGES];
-	volatile int		Head;	// dequeue at the head
-	volatile int		Tail;	// enqueue at the tail
-	ovrMQWait			Wait;
-	volatile bool		EnabledFlag;
-	volatile bool		PostedFlag;
-	volatile bool		ReceivedFlag;
-	volatile bool		ProcessedFlag;
-	pthread_mutex_t		Mutex;
-	pthread_cond_t		PostedCondition;
-	pthread_cond_t		ReceivedCondition;
-	pthread_cond_t		ProcessedCondition;
-} ovrMessageQueue;
-
-static void ovrMessageQueue_Create( ovrMessageQueue * messageQueue )
-{
-	messageQueue->Head = 0;
-	messageQueue->Tail = 0;
-	messageQueue->Wait = MQ_WAIT_NONE;
-	messageQueue->EnabledFlag = false;
-	messageQueue->PostedFlag = false;
-	messageQueue->ReceivedFlag = false;
-	messageQueue->ProcessedFlag = false;
-
-	pthread_mutexattr_t	attr;
-	pthread_mutexattr_init( &attr );
-	pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_ERRORCHECK );
-	pthread_mutex_init( &messageQueue->Mutex, &attr );
-	pthread_mutexattr_destroy( &attr );
-	pthread_cond_init( &messageQueue->PostedCondition, NULL );
-	pthread_cond_init( &messageQueue->ReceivedCondition, NULL );
-	pthread_cond_init( &messageQueue->ProcessedCondition, NULL );
-}
-
-static void ovrMessageQueue_Destroy( ovrMessageQueue * messageQueue )
-{
-	pthread_mutex_destroy( &messageQueue->Mutex );
-	pthread_cond_destroy( &messageQueue->PostedCondition );
-	pthread_cond_destroy( &messageQueue->ReceivedCondition );
-	pthread_cond_destroy( &messageQueue->ProcessedCondition );
-}
-
-static void ovrMessageQueue_Enable( ovrMessageQueue * messageQueue, const bool set )
-{
-	messageQueue->EnabledFlag = set;
-}
-
-static void ovrMessageQueue_PostMessage( ovrMessageQueue * messageQueue, const ovrMessage * message )
-{
-	if ( !messageQueue->EnabledFlag )
-	{
-		return;
-	}
-	while ( messageQueue->Tail - messageQueue->Head >= MAX_MESSAGES )
-	{
-		usleep( 1000 );
-	}
-	pthread_mutex_lock( &messageQueue->Mutex );
-	messageQueue->Messages[messageQueue->Tail & ( MAX_MESSAGES - 1 )] = *message;
-	messageQueue->Tail++;
-	messageQueue->PostedFlag = true;
-	pthread_cond_broadcast( &messageQueue->PostedCondition );
-	if ( message->Wait == MQ_WAIT_RECEIVED )
-	{
-		while ( !messageQueue->ReceivedFlag )
-		{
-			pthread_cond_wait( &messageQueue->ReceivedCondition, &messageQueue->Mutex );
-		}
-		messageQueue->ReceivedFlag = false;
-	}
-	else if ( message->Wait == MQ_WAIT_PROCESSED )
-	{
-		while ( !messageQueue->ProcessedFlag )
-		{
-			pthread_cond_wait( &messageQueue->ProcessedCondition, &messageQueue->Mutex );
-		}
-		messageQueue->ProcessedFlag = false;
-	}
-	pthread_mutex_unlock( &messageQueue->Mutex );
-}
-
-static void ovrMessageQueue_SleepUntilMessage( ovrMessageQueue * messageQueue )
-{
-	if ( messageQueue->Wait == MQ_WAIT_PROCESSED )
-	{
-		messageQueue->ProcessedFlag = true;
-		pthread_cond_broadcast( &messageQueue->ProcessedCondition );
-		messageQueue->Wait = MQ_WAIT_NONE;
-	}
-	pthread_mutex_lock( &messageQueue->Mutex );
-	if ( messageQueue->Tail > messageQueue->Head )
-	{
-		pthread_mutex_unlock( &messageQueue->Mutex );
-		return;
-	}
-	while ( !messageQueue->PostedFlag )
-	{
-		pthread_cond_wait( &messageQueue->PostedCondition, &messageQueue->Mutex );
-	}
-	messageQueue->PostedFlag = false;
-	pthread_mutex_unlock( &messageQueue->Mutex );
-}
-
-static bool ovrMessageQueue_GetNextMessage( ovrMessageQueue * messageQueue, ovrMessage * message, bool waitForMessages )
-{
-	if ( messageQueue->Wait == MQ_WAIT_PROCESSED )
-	{
-		messageQueue->ProcessedFlag = true;
-		pthread_cond_broadcast( &messageQueue->ProcessedCondition );
-		messageQueue->Wait = MQ_WAIT_NONE;
-	}
-	if ( waitForMessages )
-	{
-		ovrMessageQueue_SleepUntilMessage( messageQueue );
-	}
-	pthread_mutex_lock( &messageQueue->Mutex );
-	if ( messageQueue->Tail <= messageQueue->Head )
-	{
-		pthread_mutex_unlock( &messageQueue->Mutex );
-		return false;
-	}
-	*message = messageQueue->Messages[messageQueue->Head & ( MAX_MESSAGES - 1 )];
-	messageQueue->Head++;
-	pthread_mutex_unlock( &messageQueue->Mutex );
-	if ( message->Wait == MQ_WAIT_RECEIVED )
-	{
-		messageQueue->ReceivedFlag = true;
-		pthread_cond_broadcast( &messageQueue->ReceivedCondition );
-	}
-	else if ( message->Wait == MQ_WAIT_PROCESSED )
-	{
-		messageQueue->Wait = MQ_WAIT_PROCESSED;
-	}
-	return true;
-}
+//The message queue has no VrApi, EGL or android dependencies, so that mqbench
+//can build it on a desktop. The engine makefile that lists the QzDoom sources
+//is not in this tree and only knows this file, so it is compiled in here
+//rather than as a translation unit of its own.
+#include "VrMessageQueue.c"
 
 /*
 ================================================================================
@@ -1316,6 +1013,20 @@ void QzDoom_GetScreenRes(uint32_t *width, uint32_t *height)
     *height = m_height;
 }
 
+//Size of the eye buffer sub-rectangle to render this frame, at most QzDoom_GetScreenRes
+void QzDoom_GetRenderRes(uint32_t *width, uint32_t *height)
+{
+	if (QzDoom_useScreenLayer())
+	{
+		*width = m_width;
+		*height = m_height;
+		return;
+	}
+
+	*width = ovrDynamicResolution_ScaleSize(&gDynamicResolution, m_width);
+	*height = ovrDynamicResolution_ScaleSize(&gDynamicResolution, m_height);
+}
+
 void Android_MessageBox(const char *title, const char *text)
 {
     ALOGE("%s %s", title, text);
@@ -1363,7 +1074,12 @@ int QzDoom_GetRefresh()
 
 int QzDoom_SetRefreshRate(int refreshRate)
 {
-	return vrapi_SetDisplayRefreshRate(gAppState.Ovr, (float)refreshRate);
+	const int result = vrapi_SetDisplayRefreshRate(gAppState.Ovr, (float)refreshRate);
+	if (result == ovrSuccess)
+	{
+		ovrFrameTiming_SetRefreshRate(&gFrameTiming, refreshRate);
+	}
+	return result;
 }
 
 bool QzDoom_IsRefreshSupported(int refreshRate)
@@ -1390,32 +1106,62 @@ float QzDoom_GetFOV()
 	return vrFOV;
 }
 
+bool QzDoom_isMultiview()
+{
+	return !QzDoom_useScreenLayer() && gAppState.Renderer.NumBuffers == 1;
+}
+
+//In multiview mode both eyes are layers of one buffer that is bound and cleared
+//once, for eye 0; the call for eye 1 does nothing
 void QzDoom_prepareEyeBuffer(int eye )
 {
 	ovrRenderer *renderer = QzDoom_useScreenLayer() ? &gAppState.Scene.CylinderRenderer : &gAppState.Renderer;
 
-	ovrFramebuffer *frameBuffer = &(renderer->FrameBuffer[eye]);
+	if (renderer->NumBuffers == 1 && eye != 0)
+	{
+		return;
+	}
+
+	ovrFrameTiming_Mark(&gFrameTiming, gAppState.FrameIndex, eye == 0 ? FRAME_STAGE_EYE0_START : FRAME_STAGE_EYE1_START);
+
+	ovrFramebuffer *frameBuffer = &(renderer->FrameBuffer[renderer->NumBuffers == 1 ? 0 : eye]);
 	ovrFramebuffer_SetCurrent(frameBuffer);
 
+	if (renderer == &gAppState.Renderer)
+	{
+		frameBuffer->ViewportWidth = ovrDynamicResolution_ScaleSize(&gDynamicResolution, frameBuffer->Width);
+		frameBuffer->ViewportHeight = ovrDynamicResolution_ScaleSize(&gDynamicResolution, frameBuffer->Height);
+	}
+
 	GL(glEnable(GL_SCISSOR_TEST));
 	GL(glDepthMask(GL_TRUE));
 	GL(glEnable(GL_DEPTH_TEST));
 	GL(glDepthFunc(GL_LEQUAL));
 
-	//Weusing the size of the render target
+	//Clear the whole target, then render into the (possibly scaled down) sub-rectangle
 	GL(glViewport(0, 0, frameBuffer->Width, frameBuffer->Height));
 	GL(glScissor(0, 0, frameBuffer->Width, frameBuffer->Height));
 
 	GL(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
 	GL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 	GL(glDisable(GL_SCISSOR_TEST));
+
+	GL(glViewport(0, 0, frameBuffer->ViewportWidth, frameBuffer->ViewportHeight));
 }
 
+//Likewise the multiview buffer is resolved and advanced once, for eye 0
 void QzDoom_finishEyeBuffer(int eye )
 {
 	ovrRenderer *renderer = QzDoom_useScreenLayer() ? &gAppState.Scene.CylinderRenderer : &gAppState.Renderer;
 
-	ovrFramebuffer *frameBuffer = &(renderer->FrameBuffer[eye]);
+	if (renderer->NumBuffers == 1 && eye != 0)
+	{
+		return;
+	}
+
+	ovrFramebuffer *frameBuffer = &(renderer->FrameBuffer[renderer->NumBuffers == 1 ? 0 : eye]);
+
+	ovrFrameTiming_Mark(&gFrameTiming, gAppState.FrameIndex, eye == 0 ? FRAME_STAGE_EYE0_RESOLVE : FRAME_STAGE_EYE1_RESOLVE);
 
 	//Clear edge to prevent smearing
 	ovrFramebuffer_ClearEdgeTexels(frameBuffer);
@@ -1423,6 +1169,8 @@ void QzDoom_finishEyeBuffer(int eye )
 	ovrFramebuffer_Advance(frameBuffer);
 
 	ovrFramebuffer_SetNone();
+
+	ovrFrameTiming_Mark(&gFrameTiming, gAppState.FrameIndex, eye == 0 ? FRAME_STAGE_EYE0_END : FRAME_STAGE_EYE1_END);
 }
 
 bool QzDoom_processMessageQueue() {
@@ -1470,6 +1218,7 @@ bool QzDoom_processMessageQueue() {
 			}
 			case MESSAGE_ON_PAUSE:
 			{
+				ovrFrameTiming_LogStats();
 				gAppState.Resumed = false;
 				break;
 			}
@@ -1541,7 +1290,7 @@ void * AppThreadFunction(void * parm ) {
         QzDoom_processMessageQueue();
 	}
 
-	ovrRenderer_Create(m_width, m_height, &gAppState.Renderer, &java);
+	ovrRenderer_Create(m_width, m_height, &gAppState.Renderer, &java, USE_MULTIVIEW);
 
 	if ( gAppState.Ovr == NULL )
 	{
@@ -1552,6 +1301,14 @@ void * AppThreadFunction(void * parm ) {
 		QzDoom_SetRefreshRate(DISPLAY_REFRESH);
 	}
 
+	//The frame timing statistics can be read from any thread, so they don't
+	//query VrApi themselves; the rate is cached here on the VR thread
+	const int refreshRate = DISPLAY_REFRESH > 0 ? DISPLAY_REFRESH : QzDoom_GetRefresh();
+	ovrFrameTiming_SetRefreshRate(&gFrameTiming, refreshRate);
+
+	//Eye buffers are allocated at full size, the controller scales the viewport within them
+	ovrDynamicResolution_Init(&gDynamicResolution, DYNRES_MIN_SCALE, 1000.0f / refreshRate);
+
 	// Create the scene if not yet created.
 	ovrScene_Create( m_width, m_height, &gAppState.Scene, &java );
 
@@ -1652,6 +1409,7 @@ void QzDoom_getHMDOrientation(ovrTracking2 *tracking) {//Get orientation
 	// depends on the pipeline depth of the engine and the synthesis rate.
 	// The better the prediction, the less black will be pulled in at the edges.
 	*tracking = vrapi_GetPredictedTracking2(gAppState.Ovr, gAppState.DisplayTime);
+	ovrFrameTiming_Mark(&gFrameTiming, gAppState.FrameIndex, FRAME_STAGE_POSE);
 
 
 	// We extract Yaw, Pitch, Roll instead of directly using the orientation
@@ -1711,7 +1469,9 @@ void QzDoom_getTrackedRemotesOrientation(int vr_control_scheme) {//Get info for
 void QzDoom_submitFrame(ovrTracking2 *tracking)
 {
     ovrSubmitFrameDescription2 frameDesc = {0};
-    
+
+    ovrFrameTiming_Mark(&gFrameTiming, gAppState.FrameIndex, FRAME_STAGE_SUBMIT_START);
+
     if (!QzDoom_useScreenLayer()) {
 
         ovrLayerProjection2 layer = vrapi_DefaultLayerProjection2();
@@ -1730,8 +1490,13 @@ void QzDoom_submitFrame(ovrTracking2 *tracking)
 
             layer.Textures[eye].TextureRect.x = 0;
             layer.Textures[eye].TextureRect.y = 0;
-            layer.Textures[eye].TextureRect.width = 1.0f;
-            layer.Textures[eye].TextureRect.height = 1.0f;
+            layer.Textures[eye].TextureRect.width = (float)frameBuffer->ViewportWidth / frameBuffer->Width;
+            layer.Textures[eye].TextureRect.height = (float)frameBuffer->ViewportHeight / frameBuffer->Height;
+
+            //Sample only the rendered part of the texture
+            const ovrMatrix4f scale = ovrMatrix4f_CreateScale(layer.Textures[eye].TextureRect.width,
+                                                              layer.Textures[eye].TextureRect.height, 1.0f);
+            layer.Textures[eye].TexCoordsFromTanAngles = ovrMatrix4f_Multiply(&scale, &layer.Textures[eye].TexCoordsFromTanAngles);
         }
         layer.Header.Flags |= VRAPI_FRAME_LAYER_FLAG_CHROMATIC_ABERRATION_CORRECTION;
 
@@ -1782,6 +1547,16 @@ void QzDoom_submitFrame(ovrTracking2 *tracking)
         vrapi_SubmitFrame2(gAppState.Ovr, &frameDesc);
     }
 
+    ovrFrameTiming_Mark(&gFrameTiming, gAppState.FrameIndex, FRAME_STAGE_SUBMIT_END);
+
+    //Pick the resolution for the next frame
+    float workMs, intervalMs;
+    if (ovrFrameTiming_LastFrame(&gFrameTiming, gAppState.FrameIndex, &workMs, &intervalMs))
+    {
+        ovrDynamicResolution_Update(&gDynamicResolution, workMs,
+                                    intervalMs > gDynamicResolution.TargetMs * 1.5f);
+    }
+
     incrementFrameIndex();
 }
 
@@ -1921,6 +1696,9 @@ JNIEXPORT jlong JNICALL Java_com_drbeef_questzdoom_GLES3JNILib_onCreate( JNIEnv
             msaa   = arg_int0("m", "msaa", "<int>", "MSAA 1-4 (default: 1)"),
             ffr   = arg_int0("f", "ffr", "<int>", "FFR 0-4 (default: 0)"),
             refresh   = arg_int0("r", "refresh", "<int>", "Display Refresh 60, 72 or 90 (default: 72)"),
+            frametrace   = arg_file0("t", "frametrace", "<file>", "Write a frame timing trace on pause, CSV or binary (*.bin)"),
+            multiview   = arg_lit0(NULL, "multiview", "Render both eyes in a single pass (GL_OVR_multiview2)"),
+            dynres   = arg_dbl0("d", "dynres", "<double>", "Dynamic resolution, minimum eye buffer scale (e.g. 0.7)"),
 			end     = arg_end(20)
 	};
 
@@ -1976,6 +1754,29 @@ JNIEXPORT jlong JNICALL Java_com_drbeef_questzdoom_GLES3JNILib_onCreate( JNIEnv
         {
 			DISPLAY_REFRESH = refresh->ival[0];
         }
+
+        if (frametrace->count > 0 && strlen(frametrace->filename[0]) > 0)
+        {
+			gFrameTiming.TracePath = strdup(frametrace->filename[0]);
+        }
+
+        if (multiview->count > 0)
+        {
+#if ENGINE_MULTIVIEW
+			USE_MULTIVIEW = true;
+#else
+			ALOGE("--multiview ignored, this build has no single-pass renderer (ENGINE_MULTIVIEW=0)");
+#endif
+        }
+
+        if (dynres->count > 0 && dynres->dval[0] > 0.0 && dynres->dval[0] < 1.0)
+        {
+#if ENGINE_DYNAMIC_RESOLUTION
+			DYNRES_MIN_SCALE = dynres->dval[0];
+#else
+			ALOGE("--dynres ignored, this build does not size the engine viewport from QzDoom_GetRenderRes (ENGINE_DYNAMIC_RESOLUTION=0)");
+#endif
+        }
 	}
 
 	ovrAppThread * appThread = (ovrAppThread *) malloc( sizeof( ovrAppThread ) );
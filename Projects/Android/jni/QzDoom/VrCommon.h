@@ -12,6 +12,7 @@ extern "C"
 #include <android/log.h>
 
 #include "mathlib.h"
+#include "VrFrameTiming.h"
 
 #define LOG_TAG "QzDoom"
 
@@ -85,6 +86,7 @@ void handleTrackedControllerButton(ovrInputStateTrackedRemote * trackedRemoteSta
 //Called from engine code
 bool QzDoom_useScreenLayer();
 void QzDoom_GetScreenRes(uint32_t *width, uint32_t *height);
+void QzDoom_GetRenderRes(uint32_t *width, uint32_t *height);
 void QzDoom_Vibrate(float duration, int channel, float intensity );
 bool QzDoom_processMessageQueue();
 void QzDoom_FrameSetup();
@@ -100,10 +102,15 @@ void QzDoom_HapticDisable();
 
 void incrementFrameIndex();
 
+bool QzDoom_isMultiview();
 void QzDoom_prepareEyeBuffer(int eye );
 void QzDoom_finishEyeBuffer(int eye );
 void QzDoom_submitFrame(ovrTracking2 *tracking);
 
+//Frame timing instrumentation, see VrFrameTiming.h
+void QzDoom_GetFrameTimingStats(ovrFrameTimingStats *stats);
+bool QzDoom_DumpFrameTimings(const char *path);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
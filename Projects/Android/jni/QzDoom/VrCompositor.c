@@ -432,7 +432,7 @@ void ovrScene_Create( int width, int height, ovrScene * scene, const ovrJava * j
 		scene->CylinderHeight = height;
 		
 		//Create cylinder renderer
-		ovrRenderer_Create( width, height, &scene->CylinderRenderer, java );
+		ovrRenderer_Create( width, height, &scene->CylinderRenderer, java, false );
 	}
 	
 	scene->CreatedScene = true;
@@ -5,6 +5,7 @@ Filename	:	VrCompositor.h
 *************************************************************************************/
 
 #include "VrInput.h"
+#include "VrFramebuffer.h"
 
 #define CHECK_GL_ERRORS
 #ifdef CHECK_GL_ERRORS
@@ -45,34 +46,6 @@ static void GLCheckErrors( int line )
 #endif // CHECK_GL_ERRORS
 
 
-/*
-================================================================================
-
-ovrFramebuffer
-
-================================================================================
-*/
-
-typedef struct
-{
-	int						Width;
-	int						Height;
-	int						Multisamples;
-	int						TextureSwapChainLength;
-	int						ProcessingTextureSwapChainIndex;
-	int						ReadyTextureSwapChainIndex;
-	ovrTextureSwapChain *	ColorTextureSwapChain;
-	GLuint *				DepthBuffers;
-	GLuint *				FrameBuffers;
-} ovrFramebuffer;
-
-void ovrFramebuffer_SetCurrent( ovrFramebuffer * frameBuffer );
-void ovrFramebuffer_Destroy( ovrFramebuffer * frameBuffer );
-void ovrFramebuffer_SetNone();
-void ovrFramebuffer_Resolve( ovrFramebuffer * frameBuffer );
-void ovrFramebuffer_Advance( ovrFramebuffer * frameBuffer );
-void ovrFramebuffer_ClearEdgeTexels( ovrFramebuffer * frameBuffer );
-
 /*
 ================================================================================
 
@@ -89,7 +62,7 @@ typedef struct
 
 
 void ovrRenderer_Clear( ovrRenderer * renderer );
-void ovrRenderer_Create( int width, int height, ovrRenderer * renderer, const ovrJava * java );
+void ovrRenderer_Create( int width, int height, ovrRenderer * renderer, const ovrJava * java, const bool useMultiview );
 void ovrRenderer_Destroy( ovrRenderer * renderer );
 
 
@@ -0,0 +1,94 @@
+/************************************************************************************
+
+Filename	:	VrDynamicResolution.c
+Content		:	Compiled as part of QzDoom_SurfaceView.c, which includes it,
+				and with dynrestest.c on a desktop. Don't list it in a
+				makefile next to QzDoom_SurfaceView.c.
+
+*************************************************************************************/
+
+#include "VrDynamicResolution.h"
+
+/*
+================================================================================
+
+ovrDynamicResolution
+
+Eye buffers are allocated at the maximum size and the scene is rendered into a
+sub-rectangle; the controller shrinks that rectangle quickly when the frame
+work time approaches the vsync budget and grows it back slowly once there is
+headroom.
+
+================================================================================
+*/
+
+#define DYNRES_HIGH_WATERMARK		0.90f	// of the vsync budget, shrink above this
+#define DYNRES_LOW_WATERMARK		0.75f	// of the vsync budget, grow below this
+#define DYNRES_GROW_DELAY			18		// frames of headroom before growing
+#define DYNRES_SHRINK_FACTOR		0.95f
+#define DYNRES_MISSED_FACTOR		0.85f
+#define DYNRES_GROW_STEP			0.02f
+
+void ovrDynamicResolution_Init( ovrDynamicResolution * dr, const float minScale, const float targetMs )
+{
+	dr->Enabled = minScale > 0.0f && minScale < 1.0f;
+	dr->Scale = 1.0f;
+	dr->MinScale = dr->Enabled ? minScale : 1.0f;
+	dr->TargetMs = targetMs;
+	dr->FilteredMs = 0.0f;
+	dr->HeadroomFrames = 0;
+}
+
+float ovrDynamicResolution_Update( ovrDynamicResolution * dr, const float workMs, const bool missedVsync )
+{
+	if ( !dr->Enabled )
+	{
+		return dr->Scale;
+	}
+
+	dr->FilteredMs = ( dr->FilteredMs == 0.0f ) ? workMs : dr->FilteredMs * 0.8f + workMs * 0.2f;
+
+	if ( missedVsync )
+	{
+		dr->Scale *= DYNRES_MISSED_FACTOR;
+		dr->FilteredMs = 0.0f;
+		dr->HeadroomFrames = 0;
+	}
+	else if ( dr->FilteredMs > dr->TargetMs * DYNRES_HIGH_WATERMARK )
+	{
+		dr->Scale *= DYNRES_SHRINK_FACTOR;
+		dr->HeadroomFrames = 0;
+	}
+	else if ( dr->FilteredMs < dr->TargetMs * DYNRES_LOW_WATERMARK )
+	{
+		if ( ++dr->HeadroomFrames >= DYNRES_GROW_DELAY )
+		{
+			dr->Scale += DYNRES_GROW_STEP;
+			dr->HeadroomFrames = 0;
+		}
+	}
+	else
+	{
+		dr->HeadroomFrames = 0;
+	}
+
+	if ( dr->Scale < dr->MinScale )
+	{
+		dr->Scale = dr->MinScale;
+	}
+	else if ( dr->Scale > 1.0f )
+	{
+		dr->Scale = 1.0f;
+	}
+	return dr->Scale;
+}
+
+int ovrDynamicResolution_ScaleSize( const ovrDynamicResolution * dr, const int size )
+{
+	if ( !dr->Enabled )
+	{
+		return size;
+	}
+	const int scaled = ( (int)( size * dr->Scale ) + DYNRES_SCALE_GRANULARITY / 2 ) & ~( DYNRES_SCALE_GRANULARITY - 1 );
+	return scaled < DYNRES_SCALE_GRANULARITY ? DYNRES_SCALE_GRANULARITY : ( scaled > size ? size : scaled );
+}
@@ -0,0 +1,38 @@
+/************************************************************************************
+
+Filename	:	VrDynamicResolution.h
+Content		:	Feedback controller for the eye buffer viewport scale. Has no
+				VrApi, EGL or GL dependencies so that it can be driven from
+				synthetic frame time traces on a desktop (see dynrestest.c).
+
+*************************************************************************************/
+
+#if !defined(vrdynamicresolution_h)
+#define vrdynamicresolution_h
+
+#include <stdbool.h>
+
+#define DYNRES_SCALE_GRANULARITY	8		// viewport sizes are rounded to this many pixels
+
+typedef struct
+{
+	bool	Enabled;
+	float	Scale;			// current viewport scale, MinScale..1
+	float	MinScale;
+	float	TargetMs;		// vsync period
+	float	FilteredMs;		// smoothed frame work time
+	int		HeadroomFrames;
+} ovrDynamicResolution;
+
+// A minScale outside 0..1 (exclusive) leaves the controller disabled at scale 1.
+void	ovrDynamicResolution_Init( ovrDynamicResolution * dr, const float minScale, const float targetMs );
+
+// Feeds one frame: workMs is the CPU time from the previous submit to this one,
+// missedVsync is set if the frame interval overran the display refresh.
+// Returns the scale for the next frame.
+float	ovrDynamicResolution_Update( ovrDynamicResolution * dr, const float workMs, const bool missedVsync );
+
+// Scales a full eye buffer dimension, rounded to DYNRES_SCALE_GRANULARITY.
+int		ovrDynamicResolution_ScaleSize( const ovrDynamicResolution * dr, const int size );
+
+#endif //vrdynamicresolution_h
@@ -0,0 +1,297 @@
+/************************************************************************************
+
+Filename	:	VrFrameTiming.c
+Content		:	Compiled as part of QzDoom_SurfaceView.c, and of
+				frametimingtest.c on a desktop, which both include it. Don't
+				list it in a makefile next to QzDoom_SurfaceView.c.
+
+*************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "VrFrameTiming.h"
+
+/*
+================================================================================
+
+ovrFrameTiming
+
+Per-frame CPU timeline of the VR frame loop. The render thread stamps each
+stage of the frame into a ring of the last MAX_FRAME_TIMINGS frames; every
+record carries a sequence counter so any thread can take a consistent copy
+without locking the render thread.
+
+================================================================================
+*/
+
+#define MAX_FRAME_TIMINGS	256
+
+typedef struct
+{
+	atomic_llong	Sequence;	// odd while the frame is being recorded
+	long long		FrameIndex;
+	long long		Stamps[FRAME_STAGE_MAX];	// nanoseconds, 0 if the stage did not run
+} ovrFrameTimingRecord;
+
+typedef struct
+{
+	ovrFrameTimingRecord	Records[MAX_FRAME_TIMINGS];
+	atomic_int				RefreshRate;	// Hz, set on the render thread, 0 if not known yet
+	char *					TracePath;
+} ovrFrameTiming;
+
+static const char * FrameStageNames[FRAME_STAGE_MAX] =
+{
+	"pose",
+	"eye0_start", "eye0_resolve", "eye0_end",
+	"eye1_start", "eye1_resolve", "eye1_end",
+	"submit_start", "submit_end"
+};
+
+static long long GetTimeInNanoSeconds()
+{
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Records a stage at the given time; the render thread uses ovrFrameTiming_Mark.
+static void ovrFrameTiming_MarkAt( ovrFrameTiming * timing, const long long frameIndex, const ovrFrameStage stage, const long long nanoseconds )
+{
+	ovrFrameTimingRecord * record = &timing->Records[frameIndex & ( MAX_FRAME_TIMINGS - 1 )];
+	if ( record->FrameIndex != frameIndex ||
+		 ( atomic_load_explicit( &record->Sequence, memory_order_relaxed ) & 1 ) == 0 )
+	{
+		atomic_store_explicit( &record->Sequence, frameIndex * 2 + 1, memory_order_relaxed );
+		atomic_thread_fence( memory_order_release );
+		record->FrameIndex = frameIndex;
+		memset( record->Stamps, 0, sizeof( record->Stamps ) );
+	}
+	record->Stamps[stage] = nanoseconds;
+	if ( stage == FRAME_STAGE_SUBMIT_END )
+	{
+		atomic_store_explicit( &record->Sequence, frameIndex * 2 + 2, memory_order_release );
+	}
+}
+
+static void ovrFrameTiming_Mark( ovrFrameTiming * timing, const long long frameIndex, const ovrFrameStage stage )
+{
+	ovrFrameTiming_MarkAt( timing, frameIndex, stage, GetTimeInNanoSeconds() );
+}
+
+// Called on the render thread, which is the one that may query VrApi for it.
+static void ovrFrameTiming_SetRefreshRate( ovrFrameTiming * timing, const int refreshRate )
+{
+	atomic_store_explicit( &timing->RefreshRate, refreshRate, memory_order_relaxed );
+}
+
+// Takes a consistent copy of a completed record, returns false if the slot is
+// empty or being rewritten.
+static bool ovrFrameTiming_Read( const ovrFrameTiming * timing, const int slot, ovrFrameTimingRecord * out )
+{
+	const ovrFrameTimingRecord * record = &timing->Records[slot];
+	const long long before = atomic_load_explicit( &record->Sequence, memory_order_acquire );
+	if ( before == 0 || ( before & 1 ) != 0 )
+	{
+		return false;
+	}
+	out->FrameIndex = record->FrameIndex;
+	memcpy( out->Stamps, record->Stamps, sizeof( out->Stamps ) );
+	atomic_thread_fence( memory_order_acquire );
+	return atomic_load_explicit( &record->Sequence, memory_order_relaxed ) == before;
+}
+
+// Collects the completed records ordered by frame index, returns the count.
+static int ovrFrameTiming_Snapshot( const ovrFrameTiming * timing, ovrFrameTimingRecord * records )
+{
+	int count = 0;
+	for ( int i = 0; i < MAX_FRAME_TIMINGS; i++ )
+	{
+		if ( ovrFrameTiming_Read( timing, i, &records[count] ) )
+		{
+			// Insertion sort, the ring is already mostly ordered.
+			ovrFrameTimingRecord current = records[count];
+			int j = count;
+			for ( ; j > 0 && records[j - 1].FrameIndex > current.FrameIndex; j-- )
+			{
+				records[j] = records[j - 1];
+			}
+			records[j] = current;
+			count++;
+		}
+	}
+	return count;
+}
+
+// Work time (previous submit end to this submit start) and interval (submit end
+// to submit end) of a frame just submitted on the render thread.
+static bool ovrFrameTiming_LastFrame( const ovrFrameTiming * timing, const long long frameIndex, float * workMs, float * intervalMs )
+{
+	const ovrFrameTimingRecord * record = &timing->Records[frameIndex & ( MAX_FRAME_TIMINGS - 1 )];
+	const ovrFrameTimingRecord * previous = &timing->Records[( frameIndex - 1 ) & ( MAX_FRAME_TIMINGS - 1 )];
+	if ( record->FrameIndex != frameIndex || previous->FrameIndex != frameIndex - 1 ||
+		 previous->Stamps[FRAME_STAGE_SUBMIT_END] == 0 )
+	{
+		return false;
+	}
+	*workMs = ( record->Stamps[FRAME_STAGE_SUBMIT_START] - previous->Stamps[FRAME_STAGE_SUBMIT_END] ) * 1e-6f;
+	*intervalMs = ( record->Stamps[FRAME_STAGE_SUBMIT_END] - previous->Stamps[FRAME_STAGE_SUBMIT_END] ) * 1e-6f;
+	return true;
+}
+
+static int CompareFloats( const void * a, const void * b )
+{
+	const float fa = *(const float *)a;
+	const float fb = *(const float *)b;
+	return ( fa > fb ) - ( fa < fb );
+}
+
+static float StageMilliseconds( const ovrFrameTimingRecord * record, const ovrFrameStage from, const ovrFrameStage to )
+{
+	if ( record->Stamps[from] == 0 || record->Stamps[to] == 0 )
+	{
+		return 0.0f;
+	}
+	return ( record->Stamps[to] - record->Stamps[from] ) * 1e-6f;
+}
+
+// Can be called from any thread, each caller takes its own copy of the ring.
+static void ovrFrameTiming_GetStats( const ovrFrameTiming * timing, ovrFrameTimingStats * stats )
+{
+	float frameTimes[MAX_FRAME_TIMINGS];
+
+	memset( stats, 0, sizeof( *stats ) );
+
+	ovrFrameTimingRecord * records = (ovrFrameTimingRecord *)malloc( MAX_FRAME_TIMINGS * sizeof( ovrFrameTimingRecord ) );
+	if ( records == NULL )
+	{
+		return;
+	}
+	const int count = ovrFrameTiming_Snapshot( timing, records );
+
+	const int refresh = atomic_load_explicit( &timing->RefreshRate, memory_order_relaxed );
+	const float vsyncMs = 1000.0f / ( refresh > 0 ? refresh : 72 );
+
+	int intervals = 0;
+	for ( int i = 0; i < count; i++ )
+	{
+		const ovrFrameTimingRecord * record = &records[i];
+		stats->PoseMs += StageMilliseconds( record, FRAME_STAGE_POSE, FRAME_STAGE_EYE0_START );
+		stats->EyeRenderMs[0] += StageMilliseconds( record, FRAME_STAGE_EYE0_START, FRAME_STAGE_EYE0_RESOLVE );
+		stats->ResolveMs[0] += StageMilliseconds( record, FRAME_STAGE_EYE0_RESOLVE, FRAME_STAGE_EYE0_END );
+		stats->EyeRenderMs[1] += StageMilliseconds( record, FRAME_STAGE_EYE1_START, FRAME_STAGE_EYE1_RESOLVE );
+		stats->ResolveMs[1] += StageMilliseconds( record, FRAME_STAGE_EYE1_RESOLVE, FRAME_STAGE_EYE1_END );
+		stats->SubmitMs += StageMilliseconds( record, FRAME_STAGE_SUBMIT_START, FRAME_STAGE_SUBMIT_END );
+
+		if ( i > 0 && records[i - 1].FrameIndex + 1 == record->FrameIndex )
+		{
+			const float frameTime = ( record->Stamps[FRAME_STAGE_SUBMIT_END] - records[i - 1].Stamps[FRAME_STAGE_SUBMIT_END] ) * 1e-6f;
+			frameTimes[intervals++] = frameTime;
+			if ( frameTime > vsyncMs * 1.5f )
+			{
+				stats->MissedVsyncs += (int)( frameTime / vsyncMs + 0.5f ) - 1;
+			}
+		}
+	}
+
+	stats->Frames = count;
+	if ( count > 0 )
+	{
+		stats->PoseMs /= count;
+		stats->SubmitMs /= count;
+		for ( int eye = 0; eye < 2; eye++ )
+		{
+			stats->EyeRenderMs[eye] /= count;
+			stats->ResolveMs[eye] /= count;
+		}
+	}
+	if ( intervals > 0 )
+	{
+		qsort( frameTimes, intervals, sizeof( float ), CompareFloats );
+		stats->FrameTimeP50 = frameTimes[( intervals - 1 ) * 50 / 100];
+		stats->FrameTimeP95 = frameTimes[( intervals - 1 ) * 95 / 100];
+		stats->FrameTimeP99 = frameTimes[( intervals - 1 ) * 99 / 100];
+	}
+
+	free( records );
+}
+
+static bool ovrFrameTiming_WriteCsv( FILE * f, const ovrFrameTimingRecord * records, const int count )
+{
+	fprintf( f, "frame" );
+	for ( int stage = 0; stage < FRAME_STAGE_MAX; stage++ )
+	{
+		fprintf( f, ",%s", FrameStageNames[stage] );
+	}
+	fprintf( f, "\n" );
+
+	for ( int i = 0; i < count; i++ )
+	{
+		fprintf( f, "%lld", records[i].FrameIndex );
+		for ( int stage = 0; stage < FRAME_STAGE_MAX; stage++ )
+		{
+			if ( records[i].Stamps[stage] != 0 )
+			{
+				fprintf( f, ",%lld", records[i].Stamps[stage] / 1000 );
+			}
+			else
+			{
+				fprintf( f, "," );
+			}
+		}
+		fprintf( f, "\n" );
+	}
+	return !ferror( f );
+}
+
+static bool ovrFrameTiming_WriteBinary( FILE * f, const ovrFrameTimingRecord * records, const int count )
+{
+	ovrFrameTraceHeader header;
+	memcpy( header.Magic, FRAME_TRACE_MAGIC, sizeof( header.Magic ) );
+	header.Version = FRAME_TRACE_VERSION;
+	header.Stages = FRAME_STAGE_MAX;
+	header.Frames = count;
+	fwrite( &header, sizeof( header ), 1, f );
+
+	for ( int i = 0; i < count; i++ )
+	{
+		fwrite( &records[i].FrameIndex, sizeof( long long ), 1, f );
+		fwrite( records[i].Stamps, sizeof( long long ), FRAME_STAGE_MAX, f );
+	}
+	return !ferror( f );
+}
+
+// Writes the completed records to path, see VrFrameTiming.h for the formats.
+// Can be called from any thread.
+static bool ovrFrameTiming_Dump( const ovrFrameTiming * timing, const char * path )
+{
+	const size_t length = strlen( path );
+	const bool binary = length > 4 && strcmp( path + length - 4, ".bin" ) == 0;
+
+	ovrFrameTimingRecord * records = (ovrFrameTimingRecord *)malloc( MAX_FRAME_TIMINGS * sizeof( ovrFrameTimingRecord ) );
+	if ( records == NULL )
+	{
+		return false;
+	}
+
+	FILE * f = fopen( path, binary ? "wb" : "w" );
+	if ( f == NULL )
+	{
+		free( records );
+		return false;
+	}
+
+	const int count = ovrFrameTiming_Snapshot( timing, records );
+	bool ok = binary ? ovrFrameTiming_WriteBinary( f, records, count ) : ovrFrameTiming_WriteCsv( f, records, count );
+	if ( fclose( f ) != 0 )
+	{
+		ok = false;
+	}
+	free( records );
+	return ok;
+}
@@ -0,0 +1,59 @@
+/************************************************************************************
+
+Filename	:	VrFrameTiming.h
+Content		:	Frame stages, statistics and trace file format of the frame
+				timing recorder (VrFrameTiming.c). Has no VrApi, EGL or android
+				dependencies so that the recorder can be tested on a desktop
+				(see frametimingtest.c).
+
+*************************************************************************************/
+
+#if !defined(vrframetiming_h)
+#define vrframetiming_h
+
+typedef enum
+{
+	FRAME_STAGE_POSE,
+	FRAME_STAGE_EYE0_START,
+	FRAME_STAGE_EYE0_RESOLVE,
+	FRAME_STAGE_EYE0_END,
+	FRAME_STAGE_EYE1_START,
+	FRAME_STAGE_EYE1_RESOLVE,
+	FRAME_STAGE_EYE1_END,
+	FRAME_STAGE_SUBMIT_START,
+	FRAME_STAGE_SUBMIT_END,
+	FRAME_STAGE_MAX
+} ovrFrameStage;
+
+typedef struct
+{
+	int		Frames;			// frames in the window
+	float	FrameTimeP50;	// submit to submit, ms
+	float	FrameTimeP95;
+	float	FrameTimeP99;
+	int		MissedVsyncs;	// at the display refresh rate
+	float	PoseMs;			// averages over the window
+	float	EyeRenderMs[2];
+	float	ResolveMs[2];
+	float	SubmitMs;
+} ovrFrameTimingStats;
+
+// Traces are CSV, or binary when the file name ends in ".bin". Both hold one
+// record per frame with the CLOCK_MONOTONIC time of every stage, so intervals
+// between frames can be taken from them as well as the stages within a frame.
+// CSV times are in microseconds and empty for stages that did not run. The
+// binary trace is an ovrFrameTraceHeader followed by Frames records of
+// 1 + Stages native-endian 64-bit integers: the frame index, then the stage
+// times in nanoseconds, 0 for stages that did not run.
+#define FRAME_TRACE_MAGIC		"QZFT"
+#define FRAME_TRACE_VERSION		1
+
+typedef struct
+{
+	char	Magic[4];		// FRAME_TRACE_MAGIC
+	int		Version;		// FRAME_TRACE_VERSION
+	int		Stages;			// FRAME_STAGE_MAX of the writer
+	int		Frames;
+} ovrFrameTraceHeader;
+
+#endif //vrframetiming_h
@@ -0,0 +1,331 @@
+/************************************************************************************
+
+Filename	:	VrFramebuffer.c
+Content		:	Compiled as part of QzDoom_SurfaceView.c, and of
+				framebuffertest.c on a desktop, which both include it. Don't
+				list it in a makefile next to QzDoom_SurfaceView.c.
+
+				The including file provides the GL() and ALOGE() macros and
+				vrapi_CreateTextureSwapChain3, vrapi_GetTextureSwapChainLength,
+				vrapi_GetTextureSwapChainHandle and vrapi_DestroyTextureSwapChain.
+
+*************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+
+#include "VrFramebuffer.h"
+
+static const char * GlFrameBufferStatusString( GLenum status )
+{
+	switch ( status )
+	{
+		case GL_FRAMEBUFFER_UNDEFINED:						return "GL_FRAMEBUFFER_UNDEFINED";
+		case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT:			return "GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT";
+		case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:	return "GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT";
+		case GL_FRAMEBUFFER_UNSUPPORTED:					return "GL_FRAMEBUFFER_UNSUPPORTED";
+		case GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE:			return "GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE";
+		default:											return "unknown";
+	}
+}
+
+
+/*
+================================================================================
+
+ovrFramebuffer
+
+================================================================================
+*/
+
+
+static void ovrFramebuffer_Clear( ovrFramebuffer * frameBuffer )
+{
+	frameBuffer->Width = 0;
+	frameBuffer->Height = 0;
+	frameBuffer->ViewportWidth = 0;
+	frameBuffer->ViewportHeight = 0;
+	frameBuffer->Multisamples = 0;
+	frameBuffer->UseMultiview = false;
+	frameBuffer->TextureSwapChainLength = 0;
+	frameBuffer->ProcessingTextureSwapChainIndex = 0;
+	frameBuffer->ReadyTextureSwapChainIndex = 0;
+	frameBuffer->ColorTextureSwapChain = NULL;
+	frameBuffer->DepthBuffers = NULL;
+	frameBuffer->FrameBuffers = NULL;
+}
+
+typedef void (GL_APIENTRYP PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXTPROC) (GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void (GL_APIENTRYP PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC) (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples);
+typedef void (GL_APIENTRYP PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC) (GLenum target, GLenum attachment, GLuint texture, GLint level, GLint baseViewIndex, GLsizei numViews);
+typedef void (GL_APIENTRYP PFNGLFRAMEBUFFERTEXTUREMULTISAMPLEMULTIVIEWOVRPROC) (GLenum target, GLenum attachment, GLuint texture, GLint level, GLsizei samples, GLint baseViewIndex, GLsizei numViews);
+
+
+// eglGetProcAddress returns a dispatch stub for any gl* name on some drivers
+// (Mesa among them), so extension entry points are only used when the
+// extension is listed as well.
+static bool GlExtensionAvailable( const char * name )
+{
+	const char * extensions = (const char *)glGetString( GL_EXTENSIONS );
+	const size_t length = strlen( name );
+	for ( const char * s = extensions; s != NULL && ( s = strstr( s, name ) ) != NULL; s += length )
+	{
+		if ( ( s == extensions || s[-1] == ' ' ) && ( s[length] == ' ' || s[length] == '\0' ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Multiview variant: a single texture array swap chain with one layer per eye,
+// rendered in one pass through GL_OVR_multiview2. Fails rather than dropping
+// MSAA, so that the caller can fall back to one multisampled buffer per eye.
+static bool ovrFramebuffer_CreateMultiview( ovrFramebuffer * frameBuffer, const GLenum colorFormat, const int width, const int height, const int multisamples )
+{
+	PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC glFramebufferTextureMultiviewOVR =
+			(PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC)eglGetProcAddress("glFramebufferTextureMultiviewOVR");
+	PFNGLFRAMEBUFFERTEXTUREMULTISAMPLEMULTIVIEWOVRPROC glFramebufferTextureMultisampleMultiviewOVR =
+			(PFNGLFRAMEBUFFERTEXTUREMULTISAMPLEMULTIVIEWOVRPROC)eglGetProcAddress("glFramebufferTextureMultisampleMultiviewOVR");
+
+	if ( glFramebufferTextureMultiviewOVR == NULL || !GlExtensionAvailable( "GL_OVR_multiview2" ) )
+	{
+		ALOGE( "GL_OVR_multiview2 not available" );
+		return false;
+	}
+	if ( multisamples > 1 && ( glFramebufferTextureMultisampleMultiviewOVR == NULL ||
+							   !GlExtensionAvailable( "GL_OVR_multiview_multisampled_render_to_texture" ) ) )
+	{
+		ALOGE( "%dx MSAA requested, but GL_OVR_multiview_multisampled_render_to_texture is not available", multisamples );
+		return false;
+	}
+
+	frameBuffer->Width = width;
+	frameBuffer->Height = height;
+	frameBuffer->ViewportWidth = width;
+	frameBuffer->ViewportHeight = height;
+	frameBuffer->Multisamples = multisamples;
+	frameBuffer->UseMultiview = true;
+
+	frameBuffer->ColorTextureSwapChain = vrapi_CreateTextureSwapChain3( VRAPI_TEXTURE_TYPE_2D_ARRAY, colorFormat, frameBuffer->Width, frameBuffer->Height, 1, 3 );
+	frameBuffer->TextureSwapChainLength = vrapi_GetTextureSwapChainLength( frameBuffer->ColorTextureSwapChain );
+	frameBuffer->DepthBuffers = (GLuint *)calloc( frameBuffer->TextureSwapChainLength, sizeof( GLuint ) );
+	frameBuffer->FrameBuffers = (GLuint *)calloc( frameBuffer->TextureSwapChainLength, sizeof( GLuint ) );
+
+	for ( int i = 0; i < frameBuffer->TextureSwapChainLength; i++ )
+	{
+		// Create the color buffer texture.
+		const GLuint colorTexture = vrapi_GetTextureSwapChainHandle( frameBuffer->ColorTextureSwapChain, i );
+		GL( glBindTexture( GL_TEXTURE_2D_ARRAY, colorTexture ) );
+		GL( glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE ) );
+		GL( glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE ) );
+		GL( glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR ) );
+		GL( glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR ) );
+		GL( glBindTexture( GL_TEXTURE_2D_ARRAY, 0 ) );
+
+		// Layered rendering needs a depth texture array rather than a renderbuffer.
+		GL( glGenTextures( 1, &frameBuffer->DepthBuffers[i] ) );
+		GL( glBindTexture( GL_TEXTURE_2D_ARRAY, frameBuffer->DepthBuffers[i] ) );
+		GL( glTexStorage3D( GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT24, width, height, 2 ) );
+		GL( glBindTexture( GL_TEXTURE_2D_ARRAY, 0 ) );
+
+		// Create the frame buffer.
+		GL( glGenFramebuffers( 1, &frameBuffer->FrameBuffers[i] ) );
+		GL( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, frameBuffer->FrameBuffers[i] ) );
+		if ( multisamples > 1 )
+		{
+			GL( glFramebufferTextureMultisampleMultiviewOVR( GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, frameBuffer->DepthBuffers[i], 0, multisamples, 0, 2 ) );
+			GL( glFramebufferTextureMultisampleMultiviewOVR( GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorTexture, 0, multisamples, 0, 2 ) );
+		}
+		else
+		{
+			GL( glFramebufferTextureMultiviewOVR( GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, frameBuffer->DepthBuffers[i], 0, 0, 2 ) );
+			GL( glFramebufferTextureMultiviewOVR( GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorTexture, 0, 0, 2 ) );
+		}
+		GL( GLenum renderFramebufferStatus = glCheckFramebufferStatus( GL_DRAW_FRAMEBUFFER ) );
+		GL( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, 0 ) );
+		if ( renderFramebufferStatus != GL_FRAMEBUFFER_COMPLETE )
+		{
+			ALOGE( "Incomplete multiview frame buffer object: %s", GlFrameBufferStatusString( renderFramebufferStatus ) );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Renders without MSAA, and says so, if GL_EXT_multisampled_render_to_texture
+// is not available.
+static bool ovrFramebuffer_Create( ovrFramebuffer * frameBuffer, const GLenum colorFormat, const int width, const int height, int multisamples )
+{
+    PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXTPROC glRenderbufferStorageMultisampleEXT =
+            (PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXTPROC)eglGetProcAddress("glRenderbufferStorageMultisampleEXT");
+    PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC glFramebufferTexture2DMultisampleEXT =
+            (PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC)eglGetProcAddress("glFramebufferTexture2DMultisampleEXT");
+
+	if ( multisamples > 1 && ( glRenderbufferStorageMultisampleEXT == NULL || glFramebufferTexture2DMultisampleEXT == NULL ||
+							   !GlExtensionAvailable( "GL_EXT_multisampled_render_to_texture" ) ) )
+	{
+		ALOGE( "%dx MSAA requested, but GL_EXT_multisampled_render_to_texture is not available, rendering without MSAA", multisamples );
+		multisamples = 1;
+	}
+
+    frameBuffer->Width = width;
+	frameBuffer->Height = height;
+	frameBuffer->ViewportWidth = width;
+	frameBuffer->ViewportHeight = height;
+	frameBuffer->Multisamples = multisamples;
+
+	frameBuffer->ColorTextureSwapChain = vrapi_CreateTextureSwapChain3( VRAPI_TEXTURE_TYPE_2D, colorFormat, frameBuffer->Width, frameBuffer->Height, 1, 3 );
+	frameBuffer->TextureSwapChainLength = vrapi_GetTextureSwapChainLength( frameBuffer->ColorTextureSwapChain );
+	frameBuffer->DepthBuffers = (GLuint *)malloc( frameBuffer->TextureSwapChainLength * sizeof( GLuint ) );
+	frameBuffer->FrameBuffers = (GLuint *)malloc( frameBuffer->TextureSwapChainLength * sizeof( GLuint ) );
+
+	for ( int i = 0; i < frameBuffer->TextureSwapChainLength; i++ )
+	{
+		// Create the color buffer texture.
+		const GLuint colorTexture = vrapi_GetTextureSwapChainHandle( frameBuffer->ColorTextureSwapChain, i );
+		GLenum colorTextureTarget = GL_TEXTURE_2D;
+		GL( glBindTexture( colorTextureTarget, colorTexture ) );
+        // Just clamp to edge. However, this requires manually clearing the border
+        // around the layer to clear the edge texels.
+        GL( glTexParameteri( colorTextureTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE ) );
+        GL( glTexParameteri( colorTextureTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE ) );
+
+		GL( glTexParameteri( colorTextureTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR ) );
+		GL( glTexParameteri( colorTextureTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR ) );
+		GL( glBindTexture( colorTextureTarget, 0 ) );
+
+        if (multisamples > 1)
+        {
+
+            // Create multisampled depth buffer.
+            GL(glGenRenderbuffers(1, &frameBuffer->DepthBuffers[i]));
+            GL(glBindRenderbuffer(GL_RENDERBUFFER, frameBuffer->DepthBuffers[i]));
+            GL(glRenderbufferStorageMultisampleEXT(GL_RENDERBUFFER, multisamples, GL_DEPTH_COMPONENT24, width, height));
+            GL(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+            // Create the frame buffer.
+            GL(glGenFramebuffers(1, &frameBuffer->FrameBuffers[i]));
+            GL(glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer->FrameBuffers[i]));
+            GL(glFramebufferTexture2DMultisampleEXT(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0, multisamples));
+            GL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, frameBuffer->DepthBuffers[i]));
+            GL(GLenum renderFramebufferStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+            GL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+            if (renderFramebufferStatus != GL_FRAMEBUFFER_COMPLETE)
+            {
+                ALOGE("OVRHelper::Incomplete frame buffer object: %s", GlFrameBufferStatusString(renderFramebufferStatus));
+                return false;
+            }
+        }
+        else
+        {
+            {
+                // Create depth buffer.
+                GL( glGenRenderbuffers( 1, &frameBuffer->DepthBuffers[i] ) );
+                GL( glBindRenderbuffer( GL_RENDERBUFFER, frameBuffer->DepthBuffers[i] ) );
+                GL( glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, frameBuffer->Width, frameBuffer->Height ) );
+                GL( glBindRenderbuffer( GL_RENDERBUFFER, 0 ) );
+
+                // Create the frame buffer.
+                GL( glGenFramebuffers( 1, &frameBuffer->FrameBuffers[i] ) );
+                GL( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, frameBuffer->FrameBuffers[i] ) );
+                GL( glFramebufferRenderbuffer( GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, frameBuffer->DepthBuffers[i] ) );
+                GL( glFramebufferTexture2D( GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0 ) );
+                GL( GLenum renderFramebufferStatus = glCheckFramebufferStatus( GL_DRAW_FRAMEBUFFER ) );
+                GL( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, 0 ) );
+                if ( renderFramebufferStatus != GL_FRAMEBUFFER_COMPLETE )
+                {
+                    ALOGE( "Incomplete frame buffer object: %s", GlFrameBufferStatusString( renderFramebufferStatus ) );
+                    return false;
+                }
+            }
+        }
+	}
+
+	return true;
+}
+
+void ovrFramebuffer_Destroy( ovrFramebuffer * frameBuffer )
+{
+	GL( glDeleteFramebuffers( frameBuffer->TextureSwapChainLength, frameBuffer->FrameBuffers ) );
+	if ( frameBuffer->UseMultiview )
+	{
+		GL( glDeleteTextures( frameBuffer->TextureSwapChainLength, frameBuffer->DepthBuffers ) );
+	}
+	else
+	{
+		GL( glDeleteRenderbuffers( frameBuffer->TextureSwapChainLength, frameBuffer->DepthBuffers ) );
+	}
+
+	vrapi_DestroyTextureSwapChain( frameBuffer->ColorTextureSwapChain );
+
+	free( frameBuffer->DepthBuffers );
+	free( frameBuffer->FrameBuffers );
+
+	ovrFramebuffer_Clear( frameBuffer );
+}
+
+void ovrFramebuffer_SetCurrent( ovrFramebuffer * frameBuffer )
+{
+	GL( glBindFramebuffer( GL_FRAMEBUFFER, frameBuffer->FrameBuffers[frameBuffer->ProcessingTextureSwapChainIndex] ) );
+}
+
+void ovrFramebuffer_SetNone()
+{
+	GL( glBindFramebuffer( GL_DRAW_FRAMEBUFFER, 0 ) );
+}
+
+void ovrFramebuffer_Resolve( ovrFramebuffer * frameBuffer )
+{
+	// Discard the depth buffer, so the tiler won't need to write it back out to memory.
+	const GLenum depthAttachment[1] = { GL_DEPTH_ATTACHMENT };
+	glInvalidateFramebuffer( GL_DRAW_FRAMEBUFFER, 1, depthAttachment );
+
+    // Flush this frame worth of commands.
+    glFlush();
+}
+
+void ovrFramebuffer_Advance( ovrFramebuffer * frameBuffer )
+{
+	// Advance to the next texture from the set.
+    frameBuffer->ReadyTextureSwapChainIndex = frameBuffer->ProcessingTextureSwapChainIndex;
+	frameBuffer->ProcessingTextureSwapChainIndex = ( frameBuffer->ProcessingTextureSwapChainIndex + 1 ) % frameBuffer->TextureSwapChainLength;
+}
+
+
+void ovrFramebuffer_ClearEdgeTexels( ovrFramebuffer * frameBuffer )
+{
+	// Only the rendered sub-rectangle is sampled by the compositor
+	const int width = frameBuffer->ViewportWidth;
+	const int height = frameBuffer->ViewportHeight;
+
+	GL( glEnable( GL_SCISSOR_TEST ) );
+	GL( glViewport( 0, 0, width, height ) );
+
+	// Explicitly clear the border texels to black because OpenGL-ES does not support GL_CLAMP_TO_BORDER.
+	// Clear to fully opaque black.
+	GL( glClearColor( 0.0f, 0.0f, 0.0f, 1.0f ) );
+
+	// bottom
+	GL( glScissor( 0, 0, width, 1 ) );
+	GL( glClear( GL_COLOR_BUFFER_BIT ) );
+	// top
+	GL( glScissor( 0, height - 1, width, 1 ) );
+	GL( glClear( GL_COLOR_BUFFER_BIT ) );
+	// left
+	GL( glScissor( 0, 0, 1, height ) );
+	GL( glClear( GL_COLOR_BUFFER_BIT ) );
+	// right
+	GL( glScissor( width - 1, 0, 1, height ) );
+	GL( glClear( GL_COLOR_BUFFER_BIT ) );
+
+
+	GL( glScissor( 0, 0, 0, 0 ) );
+	GL( glDisable( GL_SCISSOR_TEST ) );
+}
+
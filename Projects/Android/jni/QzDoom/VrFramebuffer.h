@@ -0,0 +1,42 @@
+/************************************************************************************
+
+Filename	:	VrFramebuffer.h
+Content		:	Eye buffer frame buffers on top of a VrApi texture swap chain
+				(VrFramebuffer.c). Only the swap chain type is taken from VrApi,
+				so that the frame buffers can be tested on a desktop GLES
+				implementation with a stub swap chain (see framebuffertest.c).
+
+*************************************************************************************/
+
+#if !defined(vrframebuffer_h)
+#define vrframebuffer_h
+
+#include <stdbool.h>
+#include <GLES3/gl3.h>
+
+struct ovrTextureSwapChain;
+
+typedef struct
+{
+	int							Width;
+	int							Height;
+	int							ViewportWidth;	// rendered sub-rectangle
+	int							ViewportHeight;
+	int							Multisamples;	// as created, 1 if MSAA was not available
+	bool						UseMultiview;
+	int							TextureSwapChainLength;
+	int							ProcessingTextureSwapChainIndex;
+	int							ReadyTextureSwapChainIndex;
+	struct ovrTextureSwapChain *	ColorTextureSwapChain;
+	GLuint *					DepthBuffers;
+	GLuint *					FrameBuffers;
+} ovrFramebuffer;
+
+void ovrFramebuffer_SetCurrent( ovrFramebuffer * frameBuffer );
+void ovrFramebuffer_Destroy( ovrFramebuffer * frameBuffer );
+void ovrFramebuffer_SetNone();
+void ovrFramebuffer_Resolve( ovrFramebuffer * frameBuffer );
+void ovrFramebuffer_Advance( ovrFramebuffer * frameBuffer );
+void ovrFramebuffer_ClearEdgeTexels( ovrFramebuffer * frameBuffer );
+
+#endif //vrframebuffer_h
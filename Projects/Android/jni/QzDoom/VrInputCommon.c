@@ -46,30 +46,15 @@ void handleTrackedControllerButton(ovrInputStateTrackedRemote * trackedRemoteSta
     Joy_GenerateButtonEvents(prevTrackedRemoteState->Buttons & button ? 1 : 0, trackedRemoteState->Buttons & button ? 1 : 0, 1, key);
 }
 
-static void Matrix4x4_Transform (const matrix4x4 *in, const float v[3], float out[3])
-{
-    out[0] = v[0] * (*in)[0][0] + v[1] * (*in)[0][1] + v[2] * (*in)[0][2] + (*in)[0][3];
-    out[1] = v[0] * (*in)[1][0] + v[1] * (*in)[1][1] + v[2] * (*in)[1][2] + (*in)[1][3];
-    out[2] = v[0] * (*in)[2][0] + v[1] * (*in)[2][1] + v[2] * (*in)[2][2] + (*in)[2][3];
-}
-
-void Matrix4x4_CreateFromEntity( matrix4x4 out, const vec3_t angles, const vec3_t origin, float scale );
-
+//Rotates a 2D vector by a yaw in degrees, same result as transforming it by
+//Matrix4x4_CreateFromEntity({0, rotation, 0}) without building the matrix
 void rotateAboutOrigin(float v1, float v2, float rotation, vec2_t out)
 {
-    vec3_t temp = {0.0f, 0.0f, 0.0f};
-    temp[0] = v1;
-    temp[1] = v2;
-
-    vec3_t v = {0.0f, 0.0f, 0.0f};
-    matrix4x4 matrix;
-    vec3_t angles = {0.0f, rotation, 0.0f};
-    vec3_t origin = {0.0f, 0.0f, 0.0f};
-    Matrix4x4_CreateFromEntity(matrix, angles, origin, 1.0f);
-    Matrix4x4_Transform(&matrix, temp, v);
-
-    out[0] = v[0];
-    out[1] = v[1];
+    float s, c;
+    SinCos(DEG2RAD(rotation), &s, &c);
+
+    out[0] = c * v1 - s * v2;
+    out[1] = s * v1 + c * v2;
 }
 
 float length(float x, float y)
@@ -0,0 +1,155 @@
+/************************************************************************************
+
+Filename	:	VrMessageQueue.c
+Content		:	Compiled as part of QzDoom_SurfaceView.c, which includes it,
+				and on its own by mqbench.c. Don't list it in a makefile
+				next to QzDoom_SurfaceView.c.
+
+*************************************************************************************/
+
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "VrMessageQueue.h"
+
+/*
+================================================================================
+
+ovrMessageQueue
+
+================================================================================
+*/
+
+void ovrMessage_Init( ovrMessage * message, const int id, const int wait )
+{
+	message->Id = id;
+	message->Wait = wait;
+	memset( message->Parms, 0, sizeof( message->Parms ) );
+}
+
+void	ovrMessage_SetPointerParm( ovrMessage * message, int index, void * ptr ) { *(void **)&message->Parms[index] = ptr; }
+void *	ovrMessage_GetPointerParm( ovrMessage * message, int index ) { return *(void **)&message->Parms[index]; }
+void	ovrMessage_SetIntegerParm( ovrMessage * message, int index, int value ) { message->Parms[index] = value; }
+int		ovrMessage_GetIntegerParm( ovrMessage * message, int index ) { return (int)message->Parms[index]; }
+void	ovrMessage_SetFloatParm( ovrMessage * message, int index, float value ) { *(float *)&message->Parms[index] = value; }
+float	ovrMessage_GetFloatParm( ovrMessage * message, int index ) { return *(float *)&message->Parms[index]; }
+
+static void ovrFutex_Wait( atomic_int * addr, const int value )
+{
+	syscall( __NR_futex, (int *)addr, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0 );
+}
+
+static void ovrFutex_WakeAll( atomic_int * addr )
+{
+	syscall( __NR_futex, (int *)addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+}
+
+// Sleeps until the counter has reached 'target', tolerating wrap-around.
+static void ovrFutex_WaitUntil( atomic_int * addr, const int target )
+{
+	for ( ; ; )
+	{
+		const int value = atomic_load_explicit( addr, memory_order_acquire );
+		if ( value - target >= 0 )
+		{
+			return;
+		}
+		ovrFutex_Wait( addr, value );
+	}
+}
+
+void ovrMessageQueue_Create( ovrMessageQueue * messageQueue )
+{
+	atomic_init( &messageQueue->Head, 0 );
+	atomic_init( &messageQueue->Tail, 0 );
+	atomic_init( &messageQueue->ReceivedSeq, 0 );
+	atomic_init( &messageQueue->ProcessedSeq, 0 );
+	messageQueue->PendingSeq = 0;
+	messageQueue->Wait = MQ_WAIT_NONE;
+	atomic_init( &messageQueue->EnabledFlag, false );
+}
+
+void ovrMessageQueue_Destroy( ovrMessageQueue * messageQueue )
+{
+}
+
+void ovrMessageQueue_Enable( ovrMessageQueue * messageQueue, const bool set )
+{
+	atomic_store_explicit( &messageQueue->EnabledFlag, set, memory_order_release );
+}
+
+void ovrMessageQueue_PostMessage( ovrMessageQueue * messageQueue, const ovrMessage * message )
+{
+	if ( !atomic_load_explicit( &messageQueue->EnabledFlag, memory_order_acquire ) )
+	{
+		return;
+	}
+	const int tail = atomic_load_explicit( &messageQueue->Tail, memory_order_relaxed );
+	// Wait for the consumer to free a slot.
+	ovrFutex_WaitUntil( &messageQueue->Head, tail - MAX_MESSAGES + 1 );
+
+	messageQueue->Messages[tail & ( MAX_MESSAGES - 1 )] = *message;
+	atomic_store_explicit( &messageQueue->Tail, tail + 1, memory_order_release );
+	ovrFutex_WakeAll( &messageQueue->Tail );
+
+	if ( message->Wait == MQ_WAIT_RECEIVED )
+	{
+		ovrFutex_WaitUntil( &messageQueue->ReceivedSeq, tail + 1 );
+	}
+	else if ( message->Wait == MQ_WAIT_PROCESSED )
+	{
+		ovrFutex_WaitUntil( &messageQueue->ProcessedSeq, tail + 1 );
+	}
+}
+
+static void ovrMessageQueue_SignalProcessed( ovrMessageQueue * messageQueue )
+{
+	if ( messageQueue->Wait == MQ_WAIT_PROCESSED )
+	{
+		atomic_store_explicit( &messageQueue->ProcessedSeq, messageQueue->PendingSeq, memory_order_release );
+		ovrFutex_WakeAll( &messageQueue->ProcessedSeq );
+		messageQueue->Wait = MQ_WAIT_NONE;
+	}
+}
+
+void ovrMessageQueue_SleepUntilMessage( ovrMessageQueue * messageQueue )
+{
+	ovrMessageQueue_SignalProcessed( messageQueue );
+	const int head = atomic_load_explicit( &messageQueue->Head, memory_order_relaxed );
+	ovrFutex_WaitUntil( &messageQueue->Tail, head + 1 );
+}
+
+bool ovrMessageQueue_GetNextMessage( ovrMessageQueue * messageQueue, ovrMessage * message, bool waitForMessages )
+{
+	ovrMessageQueue_SignalProcessed( messageQueue );
+	if ( waitForMessages )
+	{
+		ovrMessageQueue_SleepUntilMessage( messageQueue );
+	}
+	const int head = atomic_load_explicit( &messageQueue->Head, memory_order_relaxed );
+	const int tail = atomic_load_explicit( &messageQueue->Tail, memory_order_acquire );
+	if ( tail - head <= 0 )
+	{
+		return false;
+	}
+	*message = messageQueue->Messages[head & ( MAX_MESSAGES - 1 )];
+	atomic_store_explicit( &messageQueue->Head, head + 1, memory_order_release );
+	// Always wake the head: the producer may have filled the queue and gone to
+	// sleep after 'tail' was read, so the count seen here cannot tell whether
+	// it is waiting. Messages are rare and a wake without waiters is cheap.
+	ovrFutex_WakeAll( &messageQueue->Head );
+	if ( message->Wait == MQ_WAIT_RECEIVED )
+	{
+		atomic_store_explicit( &messageQueue->ReceivedSeq, head + 1, memory_order_release );
+		ovrFutex_WakeAll( &messageQueue->ReceivedSeq );
+	}
+	else if ( message->Wait == MQ_WAIT_PROCESSED )
+	{
+		messageQueue->PendingSeq = head + 1;
+		messageQueue->Wait = MQ_WAIT_PROCESSED;
+	}
+	return true;
+}
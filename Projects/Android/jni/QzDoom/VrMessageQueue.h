@@ -0,0 +1,64 @@
+/************************************************************************************
+
+Filename	:	VrMessageQueue.h
+Content		:	Message queue between the Java UI thread and the render thread.
+				Has no VrApi, EGL or android dependencies so that it can be
+				built and benchmarked on a desktop (see mqbench.c).
+
+*************************************************************************************/
+
+#if !defined(vrmessagequeue_h)
+#define vrmessagequeue_h
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+typedef enum
+{
+	MQ_WAIT_NONE,		// don't wait
+	MQ_WAIT_RECEIVED,	// wait until the consumer thread has received the message
+	MQ_WAIT_PROCESSED	// wait until the consumer thread has processed the message
+} ovrMQWait;
+
+#define MAX_MESSAGE_PARMS	8
+#define MAX_MESSAGES		1024
+
+typedef struct
+{
+	int			Id;
+	ovrMQWait	Wait;
+	long long	Parms[MAX_MESSAGE_PARMS];
+} ovrMessage;
+
+void	ovrMessage_Init( ovrMessage * message, const int id, const int wait );
+void	ovrMessage_SetPointerParm( ovrMessage * message, int index, void * ptr );
+void *	ovrMessage_GetPointerParm( ovrMessage * message, int index );
+void	ovrMessage_SetIntegerParm( ovrMessage * message, int index, int value );
+int		ovrMessage_GetIntegerParm( ovrMessage * message, int index );
+void	ovrMessage_SetFloatParm( ovrMessage * message, int index, float value );
+float	ovrMessage_GetFloatParm( ovrMessage * message, int index );
+
+// Lock-free single-producer / single-consumer cyclic queue with messages.
+// The producer is the Java UI thread, the consumer is the render thread.
+// Head and Tail are free-running counters; the consumer polls without taking
+// any lock and only the (rare) blocking cases go through a futex wait.
+typedef struct
+{
+	ovrMessage	 		Messages[MAX_MESSAGES];
+	atomic_int			Head;			// dequeue at the head
+	atomic_int			Tail;			// enqueue at the tail
+	atomic_int			ReceivedSeq;	// one past the last message received by the consumer
+	atomic_int			ProcessedSeq;	// one past the last message processed by the consumer
+	int					PendingSeq;		// consumer only: message waiting for MQ_WAIT_PROCESSED
+	ovrMQWait			Wait;
+	atomic_bool			EnabledFlag;
+} ovrMessageQueue;
+
+void	ovrMessageQueue_Create( ovrMessageQueue * messageQueue );
+void	ovrMessageQueue_Destroy( ovrMessageQueue * messageQueue );
+void	ovrMessageQueue_Enable( ovrMessageQueue * messageQueue, const bool set );
+void	ovrMessageQueue_PostMessage( ovrMessageQueue * messageQueue, const ovrMessage * message );
+void	ovrMessageQueue_SleepUntilMessage( ovrMessageQueue * messageQueue );
+bool	ovrMessageQueue_GetNextMessage( ovrMessageQueue * messageQueue, ovrMessage * message, bool waitForMessages );
+
+#endif //vrmessagequeue_h
@@ -0,0 +1,181 @@
+/************************************************************************************
+
+Filename	:	dynrestest.c
+Content		:	Drives ovrDynamicResolution (VrDynamicResolution.c) with
+				synthetic frame time traces and checks how the scale responds.
+				The frame work time of the simulated renderer is a fixed CPU
+				part plus a GPU part proportional to the rendered pixels.
+
+				This is not part of the Android build; on a desktop:
+
+				cc -O2 -o dynrestest dynrestest.c VrDynamicResolution.c
+				./dynrestest [-v]
+
+*************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "VrDynamicResolution.h"
+
+#define TARGET_MS		( 1000.0f / 72.0f )
+#define EYE_SIZE		1440
+
+static bool verbose;
+static int failures;
+
+static void Check( const bool ok, const char * test, const char * what )
+{
+	if ( !ok )
+	{
+		printf( "FAIL %s: %s\n", test, what );
+		failures++;
+	}
+}
+
+// Work time of one frame rendered at 'scale'; 'load' is the work at full size.
+static float FrameMs( const float load, const float cpuMs, const float scale )
+{
+	return cpuMs + ( load - cpuMs ) * scale * scale;
+}
+
+typedef struct
+{
+	float	MinScale;			// lowest scale seen
+	float	MaxScale;
+	float	FinalScale;
+	int		Missed;				// frames whose interval overran the vsync
+	int		LastMissed;			// last frame that missed, -1 if none
+} traceResult;
+
+// Runs frames [0, frames) with the full size work time given by load(frame),
+// a frame misses vsync when its work time exceeds the budget.
+static traceResult RunTrace( ovrDynamicResolution * dr, const char * name, float ( *load )( int ), const float cpuMs, const int frames )
+{
+	traceResult r;
+	r.MinScale = 1.0f;
+	r.MaxScale = 0.0f;
+	r.Missed = 0;
+	r.LastMissed = -1;
+
+	float scale = dr->Scale;
+	for ( int frame = 0; frame < frames; frame++ )
+	{
+		const float workMs = FrameMs( load( frame ), cpuMs, scale );
+		const bool missed = workMs > TARGET_MS;
+		if ( missed )
+		{
+			r.Missed++;
+			r.LastMissed = frame;
+		}
+		scale = ovrDynamicResolution_Update( dr, workMs, missed );
+		r.MinScale = fminf( r.MinScale, scale );
+		r.MaxScale = fmaxf( r.MaxScale, scale );
+		if ( verbose && frame % 20 == 0 )
+		{
+			printf( "%-10s %4d work %6.2f ms scale %.3f size %d\n", name, frame, workMs, scale,
+					ovrDynamicResolution_ScaleSize( dr, EYE_SIZE ) );
+		}
+	}
+	r.FinalScale = scale;
+	return r;
+}
+
+static float LightLoad( int frame ) { return 8.0f; }
+static float HeavyLoad( int frame ) { return 20.0f; }
+static float ExtremeLoad( int frame ) { return 60.0f; }
+static float SpikeLoad( int frame ) { return frame == 100 ? 40.0f : 8.0f; }
+static float HeavyThenLight( int frame ) { return frame < 300 ? 20.0f : 8.0f; }
+static float NearBudget( int frame ) { return 11.5f + ( frame & 1 ) * 0.5f; }
+
+int main( int argc, char * argv[] )
+{
+	ovrDynamicResolution dr;
+	traceResult r;
+
+	verbose = argc > 1 && strcmp( argv[1], "-v" ) == 0;
+
+	// Disabled: any trace leaves the full size.
+	ovrDynamicResolution_Init( &dr, 1.0f, TARGET_MS );
+	r = RunTrace( &dr, "disabled", HeavyLoad, 2.0f, 300 );
+	Check( !dr.Enabled && r.FinalScale == 1.0f && r.MinScale == 1.0f, "disabled", "scale changed" );
+	Check( ovrDynamicResolution_ScaleSize( &dr, EYE_SIZE + 3 ) == EYE_SIZE + 3, "disabled", "size changed" );
+
+	// Headroom: stays at full size.
+	ovrDynamicResolution_Init( &dr, 0.5f, TARGET_MS );
+	r = RunTrace( &dr, "light", LightLoad, 2.0f, 600 );
+	Check( r.MinScale == 1.0f && r.Missed == 0, "light", "scaled down without need" );
+
+	// Between the watermarks: holds the scale, no oscillation.
+	ovrDynamicResolution_Init( &dr, 0.5f, TARGET_MS );
+	r = RunTrace( &dr, "nearbudget", NearBudget, 2.0f, 600 );
+	Check( r.MinScale == 1.0f && r.Missed == 0, "nearbudget", "scale moved inside the dead band" );
+
+	// Sustained overload: settles below the budget within a second and stays there.
+	ovrDynamicResolution_Init( &dr, 0.5f, TARGET_MS );
+	r = RunTrace( &dr, "heavy", HeavyLoad, 2.0f, 1000 );
+	Check( r.LastMissed < 72, "heavy", "still missing vsync after a second" );
+	Check( FrameMs( 20.0f, 2.0f, r.FinalScale ) <= TARGET_MS, "heavy", "settled over budget" );
+	Check( r.FinalScale > 0.5f, "heavy", "dropped to the minimum with room to spare" );
+	{
+		// Steady state: the scale moves by at most a couple of steps.
+		const traceResult steady = RunTrace( &dr, "heavy2", HeavyLoad, 2.0f, 1000 );
+		Check( steady.MaxScale - steady.MinScale < 0.1f && steady.Missed == 0, "heavy", "oscillates" );
+	}
+
+	// Impossible load: clamps at the minimum.
+	ovrDynamicResolution_Init( &dr, 0.6f, TARGET_MS );
+	r = RunTrace( &dr, "extreme", ExtremeLoad, 2.0f, 300 );
+	Check( r.FinalScale == 0.6f && r.MinScale == 0.6f, "extreme", "not clamped at the minimum" );
+
+	// One missed frame: drops at once, then recovers to full size.
+	ovrDynamicResolution_Init( &dr, 0.5f, TARGET_MS );
+	r = RunTrace( &dr, "spike", SpikeLoad, 2.0f, 101 );
+	Check( fabsf( r.FinalScale - 0.85f ) < 1e-6f, "spike", "missed frame did not drop the scale" );
+	r = RunTrace( &dr, "spike", SpikeLoad, 2.0f, 400 );
+	Check( r.FinalScale == 1.0f, "spike", "did not recover" );
+
+	// Load goes away: grows back to full size, slowly.
+	ovrDynamicResolution_Init( &dr, 0.5f, TARGET_MS );
+	r = RunTrace( &dr, "heavylight", HeavyThenLight, 2.0f, 300 );
+	const float reduced = r.FinalScale;
+	int framesToRecover = 0;
+	while ( dr.Scale < 1.0f && framesToRecover < 2000 )
+	{
+		ovrDynamicResolution_Update( &dr, FrameMs( 8.0f, 2.0f, dr.Scale ), false );
+		framesToRecover++;
+	}
+	Check( reduced < 1.0f && dr.Scale == 1.0f, "heavylight", "did not grow back" );
+	Check( framesToRecover > 72, "heavylight", "grew back within a second, expect visible pumping" );
+
+	// Viewport sizes: multiples of the granularity inside the buffer.
+	ovrDynamicResolution_Init( &dr, 0.01f, TARGET_MS );
+	for ( int i = 0; i < 400; i++ )
+	{
+		dr.Scale = 0.01f + i * ( 0.99f / 399 );
+		for ( int size = 1; size <= 2048; size += 7 )
+		{
+			const int scaled = ovrDynamicResolution_ScaleSize( &dr, size );
+			if ( scaled % DYNRES_SCALE_GRANULARITY != 0 && scaled != size )
+			{
+				Check( false, "scalesize", "not a multiple of the granularity" );
+				i = 400;
+				break;
+			}
+			if ( scaled > size && size >= DYNRES_SCALE_GRANULARITY )
+			{
+				Check( false, "scalesize", "larger than the buffer" );
+				i = 400;
+				break;
+			}
+		}
+	}
+
+	if ( failures == 0 )
+	{
+		printf( "all dynamic resolution traces passed\n" );
+	}
+	return failures == 0 ? 0 : 1;
+}
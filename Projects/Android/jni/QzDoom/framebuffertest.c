@@ -0,0 +1,481 @@
+/************************************************************************************
+
+Filename	:	framebuffertest.c
+Content		:	Creates the eye buffer frame buffers (VrFramebuffer.c) on a
+				desktop OpenGL ES 3 implementation, over a stub of the VrApi
+				texture swap chain that allocates its GL textures the way the
+				runtime does, and runs frames through them the way
+				QzDoom_prepareEyeBuffer and QzDoom_finishEyeBuffer do: the
+				swap chain entries must be rendered in turn, keep the
+				rendered sub-rectangle with black edge texels, and MSAA or
+				multiview that the driver lacks must be reported rather than
+				silently dropped. Multiview rendering is checked when the
+				driver has GL_OVR_multiview2; Mesa llvmpipe (22.x) has neither
+				that nor GL_EXT_multisampled_render_to_texture, so there only
+				the fallbacks run.
+
+				This is not part of the Android build; on a Linux desktop with
+				Mesa (a surfaceless EGL display, no window system needed):
+
+				cc -O2 -o framebuffertest framebuffertest.c -lEGL -lGLESv2
+				./framebuffertest [-v]
+
+*************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+
+static bool verbose;
+static int failures;
+static int logErrors;
+static int glErrors;
+
+static void LogError( const char * format, ... )
+{
+	va_list args;
+	va_start( args, format );
+	if ( verbose )
+	{
+		printf( "  ALOGE: " );
+		vprintf( format, args );
+		printf( "\n" );
+	}
+	va_end( args );
+	logErrors++;
+}
+
+static void CheckGlErrors( const int line )
+{
+	for ( GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError() )
+	{
+		printf( "GL error 0x%04x on line %d\n", error, line );
+		glErrors++;
+	}
+}
+
+#define ALOGE( ... )	LogError( __VA_ARGS__ )
+#define GL( func )		func; CheckGlErrors( __LINE__ );
+
+/*
+================================================================================
+
+Stub VrApi texture swap chain
+
+================================================================================
+*/
+
+typedef enum
+{
+	VRAPI_TEXTURE_TYPE_2D,
+	VRAPI_TEXTURE_TYPE_2D_ARRAY
+} ovrTextureType;
+
+#define MAX_SWAP_CHAIN_LENGTH	4
+
+struct ovrTextureSwapChain
+{
+	ovrTextureType	Type;
+	int				Length;
+	GLuint			Textures[MAX_SWAP_CHAIN_LENGTH];
+};
+typedef struct ovrTextureSwapChain ovrTextureSwapChain;
+
+static int liveSwapChains;
+
+// Both eyes are the two layers of a texture array swap chain.
+static ovrTextureSwapChain * vrapi_CreateTextureSwapChain3( ovrTextureType type, int64_t format, int width, int height, int levels, int bufferCount )
+{
+	ovrTextureSwapChain * chain = (ovrTextureSwapChain *)calloc( 1, sizeof( ovrTextureSwapChain ) );
+	const GLenum target = type == VRAPI_TEXTURE_TYPE_2D_ARRAY ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+	chain->Type = type;
+	chain->Length = bufferCount < MAX_SWAP_CHAIN_LENGTH ? bufferCount : MAX_SWAP_CHAIN_LENGTH;
+	glGenTextures( chain->Length, chain->Textures );
+	for ( int i = 0; i < chain->Length; i++ )
+	{
+		glBindTexture( target, chain->Textures[i] );
+		if ( type == VRAPI_TEXTURE_TYPE_2D_ARRAY )
+		{
+			glTexStorage3D( target, levels, (GLenum)format, width, height, 2 );
+		}
+		else
+		{
+			glTexStorage2D( target, levels, (GLenum)format, width, height );
+		}
+		glBindTexture( target, 0 );
+	}
+	liveSwapChains++;
+	return chain;
+}
+
+static int vrapi_GetTextureSwapChainLength( ovrTextureSwapChain * chain )
+{
+	return chain->Length;
+}
+
+static unsigned int vrapi_GetTextureSwapChainHandle( ovrTextureSwapChain * chain, int index )
+{
+	return chain->Textures[index];
+}
+
+static void vrapi_DestroyTextureSwapChain( ovrTextureSwapChain * chain )
+{
+	if ( chain != NULL )
+	{
+		glDeleteTextures( chain->Length, chain->Textures );
+		free( chain );
+		liveSwapChains--;
+	}
+}
+
+#include "VrFramebuffer.c"
+
+/*
+================================================================================
+
+Tests
+
+================================================================================
+*/
+
+#define WIDTH			64
+#define HEIGHT			48
+#define FRAMES			5
+
+static void Check( const bool ok, const char * test, const char * what )
+{
+	if ( !ok )
+	{
+		printf( "FAIL %s: %s\n", test, what );
+		failures++;
+	}
+}
+
+static bool CreateContext()
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress( "eglGetPlatformDisplayEXT" );
+	EGLDisplay display = eglGetPlatformDisplayEXT != NULL ?
+			eglGetPlatformDisplayEXT( EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL ) : EGL_NO_DISPLAY;
+	if ( display == EGL_NO_DISPLAY )
+	{
+		display = eglGetDisplay( EGL_DEFAULT_DISPLAY );
+	}
+	if ( display == EGL_NO_DISPLAY || !eglInitialize( display, NULL, NULL ) )
+	{
+		printf( "no EGL display\n" );
+		return false;
+	}
+
+	const EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR, EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_NONE };
+	EGLConfig config;
+	EGLint numConfigs = 0;
+	if ( !eglChooseConfig( display, configAttribs, &config, 1, &numConfigs ) || numConfigs == 0 )
+	{
+		printf( "no OpenGL ES 3 EGL config\n" );
+		return false;
+	}
+
+	const EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE };
+	eglBindAPI( EGL_OPENGL_ES_API );
+	EGLContext context = eglCreateContext( display, config, EGL_NO_CONTEXT, contextAttribs );
+	if ( context == EGL_NO_CONTEXT || !eglMakeCurrent( display, EGL_NO_SURFACE, EGL_NO_SURFACE, context ) )
+	{
+		printf( "no surfaceless OpenGL ES 3 context: EGL error 0x%04x\n", eglGetError() );
+		return false;
+	}
+
+	printf( "%s, %s\n", (const char *)glGetString( GL_RENDERER ), (const char *)glGetString( GL_VERSION ) );
+	return true;
+}
+
+typedef struct
+{
+	unsigned char	r, g, b;
+} rgb;
+
+static const rgb black = { 0, 0, 0 };
+
+static rgb ReadTexel( const GLuint texture, const bool array, const int layer, const int x, const int y )
+{
+	GLuint fbo;
+	unsigned char pixel[4] = { 0 };
+	GL( glGenFramebuffers( 1, &fbo ) );
+	GL( glBindFramebuffer( GL_READ_FRAMEBUFFER, fbo ) );
+	if ( array )
+	{
+		GL( glFramebufferTextureLayer( GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, layer ) );
+	}
+	else
+	{
+		GL( glFramebufferTexture2D( GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0 ) );
+	}
+	GL( glReadPixels( x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel ) );
+	GL( glBindFramebuffer( GL_READ_FRAMEBUFFER, 0 ) );
+	GL( glDeleteFramebuffers( 1, &fbo ) );
+	const rgb texel = { pixel[0], pixel[1], pixel[2] };
+	return texel;
+}
+
+static bool SameColor( const rgb a, const rgb b )
+{
+	return abs( a.r - b.r ) <= 1 && abs( a.g - b.g ) <= 1 && abs( a.b - b.b ) <= 1;
+}
+
+// Color the 'engine' draws into the viewport of a frame, and the one the
+// whole target is cleared to before.
+static rgb FrameColor( const int frame, const int eye )
+{
+	const rgb color = { (unsigned char)( 40 * ( frame + 1 ) ), (unsigned char)( 128 + 64 * eye ), 200 };
+	return color;
+}
+
+static const rgb clearColor = { 51, 0, 0 };
+
+// QzDoom_prepareEyeBuffer: clear the whole target, render into the viewport.
+static void PrepareEyeBuffer( ovrFramebuffer * frameBuffer, const int viewportWidth, const int viewportHeight, const rgb color )
+{
+	ovrFramebuffer_SetCurrent( frameBuffer );
+	frameBuffer->ViewportWidth = viewportWidth;
+	frameBuffer->ViewportHeight = viewportHeight;
+
+	GL( glEnable( GL_SCISSOR_TEST ) );
+	GL( glViewport( 0, 0, frameBuffer->Width, frameBuffer->Height ) );
+	GL( glScissor( 0, 0, frameBuffer->Width, frameBuffer->Height ) );
+	GL( glClearColor( clearColor.r / 255.0f, clearColor.g / 255.0f, clearColor.b / 255.0f, 1.0f ) );
+	GL( glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT ) );
+
+	// The engine's frame, a flat color over the viewport.
+	GL( glScissor( 0, 0, viewportWidth, viewportHeight ) );
+	GL( glClearColor( color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, 1.0f ) );
+	GL( glClear( GL_COLOR_BUFFER_BIT ) );
+	GL( glDisable( GL_SCISSOR_TEST ) );
+
+	GL( glViewport( 0, 0, viewportWidth, viewportHeight ) );
+}
+
+// QzDoom_finishEyeBuffer
+static void FinishEyeBuffer( ovrFramebuffer * frameBuffer )
+{
+	ovrFramebuffer_ClearEdgeTexels( frameBuffer );
+	ovrFramebuffer_Resolve( frameBuffer );
+	ovrFramebuffer_Advance( frameBuffer );
+	ovrFramebuffer_SetNone();
+}
+
+// The swap chain texture just advanced to holds the frame in the viewport,
+// black edge texels around it and the clear color outside.
+static void CheckEyeTexture( const ovrFramebuffer * frameBuffer, const int layer, const rgb color, const char * test )
+{
+	const GLuint texture = vrapi_GetTextureSwapChainHandle( frameBuffer->ColorTextureSwapChain, frameBuffer->ReadyTextureSwapChainIndex );
+	const bool array = frameBuffer->UseMultiview;
+	const int vw = frameBuffer->ViewportWidth;
+	const int vh = frameBuffer->ViewportHeight;
+
+	Check( SameColor( ReadTexel( texture, array, layer, vw / 2, vh / 2 ), color ), test, "viewport not rendered" );
+	Check( SameColor( ReadTexel( texture, array, layer, 0, vh / 2 ), black ), test, "left edge texel not cleared" );
+	Check( SameColor( ReadTexel( texture, array, layer, vw - 1, vh / 2 ), black ), test, "right edge texel not cleared" );
+	Check( SameColor( ReadTexel( texture, array, layer, vw / 2, 0 ), black ), test, "bottom edge texel not cleared" );
+	Check( SameColor( ReadTexel( texture, array, layer, vw / 2, vh - 1 ), black ), test, "top edge texel not cleared" );
+	Check( SameColor( ReadTexel( texture, array, layer, 1, 1 ), color ), test, "texel inside the edge cleared" );
+	if ( vw < frameBuffer->Width )
+	{
+		Check( SameColor( ReadTexel( texture, array, layer, vw, vh / 2 ), clearColor ), test, "edge cleared outside the viewport" );
+		Check( SameColor( ReadTexel( texture, array, layer, frameBuffer->Width - 1, frameBuffer->Height - 1 ), clearColor ), test, "target not cleared outside the viewport" );
+	}
+}
+
+// Viewport of a frame: full size, then scaled down as dynamic resolution does.
+static int ViewportSize( const int size, const int frame )
+{
+	return frame < 2 ? size : size * ( 10 - frame ) / 10;
+}
+
+// One buffer per eye, rendered through every swap chain entry in turn.
+static void TestPerEye( const int multisamples )
+{
+	char test[64];
+	snprintf( test, sizeof( test ), "per eye, %dx MSAA requested", multisamples );
+
+	const bool msaaAvailable = GlExtensionAvailable( "GL_EXT_multisampled_render_to_texture" );
+	const int logged = logErrors;
+	ovrFramebuffer frameBuffers[2];
+	for ( int eye = 0; eye < 2; eye++ )
+	{
+		ovrFramebuffer_Clear( &frameBuffers[eye] );
+		Check( ovrFramebuffer_Create( &frameBuffers[eye], GL_RGBA8, WIDTH, HEIGHT, multisamples ), test, "create failed" );
+	}
+	if ( failures > 0 )
+	{
+		return;
+	}
+
+	const int expected = multisamples > 1 && !msaaAvailable ? 1 : multisamples;
+	Check( frameBuffers[0].Multisamples == expected && frameBuffers[1].Multisamples == expected, test, "wrong sample count" );
+	Check( ( logErrors - logged ) == ( expected != multisamples ? 2 : 0 ), test, "MSAA fallback not reported, or reported without one" );
+	Check( frameBuffers[0].TextureSwapChainLength == 3, test, "swap chain length" );
+
+	for ( int frame = 0; frame < FRAMES; frame++ )
+	{
+		for ( int eye = 0; eye < 2; eye++ )
+		{
+			PrepareEyeBuffer( &frameBuffers[eye], ViewportSize( WIDTH, frame ), ViewportSize( HEIGHT, frame ), FrameColor( frame, eye ) );
+			FinishEyeBuffer( &frameBuffers[eye] );
+
+			Check( frameBuffers[eye].ReadyTextureSwapChainIndex == frame % 3, test, "swap chain entries not used in turn" );
+			CheckEyeTexture( &frameBuffers[eye], 0, FrameColor( frame, eye ), test );
+		}
+		if ( frame > 0 )
+		{
+			// The entry the compositor may still be showing is left alone.
+			const GLuint previous = vrapi_GetTextureSwapChainHandle( frameBuffers[0].ColorTextureSwapChain, ( frame - 1 ) % 3 );
+			Check( SameColor( ReadTexel( previous, false, 0, 1, 1 ), FrameColor( frame - 1, 0 ) ), test, "previous swap chain entry overwritten" );
+		}
+	}
+
+	for ( int eye = 0; eye < 2; eye++ )
+	{
+		ovrFramebuffer_Destroy( &frameBuffers[eye] );
+		Check( frameBuffers[eye].ColorTextureSwapChain == NULL && frameBuffers[eye].FrameBuffers == NULL, test, "destroy did not clear" );
+	}
+	if ( verbose )
+	{
+		printf( "%s: %d samples\n", test, expected );
+	}
+}
+
+static GLuint CreateMultiviewProgram()
+{
+	static const char * vertexSource =
+		"#version 300 es\n"
+		"#extension GL_OVR_multiview2 : require\n"
+		"layout( num_views = 2 ) in;\n"
+		"out vec4 color;\n"
+		"void main()\n"
+		"{\n"
+		"	gl_Position = vec4( float( ( gl_VertexID & 1 ) * 4 - 1 ), float( ( gl_VertexID & 2 ) * 2 - 1 ), 0.0, 1.0 );\n"
+		"	color = gl_ViewID_OVR == 0u ? vec4( 1.0, 0.0, 0.0, 1.0 ) : vec4( 0.0, 1.0, 0.0, 1.0 );\n"
+		"}\n";
+	static const char * fragmentSource =
+		"#version 300 es\n"
+		"precision mediump float;\n"
+		"in vec4 color;\n"
+		"out vec4 fragColor;\n"
+		"void main()\n"
+		"{\n"
+		"	fragColor = color;\n"
+		"}\n";
+
+	const GLuint vertexShader = glCreateShader( GL_VERTEX_SHADER );
+	GL( glShaderSource( vertexShader, 1, &vertexSource, NULL ) );
+	GL( glCompileShader( vertexShader ) );
+	const GLuint fragmentShader = glCreateShader( GL_FRAGMENT_SHADER );
+	GL( glShaderSource( fragmentShader, 1, &fragmentSource, NULL ) );
+	GL( glCompileShader( fragmentShader ) );
+	const GLuint program = glCreateProgram();
+	GL( glAttachShader( program, vertexShader ) );
+	GL( glAttachShader( program, fragmentShader ) );
+	GL( glLinkProgram( program ) );
+	GL( glDeleteShader( vertexShader ) );
+	GL( glDeleteShader( fragmentShader ) );
+
+	GLint linked = GL_FALSE;
+	GL( glGetProgramiv( program, GL_LINK_STATUS, &linked ) );
+	if ( !linked )
+	{
+		char log[1024];
+		glGetProgramInfoLog( program, sizeof( log ), NULL, log );
+		printf( "multiview program: %s\n", log );
+		glDeleteProgram( program );
+		return 0;
+	}
+	return program;
+}
+
+// Both eyes as layers of one buffer, drawn once with gl_ViewID_OVR picking the
+// color, or a reported failure without a swap chain left behind.
+static void TestMultiview( const int multisamples )
+{
+	char test[64];
+	snprintf( test, sizeof( test ), "multiview, %dx MSAA requested", multisamples );
+
+	const bool available = GlExtensionAvailable( "GL_OVR_multiview2" ) &&
+						   ( multisamples <= 1 || GlExtensionAvailable( "GL_OVR_multiview_multisampled_render_to_texture" ) );
+	const int logged = logErrors;
+	ovrFramebuffer frameBuffer;
+	ovrFramebuffer_Clear( &frameBuffer );
+	const bool created = ovrFramebuffer_CreateMultiview( &frameBuffer, GL_RGBA8, WIDTH, HEIGHT, multisamples );
+
+	if ( !available )
+	{
+		Check( !created, test, "created without the extensions" );
+		Check( logErrors > logged, test, "failure not reported" );
+		Check( frameBuffer.ColorTextureSwapChain == NULL && liveSwapChains == 0, test, "swap chain left behind" );
+		printf( "%s: not available, checked the reported failure only\n", test );
+		return;
+	}
+
+	Check( created, test, "create failed" );
+	Check( logErrors == logged, test, "errors reported" );
+	if ( !created )
+	{
+		return;
+	}
+
+	const GLuint program = CreateMultiviewProgram();
+	Check( program != 0, test, "no multiview program" );
+	GLuint vertexArray;
+	GL( glGenVertexArrays( 1, &vertexArray ) );
+
+	const rgb red = { 255, 0, 0 };
+	const rgb green = { 0, 255, 0 };
+	for ( int frame = 0; frame < FRAMES && program != 0; frame++ )
+	{
+		PrepareEyeBuffer( &frameBuffer, ViewportSize( WIDTH, frame ), ViewportSize( HEIGHT, frame ), black );
+		GL( glUseProgram( program ) );
+		GL( glBindVertexArray( vertexArray ) );
+		GL( glDrawArrays( GL_TRIANGLES, 0, 3 ) );
+		GL( glBindVertexArray( 0 ) );
+		GL( glUseProgram( 0 ) );
+		FinishEyeBuffer( &frameBuffer );
+
+		Check( frameBuffer.ReadyTextureSwapChainIndex == frame % 3, test, "swap chain entries not used in turn" );
+		CheckEyeTexture( &frameBuffer, 0, red, test );
+		CheckEyeTexture( &frameBuffer, 1, green, test );
+	}
+
+	GL( glDeleteVertexArrays( 1, &vertexArray ) );
+	glDeleteProgram( program );
+	ovrFramebuffer_Destroy( &frameBuffer );
+}
+
+int main( int argc, char * argv[] )
+{
+	verbose = argc > 1 && strcmp( argv[1], "-v" ) == 0;
+
+	if ( !CreateContext() )
+	{
+		return 2;
+	}
+
+	TestPerEye( 1 );
+	TestPerEye( 4 );
+	TestMultiview( 1 );
+	TestMultiview( 4 );
+
+	Check( liveSwapChains == 0, "destroy", "swap chains leaked" );
+	Check( glErrors == 0, "GL", "GL errors" );
+
+	if ( failures == 0 )
+	{
+		printf( "all frame buffer tests passed\n" );
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,287 @@
+/************************************************************************************
+
+Filename	:	frametimingtest.c
+Content		:	Tests the frame timing recorder (VrFrameTiming.c) on a desktop:
+				statistics of synthetic 72 Hz frame traces with known stage
+				times and missed vsyncs, the ring keeping the last frames in
+				order, CSV and binary traces read back against the recorded
+				times, and a reader thread taking snapshots while frames are
+				being recorded, which must never see a torn record.
+
+				This is not part of the Android build; on a Linux desktop:
+
+				cc -O2 -o frametimingtest frametimingtest.c -lpthread
+				./frametimingtest [-v]
+
+*************************************************************************************/
+
+#include <math.h>
+#include <pthread.h>
+
+#include "VrFrameTiming.c"
+
+#define REFRESH			72
+#define VSYNC_NS		( 1000000000LL / REFRESH )
+#define MS				1000000LL
+
+static bool verbose;
+static int failures;
+static ovrFrameTiming timing;
+static ovrFrameTimingRecord records[MAX_FRAME_TIMINGS];
+
+static void Check( const bool ok, const char * test, const char * what )
+{
+	if ( !ok )
+	{
+		printf( "FAIL %s: %s\n", test, what );
+		failures++;
+	}
+}
+
+static bool Near( const float a, const float b )
+{
+	return fabsf( a - b ) < 0.01f;
+}
+
+// Stage offsets within a frame, in ms after the pose: both eyes rendered and
+// resolved, then submitted.
+static const float StageOffsetMs[FRAME_STAGE_MAX] =
+{
+	0.0f,
+	0.5f, 4.5f, 5.0f,
+	5.0f, 9.0f, 9.5f,
+	10.0f, 10.25f
+};
+
+// Records frames one vsync interval apart from start; with missedEvery set, the
+// frames whose index is a multiple of it take two intervals instead of one.
+// Returns the time after the last frame.
+static long long RecordFrames( const long long firstFrame, const int frames, long long start, const int missedEvery )
+{
+	for ( int i = 0; i < frames; i++ )
+	{
+		const long long frame = firstFrame + i;
+		for ( int stage = 0; stage < FRAME_STAGE_MAX; stage++ )
+		{
+			ovrFrameTiming_MarkAt( &timing, frame, (ovrFrameStage)stage, start + (long long)( StageOffsetMs[stage] * MS ) );
+		}
+		start += ( missedEvery > 0 && frame % missedEvery == 0 ) ? 2 * VSYNC_NS : VSYNC_NS;
+	}
+	return start;
+}
+
+static void TestStats()
+{
+	ovrFrameTimingStats stats;
+
+	memset( &timing, 0, sizeof( timing ) );
+	ovrFrameTiming_GetStats( &timing, &stats );
+	Check( stats.Frames == 0 && stats.FrameTimeP50 == 0.0f, "empty", "stats of an empty ring" );
+
+	ovrFrameTiming_SetRefreshRate( &timing, REFRESH );
+	RecordFrames( 1, 1000, 5 * MS, 0 );
+	ovrFrameTiming_GetStats( &timing, &stats );
+	Check( stats.Frames == MAX_FRAME_TIMINGS, "steady", "not the last MAX_FRAME_TIMINGS frames" );
+	Check( stats.MissedVsyncs == 0, "steady", "missed vsyncs counted" );
+	Check( Near( stats.FrameTimeP50, 1000.0f / REFRESH ) && Near( stats.FrameTimeP99, 1000.0f / REFRESH ), "steady", "frame time percentiles" );
+	Check( Near( stats.PoseMs, 0.5f ) && Near( stats.EyeRenderMs[0], 4.0f ) && Near( stats.EyeRenderMs[1], 4.0f ), "steady", "stage averages" );
+	Check( Near( stats.ResolveMs[0], 0.5f ) && Near( stats.ResolveMs[1], 0.5f ) && Near( stats.SubmitMs, 0.25f ), "steady", "resolve and submit averages" );
+
+	// Every 10th frame takes two intervals: one missed vsync each, and p95 and
+	// up land on the long frames.
+	memset( &timing, 0, sizeof( timing ) );
+	ovrFrameTiming_SetRefreshRate( &timing, REFRESH );
+	RecordFrames( 0, MAX_FRAME_TIMINGS, 5 * MS, 10 );
+	ovrFrameTiming_GetStats( &timing, &stats );
+	int expected = 0;
+	for ( int frame = 0; frame < MAX_FRAME_TIMINGS - 1; frame++ )
+	{
+		expected += frame % 10 == 0;
+	}
+	Check( stats.MissedVsyncs == expected, "missed", "missed vsync count" );
+	Check( Near( stats.FrameTimeP50, 1000.0f / REFRESH ), "missed", "p50 moved" );
+	Check( Near( stats.FrameTimeP95, 2000.0f / REFRESH ) && Near( stats.FrameTimeP99, 2000.0f / REFRESH ), "missed", "p95/p99 not on the long frames" );
+
+	// The same trace counted at 90 Hz: every interval is late.
+	ovrFrameTiming_SetRefreshRate( &timing, 90 );
+	ovrFrameTiming_GetStats( &timing, &stats );
+	Check( stats.MissedVsyncs == expected * 2, "refresh", "missed vsyncs not counted at the cached rate" );
+
+	if ( verbose )
+	{
+		printf( "p50/p95/p99 %.2f/%.2f/%.2f ms, missed %d over %d frames\n",
+				stats.FrameTimeP50, stats.FrameTimeP95, stats.FrameTimeP99, stats.MissedVsyncs, stats.Frames );
+	}
+}
+
+static void TestRing()
+{
+	memset( &timing, 0, sizeof( timing ) );
+	const long long end = RecordFrames( 100, 3 * MAX_FRAME_TIMINGS + 17, 5 * MS, 0 );
+
+	// A frame in progress is not reported.
+	ovrFrameTiming_MarkAt( &timing, 100 + 3 * MAX_FRAME_TIMINGS + 17, FRAME_STAGE_POSE, end );
+
+	const int count = ovrFrameTiming_Snapshot( &timing, records );
+	Check( count == MAX_FRAME_TIMINGS - 1, "ring", "frame in progress reported" );
+	bool ordered = true;
+	for ( int i = 0; i < count; i++ )
+	{
+		ordered &= records[i].FrameIndex == 100 + 2 * MAX_FRAME_TIMINGS + 18 + i;
+	}
+	Check( ordered, "ring", "not the last frames in order" );
+
+	// Stages stamped from the clock come out in order.
+	for ( int stage = 0; stage < FRAME_STAGE_MAX; stage++ )
+	{
+		ovrFrameTiming_Mark( &timing, 0, (ovrFrameStage)stage );
+	}
+	bool increasing = ovrFrameTiming_Read( &timing, 0, &records[0] ) && records[0].Stamps[0] > 0;
+	for ( int stage = 1; stage < FRAME_STAGE_MAX; stage++ )
+	{
+		increasing &= records[0].Stamps[stage] >= records[0].Stamps[stage - 1];
+	}
+	Check( increasing, "ring", "clock stamps out of order" );
+
+	float workMs = 0.0f, intervalMs = 0.0f;
+	Check( ovrFrameTiming_LastFrame( &timing, 100 + 3 * MAX_FRAME_TIMINGS + 16, &workMs, &intervalMs ), "ring", "no last frame" );
+	Check( Near( intervalMs, 1000.0f / REFRESH ) && Near( workMs, 1000.0f / REFRESH - 0.25f ), "ring", "last frame work and interval" );
+}
+
+static void TestTraces()
+{
+	const char * csvPath = "frametimingtest.csv";
+	const char * binPath = "frametimingtest.bin";
+
+	memset( &timing, 0, sizeof( timing ) );
+	RecordFrames( 7, 50, 123456789012LL, 5 );
+	// A frame that skipped the second eye.
+	ovrFrameTiming_MarkAt( &timing, 57, FRAME_STAGE_POSE, 200000000000LL );
+	ovrFrameTiming_MarkAt( &timing, 57, FRAME_STAGE_SUBMIT_START, 200000001000LL );
+	ovrFrameTiming_MarkAt( &timing, 57, FRAME_STAGE_SUBMIT_END, 200000002000LL );
+	const int count = ovrFrameTiming_Snapshot( &timing, records );
+
+	// CSV: absolute microseconds, empty for stages that did not run.
+	Check( ovrFrameTiming_Dump( &timing, csvPath ), "csv", "dump failed" );
+	FILE * f = fopen( csvPath, "r" );
+	char line[512];
+	int rows = 0;
+	bool same = f != NULL && fgets( line, sizeof( line ), f ) != NULL && strncmp( line, "frame,pose,", 11 ) == 0;
+	while ( f != NULL && fgets( line, sizeof( line ), f ) != NULL && rows < count )
+	{
+		char * p = line;
+		same &= strtoll( p, &p, 10 ) == records[rows].FrameIndex;
+		for ( int stage = 0; stage < FRAME_STAGE_MAX; stage++ )
+		{
+			same &= *p++ == ',';
+			if ( *p == ',' || *p == '\n' )
+			{
+				same &= records[rows].Stamps[stage] == 0;
+			}
+			else
+			{
+				same &= strtoll( p, &p, 10 ) == records[rows].Stamps[stage] / 1000;
+			}
+		}
+		rows++;
+	}
+	Check( same && rows == count, "csv", "trace does not match the records" );
+	if ( f != NULL )
+	{
+		fclose( f );
+	}
+
+	// Binary: header, then frame index and nanosecond stamps per frame.
+	Check( ovrFrameTiming_Dump( &timing, binPath ), "bin", "dump failed" );
+	f = fopen( binPath, "rb" );
+	ovrFrameTraceHeader header;
+	same = f != NULL && fread( &header, sizeof( header ), 1, f ) == 1 &&
+		   memcmp( header.Magic, FRAME_TRACE_MAGIC, 4 ) == 0 && header.Version == FRAME_TRACE_VERSION &&
+		   header.Stages == FRAME_STAGE_MAX && header.Frames == count;
+	for ( int i = 0; same && i < count; i++ )
+	{
+		long long values[1 + FRAME_STAGE_MAX];
+		same = fread( values, sizeof( values ), 1, f ) == 1 && values[0] == records[i].FrameIndex &&
+			   memcmp( values + 1, records[i].Stamps, sizeof( records[i].Stamps ) ) == 0;
+	}
+	Check( same && f != NULL && fgetc( f ) == EOF, "bin", "trace does not match the records" );
+	if ( f != NULL )
+	{
+		fclose( f );
+	}
+
+	// Intervals between frames come out of the absolute times.
+	Check( records[1].Stamps[FRAME_STAGE_SUBMIT_END] - records[0].Stamps[FRAME_STAGE_SUBMIT_END] == VSYNC_NS, "csv", "frame interval lost" );
+
+	Check( !ovrFrameTiming_Dump( &timing, "no/such/dir/trace.csv" ), "dump", "unwritable path reported as written" );
+
+	remove( csvPath );
+	remove( binPath );
+}
+
+// The writer stamps each stage with a value derived from the frame index, so a
+// record mixing two frames shows up in the snapshot.
+static atomic_bool writerDone;
+
+static void * WriterThread( void * arg )
+{
+	for ( long long frame = 1; frame <= 2000000; frame++ )
+	{
+		for ( int stage = 0; stage < FRAME_STAGE_MAX; stage++ )
+		{
+			ovrFrameTiming_MarkAt( &timing, frame, (ovrFrameStage)stage, frame * 16 + stage + 1 );
+		}
+	}
+	atomic_store( &writerDone, true );
+	return NULL;
+}
+
+static void TestConcurrentReader()
+{
+	static ovrFrameTimingRecord snapshot[MAX_FRAME_TIMINGS];
+	pthread_t writer;
+	int snapshots = 0, torn = 0, disordered = 0;
+	long long seen = 0;
+
+	memset( &timing, 0, sizeof( timing ) );
+	atomic_store( &writerDone, false );
+	pthread_create( &writer, NULL, WriterThread, NULL );
+	while ( !atomic_load( &writerDone ) )
+	{
+		const int count = ovrFrameTiming_Snapshot( &timing, snapshot );
+		for ( int i = 0; i < count; i++ )
+		{
+			for ( int stage = 0; stage < FRAME_STAGE_MAX; stage++ )
+			{
+				torn += snapshot[i].Stamps[stage] != snapshot[i].FrameIndex * 16 + stage + 1;
+			}
+			disordered += i > 0 && snapshot[i].FrameIndex <= snapshot[i - 1].FrameIndex;
+		}
+		seen += count;
+		snapshots++;
+	}
+	pthread_join( writer, NULL );
+
+	if ( verbose )
+	{
+		printf( "%d snapshots, %lld records read while recording\n", snapshots, seen );
+	}
+	Check( torn == 0, "concurrent", "torn record in a snapshot" );
+	Check( disordered == 0, "concurrent", "snapshot not ordered" );
+}
+
+int main( int argc, char * argv[] )
+{
+	verbose = argc > 1 && strcmp( argv[1], "-v" ) == 0;
+
+	TestStats();
+	TestRing();
+	TestTraces();
+	TestConcurrentReader();
+
+	if ( failures == 0 )
+	{
+		printf( "all frame timing tests passed\n" );
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+/************************************************************************************
+
+Filename	:	mathbench.c
+Content		:	Times the mathlib.c / matrixlib.c functions that have 4-wide
+				paths (mathlib_simd.h), in ns per call over a table of
+				random inputs, best of several passes. Build it with and
+				without XASH_NO_VECTORIZE to compare the two paths;
+				mathtest.c checks that both give the same results.
+
+				This is not part of the Android build; on a Linux desktop,
+				or with the NDK clang for the device:
+
+				cc -O2 -D_GNU_SOURCE -o mathbench mathbench.c mathlib.c matrixlib.c -lm
+				cc -O2 -D_GNU_SOURCE -DXASH_NO_VECTORIZE -o mathbench_scalar mathbench.c mathlib.c matrixlib.c -lm
+				./mathbench [-p passes]
+
+*************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <math.h>
+
+#include "mathlib.h"
+
+#define INPUTS			1024		// inputs cycled through, all in L1
+#define CALLS			( INPUTS * 512 )
+
+static vec3_t angles[INPUTS];
+static vec3_t radians[INPUTS];
+static vec3_t origins[INPUTS];
+static vec4_t quats[INPUTS];
+static matrix4x4 matrices[INPUTS];
+static volatile float sink;
+
+static double GetTimeSeconds()
+{
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static float Random( const float low, const float high )
+{
+	return low + ( high - low ) * ( rand() / (float)RAND_MAX );
+}
+
+static void Setup()
+{
+	srand( 1 );
+	for ( int i = 0; i < INPUTS; i++ )
+	{
+		const vec3_t origin = { Random( -4096.0f, 4096.0f ), Random( -4096.0f, 4096.0f ), Random( -4096.0f, 4096.0f ) };
+		VectorCopy( origin, origins[i] );
+		angles[i][PITCH] = Random( -90.0f, 90.0f );
+		angles[i][YAW] = Random( -180.0f, 180.0f );
+		angles[i][ROLL] = Random( -180.0f, 180.0f );
+		VectorScale( angles[i], M_PI / 180.0f, radians[i] );
+		AngleQuaternion( radians[i], quats[i] );
+		Matrix4x4_CreateFromEntity( matrices[i], angles[i], origins[i], Random( 0.5f, 2.0f ) );
+	}
+}
+
+// Each function is called CALLS times; the results feed sink so that the calls
+// are not optimized away.
+
+static void BenchSinCos()
+{
+	float sum = 0.0f;
+	for ( int i = 0; i < CALLS; i++ )
+	{
+		float s, c;
+		SinCos( radians[i & ( INPUTS - 1 )][YAW], &s, &c );
+		sum += s + c;
+	}
+	sink = sum;
+}
+
+#ifdef XASH_VECTORIZE_SINCOS
+static void BenchSinCosFastVector3()
+{
+	float sum = 0.0f;
+	for ( int i = 0; i < CALLS; i++ )
+	{
+		const float * r = radians[i & ( INPUTS - 1 )];
+		float s0, s1, s2, c0, c1, c2;
+		SinCosFastVector3( r[0], r[1], r[2], &s0, &s1, &s2, &c0, &c1, &c2 );
+		sum += s0 + s1 + s2 + c0 + c1 + c2;
+	}
+	sink = sum;
+}
+#endif
+
+static void BenchAngleVectors()
+{
+	float sum = 0.0f;
+	for ( int i = 0; i < CALLS; i++ )
+	{
+		vec3_t forward, right, up;
+		AngleVectors( angles[i & ( INPUTS - 1 )], forward, right, up );
+		sum += forward[0] + right[1] + up[2];
+	}
+	sink = sum;
+}
+
+static void BenchAngleQuaternion()
+{
+	float sum = 0.0f;
+	for ( int i = 0; i < CALLS; i++ )
+	{
+		vec4_t q;
+		AngleQuaternion( radians[i & ( INPUTS - 1 )], q );
+		sum += q[0] + q[3];
+	}
+	sink = sum;
+}
+
+static void BenchQuaternionSlerp()
+{
+	float sum = 0.0f;
+	for ( int i = 0; i < CALLS; i++ )
+	{
+		vec4_t q, qt;
+		Vector4Copy( quats[( i + 1 ) & ( INPUTS - 1 )], q );
+		QuaternionSlerp( quats[i & ( INPUTS - 1 )], q, ( i & 255 ) * ( 1.0f / 256.0f ), qt );
+		sum += qt[0] + qt[3];
+	}
+	sink = sum;
+}
+
+static void BenchCreateFromEntity()
+{
+	float sum = 0.0f;
+	for ( int i = 0; i < CALLS; i++ )
+	{
+		matrix4x4 m;
+		Matrix4x4_CreateFromEntity( m, angles[i & ( INPUTS - 1 )], origins[i & ( INPUTS - 1 )], 1.0f );
+		sum += m[0][0] + m[2][3];
+	}
+	sink = sum;
+}
+
+static void BenchConcat()
+{
+	float sum = 0.0f;
+	for ( int i = 0; i < CALLS; i++ )
+	{
+		matrix4x4 m;
+		Matrix4x4_Concat( m, matrices[i & ( INPUTS - 1 )], matrices[( i + 1 ) & ( INPUTS - 1 )] );
+		sum += m[0][0] + m[3][3];
+	}
+	sink = sum;
+}
+
+static void BenchInvertFull()
+{
+	float sum = 0.0f;
+	for ( int i = 0; i < CALLS; i++ )
+	{
+		matrix4x4 m;
+		Matrix4x4_Invert_Full( m, matrices[i & ( INPUTS - 1 )] );
+		sum += m[0][0] + m[3][3];
+	}
+	sink = sum;
+}
+
+static void Bench( const char * name, void ( *bench )(), const int passes )
+{
+	double best = 0.0;
+	for ( int pass = 0; pass < passes; pass++ )
+	{
+		const double start = GetTimeSeconds();
+		bench();
+		const double seconds = GetTimeSeconds() - start;
+		if ( pass == 0 || seconds < best )
+		{
+			best = seconds;
+		}
+	}
+	printf( "%-28s %8.2f ns\n", name, best * 1e9 / CALLS );
+}
+
+int main( int argc, char * argv[] )
+{
+	int passes = 7;
+	for ( int i = 1; i < argc; i++ )
+	{
+		if ( strcmp( argv[i], "-p" ) == 0 && i + 1 < argc )
+		{
+			passes = atoi( argv[++i] );
+		}
+		else
+		{
+			fprintf( stderr, "usage: %s [-p passes]\n", argv[0] );
+			return 1;
+		}
+	}
+	if ( passes <= 0 )
+	{
+		fprintf( stderr, "usage: %s [-p passes]\n", argv[0] );
+		return 1;
+	}
+
+	Setup();
+
+#ifdef XASH_VECTORIZE
+	printf( "4-wide build (XASH_VECTORIZE), best of %d passes of %d calls\n", passes, CALLS );
+#else
+	printf( "scalar build, best of %d passes of %d calls\n", passes, CALLS );
+#endif
+	Bench( "SinCos", BenchSinCos, passes );
+#ifdef XASH_VECTORIZE_SINCOS
+	Bench( "SinCosFastVector3", BenchSinCosFastVector3, passes );
+#endif
+	Bench( "AngleVectors", BenchAngleVectors, passes );
+	Bench( "AngleQuaternion", BenchAngleQuaternion, passes );
+	Bench( "QuaternionSlerp", BenchQuaternionSlerp, passes );
+	Bench( "Matrix4x4_CreateFromEntity", BenchCreateFromEntity, passes );
+	Bench( "Matrix4x4_Concat", BenchConcat, passes );
+	Bench( "Matrix4x4_Invert_Full", BenchInvertFull, passes );
+	return 0;
+}
@@ -14,6 +14,7 @@ GNU General Public License for more details.
 */
 
 #include "mathlib.h"
+#include "mathlib_simd.h"
 
 unsigned short FloatToHalf( float v )
 {
@@ -262,7 +263,7 @@ AngleVectors
 */
 void AngleVectors( const vec3_t angles, vec3_t forward, vec3_t right, vec3_t up )
 {
-	static float	sr, sp, sy, cr, cp, cy;
+	float	sr, sp, sy, cr, cp, cy;
 
 #ifdef XASH_VECTORIZE_SINCOS
 	SinCosFastVector3( DEG2RAD(angles[YAW]), DEG2RAD(angles[PITCH]), DEG2RAD(angles[ROLL]),
@@ -24,6 +24,12 @@ extern "C"
 #include <math.h>
 #include <stdbool.h>
 
+// 4-wide float paths (see mathlib_simd.h), NEON on arm and SSE on x86
+#if !defined( XASH_NO_VECTORIZE ) && ( defined( __clang__ ) || __GNUC__ >= 9 ) && \
+	( defined( __ARM_NEON ) || defined( __ARM_NEON__ ) || defined( __SSE2__ ))
+#define XASH_VECTORIZE
+#define XASH_VECTORIZE_SINCOS
+#endif
 
 typedef float vec_t;
 typedef vec_t vec2_t[2];
@@ -159,6 +165,13 @@ void SinCosFastVector2( float r1, float r2,
 	__attribute__((nonnull))
 #endif
 ;
+
+void SinFastVector3( float r1, float r2, float r3,
+	float *s0, float *s1, float *s2)
+#if defined(__GNUC__)
+	__attribute__((nonnull))
+#endif
+;
 #endif
 float VectorNormalizeLength2( const vec3_t v, vec3_t out );
 void VectorVectors( const vec3_t forward, vec3_t right, vec3_t up );
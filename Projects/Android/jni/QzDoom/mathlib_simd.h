@@ -0,0 +1,114 @@
+/*
+mathlib_simd.h - 4-wide float helpers for mathlib/matrixlib
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+*/
+
+#ifndef MATHLIB_SIMD_H
+#define MATHLIB_SIMD_H
+
+#include "mathlib.h"
+
+#ifdef XASH_VECTORIZE
+
+// GCC/clang vector extensions, lowered to NEON on arm and SSE on x86
+typedef float v4sf __attribute__((vector_size(16)));
+typedef int v4si __attribute__((vector_size(16)));
+
+#define s4f_x( v )	((v)[0])
+#define s4f_y( v )	((v)[1])
+#define s4f_z( v )	((v)[2])
+#define s4f_w( v )	((v)[3])
+
+// matrix rows are not guaranteed to be 16 byte aligned
+static inline v4sf v4sf_load( const float *p )
+{
+	v4sf v;
+	__builtin_memcpy( &v, p, sizeof( v ));
+	return v;
+}
+
+static inline void v4sf_store( float *p, v4sf v )
+{
+	__builtin_memcpy( p, &v, sizeof( v ));
+}
+
+static inline v4sf v4sf_splat( float f )
+{
+	v4sf v = { f, f, f, f };
+	return v;
+}
+
+/*
+=================
+sincos_ps
+
+Cephes single precision sin/cos for 4 angles at once, same range reduction and
+polynomials as the well known sse_mathfun/neon_mathfun versions.
+=================
+*/
+static inline void sincos_ps( v4sf x, v4sf *s, v4sf *c )
+{
+	const v4si sign_mask = { (int)0x80000000, (int)0x80000000, (int)0x80000000, (int)0x80000000 };
+	v4si	xi, j, swap_sign_sin, sign_cos, poly_mask;
+	v4sf	y, z, ycos, ysin;
+
+	xi = (v4si)x;
+	v4si sign_sin = xi & sign_mask;
+	x = (v4sf)( xi & ~sign_mask );
+
+	// scale by 4/Pi and round to an even octant
+	y = x * v4sf_splat( 1.27323954473516f );
+	j = __builtin_convertvector( y, v4si );
+	j = ( j + 1 ) & ~1;
+	y = __builtin_convertvector( j, v4sf );
+
+	swap_sign_sin = ( j & 4 ) << 29;
+	poly_mask = ( j & 2 ) == 0;
+	sign_cos = ( ~( j - 2 ) & 4 ) << 29;
+	sign_sin ^= swap_sign_sin;
+
+	// extended precision modular arithmetic, x - y * Pi/4
+	x += y * v4sf_splat( -0.78515625f );
+	x += y * v4sf_splat( -2.4187564849853515625e-4f );
+	x += y * v4sf_splat( -3.77489497744594108e-8f );
+
+	z = x * x;
+
+	ycos = v4sf_splat( 2.443315711809948e-5f );
+	ycos = ycos * z + v4sf_splat( -1.388731625493765e-3f );
+	ycos = ycos * z + v4sf_splat( 4.166664568298827e-2f );
+	ycos = ycos * z * z - z * v4sf_splat( 0.5f ) + v4sf_splat( 1.0f );
+
+	ysin = v4sf_splat( -1.9515295891e-4f );
+	ysin = ysin * z + v4sf_splat( 8.3321608736e-3f );
+	ysin = ysin * z + v4sf_splat( -1.6666654611e-1f );
+	ysin = ysin * z * x + x;
+
+	// pick the right polynomial for each lane
+	v4si sinbits = ( poly_mask & (v4si)ysin ) | ( ~poly_mask & (v4si)ycos );
+	v4si cosbits = ( poly_mask & (v4si)ycos ) | ( ~poly_mask & (v4si)ysin );
+
+	*s = (v4sf)( sinbits ^ sign_sin );
+	*c = (v4sf)( cosbits ^ sign_cos );
+}
+
+static inline v4sf sin_ps( v4sf x )
+{
+	v4sf	s, c;
+
+	sincos_ps( x, &s, &c );
+	return s;
+}
+
+#endif // XASH_VECTORIZE
+
+#endif // MATHLIB_SIMD_H
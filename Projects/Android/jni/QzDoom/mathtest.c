@@ -0,0 +1,473 @@
+/************************************************************************************
+
+Filename	:	mathtest.c
+Content		:	Accuracy of the mathlib.c / matrixlib.c functions that have
+				4-wide paths (mathlib_simd.h) against double precision
+				references of the same formulas, over random inputs. The
+				same limits must hold for the vector and the scalar build,
+				so build and run it both ways:
+
+				This is not part of the Android build; on a Linux desktop:
+
+				cc -O2 -D_GNU_SOURCE -o mathtest mathtest.c mathlib.c matrixlib.c -lm
+				cc -O2 -D_GNU_SOURCE -DXASH_NO_VECTORIZE -o mathtest_scalar mathtest.c mathlib.c matrixlib.c -lm
+				./mathtest [-v]
+
+*************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <float.h>
+
+#include "mathlib.h"
+
+#define SAMPLES		100000
+
+static bool verbose;
+static int failures;
+static unsigned int seed = 0x12345678;
+
+// xorshift32, so both builds see the same inputs
+static float Random( const float low, const float high )
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return low + ( high - low ) * ( seed >> 8 ) * ( 1.0f / 16777216.0f );
+}
+
+// Reports the largest error seen against its limit.
+static void Report( const char * name, const double maxError, const double limit )
+{
+	if ( maxError > limit || isnan( maxError ) )
+	{
+		printf( "FAIL %-32s max error %.3g, limit %.3g\n", name, maxError, limit );
+		failures++;
+	}
+	else if ( verbose )
+	{
+		printf( "%-37s max error %.3g, limit %.3g\n", name, maxError, limit );
+	}
+}
+
+static double MaxError( double maxError, const float value, const double reference )
+{
+	const double error = fabs( value - reference );
+	return error > maxError || isnan( error ) ? error : maxError;
+}
+
+static void TestSinCos()
+{
+	double sinError = 0.0, cosError = 0.0;
+	for ( int i = 0; i < SAMPLES; i++ )
+	{
+		// Angles the engine passes in: degrees to radians of up to a few turns.
+		const float r = Random( -4.0f * M_PI2, 4.0f * M_PI2 );
+		float s, c;
+		SinCos( r, &s, &c );
+		sinError = MaxError( sinError, s, sin( (double)r ) );
+		cosError = MaxError( cosError, c, cos( (double)r ) );
+	}
+	Report( "SinCos sin", sinError, 2e-7 );
+	Report( "SinCos cos", cosError, 2e-7 );
+
+#ifdef XASH_VECTORIZE_SINCOS
+	double vectorError = 0.0;
+	for ( int i = 0; i < SAMPLES; i++ )
+	{
+		float r[4], s[4], c[4];
+		for ( int j = 0; j < 4; j++ )
+		{
+			r[j] = Random( -4.0f * M_PI2, 4.0f * M_PI2 );
+		}
+		SinCosFastVector4( r[0], r[1], r[2], r[3], &s[0], &s[1], &s[2], &s[3], &c[0], &c[1], &c[2], &c[3] );
+		for ( int j = 0; j < 4; j++ )
+		{
+			vectorError = MaxError( vectorError, s[j], sin( (double)r[j] ) );
+			vectorError = MaxError( vectorError, c[j], cos( (double)r[j] ) );
+		}
+		SinCosFastVector3( r[0], r[1], r[2], &s[0], &s[1], &s[2], &c[0], &c[1], &c[2] );
+		for ( int j = 0; j < 3; j++ )
+		{
+			vectorError = MaxError( vectorError, s[j], sin( (double)r[j] ) );
+			vectorError = MaxError( vectorError, c[j], cos( (double)r[j] ) );
+		}
+		SinCosFastVector2( r[0], r[1], &s[0], &s[1], &c[0], &c[1] );
+		for ( int j = 0; j < 2; j++ )
+		{
+			vectorError = MaxError( vectorError, s[j], sin( (double)r[j] ) );
+			vectorError = MaxError( vectorError, c[j], cos( (double)r[j] ) );
+		}
+		SinFastVector3( r[0], r[1], r[2], &s[0], &s[1], &s[2] );
+		for ( int j = 0; j < 3; j++ )
+		{
+			vectorError = MaxError( vectorError, s[j], sin( (double)r[j] ) );
+		}
+	}
+	Report( "SinCosFastVector*, SinFastVector3", vectorError, 3e-7 );
+#endif
+}
+
+static void TestAngleVectors()
+{
+	double maxError = 0.0;
+	for ( int i = 0; i < SAMPLES; i++ )
+	{
+		const vec3_t angles = { Random( -90.0f, 90.0f ), Random( -360.0f, 360.0f ), Random( -180.0f, 180.0f ) };
+		vec3_t forward, right, up;
+		AngleVectors( angles, forward, right, up );
+
+		const double sp = sin( angles[PITCH] * M_PI / 180.0 ), cp = cos( angles[PITCH] * M_PI / 180.0 );
+		const double sy = sin( angles[YAW] * M_PI / 180.0 ), cy = cos( angles[YAW] * M_PI / 180.0 );
+		const double sr = sin( angles[ROLL] * M_PI / 180.0 ), cr = cos( angles[ROLL] * M_PI / 180.0 );
+		const double reference[3][3] =
+		{
+			{ cp * cy, cp * sy, -sp },
+			{ -sr * sp * cy + cr * sy, -sr * sp * sy - cr * cy, -sr * cp },
+			{ cr * sp * cy + sr * sy, cr * sp * sy - sr * cy, cr * cp }
+		};
+		for ( int j = 0; j < 3; j++ )
+		{
+			maxError = MaxError( maxError, forward[j], reference[0][j] );
+			maxError = MaxError( maxError, right[j], reference[1][j] );
+			maxError = MaxError( maxError, up[j], reference[2][j] );
+		}
+	}
+	Report( "AngleVectors", maxError, 1e-6 );
+}
+
+static void TestAngleQuaternion()
+{
+	double maxError = 0.0;
+	for ( int i = 0; i < SAMPLES; i++ )
+	{
+		// Radians, as the studio model code passes them.
+		const vec3_t angles = { Random( -M_PI, M_PI ), Random( -M_PI, M_PI ), Random( -M_PI, M_PI ) };
+		vec4_t q;
+		AngleQuaternion( angles, q );
+
+		const double sr = sin( angles[0] * 0.5 ), cr = cos( angles[0] * 0.5 );
+		const double sp = sin( angles[1] * 0.5 ), cp = cos( angles[1] * 0.5 );
+		const double sy = sin( angles[2] * 0.5 ), cy = cos( angles[2] * 0.5 );
+		maxError = MaxError( maxError, q[0], sr * cp * cy - cr * sp * sy );
+		maxError = MaxError( maxError, q[1], cr * sp * cy + sr * cp * sy );
+		maxError = MaxError( maxError, q[2], cr * cp * sy - sr * sp * cy );
+		maxError = MaxError( maxError, q[3], cr * cp * cy + sr * sp * sy );
+	}
+	Report( "AngleQuaternion", maxError, 1e-6 );
+}
+
+static void RandomQuaternion( vec4_t q )
+{
+	double length;
+	do
+	{
+		for ( int j = 0; j < 4; j++ )
+		{
+			q[j] = Random( -1.0f, 1.0f );
+		}
+		length = sqrt( q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3] );
+	} while ( length < 0.1 );
+	for ( int j = 0; j < 4; j++ )
+	{
+		q[j] /= length;
+	}
+}
+
+static void TestQuaternionSlerp()
+{
+	double maxError = 0.0;
+	for ( int i = 0; i < SAMPLES; i++ )
+	{
+		vec4_t p, q, qt;
+		RandomQuaternion( p );
+		RandomQuaternion( q );
+		if ( i % 8 == 0 )
+		{
+			// Nearly the same orientation, as between two animation frames.
+			for ( int j = 0; j < 4; j++ )
+			{
+				q[j] = p[j] + Random( -1e-3f, 1e-3f );
+			}
+		}
+		const float t = Random( 0.0f, 1.0f );
+
+		// QuaternionSlerp flips q in place when it is on the far side
+		double qd[4], dot = 0.0;
+		for ( int j = 0; j < 4; j++ )
+		{
+			qd[j] = q[j];
+			dot += p[j] * qd[j];
+		}
+		if ( dot < 0.0 )
+		{
+			dot = -dot;
+			for ( int j = 0; j < 4; j++ )
+			{
+				qd[j] = -qd[j];
+			}
+		}
+
+		QuaternionSlerp( p, q, t, qt );
+
+		double sclp = 1.0 - t, sclq = t;
+		if ( 1.0 - dot > 1e-6 )
+		{
+			const double omega = acos( dot );
+			sclp = sin( ( 1.0 - t ) * omega ) / sin( omega );
+			sclq = sin( t * omega ) / sin( omega );
+		}
+		for ( int j = 0; j < 4; j++ )
+		{
+			maxError = MaxError( maxError, qt[j], sclp * p[j] + sclq * qd[j] );
+		}
+	}
+	Report( "QuaternionSlerp", maxError, 1e-6 );
+}
+
+static void TestCreateFromEntity()
+{
+	double maxError = 0.0;
+	for ( int i = 0; i < SAMPLES; i++ )
+	{
+		// All three angle branches: roll, pitch and yaw only, yaw only.
+		vec3_t angles = { Random( -90.0f, 90.0f ), Random( -360.0f, 360.0f ), Random( -180.0f, 180.0f ) };
+		if ( i % 3 > 0 )
+		{
+			angles[ROLL] = 0.0f;
+		}
+		if ( i % 3 > 1 )
+		{
+			angles[PITCH] = 0.0f;
+		}
+		const vec3_t origin = { Random( -4096.0f, 4096.0f ), Random( -4096.0f, 4096.0f ), Random( -4096.0f, 4096.0f ) };
+		const float scale = Random( 0.5f, 2.0f );
+		matrix4x4 m;
+		Matrix4x4_CreateFromEntity( m, angles, origin, scale );
+
+		const double sp = sin( angles[PITCH] * M_PI / 180.0 ), cp = cos( angles[PITCH] * M_PI / 180.0 );
+		const double sy = sin( angles[YAW] * M_PI / 180.0 ), cy = cos( angles[YAW] * M_PI / 180.0 );
+		const double sr = sin( angles[ROLL] * M_PI / 180.0 ), cr = cos( angles[ROLL] * M_PI / 180.0 );
+		const double reference[3][3] =
+		{
+			{ cp * cy, sr * sp * cy - cr * sy, cr * sp * cy + sr * sy },
+			{ cp * sy, sr * sp * sy + cr * cy, cr * sp * sy - sr * cy },
+			{ -sp, sr * cp, cr * cp }
+		};
+		for ( int row = 0; row < 3; row++ )
+		{
+			for ( int column = 0; column < 3; column++ )
+			{
+				maxError = MaxError( maxError, m[row][column] / scale, reference[row][column] );
+			}
+			maxError = MaxError( maxError, m[row][3] - origin[row], 0.0 );
+		}
+	}
+	Report( "Matrix4x4_CreateFromEntity", maxError, 1e-6 );
+}
+
+static void RandomMatrix( matrix4x4 m, const float range )
+{
+	for ( int row = 0; row < 4; row++ )
+	{
+		for ( int column = 0; column < 4; column++ )
+		{
+			m[row][column] = Random( -range, range );
+		}
+	}
+}
+
+static void TestConcat()
+{
+	double maxError = 0.0;
+	for ( int i = 0; i < SAMPLES; i++ )
+	{
+		matrix4x4 a, b, m;
+		RandomMatrix( a, 100.0f );
+		RandomMatrix( b, 100.0f );
+		Matrix4x4_Concat( m, a, b );
+
+		// relative to the magnitude of the terms summed
+		for ( int row = 0; row < 4; row++ )
+		{
+			for ( int column = 0; column < 4; column++ )
+			{
+				double sum = 0.0, magnitude = 0.0;
+				for ( int k = 0; k < 4; k++ )
+				{
+					sum += (double)a[row][k] * b[k][column];
+					magnitude += fabs( (double)a[row][k] * b[k][column] );
+				}
+				maxError = MaxError( maxError, m[row][column] / magnitude, sum / magnitude );
+			}
+		}
+	}
+	Report( "Matrix4x4_Concat (relative)", maxError, 4.0 * FLT_EPSILON );
+}
+
+// Gauss-Jordan elimination with partial pivoting in double.
+static bool InvertReference( double out[4][4], const matrix4x4 in )
+{
+	double m[4][8];
+	for ( int row = 0; row < 4; row++ )
+	{
+		for ( int column = 0; column < 4; column++ )
+		{
+			m[row][column] = in[row][column];
+			m[row][column + 4] = row == column ? 1.0 : 0.0;
+		}
+	}
+	for ( int column = 0; column < 4; column++ )
+	{
+		int pivot = column;
+		for ( int row = column + 1; row < 4; row++ )
+		{
+			if ( fabs( m[row][column] ) > fabs( m[pivot][column] ) )
+			{
+				pivot = row;
+			}
+		}
+		if ( m[pivot][column] == 0.0 )
+		{
+			return false;
+		}
+		for ( int k = 0; k < 8; k++ )
+		{
+			const double swap = m[column][k];
+			m[column][k] = m[pivot][k];
+			m[pivot][k] = swap;
+		}
+		const double scale = 1.0 / m[column][column];
+		for ( int k = 0; k < 8; k++ )
+		{
+			m[column][k] *= scale;
+		}
+		for ( int row = 0; row < 4; row++ )
+		{
+			if ( row != column )
+			{
+				const double factor = m[row][column];
+				for ( int k = 0; k < 8; k++ )
+				{
+					m[row][k] -= factor * m[column][k];
+				}
+			}
+		}
+	}
+	for ( int row = 0; row < 4; row++ )
+	{
+		for ( int column = 0; column < 4; column++ )
+		{
+			out[row][column] = m[row][column + 4];
+		}
+	}
+	return true;
+}
+
+static void TestInvert()
+{
+	double entityError = 0.0, generalError = 0.0;
+	for ( int i = 0; i < SAMPLES; i++ )
+	{
+		matrix4x4 m, inverse;
+		double reference[4][4];
+		double * maxError;
+
+		if ( i & 1 )
+		{
+			// The transforms the renderer inverts: rotation, scale, translation.
+			const vec3_t angles = { Random( -90.0f, 90.0f ), Random( -360.0f, 360.0f ), Random( -180.0f, 180.0f ) };
+			const vec3_t origin = { Random( -4096.0f, 4096.0f ), Random( -4096.0f, 4096.0f ), Random( -4096.0f, 4096.0f ) };
+			Matrix4x4_CreateFromEntity( m, angles, origin, Random( 0.5f, 2.0f ) );
+			maxError = &entityError;
+		}
+		else
+		{
+			// General matrices, kept well conditioned by a dominant diagonal.
+			RandomMatrix( m, 1.0f );
+			for ( int j = 0; j < 4; j++ )
+			{
+				m[j][j] += m[j][j] < 0.0f ? -4.0f : 4.0f;
+			}
+			maxError = &generalError;
+		}
+
+		if ( !Matrix4x4_Invert_Full( inverse, m ) || !InvertReference( reference, m ) )
+		{
+			*maxError = INFINITY;
+			continue;
+		}
+		// relative to the largest element of the inverse
+		double magnitude = 0.0;
+		for ( int row = 0; row < 4; row++ )
+		{
+			for ( int column = 0; column < 4; column++ )
+			{
+				magnitude = fmax( magnitude, fabs( reference[row][column] ) );
+			}
+		}
+		for ( int row = 0; row < 4; row++ )
+		{
+			for ( int column = 0; column < 4; column++ )
+			{
+				*maxError = MaxError( *maxError, inverse[row][column] / magnitude, reference[row][column] / magnitude );
+			}
+		}
+	}
+	Report( "Matrix4x4_Invert_Full, entity (relative)", entityError, 1e-6 );
+	Report( "Matrix4x4_Invert_Full, general (relative)", generalError, 1e-6 );
+
+	matrix4x4 singular, inverse;
+	RandomMatrix( singular, 1.0f );
+	memcpy( singular[3], singular[1], sizeof( singular[3] ) );
+	if ( Matrix4x4_Invert_Full( inverse, singular ) )
+	{
+		// Elimination may leave a rounding residue instead of an exact zero.
+		bool finite = true;
+		for ( int row = 0; row < 4; row++ )
+		{
+			for ( int column = 0; column < 4; column++ )
+			{
+				finite = finite && isfinite( inverse[row][column] );
+			}
+		}
+		if ( !finite )
+		{
+			printf( "FAIL Matrix4x4_Invert_Full: singular matrix gave a non-finite inverse\n" );
+			failures++;
+		}
+	}
+	matrix4x4 zero = { { 0 } };
+	if ( Matrix4x4_Invert_Full( inverse, zero ) )
+	{
+		printf( "FAIL Matrix4x4_Invert_Full: inverted the zero matrix\n" );
+		failures++;
+	}
+}
+
+int main( int argc, char * argv[] )
+{
+	verbose = argc > 1 && strcmp( argv[1], "-v" ) == 0;
+
+#ifdef XASH_VECTORIZE
+	printf( "4-wide build (XASH_VECTORIZE), %d samples per function\n", SAMPLES );
+#else
+	printf( "scalar build, %d samples per function\n", SAMPLES );
+#endif
+
+	TestSinCos();
+	TestAngleVectors();
+	TestAngleQuaternion();
+	TestQuaternionSlerp();
+	TestCreateFromEntity();
+	TestConcat();
+	TestInvert();
+
+	if ( failures == 0 )
+	{
+		printf( "all mathlib accuracy tests passed\n" );
+	}
+	return failures == 0 ? 0 : 1;
+}
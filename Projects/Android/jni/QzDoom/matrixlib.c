@@ -15,6 +15,7 @@ GNU General Public License for more details.
 
 //#include "common.h"
 #include "mathlib.h"
+#include "mathlib_simd.h"
 
 const matrix3x4 matrix3x4_identity =
 {
@@ -365,6 +366,24 @@ void Matrix4x4_CreateTranslate (matrix4x4 out, double x, double y, double z)
 
 void Matrix4x4_Concat (matrix4x4 out, const matrix4x4 in1, const matrix4x4 in2)
 {
+#ifdef XASH_VECTORIZE
+	// each output row is a linear combination of the rows of in2
+	const v4sf	r0 = v4sf_load( in2[0] );
+	const v4sf	r1 = v4sf_load( in2[1] );
+	const v4sf	r2 = v4sf_load( in2[2] );
+	const v4sf	r3 = v4sf_load( in2[3] );
+	v4sf		rows[4];
+	int		i;
+
+	for( i = 0; i < 4; i++ )
+	{
+		rows[i] = v4sf_splat( in1[i][0] ) * r0 + v4sf_splat( in1[i][1] ) * r1
+			+ v4sf_splat( in1[i][2] ) * r2 + v4sf_splat( in1[i][3] ) * r3;
+	}
+
+	for( i = 0; i < 4; i++ )
+		v4sf_store( out[i], rows[i] );
+#else
 	out[0][0] = in1[0][0] * in2[0][0] + in1[0][1] * in2[1][0] + in1[0][2] * in2[2][0] + in1[0][3] * in2[3][0];
 	out[0][1] = in1[0][0] * in2[0][1] + in1[0][1] * in2[1][1] + in1[0][2] * in2[2][1] + in1[0][3] * in2[3][1];
 	out[0][2] = in1[0][0] * in2[0][2] + in1[0][1] * in2[1][2] + in1[0][2] * in2[2][2] + in1[0][3] * in2[3][2];
@@ -381,6 +400,7 @@ void Matrix4x4_Concat (matrix4x4 out, const matrix4x4 in1, const matrix4x4 in2)
 	out[3][1] = in1[3][0] * in2[0][1] + in1[3][1] * in2[1][1] + in1[3][2] * in2[2][1] + in1[3][3] * in2[3][1];
 	out[3][2] = in1[3][0] * in2[0][2] + in1[3][1] * in2[1][2] + in1[3][2] * in2[2][2] + in1[3][3] * in2[3][2];
 	out[3][3] = in1[3][0] * in2[0][3] + in1[3][1] * in2[1][3] + in1[3][2] * in2[2][3] + in1[3][3] * in2[3][3];
+#endif
 }
 
 void Matrix4x4_CreateFromEntity( matrix4x4 out, const vec3_t angles, const vec3_t origin, float scale )
@@ -589,6 +609,72 @@ void Matrix4x4_Transpose( matrix4x4 out, cmatrix4x4 in1 )
 	out[3][3] = in1[3][3];
 }
 
+#ifdef XASH_VECTORIZE
+/*
+=================
+Matrix4x4_Invert_Full
+
+Branch free adjugate inverse built from the 2x2 sub-determinants of the
+upper and lower row pairs, scaled by 1/det four lanes at a time.
+=================
+*/
+bool Matrix4x4_Invert_Full( matrix4x4 out, cmatrix4x4 in1 )
+{
+	const float	*m0 = in1[0], *m1 = in1[1], *m2 = in1[2], *m3 = in1[3];
+	float		s0, s1, s2, s3, s4, s5;
+	float		c0, c1, c2, c3, c4, c5;
+	float		det;
+	v4sf		rows[4], invdet;
+	int		i;
+
+	s0 = m0[0] * m1[1] - m1[0] * m0[1];
+	s1 = m0[0] * m1[2] - m1[0] * m0[2];
+	s2 = m0[0] * m1[3] - m1[0] * m0[3];
+	s3 = m0[1] * m1[2] - m1[1] * m0[2];
+	s4 = m0[1] * m1[3] - m1[1] * m0[3];
+	s5 = m0[2] * m1[3] - m1[2] * m0[3];
+
+	c5 = m2[2] * m3[3] - m3[2] * m2[3];
+	c4 = m2[1] * m3[3] - m3[1] * m2[3];
+	c3 = m2[1] * m3[2] - m3[1] * m2[2];
+	c2 = m2[0] * m3[3] - m3[0] * m2[3];
+	c1 = m2[0] * m3[2] - m3[0] * m2[2];
+	c0 = m2[0] * m3[1] - m3[0] * m2[1];
+
+	det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+	if( !det || !isfinite( det ))
+		return false;
+
+	rows[0] = (v4sf){
+		 m1[1] * c5 - m1[2] * c4 + m1[3] * c3,
+		-m0[1] * c5 + m0[2] * c4 - m0[3] * c3,
+		 m3[1] * s5 - m3[2] * s4 + m3[3] * s3,
+		-m2[1] * s5 + m2[2] * s4 - m2[3] * s3 };
+	rows[1] = (v4sf){
+		-m1[0] * c5 + m1[2] * c2 - m1[3] * c1,
+		 m0[0] * c5 - m0[2] * c2 + m0[3] * c1,
+		-m3[0] * s5 + m3[2] * s2 - m3[3] * s1,
+		 m2[0] * s5 - m2[2] * s2 + m2[3] * s1 };
+	rows[2] = (v4sf){
+		 m1[0] * c4 - m1[1] * c2 + m1[3] * c0,
+		-m0[0] * c4 + m0[1] * c2 - m0[3] * c0,
+		 m3[0] * s4 - m3[1] * s2 + m3[3] * s0,
+		-m2[0] * s4 + m2[1] * s2 - m2[3] * s0 };
+	rows[3] = (v4sf){
+		-m1[0] * c3 + m1[1] * c1 - m1[2] * c0,
+		 m0[0] * c3 - m0[1] * c1 + m0[2] * c0,
+		-m3[0] * s3 + m3[1] * s1 - m3[2] * s0,
+		 m2[0] * s3 - m2[1] * s1 + m2[2] * s0 };
+
+	invdet = v4sf_splat( 1.0f / det );
+
+	for( i = 0; i < 4; i++ )
+		v4sf_store( out[i], rows[i] * invdet );
+
+	return true;
+}
+#else
 bool Matrix4x4_Invert_Full( matrix4x4 out, cmatrix4x4 in1 )
 {
 	float	*temp;
@@ -850,3 +936,4 @@ bool Matrix4x4_Invert_Full( matrix4x4 out, cmatrix4x4 in1 )
 	}
 	return false;
 }
+#endif
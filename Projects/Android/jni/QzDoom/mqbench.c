@@ -0,0 +1,361 @@
+/************************************************************************************
+
+Filename	:	mqbench.c
+Content		:	Compares the lock-free ovrMessageQueue (VrMessageQueue.c) with
+				the mutex/condition variable queue it replaced, which is kept
+				here as oldQueue. Three cases are timed:
+
+				poll		the render thread looking for messages once a frame
+							when there are none
+				lifecycle	MQ_WAIT_PROCESSED messages posted from another
+							thread to a render loop that polls between frames,
+							timed from post to return
+				burst		MQ_WAIT_NONE messages posted faster than they are
+							taken, so the producer keeps finding the queue full
+
+				This is not part of the Android build; on a Linux desktop:
+
+				cc -O2 -o mqbench mqbench.c VrMessageQueue.c -lpthread
+
+*************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "VrMessageQueue.h"
+
+static double GetTimeSeconds()
+{
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/*
+================================================================================
+
+oldQueue - the mutex/condition variable queue as it was before VrMessageQueue.c
+
+================================================================================
+*/
+
+typedef struct
+{
+	ovrMessage	 		Messages[MAX_MESSAGES];
+	volatile int		Head;	// dequeue at the head
+	volatile int		Tail;	// enqueue at the tail
+	ovrMQWait			Wait;
+	volatile bool		EnabledFlag;
+	volatile bool		PostedFlag;
+	volatile bool		ReceivedFlag;
+	volatile bool		ProcessedFlag;
+	pthread_mutex_t		Mutex;
+	pthread_cond_t		PostedCondition;
+	pthread_cond_t		ReceivedCondition;
+	pthread_cond_t		ProcessedCondition;
+} oldQueue;
+
+static void oldQueue_Create( oldQueue * messageQueue )
+{
+	messageQueue->Head = 0;
+	messageQueue->Tail = 0;
+	messageQueue->Wait = MQ_WAIT_NONE;
+	messageQueue->EnabledFlag = false;
+	messageQueue->PostedFlag = false;
+	messageQueue->ReceivedFlag = false;
+	messageQueue->ProcessedFlag = false;
+
+	pthread_mutexattr_t	attr;
+	pthread_mutexattr_init( &attr );
+	pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_ERRORCHECK );
+	pthread_mutex_init( &messageQueue->Mutex, &attr );
+	pthread_mutexattr_destroy( &attr );
+	pthread_cond_init( &messageQueue->PostedCondition, NULL );
+	pthread_cond_init( &messageQueue->ReceivedCondition, NULL );
+	pthread_cond_init( &messageQueue->ProcessedCondition, NULL );
+}
+
+static void oldQueue_Destroy( oldQueue * messageQueue )
+{
+	pthread_mutex_destroy( &messageQueue->Mutex );
+	pthread_cond_destroy( &messageQueue->PostedCondition );
+	pthread_cond_destroy( &messageQueue->ReceivedCondition );
+	pthread_cond_destroy( &messageQueue->ProcessedCondition );
+}
+
+static void oldQueue_Enable( oldQueue * messageQueue, const bool set )
+{
+	messageQueue->EnabledFlag = set;
+}
+
+static void oldQueue_PostMessage( oldQueue * messageQueue, const ovrMessage * message )
+{
+	if ( !messageQueue->EnabledFlag )
+	{
+		return;
+	}
+	while ( messageQueue->Tail - messageQueue->Head >= MAX_MESSAGES )
+	{
+		usleep( 1000 );
+	}
+	pthread_mutex_lock( &messageQueue->Mutex );
+	messageQueue->Messages[messageQueue->Tail & ( MAX_MESSAGES - 1 )] = *message;
+	messageQueue->Tail++;
+	messageQueue->PostedFlag = true;
+	pthread_cond_broadcast( &messageQueue->PostedCondition );
+	if ( message->Wait == MQ_WAIT_RECEIVED )
+	{
+		while ( !messageQueue->ReceivedFlag )
+		{
+			pthread_cond_wait( &messageQueue->ReceivedCondition, &messageQueue->Mutex );
+		}
+		messageQueue->ReceivedFlag = false;
+	}
+	else if ( message->Wait == MQ_WAIT_PROCESSED )
+	{
+		while ( !messageQueue->ProcessedFlag )
+		{
+			pthread_cond_wait( &messageQueue->ProcessedCondition, &messageQueue->Mutex );
+		}
+		messageQueue->ProcessedFlag = false;
+	}
+	pthread_mutex_unlock( &messageQueue->Mutex );
+}
+
+static void oldQueue_SleepUntilMessage( oldQueue * messageQueue )
+{
+	if ( messageQueue->Wait == MQ_WAIT_PROCESSED )
+	{
+		messageQueue->ProcessedFlag = true;
+		pthread_cond_broadcast( &messageQueue->ProcessedCondition );
+		messageQueue->Wait = MQ_WAIT_NONE;
+	}
+	pthread_mutex_lock( &messageQueue->Mutex );
+	if ( messageQueue->Tail > messageQueue->Head )
+	{
+		pthread_mutex_unlock( &messageQueue->Mutex );
+		return;
+	}
+	while ( !messageQueue->PostedFlag )
+	{
+		pthread_cond_wait( &messageQueue->PostedCondition, &messageQueue->Mutex );
+	}
+	messageQueue->PostedFlag = false;
+	pthread_mutex_unlock( &messageQueue->Mutex );
+}
+
+static bool oldQueue_GetNextMessage( oldQueue * messageQueue, ovrMessage * message, bool waitForMessages )
+{
+	if ( messageQueue->Wait == MQ_WAIT_PROCESSED )
+	{
+		messageQueue->ProcessedFlag = true;
+		pthread_cond_broadcast( &messageQueue->ProcessedCondition );
+		messageQueue->Wait = MQ_WAIT_NONE;
+	}
+	if ( waitForMessages )
+	{
+		oldQueue_SleepUntilMessage( messageQueue );
+	}
+	pthread_mutex_lock( &messageQueue->Mutex );
+	if ( messageQueue->Tail <= messageQueue->Head )
+	{
+		pthread_mutex_unlock( &messageQueue->Mutex );
+		return false;
+	}
+	*message = messageQueue->Messages[messageQueue->Head & ( MAX_MESSAGES - 1 )];
+	messageQueue->Head++;
+	pthread_mutex_unlock( &messageQueue->Mutex );
+	if ( message->Wait == MQ_WAIT_RECEIVED )
+	{
+		messageQueue->ReceivedFlag = true;
+		pthread_cond_broadcast( &messageQueue->ReceivedCondition );
+	}
+	else if ( message->Wait == MQ_WAIT_PROCESSED )
+	{
+		messageQueue->Wait = MQ_WAIT_PROCESSED;
+	}
+	return true;
+}
+
+/*
+================================================================================
+
+Both queues behind one interface
+
+================================================================================
+*/
+
+typedef struct
+{
+	bool				Old;
+	ovrMessageQueue		New;
+	oldQueue			Prev;
+} benchQueue;
+
+static void benchQueue_Create( benchQueue * q, bool old )
+{
+	q->Old = old;
+	if ( old ) { oldQueue_Create( &q->Prev ); oldQueue_Enable( &q->Prev, true ); }
+	else { ovrMessageQueue_Create( &q->New ); ovrMessageQueue_Enable( &q->New, true ); }
+}
+
+static void benchQueue_Destroy( benchQueue * q )
+{
+	if ( q->Old ) { oldQueue_Destroy( &q->Prev ); }
+	else { ovrMessageQueue_Destroy( &q->New ); }
+}
+
+static void benchQueue_Post( benchQueue * q, const ovrMessage * message )
+{
+	if ( q->Old ) { oldQueue_PostMessage( &q->Prev, message ); }
+	else { ovrMessageQueue_PostMessage( &q->New, message ); }
+}
+
+static bool benchQueue_Get( benchQueue * q, ovrMessage * message, bool waitForMessages )
+{
+	return q->Old ? oldQueue_GetNextMessage( &q->Prev, message, waitForMessages )
+				  : ovrMessageQueue_GetNextMessage( &q->New, message, waitForMessages );
+}
+
+enum
+{
+	BENCH_MESSAGE_WORK,
+	BENCH_MESSAGE_QUIT
+};
+
+/*
+================================================================================
+
+Cases
+
+================================================================================
+*/
+
+static double BenchPoll( benchQueue * q, const int count )
+{
+	ovrMessage message;
+	const double start = GetTimeSeconds();
+	for ( int i = 0; i < count; i++ )
+	{
+		benchQueue_Get( q, &message, false );
+	}
+	return ( GetTimeSeconds() - start ) / count;
+}
+
+typedef struct
+{
+	benchQueue *	Queue;
+	int				Count;
+	ovrMQWait		Wait;
+	double			Total;		// seconds spent in post
+	double			Worst;
+} benchProducer;
+
+static void * ProducerThread( void * parm )
+{
+	benchProducer * p = (benchProducer *)parm;
+	ovrMessage message;
+
+	for ( int i = 0; i < p->Count; i++ )
+	{
+		ovrMessage_Init( &message, BENCH_MESSAGE_WORK, p->Wait );
+		ovrMessage_SetIntegerParm( &message, 0, i );
+		const double start = GetTimeSeconds();
+		benchQueue_Post( p->Queue, &message );
+		const double t = GetTimeSeconds() - start;
+		p->Total += t;
+		if ( t > p->Worst )
+		{
+			p->Worst = t;
+		}
+		if ( p->Wait != MQ_WAIT_NONE )
+		{
+			usleep( 200 );
+		}
+	}
+	ovrMessage_Init( &message, BENCH_MESSAGE_QUIT, MQ_WAIT_PROCESSED );
+	benchQueue_Post( p->Queue, &message );
+	return NULL;
+}
+
+// Runs the consumer side on the calling thread. 'frameWork' is how long each
+// simulated frame keeps the consumer away from the queue; with 'sleepWhenEmpty'
+// it blocks for the next message instead, like the app thread without a window.
+// Returns false if the messages did not arrive in order.
+static bool BenchConsume( benchQueue * q, const double frameWork, const bool sleepWhenEmpty )
+{
+	int expected = 0;
+	for ( ; ; )
+	{
+		ovrMessage message;
+		while ( benchQueue_Get( q, &message, sleepWhenEmpty ) )
+		{
+			if ( message.Id == BENCH_MESSAGE_QUIT )
+			{
+				benchQueue_Get( q, &message, false );	// signals the quit as processed
+				return true;
+			}
+			if ( ovrMessage_GetIntegerParm( &message, 0 ) != expected++ )
+			{
+				return false;
+			}
+		}
+		const double end = GetTimeSeconds() + frameWork;
+		while ( GetTimeSeconds() < end )
+		{
+		}
+	}
+}
+
+static bool BenchProducerConsumer( benchQueue * q, const int count, const ovrMQWait wait,
+								const double frameWork, const bool sleepWhenEmpty, benchProducer * p )
+{
+	pthread_t thread;
+	memset( p, 0, sizeof( *p ) );
+	p->Queue = q;
+	p->Count = count;
+	p->Wait = wait;
+	pthread_create( &thread, NULL, ProducerThread, p );
+	const bool ok = BenchConsume( q, frameWork, sleepWhenEmpty );
+	pthread_join( thread, NULL );
+	return ok;
+}
+
+int main( int argc, char * argv[] )
+{
+	const int pollCount = 10000000;
+	const int lifecycleCount = argc > 1 ? atoi( argv[1] ) : 2000;
+	const int burstCount = 1000000;
+	bool ok = true;
+
+	printf( "%-6s %14s %24s %24s\n", "queue", "poll ns/frame", "lifecycle us avg/worst", "burst ns/msg" );
+	for ( int old = 1; old >= 0; old-- )
+	{
+		benchQueue * q = (benchQueue *)malloc( sizeof( benchQueue ) );
+		benchProducer lifecycle;
+		benchProducer burst;
+
+		benchQueue_Create( q, old );
+		const double poll = BenchPoll( q, pollCount );
+		ok &= BenchProducerConsumer( q, lifecycleCount, MQ_WAIT_PROCESSED, 100e-6, false, &lifecycle );
+		const double start = GetTimeSeconds();
+		ok &= BenchProducerConsumer( q, burstCount, MQ_WAIT_NONE, 0.0, true, &burst );
+		const double burstTime = GetTimeSeconds() - start;
+		benchQueue_Destroy( q );
+		free( q );
+
+		printf( "%-6s %14.1f %14.1f / %7.1f %24.1f\n", old ? "mutex" : "spsc",
+				poll * 1e9, lifecycle.Total / lifecycleCount * 1e6, lifecycle.Worst * 1e6,
+				burstTime / burstCount * 1e9 );
+	}
+	if ( !ok )
+	{
+		printf( "messages arrived out of order\n" );
+	}
+	return ok ? 0 : 1;
+}
@@ -113,7 +113,7 @@
 #define PACKAGE_VERSION ""
 
 /* The size of a `void*', as computed by sizeof. */
-#if defined(__aarch64__)
+#if defined(__aarch64__) || defined(__x86_64__)
 #define SIZEOF_VOIDP 8
 #else
 #define SIZEOF_VOIDP 4
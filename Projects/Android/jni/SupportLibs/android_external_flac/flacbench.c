@@ -0,0 +1,194 @@
+/* libFLAC - Free Lossless Audio Codec library
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * A small decode throughput benchmark for the stream decoder. Each file is
+ * decoded the given number of times and the fastest pass is reported, in
+ * milliseconds and in million samples (per channel) per second. The write
+ * callback folds every decoded sample into a checksum, so that the output
+ * of different builds (e.g. with and without the SSE4.1/NEON LPC restore)
+ * can be compared; the samples of the first pass of each file can also be
+ * written out raw, as native-endian FLAC__int32 values with the channels
+ * of each frame one after the other.
+ *
+ * This is not built with the library; on a POSIX host, from this
+ * directory (drop -msse4.1 on other CPUs):
+ *
+ *	cc -O2 -msse4.1 -DHAVE_CONFIG_H -DFLAC__NO_MD5 \
+ *	    -DFLAC__INTEGER_ONLY_LIBRARY -I. -Iinclude -IlibFLAC/include \
+ *	    -o flacbench flacbench.c libFLAC/bitmath.c libFLAC/bitreader.c \
+ *	    libFLAC/cpu.c libFLAC/crc.c libFLAC/fixed.c libFLAC/float.c \
+ *	    libFLAC/format.c libFLAC/lpc.c libFLAC/lpc_intrin_neon.c \
+ *	    libFLAC/lpc_intrin_sse41.c libFLAC/memory.c \
+ *	    libFLAC/stream_decoder.c
+ *	./flacbench [-p passes] [-o output.raw] input.flac...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "FLAC/stream_decoder.h"
+
+typedef struct {
+	unsigned long checksum;
+	FLAC__uint64 samples;
+	FILE *out;
+	FLAC__bool error;
+} bench_client_data;
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static FLAC__StreamDecoderWriteStatus write_callback(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	bench_client_data *cd = (bench_client_data *)client_data;
+	unsigned channel, i;
+
+	(void)decoder;
+	for(channel = 0; channel < frame->header.channels; channel++) {
+		for(i = 0; i < frame->header.blocksize; i++)
+			cd->checksum = ((cd->checksum ^ (FLAC__uint32)buffer[channel][i]) * 16777619UL) & 0xffffffffUL;
+		if(cd->out)
+			fwrite(buffer[channel], sizeof(FLAC__int32), frame->header.blocksize, cd->out);
+	}
+	cd->samples += frame->header.blocksize;
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void metadata_callback(const FLAC__StreamDecoder *decoder, const FLAC__StreamMetadata *metadata, void *client_data)
+{
+	(void)decoder, (void)metadata, (void)client_data;
+}
+
+static void error_callback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	bench_client_data *cd = (bench_client_data *)client_data;
+
+	(void)decoder;
+	if(!cd->error)
+		fprintf(stderr, "decoder error: %s\n", FLAC__StreamDecoderErrorStatusString[status]);
+	cd->error = true;
+}
+
+/* one decode of the whole file; returns the seconds it took, or -1 */
+static double decode_file(const char *filename, bench_client_data *cd)
+{
+	FLAC__StreamDecoder *decoder;
+	FLAC__StreamDecoderInitStatus init_status;
+	FLAC__bool ok;
+	double t;
+
+	if((decoder = FLAC__stream_decoder_new()) == NULL) {
+		fprintf(stderr, "%s: out of memory\n", filename);
+		return -1;
+	}
+	cd->checksum = 2166136261UL;
+	cd->samples = 0;
+	cd->error = false;
+	init_status = FLAC__stream_decoder_init_file(decoder, filename, write_callback, metadata_callback, error_callback, cd);
+	if(init_status != FLAC__STREAM_DECODER_INIT_STATUS_OK) {
+		fprintf(stderr, "%s: %s\n", filename, FLAC__StreamDecoderInitStatusString[init_status]);
+		FLAC__stream_decoder_delete(decoder);
+		return -1;
+	}
+	t = now();
+	ok = FLAC__stream_decoder_process_until_end_of_stream(decoder);
+	t = now() - t;
+	FLAC__stream_decoder_delete(decoder);
+	if(!ok || cd->error) {
+		fprintf(stderr, "%s: decoding failed\n", filename);
+		return -1;
+	}
+	return t;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-p passes] [-o output.raw] input.flac...\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+	bench_client_data cd;
+	const char *outname = NULL;
+	FILE *out = NULL;
+	double t, best, total = 0;
+	unsigned passes = 7, pass;
+	int i, files = 0;
+
+	for(i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if(strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+			passes = atoi(argv[++i]);
+		else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+			outname = argv[++i];
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if(i == argc || passes == 0) {
+		usage(argv[0]);
+		return 1;
+	}
+	if(outname && (out = fopen(outname, "wb")) == NULL) {
+		perror(outname);
+		return 2;
+	}
+
+	printf("%-24s %8s %12s %10s %12s\n", "file", "checksum", "samples", "best ms", "Msamples/s");
+	for(; i < argc; i++) {
+		best = -1;
+		for(pass = 0; pass < passes; pass++) {
+			cd.out = pass == 0 ? out : NULL;
+			if((t = decode_file(argv[i], &cd)) < 0)
+				return 3;
+			if(best < 0 || t < best)
+				best = t;
+		}
+		printf("%-24s %08lx %12llu %10.2f %12.1f\n", argv[i], cd.checksum,
+		       (unsigned long long)cd.samples, best * 1e3, cd.samples / best / 1e6);
+		total += best;
+		files++;
+	}
+	if(files > 1)
+		printf("total %.2f ms, best of %u passes\n", total * 1e3, passes);
+
+	if(out && (ferror(out) | fclose(out))) {
+		perror(outname);
+		return 2;
+	}
+	return 0;
+}
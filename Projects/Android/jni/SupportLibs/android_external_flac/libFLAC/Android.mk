@@ -14,6 +14,8 @@ LOCAL_SRC_FILES:= \
 	float.c \
 	format.c \
 	lpc.c \
+	lpc_intrin_neon.c \
+	lpc_intrin_sse41.c \
 	md5.c \
 	memory.c \
 	metadata_iterators.c \
@@ -36,5 +38,9 @@ LOCAL_LDLIBS += -lm
 
 LOCAL_ARM_MODE := arm
 
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_ARM_NEON := true
+endif
+
 
 include $(BUILD_STATIC_LIBRARY)
@@ -68,11 +68,16 @@ typedef FLAC__uint32 brword;
 #endif
 #endif
 /* counts the # of zero MSBs in a word */
+#if defined __GNUC__ && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+/* callers never pass 0, for which __builtin_clz() is undefined */
+#define COUNT_ZERO_MSBS(word) __builtin_clz(word)
+#else
 #define COUNT_ZERO_MSBS(word) ( \
 	(word) <= 0xffff ? \
 		( (word) <= 0xff? byte_to_unary_table[word] + 24 : byte_to_unary_table[(word) >> 8] + 16 ) : \
 		( (word) <= 0xffffff? byte_to_unary_table[word >> 16] + 8 : byte_to_unary_table[(word) >> 24] ) \
 )
+#endif
 /* this alternate might be slightly faster on some systems/compilers: */
 #define COUNT_ZERO_MSBS2(word) ( (word) <= 0xff ? byte_to_unary_table[word] + 24 : ((word) <= 0xffff ? byte_to_unary_table[(word) >> 8] + 16 : ((word) <= 0xffffff ? byte_to_unary_table[(word) >> 16] + 8 : byte_to_unary_table[(word) >> 24])) )
 
@@ -75,6 +75,14 @@ typedef struct {
 
 void FLAC__cpu_info(FLAC__CPUInfo *info);
 
+/* intrinsics only need the compiler, so unlike the asm routines they are
+ * used even with FLAC__NO_ASM; the target ABI decides which set we get */
+#if defined __SSE4_1__
+#define FLAC__SSE4_1_SUPPORTED 1
+#elif defined __ARM_NEON || defined __ARM_NEON__
+#define FLAC__HAS_NEONINTRIN 1
+#endif
+
 #ifndef FLAC__NO_ASM
 #ifdef FLAC__CPU_IA32
 #ifdef FLAC__HAS_NASM
@@ -0,0 +1,145 @@
+/* libFLAC - Free Lossless Audio Codec library
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "private/cpu.h"
+
+#ifdef FLAC__HAS_NEONINTRIN
+
+#include <string.h> /* for memcpy(), memset() */
+#include <arm_neon.h>
+#include "FLAC/assert.h"
+#include "FLAC/format.h"
+#include "private/lpc.h"
+
+/*
+ * Same scheme as lpc_intrin_sse41.c: the two samples before each block of
+ * four and the ones inside it are handled with scalar code, the older
+ * history with one multiply-accumulate by scalar per coefficient window.
+ * The result is identical to FLAC__lpc_restore_signal(), and a few samples
+ * before data[-order] are read; the decoder keeps zeroes there.
+ */
+
+/* the scalar part for the block at data[i]; c[] is zero-padded past order */
+#define RESTORE_BLOCK_(sum) \
+	{ \
+		const FLAC__int32 h2 = data[i-2], h1 = data[i-1]; \
+		FLAC__int32 d0, d1, d2; \
+		d0 = residual[i  ] + ((vgetq_lane_s32(sum, 0) + c[1]*h2 + c[0]*h1) >> lp_quantization); \
+		d1 = residual[i+1] + ((vgetq_lane_s32(sum, 1) + c[2]*h2 + c[1]*h1 + c[0]*d0) >> lp_quantization); \
+		d2 = residual[i+2] + ((vgetq_lane_s32(sum, 2) + c[3]*h2 + c[2]*h1 + c[1]*d0 + c[0]*d1) >> lp_quantization); \
+		data[i+3] = residual[i+3] + ((vgetq_lane_s32(sum, 3) + c[4]*h2 + c[3]*h1 + c[2]*d0 + c[1]*d1 + c[0]*d2) >> lp_quantization); \
+		data[i] = d0; \
+		data[i+1] = d1; \
+		data[i+2] = d2; \
+	}
+
+void FLAC__lpc_restore_signal_intrin_neon_order8(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[])
+{
+	int i;
+	FLAC__int32 c[8 + 3];
+	int32x4_t q2, q3, q4, q5, q6, q7;
+
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 8);
+
+	/* for the lowest orders the plain C version is already as fast */
+	if(order < 5) {
+		FLAC__lpc_restore_signal(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	memset(c, 0, sizeof(c));
+	memcpy(c, qlp_coeff, sizeof(FLAC__int32) * order);
+
+	q2 = vld1q_s32(c+2);
+	q3 = vld1q_s32(c+3);
+	q4 = vld1q_s32(c+4);
+	q5 = vld1q_s32(c+5);
+	q6 = vld1q_s32(c+6);
+	q7 = vld1q_s32(c+7);
+
+	for(i = 0; i < (int)data_len-3; i += 4) {
+		int32x4_t summ;
+		summ = vmulq_n_s32(      q2, data[i-3]);
+		summ = vmlaq_n_s32(summ, q3, data[i-4]);
+		summ = vmlaq_n_s32(summ, q4, data[i-5]);
+		summ = vmlaq_n_s32(summ, q5, data[i-6]);
+		summ = vmlaq_n_s32(summ, q6, data[i-7]);
+		summ = vmlaq_n_s32(summ, q7, data[i-8]);
+		RESTORE_BLOCK_(summ)
+	}
+	for(; i < (int)data_len; i++) {
+		FLAC__int32 sum = 0;
+		int j;
+		for(j = 0; j < (int)order; j++)
+			sum += c[j] * data[i-j-1];
+		data[i] = residual[i] + (sum >> lp_quantization);
+	}
+}
+
+void FLAC__lpc_restore_signal_intrin_neon(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[])
+{
+	int i, j;
+	FLAC__int32 c[32 + 3];
+	int32x4_t q[32];
+
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	if(order <= 8) {
+		FLAC__lpc_restore_signal_intrin_neon_order8(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	memset(c, 0, sizeof(c));
+	memcpy(c, qlp_coeff, sizeof(FLAC__int32) * order);
+
+	for(j = 2; j < (int)order; j++)
+		q[j] = vld1q_s32(c+j);
+
+	for(i = 0; i < (int)data_len-3; i += 4) {
+		int32x4_t summ = vmulq_n_s32(q[2], data[i-3]);
+		for(j = 3; j < (int)order; j++)
+			summ = vmlaq_n_s32(summ, q[j], data[i-j-1]);
+		RESTORE_BLOCK_(summ)
+	}
+	for(; i < (int)data_len; i++) {
+		FLAC__int32 sum = 0;
+		for(j = 0; j < (int)order; j++)
+			sum += c[j] * data[i-j-1];
+		data[i] = residual[i] + (sum >> lp_quantization);
+	}
+}
+
+#endif /* FLAC__HAS_NEONINTRIN */
@@ -0,0 +1,154 @@
+/* libFLAC - Free Lossless Audio Codec library
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "private/cpu.h"
+
+#ifdef FLAC__SSE4_1_SUPPORTED
+
+#include <string.h> /* for memcpy(), memset() */
+#include <smmintrin.h>
+#include "FLAC/assert.h"
+#include "FLAC/format.h"
+#include "private/lpc.h"
+
+/*
+ * The samples are restored four at a time.  The prediction of the four
+ * samples is split in two: the terms that use the two samples before the
+ * block and the ones inside it are summed with scalar code, since each new
+ * sample depends on the one just before it; all the older terms are summed
+ * in vector lanes, one output sample per lane, by multiplying a broadcast
+ * history sample with a window of the coefficients.  The vector part only
+ * needs samples from before the previous block, so it is computed while
+ * the scalar code is still working through that block.
+ *
+ * All sums wrap at 32 bits exactly like FLAC__lpc_restore_signal(), so the
+ * result is identical.  Like FLAC__lpc_restore_signal_asm_ia32_mmx() this
+ * reads a few samples before data[-order]; the decoder keeps zeroes there.
+ */
+
+/* the scalar part for the block at data[i]; c[] is zero-padded past order */
+#define RESTORE_BLOCK_(sum) \
+	{ \
+		const FLAC__int32 h2 = data[i-2], h1 = data[i-1]; \
+		FLAC__int32 d0, d1, d2; \
+		d0 = residual[i  ] + ((_mm_cvtsi128_si32(sum)    + c[1]*h2 + c[0]*h1) >> lp_quantization); \
+		d1 = residual[i+1] + ((_mm_extract_epi32(sum, 1) + c[2]*h2 + c[1]*h1 + c[0]*d0) >> lp_quantization); \
+		d2 = residual[i+2] + ((_mm_extract_epi32(sum, 2) + c[3]*h2 + c[2]*h1 + c[1]*d0 + c[0]*d1) >> lp_quantization); \
+		data[i+3] = residual[i+3] + ((_mm_extract_epi32(sum, 3) + c[4]*h2 + c[3]*h1 + c[2]*d0 + c[1]*d1 + c[0]*d2) >> lp_quantization); \
+		data[i] = d0; \
+		data[i+1] = d1; \
+		data[i+2] = d2; \
+	}
+
+#define MUL_HISTORY_(coeffs, sample) _mm_mullo_epi32((coeffs), _mm_set1_epi32(sample))
+
+void FLAC__lpc_restore_signal_intrin_sse41_order8(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[])
+{
+	int i;
+	FLAC__int32 c[8 + 3];
+	__m128i q2, q3, q4, q5, q6, q7;
+
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 8);
+
+	/* for the lowest orders the plain C version is already as fast */
+	if(order < 5) {
+		FLAC__lpc_restore_signal(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	memset(c, 0, sizeof(c));
+	memcpy(c, qlp_coeff, sizeof(FLAC__int32) * order);
+
+	q2 = _mm_loadu_si128((const __m128i*)(c+2));
+	q3 = _mm_loadu_si128((const __m128i*)(c+3));
+	q4 = _mm_loadu_si128((const __m128i*)(c+4));
+	q5 = _mm_loadu_si128((const __m128i*)(c+5));
+	q6 = _mm_loadu_si128((const __m128i*)(c+6));
+	q7 = _mm_loadu_si128((const __m128i*)(c+7));
+
+	for(i = 0; i < (int)data_len-3; i += 4) {
+		__m128i summ;
+		summ =                     MUL_HISTORY_(q2, data[i-3]);
+		summ = _mm_add_epi32(summ, MUL_HISTORY_(q3, data[i-4]));
+		summ = _mm_add_epi32(summ, MUL_HISTORY_(q4, data[i-5]));
+		summ = _mm_add_epi32(summ, MUL_HISTORY_(q5, data[i-6]));
+		summ = _mm_add_epi32(summ, MUL_HISTORY_(q6, data[i-7]));
+		summ = _mm_add_epi32(summ, MUL_HISTORY_(q7, data[i-8]));
+		RESTORE_BLOCK_(summ)
+	}
+	for(; i < (int)data_len; i++) {
+		FLAC__int32 sum = 0;
+		int j;
+		for(j = 0; j < (int)order; j++)
+			sum += c[j] * data[i-j-1];
+		data[i] = residual[i] + (sum >> lp_quantization);
+	}
+}
+
+void FLAC__lpc_restore_signal_intrin_sse41(const FLAC__int32 residual[], unsigned data_len, const FLAC__int32 qlp_coeff[], unsigned order, int lp_quantization, FLAC__int32 data[])
+{
+	int i, j;
+	FLAC__int32 c[32 + 3];
+	__m128i q[32];
+
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	if(order <= 8) {
+		FLAC__lpc_restore_signal_intrin_sse41_order8(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	memset(c, 0, sizeof(c));
+	memcpy(c, qlp_coeff, sizeof(FLAC__int32) * order);
+
+	for(j = 2; j < (int)order; j++)
+		q[j] = _mm_loadu_si128((const __m128i*)(c+j));
+
+	for(i = 0; i < (int)data_len-3; i += 4) {
+		__m128i summ = MUL_HISTORY_(q[2], data[i-3]);
+		for(j = 3; j < (int)order; j++)
+			summ = _mm_add_epi32(summ, MUL_HISTORY_(q[j], data[i-j-1]));
+		RESTORE_BLOCK_(summ)
+	}
+	for(; i < (int)data_len; i++) {
+		FLAC__int32 sum = 0;
+		for(j = 0; j < (int)order; j++)
+			sum += c[j] * data[i-j-1];
+		data[i] = residual[i] + (sum >> lp_quantization);
+	}
+}
+
+#endif /* FLAC__SSE4_1_SUPPORTED */
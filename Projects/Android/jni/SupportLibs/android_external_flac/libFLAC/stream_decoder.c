@@ -447,6 +447,16 @@ static FLAC__StreamDecoderInitStatus init_stream_internal_(
 #endif
 	}
 #endif
+	/* intrinsics, which are not affected by FLAC__NO_ASM */
+#if defined FLAC__SSE4_1_SUPPORTED
+	decoder->private_->local_lpc_restore_signal = FLAC__lpc_restore_signal_intrin_sse41;
+	decoder->private_->local_lpc_restore_signal_16bit = FLAC__lpc_restore_signal_intrin_sse41;
+	decoder->private_->local_lpc_restore_signal_16bit_order8 = FLAC__lpc_restore_signal_intrin_sse41_order8;
+#elif defined FLAC__HAS_NEONINTRIN
+	decoder->private_->local_lpc_restore_signal = FLAC__lpc_restore_signal_intrin_neon;
+	decoder->private_->local_lpc_restore_signal_16bit = FLAC__lpc_restore_signal_intrin_neon;
+	decoder->private_->local_lpc_restore_signal_16bit_order8 = FLAC__lpc_restore_signal_intrin_neon_order8;
+#endif
 
 	/* from here on, errors are fatal */
 
@@ -692,7 +702,8 @@ FLAC_API FLAC__bool FLAC__stream_decoder_finish(FLAC__StreamDecoder *decoder)
 		 * FLAC__lpc_restore_signal_asm_ia32_mmx() requires that the
 		 * output arrays have a buffer of up to 3 zeroes in front
 		 * (at negative indices) for alignment purposes; we use 4
-		 * to keep the data well-aligned.
+		 * to keep the data well-aligned.  The lpc_intrin_*.c
+		 * routines also read the history up to 3 samples early.
 		 */
 		if(0 != decoder->private_->output[i]) {
 			free(decoder->private_->output[i]-4);
@@ -1330,7 +1341,8 @@ FLAC__bool allocate_output_(FLAC__StreamDecoder *decoder, unsigned size, unsigne
 		 * FLAC__lpc_restore_signal_asm_ia32_mmx() requires that the
 		 * output arrays have a buffer of up to 3 zeroes in front
 		 * (at negative indices) for alignment purposes; we use 4
-		 * to keep the data well-aligned.
+		 * to keep the data well-aligned.  The lpc_intrin_*.c
+		 * routines also read the history up to 3 samples early.
 		 */
 		tmp = (FLAC__int32*)safe_malloc_muladd2_(sizeof(FLAC__int32), /*times (*/size, /*+*/4/*)*/);
 		if(tmp == 0) {
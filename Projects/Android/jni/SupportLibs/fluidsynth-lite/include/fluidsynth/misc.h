@@ -63,6 +63,10 @@ extern "C" {
 FLUIDSYNTH_API int fluid_is_soundfont (const char *filename);
 FLUIDSYNTH_API int fluid_is_midifile (const char *filename);
 
+FLUIDSYNTH_API int fluid_profiling_start (void);
+FLUIDSYNTH_API int fluid_profiling_get (int num, const char **name, double *min,
+                                        double *avg, double *max, unsigned int *count);
+
 
 #ifdef WIN32
 FLUIDSYNTH_API FLUID_DEPRECATED void* fluid_get_hinstance(void);
@@ -11,7 +11,7 @@ LOCAL_C_INCLUDES := $(LOCAL_PATH)/../include/ \
                     $(LOCAL_PATH)/rvoice \
                     $(LOCAL_PATH)/midi \
 
-LOCAL_CFLAGS :=  -DDEFAULT_SOUNDFONT=\"qzdoom.sf2\" -DSUPPORTS_VLA -DHAVE_PTHREAD_H -DHAVE_SYS_STAT_H -DHAVE_STDLIB_H -DHAVE_STDIO_H -DHAVE_MATH_H -DHAVE_STRING_H -DHAVE_STDARG_H -DHAVE_SYS_SOCKET_H -DHAVE_NETINET_IN_H -DHAVE_ARPA_INET_H -DHAVE_NETINET_TCP_H -DHAVE_UNISTD_H -DHAVE_ERRNO_H -DHAVE_FCNTL_H -DVERSION=1.1.6
+LOCAL_CFLAGS :=  -DDEFAULT_SOUNDFONT=\"qzdoom.sf2\" -DSUPPORTS_VLA -DHAVE_PTHREAD_H -DHAVE_SYS_STAT_H -DHAVE_STDLIB_H -DHAVE_STDIO_H -DHAVE_MATH_H -DHAVE_STRING_H -DHAVE_STDARG_H -DHAVE_SYS_SOCKET_H -DHAVE_NETINET_IN_H -DHAVE_ARPA_INET_H -DHAVE_NETINET_TCP_H -DHAVE_UNISTD_H -DHAVE_ERRNO_H -DHAVE_FCNTL_H -DHAVE_SYS_MMAN_H -DVERSION=1.1.6
 
 
 LOCAL_CPPFLAGS := $(LOCAL_CFLAGS)  -fexceptions -frtti
@@ -257,6 +257,103 @@ fast_render_loop(fluid_settings_t* settings, fluid_synth_t* synth, fluid_player_
   delete_fluid_file_renderer(renderer);
 }
 
+/* Wall clock time in seconds */
+static double
+benchmark_time(void)
+{
+#ifdef WIN32
+  return GetTickCount() / 1000.0;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
+/*
+ * Render the MIDI file as fast as possible without any audio output, then
+ * write the timings as JSON to [filename] ("-" for stdout), so they can be
+ * compared between builds. The per-stage timings are only available if
+ * libfluidsynth was built with profiling support (enable-profiling, on by
+ * default in the CMake build).
+ *
+ * Host only: this program is built by CMake, Android.mk only builds the
+ * library.
+ */
+static void
+benchmark_loop(fluid_settings_t* settings, fluid_synth_t* synth, fluid_player_t* player,
+               char* filename)
+{
+  FILE* out;
+  float *left, *right;
+  int period_size, interp, cpu_cores, polyphony;
+  unsigned int blocks = 0, count;
+  double sample_rate, frames = 0.0, start, elapsed, audio;
+  double min, avg, max;
+  const char* name;
+  int i;
+
+  fluid_settings_getint(settings, "audio.period-size", &period_size);
+  fluid_settings_getnum(settings, "synth.sample-rate", &sample_rate);
+  fluid_settings_getint(settings, "synth.cpu-cores", &cpu_cores);
+  fluid_settings_getint(settings, "synth.polyphony", &polyphony);
+  interp = FLUID_INTERP_DEFAULT;
+  fluid_settings_getint(settings, "synth.interpolation", &interp);
+
+  left = FLUID_ARRAY(float, period_size);
+  right = FLUID_ARRAY(float, period_size);
+  if (left == NULL || right == NULL) {
+    fprintf(stderr, "Out of memory\n");
+    goto done;
+  }
+
+  if (fluid_profiling_start() != FLUID_OK) {
+    fprintf(stderr, "libfluidsynth was built without enable-profiling, "
+            "no per-stage timings\n");
+  }
+
+  start = benchmark_time();
+  while (fluid_player_get_status(player) == FLUID_PLAYER_PLAYING) {
+    if (fluid_synth_write_float(synth, period_size, left, 0, 1, right, 0, 1) != FLUID_OK) {
+      break;
+    }
+    frames += period_size;
+    blocks++;
+  }
+  elapsed = benchmark_time() - start;
+  audio = frames / sample_rate;
+
+  out = FLUID_STRCMP(filename, "-") == 0 ? stdout : fopen(filename, "w");
+  if (out == NULL) {
+    fprintf(stderr, "Failed to open the benchmark file '%s'\n", filename);
+    goto done;
+  }
+
+  fprintf(out, "{\n");
+  fprintf(out, "  \"sample_rate\": %.0f,\n", sample_rate);
+  fprintf(out, "  \"period_size\": %d,\n", period_size);
+  fprintf(out, "  \"cpu_cores\": %d,\n", cpu_cores);
+  fprintf(out, "  \"polyphony\": %d,\n", polyphony);
+  fprintf(out, "  \"interpolation\": %d,\n", interp);
+  fprintf(out, "  \"blocks\": %u,\n", blocks);
+  fprintf(out, "  \"audio_seconds\": %.3f,\n", audio);
+  fprintf(out, "  \"render_seconds\": %.3f,\n", elapsed);
+  fprintf(out, "  \"realtime_factor\": %.2f,\n", elapsed > 0.0 ? audio / elapsed : 0.0);
+  fprintf(out, "  \"peak_voices\": %d,\n", fluid_synth_get_peak_voice_count(synth));
+  fprintf(out, "  \"profile\": {");
+  for (i = 0; fluid_profiling_get(i, &name, &min, &avg, &max, &count) == FLUID_OK; i++) {
+    fprintf(out, "%s\n    \"%s\": { \"min\": %.3f, \"avg\": %.3f, \"max\": %.3f, \"count\": %u }",
+            i > 0 ? "," : "", name, min, avg, max, count);
+  }
+  fprintf(out, "%s}\n}\n", i > 0 ? "\n  " : "");
+
+  if (out != stdout) fclose(out);
+
+done:
+  if (left) FLUID_FREE(left);
+  if (right) FLUID_FREE(right);
+}
+
 #ifdef HAVE_SIGNAL_H
 /*
  * handle_signal
@@ -293,10 +390,11 @@ int main(int argc, char** argv)
   int with_server = 0;
   int dump = 0;
   int fast_render = 0;
+  char* benchmark_file = NULL;
 #ifdef LASH_ENABLED
   int connect_lash = 1;
 #endif
-  char *optchars = "a:C:c:dE:f:F:G:g:hijK:L:lm:nO:o:p:R:r:sT:Vvz:";
+  char *optchars = "a:B:C:c:dE:f:F:G:g:hijK:L:lm:nO:o:p:R:r:sT:Vvz:";
 #ifdef LASH_ENABLED
   int enabled_lash = 0;		/* set to TRUE if lash gets enabled */
   fluid_lash_args_t *lash_args;
@@ -323,6 +421,7 @@ int main(int argc, char** argv)
       {"audio-file-format", 1, 0, 'O'},
       {"audio-file-type", 1, 0, 'T'},
       {"audio-groups", 1, 0, 'G'},
+      {"benchmark", 1, 0, 'B'},
       {"chorus", 1, 0, 'C'},
       {"connect-jack-outputs", 0, 0, 'j'},
       {"disable-lash", 0, 0, 'l'},
@@ -431,6 +530,10 @@ int main(int argc, char** argv)
       }
       else fluid_settings_setstr(settings, "audio.file.endian", optarg);
       break;
+    case 'B':
+      benchmark_file = optarg;
+      fast_render = 1;
+      break;
     case 'f':
       config_file = optarg;
       break;
@@ -758,11 +861,16 @@ int main(int argc, char** argv)
       goto cleanup;
     } 
 
-    fluid_settings_dupstr (settings, "audio.file.name", &filename);
-    printf ("Rendering audio to file '%s'..\n", filename);
-    if (filename) FLUID_FREE (filename);
+    if (benchmark_file != NULL) {
+      printf ("Benchmarking, writing the results to '%s'..\n", benchmark_file);
+      benchmark_loop(settings, synth, player, benchmark_file);
+    } else {
+      fluid_settings_dupstr (settings, "audio.file.name", &filename);
+      printf ("Rendering audio to file '%s'..\n", filename);
+      if (filename) FLUID_FREE (filename);
 
-    fast_render_loop(settings, synth, player);
+      fast_render_loop(settings, synth, player);
+    }
   }
 
  cleanup:
@@ -880,6 +988,9 @@ print_help (fluid_settings_t *settings)
   printf(" -a, --audio-driver=[label]\n"
 	 "    The name of the audio driver to use.\n"
 	 "    Valid values: %s\n", audio_options ? audio_options : "ERROR");
+  printf(" -B, --benchmark=[file]\n"
+	 "    Render MIDI file as fast as possible without audio output and\n"
+	 "    write the timings to [file] as JSON (\"-\" for stdout)\n");
   printf(" -c, --audio-bufcount=[count]\n"
 	 "    Number of audio buffers\n");
   printf(" -C, --chorus\n"
@@ -0,0 +1,390 @@
+/* FluidSynth - A Software Synthesizer
+ *
+ * Copyright (C) 2003  Peter Hanappe and others.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA
+ */
+
+/* dsptest.c
+ *
+ * Checks the linear, 4th and 7th order interpolators of fluid_rvoice_dsp.c
+ * against a reference that walks the same sample one output at a time.
+ * The sample is a 16 bit test tone with noise, played unlooped, looped,
+ * and looped then released, at pitches from two octaves down to past an
+ * octave up, with an amplitude ramp.  For every output sample:
+ *
+ * - the output may differ from the sum taken in double precision by at
+ *   most (taps + 1) float or double epsilons of the sum of the magnitudes
+ *   of its terms, which is the rounding error of a sum of that many terms
+ *   in any order;
+ * - when one of its points comes from before the start or after the end
+ *   or loop end, it must be the same to the last bit as the scalar
+ *   expression in fluid_rvoice_dsp.c;
+ * - the sample count, phase, amplitude and loop state left in the voice
+ *   must be the same to the last bit.
+ *
+ * Exits 1 on any difference, then prints the time per output sample in
+ * the middle of a long loop.  Build it with and without FLUID_NO_SIMD to
+ * compare the vector and scalar interpolators; the vector ones need
+ * WITH_FLOAT.  -ffp-contract=off keeps the compiler from fusing multiplies
+ * and adds differently here and in fluid_rvoice_dsp.c, which would make
+ * the scalar expressions differ in the last bit.  Not part of the Android
+ * build; on a host, from the src directory:
+ *
+ *   cc -O2 -ffp-contract=off -DHAVE_PTHREAD_H -DHAVE_STDLIB_H \
+ *      -DHAVE_STDIO_H -DHAVE_MATH_H -DHAVE_STRING_H -DHAVE_STDARG_H \
+ *      -include stdint.h -I../include -I. -Iutils -Isynth -Isfloader \
+ *      -Irvoice -Imidi [-DWITH_FLOAT] [-DFLUID_NO_SIMD] \
+ *      -o dsptest rvoice/dsptest.c -lm
+ *   ./dsptest
+ */
+
+#include "fluid_rvoice_dsp.c"
+#include <float.h>
+#include <time.h>
+
+#define SAMPLE_LEN   8192
+#define LOOP_START   2000
+#define LOOP_END     2317       /* a loop that doesn't fit whole blocks */
+#define LOOP_BLOCKS  300        /* blocks rendered before a release */
+
+#if defined(WITH_FLOAT)
+#define REAL_EPSILON FLT_EPSILON
+#else
+#define REAL_EPSILON DBL_EPSILON
+#endif
+
+enum { PLAY_UNLOOPED, PLAY_LOOPED, PLAY_RELEASED };
+
+static short int sample_data[SAMPLE_LEN];
+static fluid_sample_t sample;
+
+static struct {
+  const char *name;
+  int taps;
+  int (*interpolate) (fluid_rvoice_dsp_t *voice);
+} methods[] = {
+  { "linear", 2, fluid_rvoice_dsp_interpolate_linear },
+  { "4th order", 4, fluid_rvoice_dsp_interpolate_4th_order },
+  { "7th order", 7, fluid_rvoice_dsp_interpolate_7th_order },
+};
+#define METHOD_COUNT (int)(sizeof (methods) / sizeof (methods[0]))
+
+static const double pitches[] = {
+  0.25, 0.5, 0.7071, 0.999, 1.0, 1.0001, 1.3348, 2.0, 2.37
+};
+#define PITCH_COUNT (int)(sizeof (pitches) / sizeof (pitches[0]))
+
+/* The reference: the same walk through the sample, one output at a time */
+typedef struct {
+  fluid_phase_t phase;          /* index 0 is the first tap */
+  fluid_real_t amp;
+  int has_looped;
+  int done;
+} reference_t;
+
+static int failures;
+static double worst_error;      /* largest error / allowed error */
+static double snr_signal, snr_noise;
+
+static void
+generate_sample (void)
+{
+  unsigned int seed = 1;
+  int i;
+
+  for (i = 0; i < SAMPLE_LEN; i++)
+  {
+    double t = (double) i / 44100.0;
+    double v = 14000.0 * sin (2 * M_PI * 441.0 * t)
+      + 7000.0 * sin (2 * M_PI * 1323.0 * t + 1.0)
+      + 3500.0 * sin (2 * M_PI * 9261.0 * t + 2.0);
+
+    seed = seed * 1103515245 + 12345;
+    v += (double) ((seed >> 16) & 0x7fff) / 4.0 - 4096.0;
+    sample_data[i] = (short int) v;
+  }
+  /* full scale at the ends, where the points get duplicated */
+  sample_data[0] = 32767;
+  sample_data[SAMPLE_LEN - 1] = -32768;
+  sample_data[LOOP_START] = -32768;
+  sample_data[LOOP_END - 1] = 32767;
+
+  sample.data = sample_data;
+}
+
+/* Point k as the interpolators see it; sets *edge if it isn't sample_data[k] */
+static short int
+reference_point (const fluid_rvoice_dsp_t *voice, const reference_t *ref,
+                 int k, int *edge)
+{
+  int start_index = ref->has_looped ? voice->loopstart : voice->start;
+
+  if (k < start_index)
+  {
+    *edge = 1;
+    return ref->has_looped ? sample_data[voice->loopend - (start_index - k)]
+      : sample_data[voice->start];
+  }
+  if (voice->is_looping && k >= voice->loopend)
+  {
+    *edge = 1;
+    return sample_data[voice->loopstart + (k - voice->loopend)];
+  }
+  if (!voice->is_looping && k > voice->end)
+  {
+    *edge = 1;
+    return sample_data[voice->end];
+  }
+  return sample_data[k];
+}
+
+/* Checks one output of the interpolator and steps the reference past it */
+static void
+check_output (int method, const fluid_rvoice_dsp_t *voice, reference_t *ref,
+              fluid_real_t out, const char *what)
+{
+  int taps = methods[method].taps;
+  fluid_phase_t phase = ref->phase;
+  fluid_real_t *coeffs;
+  fluid_real_t scalar = 0;
+  double exact = 0, magnitude = 0, allowed, error;
+  int first, k, edge = 0;
+
+  if (method == 2)
+  {
+    fluid_phase_incr (phase, (fluid_phase_t) 0x80000000);
+    coeffs = sinc_table7[fluid_phase_fract_to_tablerow (phase)];
+    first = (int) fluid_phase_index (phase) - 3;
+  }
+  else if (method == 1)
+  {
+    coeffs = interp_coeff[fluid_phase_fract_to_tablerow (phase)];
+    first = (int) fluid_phase_index (phase) - 1;
+  }
+  else
+  {
+    coeffs = interp_coeff_linear[fluid_phase_fract_to_tablerow (phase)];
+    first = (int) fluid_phase_index (phase);
+  }
+
+  /* the expression of the scalar loops, summed left to right */
+  for (k = 0; k < taps; k++)
+  {
+    short int point = reference_point (voice, ref, first + k, &edge);
+
+    scalar = k ? scalar + coeffs[k] * (fluid_real_t) point
+      : coeffs[k] * (fluid_real_t) point;
+    exact += (double) coeffs[k] * point;
+    magnitude += fabs ((double) coeffs[k] * point);
+  }
+  scalar = ref->amp * scalar;
+  exact *= ref->amp;
+  magnitude *= fabs (ref->amp);
+
+  allowed = (taps + 1) * REAL_EPSILON * magnitude;
+  error = fabs (out - exact);
+  if (error > allowed || (edge && out != scalar))
+  {
+    if (failures++ < 10)
+      fprintf (stderr, "%s, %s: %.17g, expected %.17g (scalar %.17g)%s\n",
+               methods[method].name, what, (double) out, exact,
+               (double) scalar, edge ? " at an edge" : "");
+  }
+  if (allowed > 0 && error / allowed > worst_error)
+    worst_error = error / allowed;
+  snr_signal += exact * exact;
+  snr_noise += error * error;
+}
+
+/* Renders a voice block by block, checking each block against the reference */
+static void
+check_voice (int method, double pitch, int play)
+{
+  fluid_real_t buf[FLUID_BUFSIZE];
+  fluid_rvoice_dsp_t voice;
+  reference_t ref;
+  fluid_phase_t incr, left;
+  char what[64];
+  int block, i, count;
+
+  FLUID_MEMSET (&voice, 0, sizeof (voice));
+  voice.sample = &sample;
+  voice.start = 0;
+  voice.end = SAMPLE_LEN - 1;
+  voice.loopstart = LOOP_START;
+  voice.loopend = LOOP_END;
+  voice.is_looping = play != PLAY_UNLOOPED;
+  voice.dsp_buf = buf;
+  voice.amp = 1.0 / 32768;
+  voice.amp_incr = 1e-10;
+  voice.phase_incr = pitch;
+  fluid_phase_set_int (voice.phase, voice.start);
+
+  FLUID_MEMSET (&ref, 0, sizeof (ref));
+  ref.phase = voice.phase;
+  ref.amp = voice.amp;
+  fluid_phase_set_float (incr, voice.phase_incr);
+
+  snprintf (what, sizeof (what), "pitch %g, %s", pitch,
+            play == PLAY_UNLOOPED ? "unlooped" : play == PLAY_LOOPED ? "looped" : "released");
+
+  for (block = 0; !ref.done; block++)
+  {
+    if (play == PLAY_RELEASED && block == LOOP_BLOCKS)
+      voice.is_looping = 0;
+    else if (play == PLAY_LOOPED && block == LOOP_BLOCKS)
+      break;
+
+    count = methods[method].interpolate (&voice);
+
+    for (i = 0; i < FLUID_BUFSIZE && !ref.done; i++)
+    {
+      fluid_phase_t tap = ref.phase;
+      unsigned int index;
+
+      if (method == 2)
+        fluid_phase_incr (tap, (fluid_phase_t) 0x80000000);
+      index = fluid_phase_index (tap);
+      if (!voice.is_looping && index > (unsigned int) voice.end)
+      {
+        ref.done = 1;
+        break;
+      }
+      if (i >= count)
+      {
+        if (failures++ < 10)
+          fprintf (stderr, "%s, %s: %d samples in block %d, expected more\n",
+                   methods[method].name, what, count, block);
+        return;
+      }
+      check_output (method, &voice, &ref, buf[i], what);
+
+      fluid_phase_incr (ref.phase, incr);
+      ref.amp += voice.amp_incr;
+      tap = ref.phase;
+      if (method == 2)
+        fluid_phase_incr (tap, (fluid_phase_t) 0x80000000);
+      if (voice.is_looping && fluid_phase_index (tap) >= (unsigned int) voice.loopend)
+      {
+        fluid_phase_sub_int (ref.phase, voice.loopend - voice.loopstart);
+        ref.has_looped = 1;
+      }
+    }
+
+    /* a block that fills up just past the loop end leaves the jump back
+     * to the loop start to the next one */
+    left = voice.phase;
+    if (voice.is_looping && left != ref.phase)
+      fluid_phase_sub_int (left, voice.loopend - voice.loopstart);
+
+    if ((ref.done && count != i) || (!ref.done && count != FLUID_BUFSIZE)
+        || voice.amp != ref.amp || voice.has_looped != ref.has_looped
+        || (!ref.done && left != ref.phase))
+    {
+      if (failures++ < 10)
+        fprintf (stderr, "%s, %s: block %d left count %d, phase %.9f, amp %.17g, "
+                 "looped %d; expected %d, %.9f, %.17g, %d\n",
+                 methods[method].name, what, block, count,
+                 fluid_phase_double (voice.phase), (double) voice.amp,
+                 voice.has_looped, ref.done ? i : FLUID_BUFSIZE,
+                 fluid_phase_double (ref.phase), (double) ref.amp, ref.has_looped);
+      return;
+    }
+  }
+}
+
+static double
+now (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ns per output sample, best of 5, playing the whole sample as a loop */
+static double
+time_method (int method, double pitch)
+{
+  fluid_real_t buf[FLUID_BUFSIZE];
+  fluid_rvoice_dsp_t voice;
+  double best = 0;
+  int run, block;
+
+  FLUID_MEMSET (&voice, 0, sizeof (voice));
+  voice.sample = &sample;
+  voice.end = SAMPLE_LEN - 1;
+  voice.loopstart = 0;
+  voice.loopend = SAMPLE_LEN - 1;
+  voice.is_looping = 1;
+  voice.dsp_buf = buf;
+  voice.amp = 1.0 / 32768;
+  voice.phase_incr = pitch;
+
+  for (run = 0; run < 5; run++)
+  {
+    double start = now (), elapsed;
+
+    for (block = 0; block < 20000; block++)
+      methods[method].interpolate (&voice);
+    elapsed = now () - start;
+    if (run == 0 || elapsed < best)
+      best = elapsed;
+  }
+  return best * 1e9 / (20000.0 * FLUID_BUFSIZE);
+}
+
+int
+main (void)
+{
+  int method, p, play;
+
+  fluid_rvoice_dsp_config ();
+  generate_sample ();
+
+#ifdef FLUID_SIMD
+  printf ("vector interpolation");
+#else
+  printf ("scalar interpolation");
+#endif
+  printf (" with %s\n", sizeof (fluid_real_t) == sizeof (float) ? "floats" : "doubles");
+
+  for (method = 0; method < METHOD_COUNT; method++)
+  {
+    worst_error = 0;
+    snr_signal = snr_noise = 0;
+    for (p = 0; p < PITCH_COUNT; p++)
+    {
+      for (play = PLAY_UNLOOPED; play <= PLAY_RELEASED; play++)
+        check_voice (method, pitches[p], play);
+    }
+    printf ("%-10s error at most %.2f of the bound, %.1f dB below the signal\n",
+            methods[method].name, worst_error,
+            snr_noise > 0 ? 10 * log10 (snr_signal / snr_noise) : INFINITY);
+  }
+  if (failures)
+  {
+    printf ("%d FAILED\n", failures);
+    return 1;
+  }
+
+  for (method = 0; method < METHOD_COUNT; method++)
+    printf ("%-10s %.2f ns per sample at pitch 1.0, %.2f at 1.3348\n",
+            methods[method].name, time_method (method, 1.0),
+            time_method (method, 1.3348));
+  return 0;
+}
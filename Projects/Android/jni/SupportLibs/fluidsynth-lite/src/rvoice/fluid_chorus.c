@@ -131,6 +131,11 @@ struct _fluid_chorus_t {
 
   /* sinc lookup table */
   fluid_real_t sinc_table[INTERPOLATION_SAMPLES][INTERPOLATION_SUBSAMPLES];
+#ifdef FLUID_SIMD
+  /* The same coefficients, one row per subsample, lined up with the oldest
+   * sample first and padded to 8 with zeros */
+  fluid_real_t sinc_rows[INTERPOLATION_SUBSAMPLES][8];
+#endif
 };
 
 static void fluid_chorus_triangle(int *buf, int len, int depth);
@@ -173,6 +178,9 @@ new_fluid_chorus(fluid_real_t sample_rate)
 	/* Hamming window */
 	chorus->sinc_table[i][ii] *= (fluid_real_t)0.5 * (1.0 + cos(2.0 * M_PI * i_shifted / (fluid_real_t)INTERPOLATION_SAMPLES));
       };
+#ifdef FLUID_SIMD
+      chorus->sinc_rows[ii][INTERPOLATION_SAMPLES - 1 - i] = chorus->sinc_table[i][ii];
+#endif
     };
   };
 
@@ -183,9 +191,10 @@ new_fluid_chorus(fluid_real_t sample_rate)
     goto error_recovery;
   }
 
-  /* allocate sample buffer */
+  /* allocate sample buffer, every sample is stored twice so the
+   * interpolation never has to wrap around (see fluid_chorus_process_block) */
 
-  chorus->chorusbuf = FLUID_ARRAY(fluid_real_t, MAX_SAMPLES);
+  chorus->chorusbuf = FLUID_ARRAY(fluid_real_t, 2 * MAX_SAMPLES);
   if (chorus->chorusbuf == NULL) {
     fluid_log(FLUID_PANIC, "chorus: Out of memory");
     goto error_recovery;
@@ -225,7 +234,7 @@ fluid_chorus_init(fluid_chorus_t* chorus)
 {
   int i;
 
-  for (i = 0; i < MAX_SAMPLES; i++) {
+  for (i = 0; i < 2 * MAX_SAMPLES; i++) {
     chorus->chorusbuf[i] = 0.0;
   }
 
@@ -339,36 +348,45 @@ fluid_chorus_set(fluid_chorus_t* chorus, int set, int nr, float level,
 }
 
 
-void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
-			    fluid_real_t *left_out, fluid_real_t *right_out)
+/* Calculate the chorus sum d_out for a whole block.
+ *
+ * Sample n of the circular buffer is also stored at n + MAX_SAMPLES, so the
+ * INTERPOLATION_SAMPLES samples of the delay line are always in one piece.
+ * With FLUID_SIMD they are then interpolated with two 4 wide products.
+ */
+static void
+fluid_chorus_process_block(fluid_chorus_t* chorus, fluid_real_t *in,
+                           fluid_real_t *out)
 {
+  fluid_real_t* chorusbuf = chorus->chorusbuf;
+  int counter = chorus->counter;
   int sample_index;
   int i;
-  fluid_real_t d_in, d_out;
+  fluid_real_t sample, d_out;
 
   for (sample_index = 0; sample_index < FLUID_BUFSIZE; sample_index++) {
-
-    d_in = in[sample_index];
-    d_out = 0.0f;
-
-# if 0
-    /* Debug: Listen to the chorus signal only */
-    left_out[sample_index]=0;
-    right_out[sample_index]=0;
+#ifdef FLUID_SIMD
+    fluid_real4_t sum = { 0, 0, 0, 0 };
+    fluid_real4_t samples, coeffs;
 #endif
 
-    /* Write the current sample into the circular buffer */
-    chorus->chorusbuf[chorus->counter] = d_in;
+    /* Write the current sample into the circular buffer. A decaying voice
+     * can send denormals, which would stay in the buffer and slow down
+     * every tap that reads them. */
+    sample = in[sample_index];
+    if (fabs (sample) < 1e-20) sample = 0.0f;
+    chorusbuf[counter] = sample;
+    chorusbuf[counter + MAX_SAMPLES] = sample;
+    d_out = 0.0f;
 
     for (i = 0; i < chorus->number_blocks; i++) {
-      int ii;
       /* Calculate the delay in subsamples for the delay line of chorus block nr. */
 
       /* The value in the lookup table is so, that this expression
        * will always be positive.  It will always include a number of
        * full periods of MAX_SAMPLES*INTERPOLATION_SUBSAMPLES to
        * remain positive at all times. */
-      int pos_subsamples = (INTERPOLATION_SUBSAMPLES * chorus->counter
+      int pos_subsamples = (INTERPOLATION_SUBSAMPLES * counter
 			    - chorus->lookup_tab[chorus->phase[i]]);
 
       int pos_samples = pos_subsamples/INTERPOLATION_SUBSAMPLES;
@@ -376,102 +394,82 @@ void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
       /* modulo divide by INTERPOLATION_SUBSAMPLES */
       pos_subsamples &= INTERPOLATION_SUBSAMPLES_ANDMASK;
 
-      for (ii = 0; ii < INTERPOLATION_SAMPLES; ii++){
-	/* Add the delayed signal to the chorus sum d_out Note: The
-	 * delay in the delay line moves backwards for increasing
-	 * delay!*/
-
-	/* The & in chorusbuf[...] is equivalent to a division modulo
-	   MAX_SAMPLES, only faster. */
-	d_out += chorus->chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
-	  * chorus->sinc_table[ii][pos_subsamples];
+      /* Add the delayed signal to the chorus sum d_out Note: The
+       * delay in the delay line moves backwards for increasing
+       * delay! The & is equivalent to a division modulo MAX_SAMPLES,
+       * only faster. */
+#ifdef FLUID_SIMD
+      {
+	fluid_real_t* src = &chorusbuf[(pos_samples - (INTERPOLATION_SAMPLES - 1))
+				       & MAX_SAMPLES_ANDMASK];
+	fluid_real_t* row = chorus->sinc_rows[pos_subsamples];
+
+	FLUID_MEMCPY(&samples, src, sizeof(samples));
+	FLUID_MEMCPY(&coeffs, row, sizeof(coeffs));
+	sum += samples * coeffs;
+	FLUID_MEMCPY(&samples, src + 4, sizeof(samples));
+	FLUID_MEMCPY(&coeffs, row + 4, sizeof(coeffs));
+	sum += samples * coeffs;
+      }
+#else
+      {
+	int ii;
+
+	for (ii = 0; ii < INTERPOLATION_SAMPLES; ii++) {
+	  d_out += chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
+	    * chorus->sinc_table[ii][pos_subsamples];
+	  pos_samples--;
+	}
+      }
+#endif
 
-	pos_samples--;
-      };
       /* Cycle the phase of the modulating LFO */
-      chorus->phase[i]++;
-      chorus->phase[i] %= (chorus->modulation_period_samples);
+      if (++chorus->phase[i] >= chorus->modulation_period_samples) {
+	chorus->phase[i] = 0;
+      }
     } /* foreach chorus block */
 
-    d_out *= chorus->level;
-
-    /* Add the chorus sum d_out to output */
-    left_out[sample_index] += d_out;
-    right_out[sample_index] += d_out;
+#ifdef FLUID_SIMD
+    d_out = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+#endif
+    out[sample_index] = d_out * chorus->level;
 
     /* Move forward in circular buffer */
-    chorus->counter++;
-    chorus->counter %= MAX_SAMPLES;
+    counter = (counter + 1) & MAX_SAMPLES_ANDMASK;
 
   } /* foreach sample */
+
+  chorus->counter = counter;
 }
 
-/* Duplication of code ... (replaces sample data instead of mixing) */
-void fluid_chorus_processreplace(fluid_chorus_t* chorus, fluid_real_t *in,
-				fluid_real_t *left_out, fluid_real_t *right_out)
+void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
+			    fluid_real_t *left_out, fluid_real_t *right_out)
 {
+  fluid_real_t d_out[FLUID_BUFSIZE];
   int sample_index;
-  int i;
-  fluid_real_t d_in, d_out;
-
-  for (sample_index = 0; sample_index < FLUID_BUFSIZE; sample_index++) {
-
-    d_in = in[sample_index];
-    d_out = 0.0f;
-
-# if 0
-    /* Debug: Listen to the chorus signal only */
-    left_out[sample_index]=0;
-    right_out[sample_index]=0;
-#endif
-
-    /* Write the current sample into the circular buffer */
-    chorus->chorusbuf[chorus->counter] = d_in;
 
-    for (i = 0; i < chorus->number_blocks; i++) {
-      int ii;
-      /* Calculate the delay in subsamples for the delay line of chorus block nr. */
-
-      /* The value in the lookup table is so, that this expression
-       * will always be positive.  It will always include a number of
-       * full periods of MAX_SAMPLES*INTERPOLATION_SUBSAMPLES to
-       * remain positive at all times. */
-      int pos_subsamples = (INTERPOLATION_SUBSAMPLES * chorus->counter
-			    - chorus->lookup_tab[chorus->phase[i]]);
+  fluid_chorus_process_block(chorus, in, d_out);
 
-      int pos_samples = pos_subsamples / INTERPOLATION_SUBSAMPLES;
-
-      /* modulo divide by INTERPOLATION_SUBSAMPLES */
-      pos_subsamples &= INTERPOLATION_SUBSAMPLES_ANDMASK;
-
-      for (ii = 0; ii < INTERPOLATION_SAMPLES; ii++){
-	/* Add the delayed signal to the chorus sum d_out Note: The
-	 * delay in the delay line moves backwards for increasing
-	 * delay!*/
-
-	/* The & in chorusbuf[...] is equivalent to a division modulo
-	   MAX_SAMPLES, only faster. */
-	d_out += chorus->chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
-	  * chorus->sinc_table[ii][pos_subsamples];
-
-	pos_samples--;
-      };
-      /* Cycle the phase of the modulating LFO */
-      chorus->phase[i]++;
-      chorus->phase[i] %= (chorus->modulation_period_samples);
-    } /* foreach chorus block */
-
-    d_out *= chorus->level;
+  /* Add the chorus sum d_out to output */
+  for (sample_index = 0; sample_index < FLUID_BUFSIZE; sample_index++) {
+    left_out[sample_index] += d_out[sample_index];
+    right_out[sample_index] += d_out[sample_index];
+  }
+}
 
-    /* Store the chorus sum d_out to output */
-    left_out[sample_index] = d_out;
-    right_out[sample_index] = d_out;
+void fluid_chorus_processreplace(fluid_chorus_t* chorus, fluid_real_t *in,
+				fluid_real_t *left_out, fluid_real_t *right_out)
+{
+  fluid_real_t d_out[FLUID_BUFSIZE];
+  int sample_index;
 
-    /* Move forward in circular buffer */
-    chorus->counter++;
-    chorus->counter %= MAX_SAMPLES;
+  fluid_chorus_process_block(chorus, in, d_out);
 
-  } /* foreach sample */
+  /* Store the chorus sum d_out to output */
+  for (sample_index = 0; sample_index < FLUID_BUFSIZE; sample_index++) {
+    left_out[sample_index] = d_out[sample_index];
+    right_out[sample_index] = d_out[sample_index];
+  }
 }
 
 /* Purpose:
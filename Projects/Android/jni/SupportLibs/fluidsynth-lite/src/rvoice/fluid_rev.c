@@ -112,17 +112,37 @@ fluid_allpass_getfeedback(fluid_allpass* allpass)
   return allpass->feedback;
 }
 
-#define fluid_allpass_process(_allpass, _input) \
-{ \
-  fluid_real_t output; \
-  fluid_real_t bufout; \
-  bufout = _allpass.buffer[_allpass.bufidx]; \
-  output = bufout-_input; \
-  _allpass.buffer[_allpass.bufidx] = _input + (bufout * _allpass.feedback); \
-  if (++_allpass.bufidx >= _allpass.bufsize) { \
-    _allpass.bufidx = 0; \
-  } \
-  _input = output; \
+/* Run a whole block through the allpass, in place. The block is cut where
+ * the delay line wraps around. In between, every sample only touches its own
+ * slot of the delay line, so the loop vectorizes. This also holds for delay
+ * lines shorter than a block, as with very low sample rates. */
+static void
+fluid_allpass_process_block(fluid_allpass* allpass, fluid_real_t* io)
+{
+  fluid_real_t feedback = allpass->feedback;
+  fluid_real_t* buf;
+  fluid_real_t bufout, input;
+  int idx = allpass->bufidx;
+  int i, k, n;
+
+  for (k = 0; k < FLUID_BUFSIZE; k += n) {
+    n = allpass->bufsize - idx;
+    if (n > FLUID_BUFSIZE - k) {
+      n = FLUID_BUFSIZE - k;
+    }
+    buf = allpass->buffer + idx;
+    for (i = 0; i < n; i++) {
+      bufout = buf[i];
+      input = io[k + i];
+      io[k + i] = bufout - input;
+      buf[i] = input + (bufout * feedback);
+    }
+    idx += n;
+    if (idx >= allpass->bufsize) {
+      idx = 0;
+    }
+  }
+  allpass->bufidx = idx;
 }
 
 /*  fluid_real_t fluid_allpass_process(fluid_allpass* allpass, fluid_real_t input) */
@@ -208,16 +228,113 @@ fluid_comb_getfeedback(fluid_comb* comb)
   return comb->feedback;
 }
 
-#define fluid_comb_process(_comb, _input, _output) \
-{ \
-  fluid_real_t _tmp = _comb.buffer[_comb.bufidx]; \
-  _comb.filterstore = (_tmp * _comb.damp2) + (_comb.filterstore * _comb.damp1); \
-  _comb.buffer[_comb.bufidx] = _input + (_comb.filterstore * _comb.feedback); \
-  if (++_comb.bufidx >= _comb.bufsize) { \
-    _comb.bufidx = 0; \
-  } \
-  _output += _tmp; \
+/* Run a whole block through 4 combs at once and add their outputs to 'out'.
+ * With FLUID_SIMD every comb gets a vector lane. Like the allpass, the block
+ * is cut wherever one of the delay lines wraps around. The outputs are summed
+ * up in the same order as one comb at a time would, so the result doesn't
+ * change. */
+#ifdef FLUID_SIMD
+static void
+fluid_comb_process_block4(fluid_comb* comb, const fluid_real_t* in, fluid_real_t* out)
+{
+  fluid_real4_t filterstore = { comb[0].filterstore, comb[1].filterstore,
+                                comb[2].filterstore, comb[3].filterstore };
+  fluid_real4_t damp1 = { comb[0].damp1, comb[1].damp1, comb[2].damp1, comb[3].damp1 };
+  fluid_real4_t damp2 = { comb[0].damp2, comb[1].damp2, comb[2].damp2, comb[3].damp2 };
+  fluid_real4_t feedback = { comb[0].feedback, comb[1].feedback,
+                             comb[2].feedback, comb[3].feedback };
+  fluid_real4_t tmp, store;
+  fluid_real_t *buf0, *buf1, *buf2, *buf3;
+  fluid_real_t sum;
+  int i, c, k, n;
+
+  for (k = 0; k < FLUID_BUFSIZE; k += n) {
+    n = FLUID_BUFSIZE - k;
+    for (c = 0; c < 4; c++) {
+      if (n > comb[c].bufsize - comb[c].bufidx) {
+        n = comb[c].bufsize - comb[c].bufidx;
+      }
+    }
+    buf0 = comb[0].buffer + comb[0].bufidx;
+    buf1 = comb[1].buffer + comb[1].bufidx;
+    buf2 = comb[2].buffer + comb[2].bufidx;
+    buf3 = comb[3].buffer + comb[3].bufidx;
+
+    for (i = 0; i < n; i++) {
+      tmp = (fluid_real4_t) { buf0[i], buf1[i], buf2[i], buf3[i] };
+      filterstore = (tmp * damp2) + (filterstore * damp1);
+      store = in[k + i] + (filterstore * feedback);
+      buf0[i] = store[0];
+      buf1[i] = store[1];
+      buf2[i] = store[2];
+      buf3[i] = store[3];
+
+      sum = out[k + i];
+      sum += tmp[0];
+      sum += tmp[1];
+      sum += tmp[2];
+      sum += tmp[3];
+      out[k + i] = sum;
+    }
+
+    for (c = 0; c < 4; c++) {
+      comb[c].bufidx += n;
+      if (comb[c].bufidx >= comb[c].bufsize) {
+        comb[c].bufidx = 0;
+      }
+    }
+  }
+
+  for (c = 0; c < 4; c++) {
+    comb[c].filterstore = filterstore[c];
+  }
 }
+#else
+static void
+fluid_comb_process_block4(fluid_comb* comb, const fluid_real_t* in, fluid_real_t* out)
+{
+  fluid_real_t filterstore[4], tmp[4];
+  fluid_real_t* buf[4];
+  fluid_real_t sum;
+  int i, c, k, n;
+
+  for (c = 0; c < 4; c++) {
+    filterstore[c] = comb[c].filterstore;
+  }
+
+  for (k = 0; k < FLUID_BUFSIZE; k += n) {
+    n = FLUID_BUFSIZE - k;
+    for (c = 0; c < 4; c++) {
+      if (n > comb[c].bufsize - comb[c].bufidx) {
+        n = comb[c].bufsize - comb[c].bufidx;
+      }
+      buf[c] = comb[c].buffer + comb[c].bufidx;
+    }
+
+    for (i = 0; i < n; i++) {
+      sum = out[k + i];
+      for (c = 0; c < 4; c++) {
+        tmp[c] = buf[c][i];
+        filterstore[c] = (tmp[c] * comb[c].damp2) + (filterstore[c] * comb[c].damp1);
+        buf[c][i] = in[k + i] + (filterstore[c] * comb[c].feedback);
+        sum += tmp[c];
+      }
+      out[k + i] = sum;
+    }
+
+    for (c = 0; c < 4; c++) {
+      comb[c].bufidx += n;
+      if (comb[c].bufidx >= comb[c].bufsize) {
+        comb[c].bufidx = 0;
+      }
+    }
+  }
+
+  for (c = 0; c < 4; c++) {
+    comb[c].filterstore = filterstore[c];
+  }
+}
+#endif
 
 /* fluid_real_t fluid_comb_process(fluid_comb* comb, fluid_real_t input) */
 /* { */
@@ -401,41 +518,58 @@ fluid_revmodel_reset(fluid_revmodel_t* rev)
   fluid_revmodel_init(rev);
 }
 
-void
-fluid_revmodel_processreplace(fluid_revmodel_t* rev, fluid_real_t *in,
-			     fluid_real_t *left_out, fluid_real_t *right_out)
+/* Run a block through the comb and allpass filters. The filters are
+ * independent of each other (combs) or only see the output of the previous
+ * one (allpasses), so they can take the whole block one after the other,
+ * rather than every sample going through all of them. The signal is offset
+ * by DC_OFFSET, see above. */
+static void
+fluid_revmodel_process_block(fluid_revmodel_t* rev, fluid_real_t *in,
+                             fluid_real_t *outL, fluid_real_t *outR)
 {
-  int i, k = 0;
-  fluid_real_t outL, outR, input;
+  fluid_real_t input[FLUID_BUFSIZE];
+  int i, k;
 
   for (k = 0; k < FLUID_BUFSIZE; k++) {
-
-    outL = outR = 0;
-
     /* The original Freeverb code expects a stereo signal and 'input'
      * is set to the sum of the left and right input sample. Since
      * this code works on a mono signal, 'input' is set to twice the
      * input sample. */
-    input = (2.0f * in[k] + DC_OFFSET) * rev->gain;
+    input[k] = (2.0f * in[k] + DC_OFFSET) * rev->gain;
+    outL[k] = outR[k] = 0;
+  }
 
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-      fluid_comb_process(rev->combL[i], input, outL);
-      fluid_comb_process(rev->combR[i], input, outR);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      fluid_allpass_process(rev->allpassL[i], outL);
-      fluid_allpass_process(rev->allpassR[i], outR);
-    }
+  /* Accumulate comb filters in parallel */
+  for (i = 0; i < numcombs; i += 4) {
+    fluid_comb_process_block4(&rev->combL[i], input, outL);
+    fluid_comb_process_block4(&rev->combR[i], input, outR);
+  }
+
+  /* Feed through allpasses in series */
+  for (i = 0; i < numallpasses; i++) {
+    fluid_allpass_process_block(&rev->allpassL[i], outL);
+    fluid_allpass_process_block(&rev->allpassR[i], outR);
+  }
+}
 
+void
+fluid_revmodel_processreplace(fluid_revmodel_t* rev, fluid_real_t *in,
+			     fluid_real_t *left_out, fluid_real_t *right_out)
+{
+  fluid_real_t outL[FLUID_BUFSIZE], outR[FLUID_BUFSIZE];
+  fluid_real_t l, r;
+  int k;
+
+  fluid_revmodel_process_block(rev, in, outL, outR);
+
+  for (k = 0; k < FLUID_BUFSIZE; k++) {
     /* Remove the DC offset */
-    outL -= DC_OFFSET;
-    outR -= DC_OFFSET;
+    l = outL[k] - DC_OFFSET;
+    r = outR[k] - DC_OFFSET;
 
     /* Calculate output REPLACING anything already there */
-    left_out[k] = outL * rev->wet1 + outR * rev->wet2;
-    right_out[k] = outR * rev->wet1 + outL * rev->wet2;
+    left_out[k] = l * rev->wet1 + r * rev->wet2;
+    right_out[k] = r * rev->wet1 + l * rev->wet2;
   }
 }
 
@@ -443,37 +577,20 @@ void
 fluid_revmodel_processmix(fluid_revmodel_t* rev, fluid_real_t *in,
 			 fluid_real_t *left_out, fluid_real_t *right_out)
 {
-  int i, k = 0;
-  fluid_real_t outL, outR, input;
+  fluid_real_t outL[FLUID_BUFSIZE], outR[FLUID_BUFSIZE];
+  fluid_real_t l, r;
+  int k;
 
-  for (k = 0; k < FLUID_BUFSIZE; k++) {
-
-    outL = outR = 0;
-
-    /* The original Freeverb code expects a stereo signal and 'input'
-     * is set to the sum of the left and right input sample. Since
-     * this code works on a mono signal, 'input' is set to twice the
-     * input sample. */
-    input = (2.0f * in[k] + DC_OFFSET) * rev->gain;
-
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-	    fluid_comb_process(rev->combL[i], input, outL);
-	    fluid_comb_process(rev->combR[i], input, outR);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      fluid_allpass_process(rev->allpassL[i], outL);
-      fluid_allpass_process(rev->allpassR[i], outR);
-    }
+  fluid_revmodel_process_block(rev, in, outL, outR);
 
+  for (k = 0; k < FLUID_BUFSIZE; k++) {
     /* Remove the DC offset */
-    outL -= DC_OFFSET;
-    outR -= DC_OFFSET;
+    l = outL[k] - DC_OFFSET;
+    r = outR[k] - DC_OFFSET;
 
     /* Calculate output MIXING with anything already there */
-    left_out[k] += outL * rev->wet1 + outR * rev->wet2;
-    right_out[k] += outR * rev->wet1 + outL * rev->wet2;
+    left_out[k] += l * rev->wet1 + r * rev->wet2;
+    right_out[k] += r * rev->wet1 + l * rev->wet2;
   }
 }
 
@@ -60,6 +60,85 @@ static fluid_real_t sinc_table7[FLUID_INTERP_MAX][7];
 #define SINC_INTERP_ORDER 7	/* 7th order constant */
 
 
+/* Vectorized 4th and 7th order interpolation, see FLUID_SIMD. In the middle
+ * of the sample 4 output samples are made at a time: the products of each
+ * output's coefficients and points are formed as vectors, and fluid_dsp_sum4
+ * transposes and adds them so that the 4 outputs come out in one vector,
+ * summed in the same order as fluid_dsp_sum. The rest of a buffer applies
+ * the coefficients of one output at a time. The start, end and loop points
+ * are still interpolated by the scalar loops. Linear interpolation stays
+ * scalar, gathering its 2 points per output into vectors costs more than
+ * it saves. */
+#ifdef FLUID_SIMD
+typedef short int fluid_short4_t __attribute__((vector_size(4 * sizeof(short int))));
+typedef int fluid_int4_t __attribute__((vector_size(4 * sizeof(int))));
+
+/* Last 3 coefficients of sinc_table7, lined up with dsp_data[dsp_phase_index] */
+static fluid_real_t sinc_table7_hi[FLUID_INTERP_MAX][4];
+
+static FLUID_INLINE fluid_real4_t
+fluid_dsp_load_points (const short int *data)
+{
+  fluid_short4_t v;
+  FLUID_MEMCPY (&v, data, sizeof (v));
+  return __builtin_convertvector (__builtin_convertvector (v, fluid_int4_t), fluid_real4_t);
+}
+
+static FLUID_INLINE fluid_real4_t
+fluid_dsp_load_coeffs (const fluid_real_t *coeffs)
+{
+  fluid_real4_t v;
+  FLUID_MEMCPY (&v, coeffs, sizeof (v));
+  return v;
+}
+
+static FLUID_INLINE fluid_real_t
+fluid_dsp_sum (fluid_real4_t v)
+{
+  return (v[0] + v[1]) + (v[2] + v[3]);
+}
+
+/* { fluid_dsp_sum (a), fluid_dsp_sum (b), fluid_dsp_sum (c), fluid_dsp_sum (d) } */
+static FLUID_INLINE fluid_real4_t
+fluid_dsp_sum4 (fluid_real4_t a, fluid_real4_t b, fluid_real4_t c, fluid_real4_t d)
+{
+  fluid_real4_t ab = __builtin_shufflevector (a, b, 0, 4, 2, 6)
+    + __builtin_shufflevector (a, b, 1, 5, 3, 7);
+  fluid_real4_t cd = __builtin_shufflevector (c, d, 0, 4, 2, 6)
+    + __builtin_shufflevector (c, d, 1, 5, 3, 7);
+
+  return __builtin_shufflevector (ab, cd, 0, 1, 4, 5)
+    + __builtin_shufflevector (ab, cd, 2, 3, 6, 7);
+}
+
+/* Coefficients times points of one 4th order output sample */
+static FLUID_INLINE fluid_real4_t
+fluid_dsp_products_4th (const short int *data, fluid_phase_t phase)
+{
+  return fluid_dsp_load_coeffs (interp_coeff[fluid_phase_fract_to_tablerow (phase)])
+    * fluid_dsp_load_points (&data[fluid_phase_index (phase) - 1]);
+}
+
+/* Coefficients times points of one 7th order output sample, 4 and 3 of
+ * them added pairwise */
+static FLUID_INLINE fluid_real4_t
+fluid_dsp_products_7th (const short int *data, fluid_phase_t phase)
+{
+  unsigned int row = fluid_phase_fract_to_tablerow (phase);
+  unsigned int index = fluid_phase_index (phase);
+
+  return fluid_dsp_load_coeffs (sinc_table7[row]) * fluid_dsp_load_points (&data[index - 3])
+    + fluid_dsp_load_coeffs (sinc_table7_hi[row]) * fluid_dsp_load_points (&data[index]);
+}
+
+static FLUID_INLINE void
+fluid_dsp_store4 (fluid_real_t *buf, fluid_real4_t v)
+{
+  FLUID_MEMCPY (buf, &v, sizeof (v));
+}
+#endif
+
+
 /* Initializes interpolation tables */
 void fluid_rvoice_dsp_config (void)
 {
@@ -107,6 +186,16 @@ void fluid_rvoice_dsp_config (void)
     }
   }
 
+#ifdef FLUID_SIMD
+  for (i = 0; i < FLUID_INTERP_MAX; i++)
+  {
+    sinc_table7_hi[i][0] = 0;
+    sinc_table7_hi[i][1] = sinc_table7[i][4];
+    sinc_table7_hi[i][2] = sinc_table7[i][5];
+    sinc_table7_hi[i][3] = sinc_table7[i][6];
+  }
+#endif
+
 #if 0
   for (i = 0; i < FLUID_INTERP_MAX; i++)
   {
@@ -339,14 +428,46 @@ fluid_rvoice_dsp_interpolate_4th_order (fluid_rvoice_dsp_t *voice)
       dsp_amp += dsp_amp_incr;
     }
 
+#ifdef FLUID_SIMD
+    /* interpolate 4 sample points at a time while the last of them is in
+     * the middle of the sample */
+    for ( ; dsp_i + 4 <= FLUID_BUFSIZE
+	    && fluid_phase_index (dsp_phase + 3 * dsp_phase_incr) <= end_index; dsp_i += 4)
+    {
+      fluid_phase_t phase1 = dsp_phase + dsp_phase_incr;
+      fluid_phase_t phase2 = phase1 + dsp_phase_incr;
+      fluid_phase_t phase3 = phase2 + dsp_phase_incr;
+      /* stepped one sample at a time, as in the scalar loops */
+      fluid_real_t amp1 = dsp_amp + dsp_amp_incr;
+      fluid_real_t amp2 = amp1 + dsp_amp_incr;
+      fluid_real_t amp3 = amp2 + dsp_amp_incr;
+      fluid_real4_t amps = { dsp_amp, amp1, amp2, amp3 };
+
+      fluid_dsp_store4 (&dsp_buf[dsp_i], amps
+			* fluid_dsp_sum4 (fluid_dsp_products_4th (dsp_data, dsp_phase),
+					  fluid_dsp_products_4th (dsp_data, phase1),
+					  fluid_dsp_products_4th (dsp_data, phase2),
+					  fluid_dsp_products_4th (dsp_data, phase3)));
+
+      /* increment phase and amplitude */
+      dsp_phase = phase3 + dsp_phase_incr;
+      dsp_amp = amp3 + dsp_amp_incr;
+    }
+    dsp_phase_index = fluid_phase_index (dsp_phase);
+#endif
+
     /* interpolate the sequence of sample points */
     for ( ; dsp_i < FLUID_BUFSIZE && dsp_phase_index <= end_index; dsp_i++)
     {
+#ifdef FLUID_SIMD
+      dsp_buf[dsp_i] = dsp_amp * fluid_dsp_sum (fluid_dsp_products_4th (dsp_data, dsp_phase));
+#else
       coeffs = interp_coeff[fluid_phase_fract_to_tablerow (dsp_phase)];
       dsp_buf[dsp_i] = dsp_amp * (coeffs[0] * dsp_data[dsp_phase_index-1]
 				  + coeffs[1] * dsp_data[dsp_phase_index]
 				  + coeffs[2] * dsp_data[dsp_phase_index+1]
 				  + coeffs[3] * dsp_data[dsp_phase_index+2]);
+#endif
 
       /* increment phase and amplitude */
       fluid_phase_incr (dsp_phase, dsp_phase_incr);
@@ -552,9 +673,40 @@ fluid_rvoice_dsp_interpolate_7th_order (fluid_rvoice_dsp_t *voice)
     start_index -= 2;	/* set back to original start index */
 
 
+#ifdef FLUID_SIMD
+    /* interpolate 4 sample points at a time while the last of them is in
+     * the middle of the sample */
+    for ( ; dsp_i + 4 <= FLUID_BUFSIZE
+	    && fluid_phase_index (dsp_phase + 3 * dsp_phase_incr) <= end_index; dsp_i += 4)
+    {
+      fluid_phase_t phase1 = dsp_phase + dsp_phase_incr;
+      fluid_phase_t phase2 = phase1 + dsp_phase_incr;
+      fluid_phase_t phase3 = phase2 + dsp_phase_incr;
+      /* stepped one sample at a time, as in the scalar loops */
+      fluid_real_t amp1 = dsp_amp + dsp_amp_incr;
+      fluid_real_t amp2 = amp1 + dsp_amp_incr;
+      fluid_real_t amp3 = amp2 + dsp_amp_incr;
+      fluid_real4_t amps = { dsp_amp, amp1, amp2, amp3 };
+
+      fluid_dsp_store4 (&dsp_buf[dsp_i], amps
+			* fluid_dsp_sum4 (fluid_dsp_products_7th (dsp_data, dsp_phase),
+					  fluid_dsp_products_7th (dsp_data, phase1),
+					  fluid_dsp_products_7th (dsp_data, phase2),
+					  fluid_dsp_products_7th (dsp_data, phase3)));
+
+      /* increment phase and amplitude */
+      dsp_phase = phase3 + dsp_phase_incr;
+      dsp_amp = amp3 + dsp_amp_incr;
+    }
+    dsp_phase_index = fluid_phase_index (dsp_phase);
+#endif
+
     /* interpolate the sequence of sample points */
     for ( ; dsp_i < FLUID_BUFSIZE && dsp_phase_index <= end_index; dsp_i++)
     {
+#ifdef FLUID_SIMD
+      dsp_buf[dsp_i] = dsp_amp * fluid_dsp_sum (fluid_dsp_products_7th (dsp_data, dsp_phase));
+#else
       coeffs = sinc_table7[fluid_phase_fract_to_tablerow (dsp_phase)];
 
       dsp_buf[dsp_i] = dsp_amp
@@ -565,6 +717,7 @@ fluid_rvoice_dsp_interpolate_7th_order (fluid_rvoice_dsp_t *voice)
 	   + coeffs[4] * (fluid_real_t)dsp_data[dsp_phase_index+1]
 	   + coeffs[5] * (fluid_real_t)dsp_data[dsp_phase_index+2]
 	   + coeffs[6] * (fluid_real_t)dsp_data[dsp_phase_index+3]);
+#endif
 
       /* increment phase and amplitude */
       fluid_phase_incr (dsp_phase, dsp_phase_incr);
@@ -33,6 +33,12 @@
 // so don't activate the thread(s).
 #define VOICES_PER_THREAD 8
 
+// Voices are handed out to the threads in batches of this size
+#define VOICES_PER_BATCH 4
+
+// How many times a thread polls before it yields or goes to sleep
+#define MIXER_SPIN_COUNT 1000
+
 typedef struct _fluid_mixer_buffers_t fluid_mixer_buffers_t;
 
 struct _fluid_mixer_buffers_t {
@@ -45,6 +51,9 @@ struct _fluid_mixer_buffers_t {
   int finished_voice_count;
 
   atomic_int ready;             /**< Atomic: buffers are ready for mixing */
+#ifdef ENABLE_MIXER_THREADS
+  atomic_int batches;           /**< Atomic: deque of voice batches, (first << 16) | end */
+#endif
 
   int buf_blocks;             /**< Number of blocks allocated in the buffers */
 
@@ -87,11 +96,14 @@ struct _fluid_rvoice_mixer_t {
 //  int sleeping_threads;        /**< Atomic: number of threads currently asleep */
 //  int active_threads;          /**< Atomic: number of threads in the thread loop */
   atomic_int threads_should_terminate; /**< Atomic: Set to TRUE when threads should terminate */
-  atomic_int current_rvoice;           /**< Atomic: for the threads to know next voice to  */
+  atomic_int generation;               /**< Atomic: bumped every time the threads have work */
+  atomic_int sleeping_threads;         /**< Atomic: number of threads waiting on wakeup_threads */
+  atomic_int threads_rendered;         /**< Atomic: number of threads done rendering voices */
+  atomic_int threads_reduced;          /**< Atomic: number of threads done mixing buffers together */
+  atomic_int current_block;            /**< Atomic: next block to mix together */
+  int participants;                    /**< Read-only: number of threads rendering, including the synth thread */
   fluid_cond_t* wakeup_threads; /**< Signalled when the threads should wake up */
   fluid_cond_mutex_t* wakeup_threads_m; /**< wakeup_threads mutex companion */
-  fluid_cond_t* thread_ready; /**< Signalled from thread, when the thread has a buffer ready for mixing */
-  fluid_cond_mutex_t* thread_ready_m; /**< thread_ready mutex companion */
 
   atomic_int thread_count;            /**< Number of extra mixer threads for multi-core rendering */
   fluid_mixer_buffers_t* threads;    /**< Array of mixer threads (thread_count in length) */
@@ -560,12 +572,9 @@ new_fluid_rvoice_mixer(int buf_count, int fx_buf_count, fluid_real_t sample_rate
   }
   
 #ifdef ENABLE_MIXER_THREADS
-  mixer->thread_ready = new_fluid_cond();
   mixer->wakeup_threads = new_fluid_cond();
-  mixer->thread_ready_m = new_fluid_cond_mutex();
   mixer->wakeup_threads_m = new_fluid_cond_mutex();
-  if (!mixer->thread_ready || !mixer->wakeup_threads || 
-      !mixer->thread_ready_m || !mixer->wakeup_threads_m) {
+  if (!mixer->wakeup_threads || !mixer->wakeup_threads_m) {
     delete_fluid_rvoice_mixer(mixer);
     return NULL;
   }
@@ -625,12 +634,8 @@ void delete_fluid_rvoice_mixer(fluid_rvoice_mixer_t* mixer)
     return;
   fluid_rvoice_mixer_set_threads(mixer, 0, 0);
 #ifdef ENABLE_MIXER_THREADS
-  if (mixer->thread_ready)
-    delete_fluid_cond(mixer->thread_ready);
   if (mixer->wakeup_threads)
     delete_fluid_cond(mixer->wakeup_threads);
-  if (mixer->thread_ready_m)
-    delete_fluid_cond_mutex(mixer->thread_ready_m);
   if (mixer->wakeup_threads_m)
     delete_fluid_cond_mutex(mixer->wakeup_threads_m);
 #endif
@@ -719,127 +724,223 @@ int fluid_rvoice_mixer_get_bufcount(fluid_rvoice_mixer_t* mixer)
 
 #ifdef ENABLE_MIXER_THREADS
 
-static FLUID_INLINE fluid_rvoice_t* 
-fluid_mixer_get_mt_rvoice(fluid_rvoice_mixer_t* mixer)
-{
-  int i = fluid_atomic_int_inc(&mixer->current_rvoice) - 1;
-  if (i >= mixer->active_voices) 
-    return NULL;
-  return mixer->rvoices[i];
-}
-
 #define THREAD_BUF_PROCESSING 0
 #define THREAD_BUF_VALID 1
 #define THREAD_BUF_NODATA 2
-#define THREAD_BUF_TERMINATE 3
 
-/* Core thread function (processes voices in parallel to primary synthesis thread) */
-static FLUID_THREAD_RETURN_TYPE
-fluid_mixer_thread_func (void* data)
+static FLUID_INLINE fluid_mixer_buffers_t*
+fluid_mixer_get_participant(fluid_rvoice_mixer_t* mixer, int i)
+{
+  return i == 0 ? &mixer->buffers : &mixer->threads[i-1];
+}
+
+/**
+ * Take a batch from the front of our own deque
+ * @return batch index or -1 if the deque is empty
+ */
+static FLUID_INLINE int
+fluid_mixer_pop_batch(fluid_mixer_buffers_t* buffers)
+{
+  int old, first, end;
+  do {
+    old = fluid_atomic_int_get(&buffers->batches);
+    first = old >> 16;
+    end = old & 0xffff;
+    if (first >= end)
+      return -1;
+  } while (!fluid_atomic_int_compare_and_exchange(&buffers->batches, old,
+                                                  ((first + 1) << 16) | end));
+  return first;
+}
+
+/**
+ * Take a batch from the back of somebody else's deque
+ * @return batch index or -1 if the deque is empty
+ */
+static FLUID_INLINE int
+fluid_mixer_steal_batch(fluid_mixer_buffers_t* buffers)
+{
+  int old, first, end;
+  do {
+    old = fluid_atomic_int_get(&buffers->batches);
+    first = old >> 16;
+    end = old & 0xffff;
+    if (first >= end)
+      return -1;
+  } while (!fluid_atomic_int_compare_and_exchange(&buffers->batches, old,
+                                                  (first << 16) | (end - 1)));
+  return end - 1;
+}
+
+static int
+fluid_mixer_get_batch(fluid_rvoice_mixer_t* mixer, int self)
+{
+  int i, batch;
+
+  batch = fluid_mixer_pop_batch(fluid_mixer_get_participant(mixer, self));
+  // Out of work: steal from the others, starting with our neighbour
+  for (i=1; batch < 0 && i < mixer->participants; i++)
+    batch = fluid_mixer_steal_batch(fluid_mixer_get_participant(mixer,
+                                    (self + i) % mixer->participants));
+  return batch;
+}
+
+/**
+ * Render voice batches until there are none left in any deque
+ * @return TRUE if anything was rendered into the buffers
+ */
+static int
+fluid_mixer_buffers_render_batches(fluid_mixer_buffers_t* buffers, int self,
+                                   int has_data, fluid_real_t** bufs, int bufcount)
 {
-  fluid_mixer_buffers_t* buffers = data;  
   fluid_rvoice_mixer_t* mixer = buffers->mixer;
-  int hasValidData = 0;
-  FLUID_DECLARE_VLA(fluid_real_t*, bufs, buffers->buf_count*2 + buffers->fx_buf_count*2);
-  int bufcount = 0;
-  
-  while (!fluid_atomic_int_get(&mixer->threads_should_terminate)) {
-    fluid_rvoice_t* rvoice = fluid_mixer_get_mt_rvoice(mixer);
-    if (rvoice == NULL) {
-      // if no voices: signal rendered buffers, sleep
-      fluid_atomic_int_set(&buffers->ready, hasValidData ? THREAD_BUF_VALID : THREAD_BUF_NODATA);
-      fluid_cond_mutex_lock(mixer->thread_ready_m);
-      fluid_cond_signal(mixer->thread_ready);
-      fluid_cond_mutex_unlock(mixer->thread_ready_m);
-      
-      fluid_cond_mutex_lock(mixer->wakeup_threads_m);
-      while (1) {
-        int j = fluid_atomic_int_get(&buffers->ready); 
-        if (j == THREAD_BUF_PROCESSING || j == THREAD_BUF_TERMINATE)
-          break;
-        fluid_cond_wait(mixer->wakeup_threads, mixer->wakeup_threads_m);
-      }
-      fluid_cond_mutex_unlock(mixer->wakeup_threads_m);
-      
-      hasValidData = 0;
+  int i, end, batch;
+
+  while ((batch = fluid_mixer_get_batch(mixer, self)) >= 0) {
+    if (!has_data) {
+      fluid_mixer_buffers_zero(buffers);
+      bufcount = fluid_mixer_buffers_prepare(buffers, bufs);
+      has_data = 1;
     }
-    else {
-      // else: if buffer is not zeroed, zero buffers
-      if (!hasValidData) {
-        fluid_mixer_buffers_zero(buffers);
-	bufcount = fluid_mixer_buffers_prepare(buffers, bufs);
-	hasValidData = 1;
+    i = batch * VOICES_PER_BATCH;
+    end = i + VOICES_PER_BATCH;
+    if (end > mixer->active_voices)
+      end = mixer->active_voices;
+    for (; i < end; i++) {
+      fluid_profile_ref_var(prof_ref);
+      fluid_mixer_buffers_render_one(buffers, mixer->rvoices[i], bufs, bufcount);
+      // fluid_profile_data is not thread safe: only the synth thread's
+      // voices are counted
+      if (self == 0) {
+        fluid_profile(FLUID_PROF_ONE_BLOCK_VOICE, prof_ref);
       }
-      // then render voice to buffers
-      fluid_mixer_buffers_render_one(buffers, rvoice, bufs, bufcount);
     }
   }
-
-  return FLUID_THREAD_RETURN_VALUE;
+  return has_data;
 }
 
+/**
+ * Mix the thread buffers into the primary buffers. The blocks are shared out
+ * between all the threads, so nobody has to sum everything on their own.
+ */
 static void
-fluid_mixer_buffers_mix(fluid_mixer_buffers_t* dest, fluid_mixer_buffers_t* src)
+fluid_mixer_buffers_reduce(fluid_rvoice_mixer_t* mixer)
 {
-  int i,j;
-  int scount = dest->mixer->current_blockcount * FLUID_BUFSIZE;
-  int minbuf;
-  
-  minbuf = dest->buf_count;
-  if (minbuf > src->buf_count)
-    minbuf = src->buf_count;
-  for (i=0; i < minbuf; i++) {
-    for (j=0; j < scount; j++) {
-      dest->left_buf[i][j] += src->left_buf[i][j];
-      dest->right_buf[i][j] += src->right_buf[i][j];
-    }
-  }
+  fluid_mixer_buffers_t* dest = &mixer->buffers;
+  int block, i, j, t, minbuf;
+
+  while ((block = fluid_atomic_int_add(&mixer->current_block, 1))
+         < mixer->current_blockcount) {
+    int start = block * FLUID_BUFSIZE;
+    int end = start + FLUID_BUFSIZE;
+
+    for (t=0; t < mixer->participants - 1; t++) {
+      fluid_mixer_buffers_t* src = &mixer->threads[t];
+      if (fluid_atomic_int_get(&src->ready) != THREAD_BUF_VALID)
+        continue;
+
+      minbuf = dest->buf_count;
+      if (minbuf > src->buf_count)
+        minbuf = src->buf_count;
+      for (i=0; i < minbuf; i++) {
+        for (j=start; j < end; j++) {
+          dest->left_buf[i][j] += src->left_buf[i][j];
+          dest->right_buf[i][j] += src->right_buf[i][j];
+        }
+      }
 
-  minbuf = dest->fx_buf_count;
-  if (minbuf > src->fx_buf_count)
-    minbuf = src->fx_buf_count;
-  for (i=0; i < minbuf; i++) {
-    for (j=0; j < scount; j++) {
-      dest->fx_left_buf[i][j] += src->fx_left_buf[i][j];
-      dest->fx_right_buf[i][j] += src->fx_right_buf[i][j];
+      minbuf = dest->fx_buf_count;
+      if (minbuf > src->fx_buf_count)
+        minbuf = src->fx_buf_count;
+      for (i=0; i < minbuf; i++) {
+        for (j=start; j < end; j++) {
+          dest->fx_left_buf[i][j] += src->fx_left_buf[i][j];
+          dest->fx_right_buf[i][j] += src->fx_right_buf[i][j];
+        }
+      }
     }
   }
 }
 
+/**
+ * Wait for all the threads to reach a certain point. All of them are busy
+ * rendering the same block, so this should be short: spin, then yield.
+ */
+static void
+fluid_mixer_wait_threads(fluid_rvoice_mixer_t* mixer, atomic_int* count, int target)
+{
+  int spins = 0;
+  while (fluid_atomic_int_get(count) < target) {
+    if (fluid_atomic_int_get(&mixer->threads_should_terminate))
+      return;
+    if (++spins > MIXER_SPIN_COUNT)
+      fluid_thread_yield();
+  }
+}
 
 /**
- * Go through all threads and see if someone is finished for mixing 
+ * Wait for the next block to render. Spin for a while first, since blocks
+ * often come in bursts, and go to sleep on wakeup_threads after that.
  */
-static FLUID_INLINE int
-fluid_mixer_mix_in(fluid_rvoice_mixer_t* mixer, int extra_threads)
+static void
+fluid_mixer_wait_generation(fluid_rvoice_mixer_t* mixer, int* generation)
 {
-  int i, result, hasmixed;
-  do {
-    hasmixed = 0;
-    result = 0;
-    for (i=0; i < extra_threads; i++) {
-      int j = fluid_atomic_int_get(&mixer->threads[i].ready);
-      switch (j) {
-	case THREAD_BUF_PROCESSING: 
-	  result = 1;
-	  break;
-	case THREAD_BUF_VALID:
-          fluid_atomic_int_set(&mixer->threads[i].ready, THREAD_BUF_NODATA);
-	  fluid_mixer_buffers_mix(&mixer->buffers, &mixer->threads[i]);
-	  hasmixed = 1;
-	  break;
-      }
-    }
-  } while (hasmixed);
-  return result;
+  int i;
+
+  for (i=0; i < MIXER_SPIN_COUNT; i++) {
+    if (fluid_atomic_int_get(&mixer->generation) != *generation ||
+        fluid_atomic_int_get(&mixer->threads_should_terminate))
+      goto done;
+  }
+
+  fluid_cond_mutex_lock(mixer->wakeup_threads_m);
+  fluid_atomic_int_add(&mixer->sleeping_threads, 1);
+  while (fluid_atomic_int_get(&mixer->generation) == *generation &&
+         !fluid_atomic_int_get(&mixer->threads_should_terminate))
+    fluid_cond_wait(mixer->wakeup_threads, mixer->wakeup_threads_m);
+  fluid_atomic_int_add(&mixer->sleeping_threads, -1);
+  fluid_cond_mutex_unlock(mixer->wakeup_threads_m);
+
+done:
+  *generation = fluid_atomic_int_get(&mixer->generation);
 }
 
-static void 
+/* Core thread function (processes voices in parallel to primary synthesis thread) */
+static FLUID_THREAD_RETURN_TYPE
+fluid_mixer_thread_func (void* data)
+{
+  fluid_mixer_buffers_t* buffers = data;
+  fluid_rvoice_mixer_t* mixer = buffers->mixer;
+  int self = buffers - mixer->threads + 1;
+  int generation = 0;
+  int has_data;
+  FLUID_DECLARE_VLA(fluid_real_t*, bufs, buffers->buf_count*2 + buffers->fx_buf_count*2);
+
+  while (1) {
+    fluid_mixer_wait_generation(mixer, &generation);
+    if (fluid_atomic_int_get(&mixer->threads_should_terminate))
+      break;
+    // Not needed for this block
+    if (fluid_atomic_int_get(&buffers->ready) != THREAD_BUF_PROCESSING)
+      continue;
+
+    has_data = fluid_mixer_buffers_render_batches(buffers, self, 0, bufs, 0);
+    fluid_atomic_int_set(&buffers->ready, has_data ? THREAD_BUF_VALID : THREAD_BUF_NODATA);
+    fluid_atomic_int_add(&mixer->threads_rendered, 1);
+
+    fluid_mixer_wait_threads(mixer, &mixer->threads_rendered, mixer->participants);
+    fluid_mixer_buffers_reduce(mixer);
+    fluid_atomic_int_add(&mixer->threads_reduced, 1);
+  }
+
+  return FLUID_THREAD_RETURN_VALUE;
+}
+
+static void
 fluid_render_loop_multithread(fluid_rvoice_mixer_t* mixer)
 {
-  int i, bufcount;
-  //int scount = mixer->current_blockcount * FLUID_BUFSIZE;
-  FLUID_DECLARE_VLA(fluid_real_t*, bufs, 
+  int i, bufcount, batches;
+  FLUID_DECLARE_VLA(fluid_real_t*, bufs,
 		    mixer->buffers.buf_count * 2 + mixer->buffers.fx_buf_count * 2);
   // How many threads should we start this time?
   int extra_threads = mixer->active_voices / VOICES_PER_THREAD;
@@ -852,43 +953,37 @@ fluid_render_loop_multithread(fluid_rvoice_mixer_t* mixer)
     return;
   }
 
-  bufcount = fluid_mixer_buffers_prepare(&mixer->buffers, bufs);
-  
-  // Prepare voice list
-  fluid_cond_mutex_lock(mixer->wakeup_threads_m);
-  fluid_atomic_int_set(&mixer->current_rvoice, 0);
+  // Deal the voice batches out evenly, whoever runs dry steals from the others.
+  // Polyphony is limited to 65535, so the batch indices fit in 16 bits.
+  mixer->participants = extra_threads + 1;
+  batches = (mixer->active_voices + VOICES_PER_BATCH - 1) / VOICES_PER_BATCH;
+  for (i=0; i < mixer->participants; i++) {
+    int first = batches * i / mixer->participants;
+    int end = batches * (i + 1) / mixer->participants;
+    fluid_atomic_int_set(&fluid_mixer_get_participant(mixer, i)->batches,
+                         (first << 16) | end);
+  }
+  fluid_atomic_int_set(&mixer->threads_rendered, 0);
+  fluid_atomic_int_set(&mixer->threads_reduced, 0);
+  fluid_atomic_int_set(&mixer->current_block, 0);
   for (i=0; i < extra_threads; i++)
     fluid_atomic_int_set(&mixer->threads[i].ready, THREAD_BUF_PROCESSING);
-  // Signal threads to wake up
-  fluid_cond_broadcast(mixer->wakeup_threads);
-  fluid_cond_mutex_unlock(mixer->wakeup_threads_m);
-  
-  // If thread is finished, mix it in
-  while (fluid_mixer_mix_in(mixer, extra_threads)) {
-    // Otherwise get a voice and render it
-    fluid_rvoice_t* rvoice = fluid_mixer_get_mt_rvoice(mixer);
-    if (rvoice != NULL) {
-      fluid_profile_ref_var(prof_ref);
-      fluid_mixer_buffers_render_one(&mixer->buffers, rvoice, bufs, bufcount);
-      fluid_profile(FLUID_PROF_ONE_BLOCK_VOICE, prof_ref);
-      //test++;
-    }
-    else {
-      // If no voices, wait for mixes. Make sure one is still processing to avoid deadlock
-      int is_processing = 0;
-      //waits++;
-      fluid_cond_mutex_lock(mixer->thread_ready_m);
-      for (i=0; i < extra_threads; i++) 
-	if (fluid_atomic_int_get(&mixer->threads[i].ready) == 
-	    THREAD_BUF_PROCESSING)
-	  is_processing = 1;
-      if (is_processing) 
-        fluid_cond_wait(mixer->thread_ready, mixer->thread_ready_m);
-      fluid_cond_mutex_unlock(mixer->thread_ready_m);
-    }
+
+  // Signal threads to wake up, only the sleeping ones need the mutex
+  fluid_atomic_int_add(&mixer->generation, 1);
+  if (fluid_atomic_int_get(&mixer->sleeping_threads) > 0) {
+    fluid_cond_mutex_lock(mixer->wakeup_threads_m);
+    fluid_cond_broadcast(mixer->wakeup_threads);
+    fluid_cond_mutex_unlock(mixer->wakeup_threads_m);
   }
-  //FLUID_LOG(FLUID_DBG, "Blockcount: %d, mixed %d of %d voices myself, waits = %d", 
-  //	    mixer->current_blockcount, test, mixer->active_voices, waits);
+
+  bufcount = fluid_mixer_buffers_prepare(&mixer->buffers, bufs);
+  fluid_mixer_buffers_render_batches(&mixer->buffers, 0, 1, bufs, bufcount);
+  fluid_atomic_int_add(&mixer->threads_rendered, 1);
+
+  fluid_mixer_wait_threads(mixer, &mixer->threads_rendered, mixer->participants);
+  fluid_mixer_buffers_reduce(mixer);
+  fluid_mixer_wait_threads(mixer, &mixer->threads_reduced, extra_threads);
 }
 
 #endif
@@ -913,8 +1008,6 @@ fluid_rvoice_mixer_set_threads(fluid_rvoice_mixer_t* mixer, int thread_count,
     // Signal threads to wake up
     fluid_cond_mutex_lock(mixer->wakeup_threads_m);
     thread_count = fluid_atomic_int_get(&mixer->thread_count);
-    for (i=0; i < thread_count; i++)
-      fluid_atomic_int_set(&mixer->threads[i].ready, THREAD_BUF_TERMINATE);
     fluid_cond_broadcast(mixer->wakeup_threads);
     fluid_cond_mutex_unlock(mixer->wakeup_threads_m);
   
@@ -0,0 +1,274 @@
+/* FluidSynth - A Software Synthesizer
+ *
+ * Copyright (C) 2003  Peter Hanappe and others.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA
+ */
+
+/* fxtest.c
+ *
+ * Golden output test of the reverb and chorus.  Each case feeds half a
+ * second of noise followed by silence, to get the tail, through
+ * fluid_revmodel_processmix or fluid_chorus_processmix one FLUID_BUFSIZE
+ * block at a time, and checks the output against what the sample at a
+ * time implementations that the block versions replaced gave:
+ *
+ * - the hash of every output sample must be the one recorded, for the
+ *   double (Android) or the float build.  The vector chorus sums its taps
+ *   in another order, so with FLUID_SIMD only the reverb is checked this
+ *   way;
+ * - a float build, vector or not, must be within TOLERANCE of the peak at
+ *   the points recorded from the float build.
+ *
+ * Exits 1 if a case fails.  -g prints the golden values of the code it
+ * is linked with in the form of the table below.  The hashes also depend
+ * on the libm sin and cos used to build the tables; they were recorded
+ * with glibc on x86-64, and -ffp-contract=off keeps multiplies and adds
+ * from being fused differently than they were then.
+ *
+ * Not part of the Android build.  On a host, from the src directory:
+ *
+ *   cc -O2 -ffp-contract=off -DHAVE_PTHREAD_H -DHAVE_STDLIB_H \
+ *      -DHAVE_STDIO_H -DHAVE_MATH_H -DHAVE_STRING_H -DHAVE_STDARG_H \
+ *      -DHAVE_UNISTD_H -DHAVE_ERRNO_H -DHAVE_FCNTL_H -DHAVE_SYS_STAT_H \
+ *      -include stdint.h -I../include -I. -Iutils -Isynth -Isfloader \
+ *      -Irvoice -Imidi [-DWITH_FLOAT] [-DFLUID_NO_SIMD] \
+ *      -o fxtest rvoice/fxtest.c rvoice/fluid_rev.c rvoice/fluid_chorus.c \
+ *      utils/fluid_sys.c -lpthread -lm
+ *   ./fxtest [-g]
+ */
+
+#include "fluid_rev.h"
+#include "fluid_chorus.h"
+
+#define TEST_RATE    44100
+#define TEST_BURST   (TEST_RATE / 2)
+#define TEST_BLOCKS  (2 * TEST_RATE / FLUID_BUFSIZE)
+#define TEST_LENGTH  (TEST_BLOCKS * FLUID_BUFSIZE)
+#define TEST_POINTS  16
+#define POINT_OFFSET 2203
+#define TOLERANCE    1e-5
+
+enum { REVERB, CHORUS };
+
+static const struct fx_case {
+  const char* name;
+  int effect;
+  /* roomsize, damping, width, level or nr, level, speed, depth_ms, type */
+  double param[5];
+  unsigned int golden_double, golden_float;
+  /* left and right at point(), float build */
+  double points[TEST_POINTS][2];
+} cases[] = {
+  { "reverb default", REVERB, { 0.2, 0, 0.5, 0.9, 0 },
+    0xf1e6043e, 0x3949628c, {
+      { -0.0706588477, 0.238003805 }, { -2.28548145, -1.73229384 },
+      { -0.410182297, -1.201231 }, { 0.622932017, -0.372965574 },
+      { -0.70596534, -1.56568325 }, { 0.123161033, -0.26849395 },
+      { -0.0459929183, -0.0479017347 }, { -0.0572918132, -0.0700814724 },
+      { 0.0118778599, -0.000618019141 }, { 0.000694816583, -0.00135389878 },
+      { -0.000134957954, -0.00308094313 }, { -0.000537709566, 0.000707182568 },
+      { -1.03378352e-05, -1.09915354e-05 }, { -0.000127569889, -0.000155120302 },
+      { 2.10454236e-05, -5.02877665e-05 }, { 8.91550826e-07, -9.93943831e-06 } } },
+  { "reverb large", REVERB, { 1, 0.4, 100, 1, 0 },
+    0xa8bace8a, 0xc0374882, {
+      { -34.2028809, 34.3888206 }, { -98.9258881, 95.4282837 },
+      { 161.082947, -161.77771 }, { 164.778412, -165.920212 },
+      { 31.0964966, -32.5361633 }, { 3.82402134, -4.09626675 },
+      { -64.6774826, 63.0050812 }, { 6.8955555, -6.07375526 },
+      { 29.9673042, -29.8227272 }, { -17.9398232, 18.3305092 },
+      { 5.30322313, -4.98170662 }, { 38.7216454, -37.947628 },
+      { -5.45040989, 5.41911077 }, { 14.8581524, -15.1783857 },
+      { -8.32000923, 8.42101383 }, { 4.89002848, -5.29444551 } } },
+  { "chorus default", CHORUS, { 3, 2, 0.3, 8, 0 },
+    0x33dcde05, 0xf4a98c55, {
+      { 1.35081017, 1.35081017 }, { 1.51397681, 1.51397681 },
+      { -0.775456011, -0.775456011 }, { -1.06405568, -1.06405568 },
+      { -3.69815612, -3.69815612 }, { -0.42581585, -0.42581585 },
+      { 0.153203204, 0.153203204 }, { -0.00991335511, -0.00991335511 },
+      { 2.16553402, 2.16553402 }, { 1.48855519, 1.48855519 },
+      { -0.280772924, -0.280772924 }, { -0.74516654, -0.74516654 },
+      { -0.195020735, -0.195020735 }, { -0.254291028, -0.254291028 },
+      { -0.211701319, -0.211701319 }, { 0.0489472188, 0.0489472188 } } },
+  { "chorus extreme", CHORUS, { 99, 10, 5, 40, 1 },
+    0xf6e636a9, 0x570c7305, {
+      { -43.5580406, -43.5580406 }, { 35.8158989, 35.8158989 },
+      { 12.2345486, 12.2345486 }, { 43.3702278, 43.3702278 },
+      { 9.07068157, 9.07068157 }, { 4.24802589, 4.24802589 },
+      { 35.0397186, 35.0397186 }, { -57.9334221, -57.9334221 },
+      { -40.8274689, -40.8274689 }, { -2.01579785, -2.01579785 },
+      { 36.2583237, 36.2583237 }, { -65.8991699, -65.8991699 },
+      { 81.07724, 81.07724 }, { 53.8315163, 53.8315163 },
+      { 36.3958549, 36.3958549 }, { 26.5220547, 26.5220547 } } },
+};
+#define NCASES (int)(sizeof(cases) / sizeof(cases[0]))
+
+/* The chorus has no tail, so its points are all taken during the burst */
+static int
+point(const struct fx_case* c, int n)
+{
+  return POINT_OFFSET
+    + n * ((c->effect == REVERB ? TEST_LENGTH : TEST_BURST) - POINT_OFFSET)
+      / TEST_POINTS;
+}
+
+static fluid_real_t input[TEST_LENGTH];
+static fluid_real_t left[TEST_LENGTH], right[TEST_LENGTH];
+
+static void
+make_input(void)
+{
+  unsigned int seed = 12345;
+  int i;
+
+  for (i = 0; i < TEST_LENGTH; i++) {
+    seed = seed * 1103515245 + 12345;
+    input[i] = i < TEST_BURST
+      ? (fluid_real_t) ((int) (seed >> 16 & 0x7fff) - 0x4000) / 0x4000
+      : 0;
+  }
+}
+
+static int
+run(const struct fx_case* c)
+{
+  fluid_revmodel_t* rev = NULL;
+  fluid_chorus_t* chorus = NULL;
+  int i;
+
+  if (c->effect == REVERB) {
+    rev = new_fluid_revmodel(TEST_RATE);
+    if (rev == NULL)
+      return FLUID_FAILED;
+    fluid_revmodel_set(rev, FLUID_REVMODEL_SET_ALL, c->param[0], c->param[1],
+                       c->param[2], c->param[3]);
+  } else {
+    chorus = new_fluid_chorus(TEST_RATE);
+    if (chorus == NULL)
+      return FLUID_FAILED;
+    fluid_chorus_set(chorus, FLUID_CHORUS_SET_ALL, (int) c->param[0],
+                     c->param[1], c->param[2], c->param[3], (int) c->param[4]);
+  }
+
+  FLUID_MEMSET(left, 0, sizeof(left));
+  FLUID_MEMSET(right, 0, sizeof(right));
+  for (i = 0; i < TEST_LENGTH; i += FLUID_BUFSIZE) {
+    if (rev != NULL)
+      fluid_revmodel_processmix(rev, &input[i], &left[i], &right[i]);
+    else
+      fluid_chorus_processmix(chorus, &input[i], &left[i], &right[i]);
+  }
+
+  if (rev != NULL)
+    delete_fluid_revmodel(rev);
+  if (chorus != NULL)
+    delete_fluid_chorus(chorus);
+  return FLUID_OK;
+}
+
+/* FNV-1a over the bits of the output */
+static unsigned int
+hash(void)
+{
+  const unsigned char* p;
+  unsigned int h = 2166136261u;
+  size_t n;
+
+  for (p = (const unsigned char*) left, n = 0; n < sizeof(left); n++)
+    h = (h ^ p[n]) * 16777619u;
+  for (p = (const unsigned char*) right, n = 0; n < sizeof(right); n++)
+    h = (h ^ p[n]) * 16777619u;
+  return h;
+}
+
+static void
+print_golden(const struct fx_case* c, unsigned int h)
+{
+  int n;
+
+  printf("  { \"%s\", %s, { %g, %g, %g, %g, %g },\n    0x%08x, 0x%08x, {",
+         c->name, c->effect == REVERB ? "REVERB" : "CHORUS",
+         c->param[0], c->param[1], c->param[2], c->param[3], c->param[4],
+         sizeof(fluid_real_t) == sizeof(double) ? h : c->golden_double,
+         sizeof(fluid_real_t) == sizeof(float) ? h : c->golden_float);
+  for (n = 0; n < TEST_POINTS; n++) {
+    int k = point(c, n);
+
+    if (sizeof(fluid_real_t) == sizeof(float))
+      printf("%s{ %.9g, %.9g }", n == 0 ? "\n      " : n % 2 ? ", " : ",\n      ",
+             (double) left[k], (double) right[k]);
+    else
+      printf("%s{ %.9g, %.9g }", n == 0 ? "\n      " : n % 2 ? ", " : ",\n      ",
+             c->points[n][0], c->points[n][1]);
+  }
+  printf(" } },\n");
+}
+
+int
+main(int argc, char** argv)
+{
+  int golden = argc > 1 && FLUID_STRCMP(argv[1], "-g") == 0;
+  int i, n, failed = 0;
+
+  make_input();
+
+  for (i = 0; i < NCASES; i++) {
+    const struct fx_case* c = &cases[i];
+    unsigned int h, expected;
+    int check_hash;
+    double peak = 0, worst = 0;
+
+    if (run(c) != FLUID_OK) {
+      printf("%-16s out of memory\n", c->name);
+      return 1;
+    }
+    h = hash();
+    if (golden) {
+      print_golden(c, h);
+      continue;
+    }
+
+    expected = sizeof(fluid_real_t) == sizeof(double)
+      ? c->golden_double : c->golden_float;
+#ifdef FLUID_SIMD
+    check_hash = c->effect == REVERB;
+#else
+    check_hash = 1;
+#endif
+
+    /* The double build is checked to the last bit by the hash */
+    if (sizeof(fluid_real_t) == sizeof(float)) {
+      for (n = 0; n < TEST_POINTS; n++) {
+        peak = fmax(peak, fmax(fabs(c->points[n][0]), fabs(c->points[n][1])));
+      }
+      for (n = 0; n < TEST_POINTS; n++) {
+        int k = point(c, n);
+        worst = fmax(worst, fabs(left[k] - c->points[n][0]));
+        worst = fmax(worst, fabs(right[k] - c->points[n][1]));
+      }
+      worst /= peak;
+    }
+
+    printf("%-16s hash %08x %s", c->name, h,
+           !check_hash ? "(skipped)" : h == expected ? "ok" : "WRONG");
+    if (sizeof(fluid_real_t) == sizeof(float))
+      printf(", max diff %.2g of peak", worst);
+    printf("\n");
+    if ((check_hash && h != expected) || worst > TOLERANCE)
+      failed = 1;
+  }
+  return failed;
+}
@@ -0,0 +1,201 @@
+/* FluidSynth - A Software Synthesizer
+ *
+ * Copyright (C) 2003  Peter Hanappe and others.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA
+ */
+
+/* mixerbench.c
+ *
+ * Times fluid_rvoice_mixer_render with 64, 256 and 1024 voices on 1, 2, 4
+ * and 8 cores (the synth thread plus 0, 1, 3 or 7 mixer threads), and
+ * checks that every voice is mixed exactly once whatever the thread count.
+ *
+ * The voices are stubs: fluid_rvoice_write runs a 7 tap filter per sample,
+ * about what 7th order interpolation costs, and writes the voice number,
+ * so the mixed output must be the sum of the voice numbers.  Reverb and
+ * chorus are off; only the voice scheduling is measured.  The speedups
+ * only mean something on an idle machine with at least as many cores.
+ *
+ * Not part of the Android build.  On a host, from the src directory:
+ *
+ *   cc -O2 -DHAVE_PTHREAD_H -DHAVE_STDLIB_H -DHAVE_STDIO_H -DHAVE_MATH_H \
+ *      -DHAVE_STRING_H -DHAVE_STDARG_H -DHAVE_UNISTD_H -DHAVE_ERRNO_H \
+ *      -DHAVE_FCNTL_H -DHAVE_SYS_STAT_H -DSUPPORTS_VLA -DVERSION=\"1.1.6\" \
+ *      -include stdint.h -I../include -I. -Iutils -Isynth -Isfloader \
+ *      -Irvoice -Imidi -o mixerbench rvoice/mixerbench.c utils/fluid_sys.c \
+ *      rvoice/fluid_rev.c rvoice/fluid_chorus.c -lpthread -lm
+ *   ./mixerbench [-b blocks] [-r renders]
+ */
+
+#include "fluid_rvoice_mixer.c"
+#include <time.h>
+
+#define MAX_BENCH_VOICES 1024
+
+typedef struct {
+  fluid_rvoice_t rvoice;        /* first, the mixer hands out its address */
+  int id;
+} bench_voice_t;
+
+static bench_voice_t bench_voices[MAX_BENCH_VOICES];
+
+/* Sum to exactly 1, so that the filtered voice is exactly its number */
+static const fluid_real_t taps[7] = {
+  0.5f, 0.25f, 0.125f, 0.0625f, 0.03125f, 0.015625f, 0.015625f
+};
+
+int
+fluid_rvoice_write(fluid_rvoice_t* voice, fluid_real_t *dsp_buf)
+{
+  fluid_real_t in[FLUID_BUFSIZE + 6];
+  fluid_real_t id = ((bench_voice_t*) voice)->id;
+  int i, k;
+
+  for (i = 0; i < FLUID_BUFSIZE + 6; i++)
+    in[i] = id;
+
+  for (i = 0; i < FLUID_BUFSIZE; i++) {
+    fluid_real_t sum = 0;
+    for (k = 0; k < 7; k++)
+      sum += taps[k] * in[i + k];
+    dsp_buf[i] = sum;
+  }
+  return FLUID_BUFSIZE;
+}
+
+void
+fluid_rvoice_buffers_mix(fluid_rvoice_buffers_t* buffers,
+                         fluid_real_t* dsp_buf, int samplecount,
+                         fluid_real_t** dest_bufs, int dest_bufcount)
+{
+  int i;
+
+  for (i = 0; i < samplecount; i++) {
+    dest_bufs[0][i] += dsp_buf[i];
+    dest_bufs[1][i] += 2 * dsp_buf[i];
+  }
+}
+
+void
+fluid_rvoice_set_output_rate(fluid_rvoice_t* voice, fluid_real_t value)
+{
+}
+
+static double
+now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Returns the time per render in seconds, or -1 if the output is wrong */
+static double
+bench(int cores, int voice_count, int blocks, int renders)
+{
+  fluid_rvoice_mixer_t* mixer;
+  fluid_real_t **left, **right;
+  double expected = 0, start, elapsed;
+  int i, j, errors = 0;
+
+  mixer = new_fluid_rvoice_mixer(1, 2, 44100);
+  if (mixer == NULL)
+    return -1;
+  fluid_rvoice_mixer_set_reverb_enabled(mixer, 0);
+  fluid_rvoice_mixer_set_chorus_enabled(mixer, 0);
+  fluid_rvoice_mixer_set_polyphony(mixer, voice_count);
+  fluid_rvoice_mixer_set_threads(mixer, cores - 1, 0);
+
+  for (i = 0; i < voice_count; i++) {
+    bench_voices[i].id = i + 1;
+    expected += i + 1;
+    fluid_rvoice_mixer_add_voice(mixer, &bench_voices[i].rvoice);
+  }
+  fluid_rvoice_mixer_get_bufs(mixer, &left, &right);
+
+  /* One untimed render to start the threads */
+  fluid_rvoice_mixer_render(mixer, blocks);
+
+  start = now();
+  for (i = 0; i < renders; i++) {
+    fluid_rvoice_mixer_render(mixer, blocks);
+    for (j = 0; j < blocks * FLUID_BUFSIZE; j++) {
+      if (left[0][j] != expected || right[0][j] != 2 * expected)
+        errors++;
+    }
+  }
+  elapsed = now() - start;
+
+  delete_fluid_rvoice_mixer(mixer);
+  if (errors) {
+    fprintf(stderr, "%d cores, %d voices: %d wrong samples\n",
+            cores, voice_count, errors);
+    return -1;
+  }
+  return elapsed / renders;
+}
+
+int
+main(int argc, char** argv)
+{
+  static const int cores[] = { 1, 2, 4, 8 };
+  static const int voice_counts[] = { 64, 256, 1024 };
+  int blocks = 16, renders = 200;
+  int c, v, i, failed = 0;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+      blocks = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+      renders = atoi(argv[++i]);
+    else
+      break;
+  }
+  if (i < argc || blocks <= 0 || blocks > FLUID_MIXER_MAX_BUFFERS_DEFAULT
+      || renders <= 0) {
+    fprintf(stderr, "usage: %s [-b blocks] [-r renders]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%ld cores online, %d blocks of %d samples per render\n",
+         sysconf(_SC_NPROCESSORS_ONLN), blocks, FLUID_BUFSIZE);
+  printf("%6s", "voices");
+  for (c = 0; c < 4; c++)
+    printf("  %d core%s us/block speedup", cores[c], cores[c] > 1 ? "s" : " ");
+  printf("\n");
+
+  for (v = 0; v < 3; v++) {
+    double single = 0;
+
+    printf("%6d", voice_counts[v]);
+    for (c = 0; c < 4; c++) {
+      double t = bench(cores[c], voice_counts[v], blocks, renders);
+
+      if (t < 0) {
+        failed = 1;
+        printf("  %23s", "wrong output");
+        continue;
+      }
+      if (c == 0)
+        single = t;
+      printf("  %16.2f %6.2fx", t * 1e6 / blocks, single / t);
+    }
+    printf("\n");
+  }
+  return failed;
+}
@@ -244,6 +244,9 @@ typedef struct _fluid_cached_sampledata_t {
 
   const short* sampledata;
   unsigned int samplesize;
+
+  void* mapping;          /* start of the mapped file region, NULL if read into RAM */
+  size_t mapping_size;
 } fluid_cached_sampledata_t;
 
 static fluid_cached_sampledata_t* all_cached_sampledata = NULL;
@@ -266,13 +269,61 @@ static int fluid_get_file_modification_time(char *filename, time_t *modification
 #endif
 }
 
+#if HAVE_SYS_MMAN_H
+/*
+ * Map the sample data straight from the file. Pages are only read in once a
+ * voice touches them, and they are shared with every other user of the file.
+ * Under memory pressure the kernel drops them instead of swapping them out.
+ */
+static short* fluid_sampledata_map(const char *filename, unsigned int samplepos,
+  unsigned int samplesize, void **mapping, size_t *mapping_size)
+{
+  struct stat buf;
+  long pagesize = sysconf(_SC_PAGESIZE);
+  off_t offset;
+  void *p;
+  int fd;
+
+  /* The samples must be 16 bit aligned, and byte swapping needs a copy */
+  if (FLUID_IS_BIG_ENDIAN || (samplepos & 1) || pagesize <= 0)
+    return NULL;
+
+  fd = open(filename, O_RDONLY);
+  if (fd == -1)
+    return NULL;
+
+  /* Touching a page past the end of the file raises SIGBUS, so never map
+     more than the file has */
+  if (fstat(fd, &buf) == -1 || (off_t) samplepos + samplesize > buf.st_size) {
+    close(fd);
+    return NULL;
+  }
+
+  offset = samplepos - samplepos % pagesize;
+  *mapping_size = samplesize + (samplepos - offset);
+  p = mmap(NULL, *mapping_size, PROT_READ, MAP_SHARED, fd, offset);
+  close(fd);
+
+  if (p == MAP_FAILED) {
+    FLUID_LOG(FLUID_WARN, "Failed to map the sample data, reading it into RAM instead.");
+    return NULL;
+  }
+
+  *mapping = p;
+  return (short*) ((char*) p + (samplepos - offset));
+}
+#endif
+
 static int fluid_cached_sampledata_load(char *filename, unsigned int samplepos,
-  unsigned int samplesize, short **sampledata, int try_mlock)
+  unsigned int samplesize, short **sampledata, int try_mlock, int try_mmap,
+  int *mapped)
 {
   fluid_file fd = NULL;
   short *loaded_sampledata = NULL;
   fluid_cached_sampledata_t* cached_sampledata = NULL;
   time_t modification_time;
+  void *mapping = NULL;
+  size_t mapping_size = 0;
 
   fluid_mutex_lock(cached_sampledata_mutex);
 
@@ -292,7 +343,7 @@ static int fluid_cached_sampledata_load(char *filename, unsigned int samplepos,
       continue;
     }
 
-    if (try_mlock && !cached_sampledata->mlock) {
+    if (try_mlock && !cached_sampledata->mlock && !cached_sampledata->mapping) {
       if (fluid_mlock(cached_sampledata->sampledata, samplesize) != 0)
         FLUID_LOG(FLUID_WARN, "Failed to pin the sample data to RAM; swapping is possible.");
       else
@@ -301,33 +352,42 @@ static int fluid_cached_sampledata_load(char *filename, unsigned int samplepos,
 
     cached_sampledata->num_references++;
     loaded_sampledata = (short*) cached_sampledata->sampledata;
+    mapping = cached_sampledata->mapping;
     goto success_exit;
   }
 
-  fd = FLUID_FOPEN(filename, "rb");
-  if (fd == NULL) {
-    FLUID_LOG(FLUID_ERR, "Can't open soundfont file");
-    goto error_exit;
-  }
-  if (FLUID_FSEEK(fd, samplepos, SEEK_SET) == -1) {
-    perror("error");
-    FLUID_LOG(FLUID_ERR, "Failed to seek position in data file");
-    goto error_exit;
-  }
-
+#if HAVE_SYS_MMAN_H
+  if (try_mmap)
+    loaded_sampledata = fluid_sampledata_map(filename, samplepos, samplesize,
+                                             &mapping, &mapping_size);
+#endif
 
-  loaded_sampledata = (short*) FLUID_MALLOC(samplesize);
   if (loaded_sampledata == NULL) {
-    FLUID_LOG(FLUID_ERR, "Out of memory");
-    goto error_exit;
-  }
-  if (FLUID_FREAD(loaded_sampledata, 1, samplesize, fd) < samplesize) {
-    FLUID_LOG(FLUID_ERR, "Failed to read sample data");
-    goto error_exit;
-  }
+    fd = FLUID_FOPEN(filename, "rb");
+    if (fd == NULL) {
+      FLUID_LOG(FLUID_ERR, "Can't open soundfont file");
+      goto error_exit;
+    }
+    if (FLUID_FSEEK(fd, samplepos, SEEK_SET) == -1) {
+      perror("error");
+      FLUID_LOG(FLUID_ERR, "Failed to seek position in data file");
+      goto error_exit;
+    }
+
+
+    loaded_sampledata = (short*) FLUID_MALLOC(samplesize);
+    if (loaded_sampledata == NULL) {
+      FLUID_LOG(FLUID_ERR, "Out of memory");
+      goto error_exit;
+    }
+    if (FLUID_FREAD(loaded_sampledata, 1, samplesize, fd) < samplesize) {
+      FLUID_LOG(FLUID_ERR, "Failed to read sample data");
+      goto error_exit;
+    }
 
-  FLUID_FCLOSE(fd);
-  fd = NULL;
+    FLUID_FCLOSE(fd);
+    fd = NULL;
+  }
 
 
   cached_sampledata = (fluid_cached_sampledata_t*) FLUID_MALLOC(sizeof(fluid_cached_sampledata_t));
@@ -337,9 +397,10 @@ static int fluid_cached_sampledata_load(char *filename, unsigned int samplepos,
   }
 
   /* Lock the memory to disable paging. It's okay if this fails. It
-     probably means that the user doesn't have to required permission.  */
+     probably means that the user doesn't have to required permission.
+     Mapped sample data is paged in on demand instead. */
   cached_sampledata->mlock = 0;
-  if (try_mlock) {
+  if (try_mlock && mapping == NULL) {
     if (fluid_mlock(loaded_sampledata, samplesize) != 0)
       FLUID_LOG(FLUID_WARN, "Failed to pin the sample data to RAM; swapping is possible.");
     else
@@ -347,7 +408,7 @@ static int fluid_cached_sampledata_load(char *filename, unsigned int samplepos,
   }
 
   /* If this machine is big endian, the sample have to byte swapped  */
-  if (FLUID_IS_BIG_ENDIAN) {
+  if (FLUID_IS_BIG_ENDIAN && mapping == NULL) {
     unsigned char* cbuf;
     unsigned char hi, lo;
     unsigned int i, j;
@@ -372,6 +433,8 @@ static int fluid_cached_sampledata_load(char *filename, unsigned int samplepos,
   cached_sampledata->num_references = 1;
   cached_sampledata->sampledata = loaded_sampledata;
   cached_sampledata->samplesize = samplesize;
+  cached_sampledata->mapping = mapping;
+  cached_sampledata->mapping_size = mapping_size;
 
   cached_sampledata->next = all_cached_sampledata;
   all_cached_sampledata = cached_sampledata;
@@ -380,12 +443,19 @@ static int fluid_cached_sampledata_load(char *filename, unsigned int samplepos,
  success_exit:
   fluid_mutex_unlock(cached_sampledata_mutex);
   *sampledata = loaded_sampledata;
+  *mapped = mapping != NULL;
   return FLUID_OK;
 
  error_exit:
   if (fd != NULL) {
     FLUID_FCLOSE(fd);
   }
+#if HAVE_SYS_MMAN_H
+  if (mapping != NULL) {
+    munmap(mapping, mapping_size);
+  }
+  else
+#endif
   if (loaded_sampledata != NULL) {
     FLUID_FREE(loaded_sampledata);
   }
@@ -399,6 +469,7 @@ static int fluid_cached_sampledata_load(char *filename, unsigned int samplepos,
 
   fluid_mutex_unlock(cached_sampledata_mutex);
   *sampledata = NULL;
+  *mapped = FALSE;
   return FLUID_FAILED;
 }
 
@@ -418,6 +489,11 @@ static int fluid_cached_sampledata_unload(const short *sampledata)
       if (cached_sampledata->num_references == 0) {
         if (cached_sampledata->mlock)
           fluid_munlock(cached_sampledata->sampledata, cached_sampledata->samplesize);
+#if HAVE_SYS_MMAN_H
+        if (cached_sampledata->mapping)
+          munmap(cached_sampledata->mapping, cached_sampledata->mapping_size);
+        else
+#endif
         FLUID_FREE((short*) cached_sampledata->sampledata);
         FLUID_FREE(cached_sampledata->filename);
 
@@ -476,8 +552,10 @@ fluid_defsfont_t* new_fluid_defsfont(fluid_settings_t* settings)
   sfont->samplesize = 0;
   sfont->sample = NULL;
   sfont->sampledata = NULL;
+  sfont->sampledata_mapped = FALSE;
   sfont->preset = NULL;
   fluid_settings_getint(settings, "synth.lock-memory", &sfont->mlock);
+  fluid_settings_getint(settings, "synth.mmap-samples", &sfont->mmap);
 
   /* Initialise preset cache, so we don't have to call malloc on program changes.
      Usually, we have at most one preset per channel plus one temporarily used,
@@ -612,6 +690,7 @@ int fluid_defsfont_load(fluid_defsfont_t* sfont, const char* file)
     sfsample->fluid_sample = sample;
 
     fluid_defsfont_add_sample(sfont, sample);
+    fluid_defsfont_prefetch_sample(sfont, sample);
     fluid_voice_optimize_sample(sample);
     p = fluid_list_next(p);
   }
@@ -692,7 +771,39 @@ int
 fluid_defsfont_load_sampledata(fluid_defsfont_t* sfont)
 {
   return fluid_cached_sampledata_load(sfont->filename, sfont->samplepos,
-    sfont->samplesize, &sfont->sampledata, sfont->mlock);
+    sfont->samplesize, &sfont->sampledata, sfont->mlock, sfont->mmap,
+    &sfont->sampledata_mapped);
+}
+
+/*
+ * fluid_defsfont_prefetch_sample
+ *
+ * Ask the kernel to start reading in the first FLUID_PREFETCH_SAMPLES points
+ * of a sample while the bank loads, so that a note doesn't have to wait for
+ * the disk before its attack can be played. The rest of the sample is paged
+ * in when a voice gets to it. Only needed when the sample data is mapped.
+ */
+void
+fluid_defsfont_prefetch_sample(fluid_defsfont_t* sfont, fluid_sample_t* sample)
+{
+#if HAVE_SYS_MMAN_H
+  long pagesize = sysconf(_SC_PAGESIZE);
+  unsigned int end;
+  uintptr_t start;
+
+  if (!sfont->sampledata_mapped || pagesize <= 0 || sample->data == NULL)
+    return;
+
+  end = sample->end + 1;
+  if (end > sample->start + FLUID_PREFETCH_SAMPLES)
+    end = sample->start + FLUID_PREFETCH_SAMPLES;
+  if (end <= sample->start)
+    return;
+
+  start = (uintptr_t) &sample->data[sample->start];
+  start -= start % pagesize;
+  madvise((void*) start, (uintptr_t) &sample->data[end] - start, MADV_WILLNEED);
+#endif
 }
 
 /*
@@ -392,6 +392,10 @@ int fluid_defpreset_preset_get_num(fluid_preset_t* preset);
 int fluid_defpreset_preset_noteon(fluid_preset_t* preset, fluid_synth_t* synth, int chan, int key, int vel);
 
 
+/* Points at the start of each sample read ahead when the sample data is
+   mapped, about 0.2 s at 44.1 kHz */
+#define FLUID_PREFETCH_SAMPLES	8192
+
 /*
  * fluid_defsfont_t
  */
@@ -400,10 +404,12 @@ struct _fluid_defsfont_t
   char* filename;           /* the filename of this soundfont */
   unsigned int samplepos;   /* the position in the file at which the sample data starts */
   unsigned int samplesize;  /* the size of the sample data */
-  short* sampledata;        /* the sample data, loaded in ram */
+  short* sampledata;        /* the sample data, loaded in ram or mapped from the file */
   fluid_list_t* sample;      /* the samples in this soundfont */
   fluid_defpreset_t* preset; /* the presets of this soundfont */
   int mlock;                 /* Should we try memlock (avoid swapping)? */
+  int mmap;                  /* Should we try to mmap the sample data? */
+  int sampledata_mapped;     /* Is the sample data mapped from the file? */
 
   fluid_preset_t iter_preset;        /* preset interface used in the iteration */
   fluid_defpreset_t* iter_cur;       /* the current preset in the iteration */
@@ -422,6 +428,7 @@ fluid_defpreset_t* fluid_defsfont_get_preset(fluid_defsfont_t* sfont, unsigned i
 void fluid_defsfont_iteration_start(fluid_defsfont_t* sfont);
 int fluid_defsfont_iteration_next(fluid_defsfont_t* sfont, fluid_preset_t* preset);
 int fluid_defsfont_load_sampledata(fluid_defsfont_t* sfont);
+void fluid_defsfont_prefetch_sample(fluid_defsfont_t* sfont, fluid_sample_t* sample);
 int fluid_defsfont_add_sample(fluid_defsfont_t* sfont, fluid_sample_t* sample);
 int fluid_defsfont_add_preset(fluid_defsfont_t* sfont, fluid_defpreset_t* preset);
 
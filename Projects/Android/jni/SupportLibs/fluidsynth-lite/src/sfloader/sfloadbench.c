@@ -0,0 +1,167 @@
+/* FluidSynth - A Software Synthesizer
+ *
+ * Copyright (C) 2003  Peter Hanappe and others.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA
+ */
+
+/* sfloadbench.c
+ *
+ * Compares loading a SoundFont with synth.mmap-samples on and off: the
+ * time fluid_synth_sfload takes, the resident memory it adds, the time of
+ * the first block rendered once a note is started on every preset of
+ * bank 0 (the point where mapped pages not read ahead are faulted in),
+ * and the resident memory after rendering a second of audio.
+ *
+ * Each mode runs in its own process, with the file dropped from the page
+ * cache first, so that both start cold.  synth.lock-memory is off in both.
+ * The numbers depend on the bank; use one the size of the one shipped.
+ *
+ * Not part of the Android build.  On a host, from the src directory:
+ *
+ *   cc -O2 -DHAVE_PTHREAD_H -DHAVE_STDLIB_H -DHAVE_STDIO_H -DHAVE_MATH_H \
+ *      -DHAVE_STRING_H -DHAVE_STDARG_H -DHAVE_UNISTD_H -DHAVE_ERRNO_H \
+ *      -DHAVE_FCNTL_H -DHAVE_SYS_STAT_H -DHAVE_SYS_MMAN_H -DSUPPORTS_VLA \
+ *      -DVERSION=\"1.1.6\" -DDEFAULT_SOUNDFONT=\"x.sf2\" -include stdint.h \
+ *      -I../include -I. -Iutils -Isynth -Isfloader -Irvoice -Imidi \
+ *      -o sfloadbench sfloader/sfloadbench.c utils/fluid_*.c \
+ *      sfloader/fluid_*.c rvoice/fluid_*.c synth/fluid_*.c midi/fluid_*.c \
+ *      -lpthread -lm
+ *   ./sfloadbench file.sf2
+ */
+
+#include "fluidsynth_priv.h"
+#include <time.h>
+#include <sys/wait.h>
+
+static double
+now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Resident set size in MiB */
+static double
+resident(void)
+{
+  FILE* f = fopen("/proc/self/statm", "r");
+  long size, pages = 0;
+
+  if (f != NULL) {
+    if (fscanf(f, "%ld %ld", &size, &pages) != 2)
+      pages = 0;
+    fclose(f);
+  }
+  return pages * (double) sysconf(_SC_PAGESIZE) / (1024 * 1024);
+}
+
+static int
+drop_cache(const char* filename)
+{
+  int fd = open(filename, O_RDONLY);
+  int err;
+
+  if (fd < 0)
+    return -1;
+  fdatasync(fd);
+  err = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+  return err;
+}
+
+static int
+bench(const char* filename, int use_mmap)
+{
+  static float left[44100], right[44100];
+  fluid_settings_t* settings;
+  fluid_synth_t* synth;
+  double base, start, load, loaded, first, rendered;
+  int i, chan, sfont_id;
+
+  if (drop_cache(filename) != 0)
+    fprintf(stderr, "can't drop %s from the page cache\n", filename);
+
+  settings = new_fluid_settings();
+  fluid_settings_setint(settings, "synth.mmap-samples", use_mmap);
+  fluid_settings_setint(settings, "synth.lock-memory", 0);
+  fluid_settings_setint(settings, "synth.polyphony", 256);
+  synth = new_fluid_synth(settings);
+  if (synth == NULL)
+    return 1;
+
+  base = resident();
+  start = now();
+  sfont_id = fluid_synth_sfload(synth, filename, 0);
+  load = now() - start;
+  loaded = resident();
+  if (sfont_id == FLUID_FAILED) {
+    fprintf(stderr, "can't load %s\n", filename);
+    return 1;
+  }
+
+  /* Every preset of bank 0 plays a note, 16 channels at a time */
+  for (i = 0; i < 128; i += 16) {
+    for (chan = 0; chan < 16; chan++) {
+      if (chan == 9)
+        continue;
+      if (fluid_synth_program_select(synth, chan, sfont_id, 0, i + chan) == FLUID_OK)
+        fluid_synth_noteon(synth, chan, 60, 100);
+    }
+    start = now();
+    fluid_synth_write_float(synth, FLUID_BUFSIZE, left, 0, 1, right, 0, 1);
+    if (i == 0)
+      first = now() - start;
+    fluid_synth_write_float(synth, 44100 / 8, left, 0, 1, right, 0, 1);
+  }
+  rendered = resident();
+
+  printf("%-5s %9.1f %9.1f %14.3f %12.1f\n", use_mmap ? "mmap" : "read",
+         load * 1e3, loaded - base, first * 1e3, rendered - base);
+  fflush(stdout);
+
+  delete_fluid_synth(synth);
+  delete_fluid_settings(settings);
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  int use_mmap, status, failed = 0;
+  pid_t pid;
+
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s file.sf2\n", argv[0]);
+    return 1;
+  }
+
+  printf("%-5s %9s %9s %14s %12s\n", "mode", "load ms", "load MiB",
+         "first block ms", "played MiB");
+  fflush(stdout);
+
+  for (use_mmap = 0; use_mmap <= 1; use_mmap++) {
+    pid = fork();
+    if (pid == 0)
+      _exit(bench(argv[1], use_mmap));
+    if (pid < 0 || waitpid(pid, &status, 0) != pid
+        || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      failed = 1;
+  }
+  return failed;
+}
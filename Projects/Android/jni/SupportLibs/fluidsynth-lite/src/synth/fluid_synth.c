@@ -182,7 +182,10 @@ void fluid_synth_settings(fluid_settings_t* settings)
                               FLUID_HINT_TOGGLED, NULL, NULL);
   fluid_settings_register_int(settings, "synth.ladspa.active", 0, 0, 1,
                               FLUID_HINT_TOGGLED, NULL, NULL);
-  fluid_settings_register_int(settings, "synth.lock-memory", 1, 0, 1,
+  fluid_settings_register_int(settings, "synth.lock-memory",
+                              FLUID_DEFAULT_LOCK_MEMORY, 0, 1,
+                              FLUID_HINT_TOGGLED, NULL, NULL);
+  fluid_settings_register_int(settings, "synth.mmap-samples", 1, 0, 1,
                               FLUID_HINT_TOGGLED, NULL, NULL);
   fluid_settings_register_str(settings, "midi.portname", "", 0, NULL, NULL);
 
@@ -2412,6 +2415,26 @@ fluid_synth_get_active_voice_count(fluid_synth_t* synth)
   FLUID_API_RETURN(result);
 }
 
+/**
+ * Get the highest number of voices that have been playing at the same time.
+ * @param synth FluidSynth instance
+ * @return Peak count of active synthesis voices since the synth was created
+ *
+ * Unlike polling fluid_synth_get_active_voice_count() between calls to
+ * fluid_synth_write_*(), this also counts voices that start and end within
+ * one call.
+ */
+int
+fluid_synth_get_peak_voice_count(fluid_synth_t* synth)
+{
+  int result;
+  fluid_return_val_if_fail (synth != NULL, FLUID_FAILED);
+  fluid_synth_api_enter(synth);
+
+  result = synth->peak_voice_count;
+  FLUID_API_RETURN(result);
+}
+
 /**
  * Get the internal synthesis buffer size value.
  * @param synth FluidSynth instance
@@ -138,6 +138,7 @@ struct _fluid_synth_t
   int nvoice;                        /**< the length of the synthesis process array (max polyphony allowed) */
   fluid_voice_t** voice;             /**< the synthesis voices */
   int active_voice_count;            /**< count of active voices */
+  int peak_voice_count;              /**< highest active_voice_count so far */
   unsigned int noteid;               /**< the id is incremented for every new note. it's used for noteoff's  */
   unsigned int storeid;
   fluid_rvoice_eventhandler_t* eventhandler;
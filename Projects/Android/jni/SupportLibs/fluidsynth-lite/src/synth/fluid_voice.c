@@ -450,6 +450,8 @@ fluid_voice_mix (fluid_voice_t *voice, int count, fluid_real_t* dsp_buf,
  */
 void fluid_voice_start(fluid_voice_t* voice)
 {
+  fluid_synth_t* synth;
+
   /* The maximum volume of the loop is calculated and cached once for each
    * sample with its nominal loop settings. This happens, when the sample is used
    * for the first time.*/
@@ -461,7 +463,10 @@ void fluid_voice_start(fluid_voice_t* voice)
   voice->status = FLUID_VOICE_ON;
 
   /* Increment voice count */
-  voice->channel->synth->active_voice_count++;
+  synth = voice->channel->synth;
+  synth->active_voice_count++;
+  if (synth->active_voice_count > synth->peak_voice_count)
+    synth->peak_voice_count = synth->active_voice_count;
 }
 
 void 
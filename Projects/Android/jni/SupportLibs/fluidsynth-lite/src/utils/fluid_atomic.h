@@ -77,6 +77,8 @@ typedef volatile LONG atomic_float;
 #define fluid_atomic_int_set(atomic, val) InterlockedExchange((atomic), (val))
 #define fluid_atomic_int_exchange_and_add(atomic, add)  \
     InterlockedExchangeAdd((atomic), (add))
+#define fluid_atomic_int_compare_and_exchange(atomic, oldval, newval) \
+    (InterlockedCompareExchange((atomic), (newval), (oldval)) == (oldval))
 
 #define fluid_atomic_float_get(atomic) (*(FLOAT*)(atomic))
 
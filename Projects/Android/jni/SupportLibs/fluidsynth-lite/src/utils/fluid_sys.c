@@ -555,23 +555,28 @@ void fluid_clear_fpe_i386 (void)
 
 fluid_profile_data_t fluid_profile_data[] =
 {
-  { FLUID_PROF_WRITE,            "fluid_synth_write_*             ", 1e10, 0.0, 0.0, 0},
-  { FLUID_PROF_ONE_BLOCK,        "fluid_synth_one_block           ", 1e10, 0.0, 0.0, 0},
-  { FLUID_PROF_ONE_BLOCK_CLEAR,  "fluid_synth_one_block:clear     ", 1e10, 0.0, 0.0, 0},
-  { FLUID_PROF_ONE_BLOCK_VOICE,  "fluid_synth_one_block:one voice ", 1e10, 0.0, 0.0, 0},
-  { FLUID_PROF_ONE_BLOCK_VOICES, "fluid_synth_one_block:all voices", 1e10, 0.0, 0.0, 0},
-  { FLUID_PROF_ONE_BLOCK_REVERB, "fluid_synth_one_block:reverb    ", 1e10, 0.0, 0.0, 0},
-  { FLUID_PROF_ONE_BLOCK_CHORUS, "fluid_synth_one_block:chorus    ", 1e10, 0.0, 0.0, 0},
-  { FLUID_PROF_VOICE_NOTE,       "fluid_voice:note                ", 1e10, 0.0, 0.0, 0},
-  { FLUID_PROF_VOICE_RELEASE,    "fluid_voice:release             ", 1e10, 0.0, 0.0, 0},
-  { FLUID_PROF_LAST, "last", 1e100, 0.0, 0.0, 0}
+  { FLUID_PROF_WRITE,            "write",            "fluid_synth_write_*             ", 1e10, 0.0, 0.0, 0},
+  { FLUID_PROF_ONE_BLOCK,        "one_block",        "fluid_synth_one_block           ", 1e10, 0.0, 0.0, 0},
+  { FLUID_PROF_ONE_BLOCK_CLEAR,  "one_block_clear",  "fluid_synth_one_block:clear     ", 1e10, 0.0, 0.0, 0},
+  { FLUID_PROF_ONE_BLOCK_VOICE,  "one_block_voice",  "fluid_synth_one_block:one voice ", 1e10, 0.0, 0.0, 0},
+  { FLUID_PROF_ONE_BLOCK_VOICES, "one_block_voices", "fluid_synth_one_block:all voices", 1e10, 0.0, 0.0, 0},
+  { FLUID_PROF_ONE_BLOCK_REVERB, "one_block_reverb", "fluid_synth_one_block:reverb    ", 1e10, 0.0, 0.0, 0},
+  { FLUID_PROF_ONE_BLOCK_CHORUS, "one_block_chorus", "fluid_synth_one_block:chorus    ", 1e10, 0.0, 0.0, 0},
+  { FLUID_PROF_VOICE_NOTE,       "voice_note",       "fluid_voice:note                ", 1e10, 0.0, 0.0, 0},
+  { FLUID_PROF_VOICE_RELEASE,    "voice_release",    "fluid_voice:release             ", 1e10, 0.0, 0.0, 0},
+  { FLUID_PROF_LAST, "last", "last", 1e100, 0.0, 0.0, 0}
 };
 
+int fluid_profiling_active = 0;
+
 
 void fluid_profiling_print(void)
 {
   int i;
 
+  if (!fluid_profiling_active)
+    return;
+
   printf("fluid_profiling_print\n");
 
   FLUID_LOG(FLUID_INFO, "Estimated times: min/avg/max (micro seconds)");
@@ -592,6 +597,63 @@ void fluid_profiling_print(void)
 
 #endif /* WITH_PROFILING */
 
+/**
+ * Clear the timings collected so far and start collecting them.
+ * @return #FLUID_OK on success, #FLUID_FAILED if libfluidsynth was built
+ *   without profiling support
+ */
+int
+fluid_profiling_start(void)
+{
+#if WITH_PROFILING
+  int i;
+
+  for (i = 0; i < FLUID_PROF_LAST; i++) {
+    fluid_profile_data[i].min = 1e10;
+    fluid_profile_data[i].max = 0.0;
+    fluid_profile_data[i].total = 0.0;
+    fluid_profile_data[i].count = 0;
+  }
+  fluid_profiling_active = 1;
+  return FLUID_OK;
+#else
+  return FLUID_FAILED;
+#endif
+}
+
+/**
+ * Get the timings collected for one of the profiled pieces of code.
+ * @param num Profile number, counting up from 0
+ * @param name Location to store a short identifier of the profiled code
+ * @param min Location to store the shortest time in microseconds
+ * @param avg Location to store the average time in microseconds
+ * @param max Location to store the longest time in microseconds
+ * @param count Location to store the number of measurements
+ * @return #FLUID_OK on success, #FLUID_FAILED if \a num is out of range or
+ *   libfluidsynth was built without profiling support
+ */
+int
+fluid_profiling_get(int num, const char** name, double* min, double* avg,
+                    double* max, unsigned int* count)
+{
+#if WITH_PROFILING
+  fluid_profile_data_t* data;
+
+  if (num < 0 || num >= FLUID_PROF_LAST)
+    return FLUID_FAILED;
+
+  data = &fluid_profile_data[num];
+  if (name) *name = data->name;
+  if (min) *min = data->count > 0 ? data->min : 0.0;
+  if (avg) *avg = data->count > 0 ? data->total / data->count : 0.0;
+  if (max) *max = data->max;
+  if (count) *count = data->count;
+  return FLUID_OK;
+#else
+  return FLUID_FAILED;
+#endif
+}
+
 
 
 /***************************************************************
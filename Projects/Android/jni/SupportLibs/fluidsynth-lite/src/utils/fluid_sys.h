@@ -222,6 +222,9 @@ void delete_fluid_thread(fluid_thread_t* thread);
 void fluid_thread_self_set_prio (int prio_level);
 int fluid_thread_join(fluid_thread_t* thread);
 
+#include <sched.h>
+#define fluid_thread_yield()            sched_yield()
+
 #else
 
 static FLUID_INLINE void
@@ -317,6 +320,8 @@ void delete_fluid_thread(fluid_thread_t* thread);
 void fluid_thread_self_set_prio (int prio_level);
 int fluid_thread_join(fluid_thread_t* thread);
 
+#define fluid_thread_yield()            SwitchToThread()
+
 #endif /* HAVE_PTHREAD_H */
 
 static inline int
@@ -387,6 +392,7 @@ void fluid_profiling_print(void);
     piece of code. */
 typedef struct _fluid_profile_data_t {
   int num;
+  char* name;
   char* description;
   double min, max, total;
   unsigned int count;
@@ -394,23 +400,30 @@ typedef struct _fluid_profile_data_t {
 
 extern fluid_profile_data_t fluid_profile_data[];
 
+/** Set by fluid_profiling_start(). Until then the profiled code only pays
+    for testing it, so profiling support can stay compiled in. */
+extern int fluid_profiling_active;
+
 /** Macro to obtain a time refence used for the profiling */
-#define fluid_profile_ref() fluid_utime()
+#define fluid_profile_ref() (fluid_profiling_active ? fluid_utime() : 0.0)
 
 /** Macro to create a variable and assign the current reference time for profiling.
  * So we don't get unused variable warnings when profiling is disabled. */
-#define fluid_profile_ref_var(name)     double name = fluid_utime()
+#define fluid_profile_ref_var(name)     double name = fluid_profile_ref()
 
 /** Macro to calculate the min/avg/max. Needs a time refence and a
-    profile number. */
+    profile number. A reference taken before profiling started is 0 and
+    isn't counted. */
 #define fluid_profile(_num,_ref) { \
-  double _now = fluid_utime(); \
-  double _delta = _now - _ref; \
-  fluid_profile_data[_num].min = _delta < fluid_profile_data[_num].min ? _delta : fluid_profile_data[_num].min; \
-  fluid_profile_data[_num].max = _delta > fluid_profile_data[_num].max ? _delta : fluid_profile_data[_num].max; \
-  fluid_profile_data[_num].total += _delta; \
-  fluid_profile_data[_num].count++; \
-  _ref = _now; \
+  if (fluid_profiling_active && _ref > 0.0) { \
+    double _now = fluid_utime(); \
+    double _delta = _now - _ref; \
+    fluid_profile_data[_num].min = _delta < fluid_profile_data[_num].min ? _delta : fluid_profile_data[_num].min; \
+    fluid_profile_data[_num].max = _delta > fluid_profile_data[_num].max ? _delta : fluid_profile_data[_num].max; \
+    fluid_profile_data[_num].total += _delta; \
+    fluid_profile_data[_num].count++; \
+    _ref = _now; \
+  } \
 }
 
 
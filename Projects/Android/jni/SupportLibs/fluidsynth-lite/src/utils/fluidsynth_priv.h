@@ -78,6 +78,10 @@
 #include <fcntl.h>
 #endif
 
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
 #if HAVE_SYS_TYPES_H
 #include <sys/types.h>
 #endif
@@ -134,6 +138,15 @@ typedef float fluid_real_t;
 typedef double fluid_real_t;
 #endif
 
+/* 4 wide vectors through the GCC/clang vector extensions, which get lowered
+ * to NEON or SSE2. With doubles a vector only holds two values and isn't
+ * worth the trouble, so this needs WITH_FLOAT. */
+#if defined(WITH_FLOAT) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 12)) \
+    && (defined(__ARM_NEON) || defined(__SSE2__)) && !defined(FLUID_NO_SIMD)
+#define FLUID_SIMD 1
+typedef fluid_real_t fluid_real4_t __attribute__((vector_size(4 * sizeof(fluid_real_t))));
+#endif
+
 #if defined(SUPPORTS_VLA)
 #  define FLUID_DECLARE_VLA(_type, _name, _len) \
      _type _name[_len]
@@ -181,6 +194,15 @@ typedef struct _fluid_sample_timer_t fluid_sample_timer_t;
 #define FLUID_DEFAULT_AUDIO_RT_PRIO  60         /**< Default setting for audio.realtime-prio */
 #define FLUID_DEFAULT_MIDI_RT_PRIO   50         /**< Default setting for midi.realtime-prio */
 
+/* Default setting for synth.lock-memory. Android maps the sample data
+   (synth.mmap-samples) so that the kernel can drop pages of it under memory
+   pressure; if the mapping fails, don't pin the whole bank instead. */
+#ifdef __ANDROID__
+#define FLUID_DEFAULT_LOCK_MEMORY    0
+#else
+#define FLUID_DEFAULT_LOCK_MEMORY    1
+#endif
+
 #ifndef PI
 #define PI                          3.141592654
 #endif
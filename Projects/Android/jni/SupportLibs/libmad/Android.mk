@@ -12,6 +12,16 @@ LOCAL_SRC_FILES := version.c fixed.c bit.c timer.c stream.c frame.c  \
 
 LOCAL_CFLAGS           := -Wall -DHAVE_CONFIG_H -DFPM_DEFAULT
 
+# SSE2/NEON synthesis filterbank and long block IMDCT (bit-exact with the C code)
+ifneq ($(filter arm64-v8a armeabi-v7a x86 x86_64,$(TARGET_ARCH_ABI)),)
+LOCAL_CFLAGS           += -DASO_SIMD
+LOCAL_SRC_FILES        += synth_simd.c imdct_simd.c
+endif
+
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_ARM_NEON         := true
+endif
+
 include $(BUILD_STATIC_LIBRARY)
 
 
@@ -42,6 +42,10 @@
 #  define OPT_SSO
 # endif
 
+# if defined(ASO_SIMD) && !defined(ASO_SYNTH)
+#  define ASO_SYNTH
+# endif
+
 # if defined(HAVE_UNISTD_H) && defined(HAVE_WAITPID) &&  \
     defined(HAVE_FCNTL) && defined(HAVE_PIPE) && defined(HAVE_FORK)
 #  define USE_ASYNC
@@ -0,0 +1,360 @@
+/*
+ * libmad - MPEG audio decoder library
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+# ifdef HAVE_CONFIG_H
+#  include "config.h"
+# endif
+
+# include "global.h"
+
+# include "fixed.h"
+# include "simd.h"
+
+/*
+ * This is the ASO_SIMD version of the long block path of III_decode() in
+ * layer3.c: IMDCT, windowing, overlap-add and frequency inversion of four
+ * subbands at once, one subband in each vector lane. The steps are those
+ * of III_imdct_l(), III_overlap() and III_freqinver() with the same
+ * fixed-point arithmetic, so the samples are identical to the C code.
+ */
+
+# define MUL(x, y)	v_mulf((x), (y))
+
+/*
+ * windowing coefficients for long blocks
+ * derived from section 2.4.3.4.10.3 of ISO/IEC 11172-3
+ *
+ * window_l[i] = sin((PI / 36) * (i + 1/2))
+ */
+static
+mad_fixed_t const window_l[36] = {
+  MAD_F(0x00b2aa3e) /* 0.043619387 */, MAD_F(0x0216a2a2) /* 0.130526192 */,
+  MAD_F(0x03768962) /* 0.216439614 */, MAD_F(0x04cfb0e2) /* 0.300705800 */,
+  MAD_F(0x061f78aa) /* 0.382683432 */, MAD_F(0x07635284) /* 0.461748613 */,
+  MAD_F(0x0898c779) /* 0.537299608 */, MAD_F(0x09bd7ca0) /* 0.608761429 */,
+  MAD_F(0x0acf37ad) /* 0.675590208 */, MAD_F(0x0bcbe352) /* 0.737277337 */,
+  MAD_F(0x0cb19346) /* 0.793353340 */, MAD_F(0x0d7e8807) /* 0.843391446 */,
+
+  MAD_F(0x0e313245) /* 0.887010833 */, MAD_F(0x0ec835e8) /* 0.923879533 */,
+  MAD_F(0x0f426cb5) /* 0.953716951 */, MAD_F(0x0f9ee890) /* 0.976296007 */,
+  MAD_F(0x0fdcf549) /* 0.991444861 */, MAD_F(0x0ffc19fd) /* 0.999048222 */,
+  MAD_F(0x0ffc19fd) /* 0.999048222 */, MAD_F(0x0fdcf549) /* 0.991444861 */,
+  MAD_F(0x0f9ee890) /* 0.976296007 */, MAD_F(0x0f426cb5) /* 0.953716951 */,
+  MAD_F(0x0ec835e8) /* 0.923879533 */, MAD_F(0x0e313245) /* 0.887010833 */,
+
+  MAD_F(0x0d7e8807) /* 0.843391446 */, MAD_F(0x0cb19346) /* 0.793353340 */,
+  MAD_F(0x0bcbe352) /* 0.737277337 */, MAD_F(0x0acf37ad) /* 0.675590208 */,
+  MAD_F(0x09bd7ca0) /* 0.608761429 */, MAD_F(0x0898c779) /* 0.537299608 */,
+  MAD_F(0x07635284) /* 0.461748613 */, MAD_F(0x061f78aa) /* 0.382683432 */,
+  MAD_F(0x04cfb0e2) /* 0.300705800 */, MAD_F(0x03768962) /* 0.216439614 */,
+  MAD_F(0x0216a2a2) /* 0.130526192 */, MAD_F(0x00b2aa3e) /* 0.043619387 */,
+};
+
+/*
+ * windowing coefficients for short blocks
+ * derived from section 2.4.3.4.10.3 of ISO/IEC 11172-3
+ *
+ * window_s[i] = sin((PI / 12) * (i + 1/2))
+ */
+static
+mad_fixed_t const window_s[12] = {
+  MAD_F(0x0216a2a2) /* 0.130526192 */, MAD_F(0x061f78aa) /* 0.382683432 */,
+  MAD_F(0x09bd7ca0) /* 0.608761429 */, MAD_F(0x0cb19346) /* 0.793353340 */,
+  MAD_F(0x0ec835e8) /* 0.923879533 */, MAD_F(0x0fdcf549) /* 0.991444861 */,
+  MAD_F(0x0fdcf549) /* 0.991444861 */, MAD_F(0x0ec835e8) /* 0.923879533 */,
+  MAD_F(0x0cb19346) /* 0.793353340 */, MAD_F(0x09bd7ca0) /* 0.608761429 */,
+  MAD_F(0x061f78aa) /* 0.382683432 */, MAD_F(0x0216a2a2) /* 0.130526192 */,
+};
+
+static
+void fastsdct(mad_vfixed_t const x[9], mad_vfixed_t y[17])
+{
+  mad_vfixed_t a0,  a1,  a2,  a3,  a4,  a5,  a6,  a7,  a8,  a9,  a10, a11, a12;
+  mad_vfixed_t a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25;
+  mad_vfixed_t m0,  m1,  m2,  m3,  m4,  m5,  m6,  m7;
+
+  enum {
+    c0 =  MAD_F(0x1f838b8d),  /* 2 * cos( 1 * PI / 18) */
+    c1 =  MAD_F(0x1bb67ae8),  /* 2 * cos( 3 * PI / 18) */
+    c2 =  MAD_F(0x18836fa3),  /* 2 * cos( 4 * PI / 18) */
+    c3 =  MAD_F(0x1491b752),  /* 2 * cos( 5 * PI / 18) */
+    c4 =  MAD_F(0x0af1d43a),  /* 2 * cos( 7 * PI / 18) */
+    c5 =  MAD_F(0x058e86a0),  /* 2 * cos( 8 * PI / 18) */
+    c6 = -MAD_F(0x1e11f642)   /* 2 * cos(16 * PI / 18) */
+  };
+
+  a0 = v_add(x[3], x[5]);
+  a1 = v_sub(x[3], x[5]);
+  a2 = v_add(x[6], x[2]);
+  a3 = v_sub(x[6], x[2]);
+  a4 = v_add(x[1], x[7]);
+  a5 = v_sub(x[1], x[7]);
+  a6 = v_add(x[8], x[0]);
+  a7 = v_sub(x[8], x[0]);
+
+  a8  = v_add(a0,  a2);
+  a9  = v_sub(a0,  a2);
+  a10 = v_sub(a0,  a6);
+  a11 = v_sub(a2,  a6);
+  a12 = v_add(a8,  a6);
+  a13 = v_sub(a1,  a3);
+  a14 = v_add(a13, a7);
+  a15 = v_add(a3,  a7);
+  a16 = v_sub(a1,  a7);
+  a17 = v_add(a1,  a3);
+
+  m0 = MUL(a17, -c3);
+  m1 = MUL(a16, -c0);
+  m2 = MUL(a15, -c4);
+  m3 = MUL(a14, -c1);
+  m4 = MUL(a5,  -c1);
+  m5 = MUL(a11, -c6);
+  m6 = MUL(a10, -c5);
+  m7 = MUL(a9,  -c2);
+
+  a18 = v_add(x[4], a4);
+  a19 = v_sub(v_shl(x[4], 1), a4);
+  a20 = v_add(a19, m5);
+  a21 = v_sub(a19, m5);
+  a22 = v_add(a19, m6);
+  a23 = v_add(m4,  m2);
+  a24 = v_sub(m4,  m2);
+  a25 = v_add(m4,  m1);
+
+  /* output to every other slot for convenience */
+
+  y[ 0] = v_add(a18, a12);
+  y[ 2] = v_sub(m0,  a25);
+  y[ 4] = v_sub(m7,  a20);
+  y[ 6] = m3;
+  y[ 8] = v_sub(a21, m6);
+  y[10] = v_sub(a24, m1);
+  y[12] = v_sub(a12, v_shl(a18, 1));
+  y[14] = v_add(a23, m0);
+  y[16] = v_add(a22, m7);
+}
+
+static inline
+void sdctII(mad_vfixed_t const x[18], mad_vfixed_t X[18])
+{
+  mad_vfixed_t tmp[9];
+  int i;
+
+  /* scale[i] = 2 * cos(PI * (2 * i + 1) / (2 * 18)) */
+  static mad_fixed_t const scale[9] = {
+    MAD_F(0x1fe0d3b4), MAD_F(0x1ee8dd47), MAD_F(0x1d007930),
+    MAD_F(0x1a367e59), MAD_F(0x16a09e66), MAD_F(0x125abcf8),
+    MAD_F(0x0d8616bc), MAD_F(0x08483ee1), MAD_F(0x02c9fad7)
+  };
+
+  /* divide the 18-point SDCT-II into two 9-point SDCT-IIs */
+
+  /* even input butterfly */
+
+  for (i = 0; i < 9; ++i)
+    tmp[i] = v_add(x[i], x[18 - i - 1]);
+
+  fastsdct(tmp, &X[0]);
+
+  /* odd input butterfly and scaling */
+
+  for (i = 0; i < 9; ++i)
+    tmp[i] = MUL(v_sub(x[i], x[18 - i - 1]), scale[i]);
+
+  fastsdct(tmp, &X[1]);
+
+  /* output accumulation */
+
+  for (i = 3; i < 18; i += 2)
+    X[i] = v_sub(X[i], X[i - 2]);
+}
+
+static inline
+void dctIV(mad_vfixed_t const y[18], mad_vfixed_t X[18])
+{
+  mad_vfixed_t tmp[18];
+  int i;
+
+  /* scale[i] = 2 * cos(PI * (2 * i + 1) / (4 * 18)) */
+  static mad_fixed_t const scale[18] = {
+    MAD_F(0x1ff833fa), MAD_F(0x1fb9ea93), MAD_F(0x1f3dd120),
+    MAD_F(0x1e84d969), MAD_F(0x1d906bcf), MAD_F(0x1c62648b),
+    MAD_F(0x1afd100f), MAD_F(0x1963268b), MAD_F(0x1797c6a4),
+    MAD_F(0x159e6f5b), MAD_F(0x137af940), MAD_F(0x11318ef3),
+    MAD_F(0x0ec6a507), MAD_F(0x0c3ef153), MAD_F(0x099f61c5),
+    MAD_F(0x06ed12c5), MAD_F(0x042d4544), MAD_F(0x0165547c)
+  };
+
+  /* scaling */
+
+  for (i = 0; i < 18; ++i)
+    tmp[i] = MUL(y[i], scale[i]);
+
+  /* SDCT-II */
+
+  sdctII(tmp, X);
+
+  /* scale reduction and output accumulation */
+
+  X[0] = v_div2(X[0]);
+  for (i = 1; i < 18; ++i)
+    X[i] = v_sub(v_div2(X[i]), X[i - 1]);
+}
+
+/*
+ * NAME:	imdct36
+ * DESCRIPTION:	perform X[18]->x[36] IMDCT using Szu-Wei Lee's fast algorithm
+ */
+static inline
+void imdct36(mad_vfixed_t const x[18], mad_vfixed_t y[36])
+{
+  mad_vfixed_t tmp[18];
+  int i;
+
+  /* DCT-IV */
+
+  dctIV(x, tmp);
+
+  /* convert 18-point DCT-IV to 36-point IMDCT */
+
+  for (i =  0; i <  9; ++i)
+    y[i] =  tmp[9 + i];
+  for (i =  9; i < 27; ++i)
+    y[i] = v_neg(tmp[36 - (9 + i) - 1]);
+  for (i = 27; i < 36; ++i)
+    y[i] = v_neg(tmp[i - 27]);
+}
+
+/*
+ * NAME:	transpose()
+ * DESCRIPTION:	move 18 values of four subbands into or out of vector lanes
+ */
+static
+void load_x4(mad_vfixed_t v[18], mad_fixed_t const *x)
+{
+  mad_fixed_t tail[2][4];
+  int i;
+
+  for (i = 0; i < 16; i += 4) {
+    v[i + 0] = v_load(&x[0 * 18 + i]);
+    v[i + 1] = v_load(&x[1 * 18 + i]);
+    v[i + 2] = v_load(&x[2 * 18 + i]);
+    v[i + 3] = v_load(&x[3 * 18 + i]);
+
+    v_transpose4(v[i + 0], v[i + 1], v[i + 2], v[i + 3]);
+  }
+
+  for (i = 0; i < 4; ++i) {
+    tail[0][i] = x[i * 18 + 16];
+    tail[1][i] = x[i * 18 + 17];
+  }
+
+  v[16] = v_load(tail[0]);
+  v[17] = v_load(tail[1]);
+}
+
+static
+void store_x4(mad_fixed_t *x, mad_vfixed_t const v[18])
+{
+  mad_vfixed_t t0, t1, t2, t3;
+  mad_fixed_t tail[2][4];
+  int i;
+
+  for (i = 0; i < 16; i += 4) {
+    t0 = v[i + 0];
+    t1 = v[i + 1];
+    t2 = v[i + 2];
+    t3 = v[i + 3];
+
+    v_transpose4(t0, t1, t2, t3);
+
+    v_store(&x[0 * 18 + i], t0);
+    v_store(&x[1 * 18 + i], t1);
+    v_store(&x[2 * 18 + i], t2);
+    v_store(&x[3 * 18 + i], t3);
+  }
+
+  v_store(tail[0], v[16]);
+  v_store(tail[1], v[17]);
+
+  for (i = 0; i < 4; ++i) {
+    x[i * 18 + 16] = tail[0][i];
+    x[i * 18 + 17] = tail[1][i];
+  }
+}
+
+/*
+ * NAME:	III_imdct_l4()
+ * DESCRIPTION:	perform IMDCT, windowing, overlap-add and frequency
+ *		inversion for four subbands of long blocks
+ */
+void III_imdct_l4(mad_fixed_t const X[4 * 18], mad_fixed_t overlap[4][18],
+		  mad_fixed_t sample[18][32], unsigned int sb,
+		  unsigned int block_type)
+{
+  mad_vfixed_t x[18], z[36], odd;
+  mad_fixed_t lanes[4];
+  unsigned int i;
+
+  /* IMDCT */
+
+  load_x4(x, X);
+  imdct36(x, z);
+
+  /* windowing */
+
+  switch (block_type) {
+  case 0:  /* normal window */
+    for (i =  0; i < 36; ++i) z[i] = MUL(z[i], window_l[i]);
+    break;
+
+  case 1:  /* start block */
+    for (i =  0; i < 18; ++i) z[i] = MUL(z[i], window_l[i]);
+    /*  (i = 18; i < 24; ++i) z[i] unchanged */
+    for (i = 24; i < 30; ++i) z[i] = MUL(z[i], window_s[i - 18]);
+    for (i = 30; i < 36; ++i) z[i] = v_set(0);
+    break;
+
+  case 3:  /* stop block */
+    for (i =  0; i <  6; ++i) z[i] = v_set(0);
+    for (i =  6; i < 12; ++i) z[i] = MUL(z[i], window_s[i - 6]);
+    /*  (i = 12; i < 18; ++i) z[i] unchanged */
+    for (i = 18; i < 36; ++i) z[i] = MUL(z[i], window_l[i]);
+    break;
+  }
+
+  /* overlap-add */
+
+  load_x4(x, &overlap[0][0]);
+  for (i = 0; i < 18; ++i)
+    x[i] = v_add(z[i], x[i]);
+
+  store_x4(&overlap[0][0], &z[18]);
+
+  /* frequency inversion of the odd subbands, as (x ^ -1) - -1 */
+
+  for (i = 0; i < 4; ++i)
+    lanes[i] = -((sb + i) & 1);
+  odd = v_load(lanes);
+
+  for (i = 1; i < 18; i += 2)
+    x[i] = v_sub(v_xor(x[i], odd), odd);
+
+  for (i = 0; i < 18; ++i)
+    v_store(&sample[i][sb], x[i]);
+}
@@ -1572,6 +1572,11 @@ void III_aliasreduce(mad_fixed_t xr[576], int lines)
   }
 }
 
+# if defined(ASO_SIMD)
+void III_imdct_l4(mad_fixed_t const [4 * 18], mad_fixed_t [4][18],
+		  mad_fixed_t [18][32], unsigned int, unsigned int);
+# endif
+
 # if defined(ASO_IMDCT)
 void III_imdct_l(mad_fixed_t const [18], mad_fixed_t [36], unsigned int);
 # else
@@ -2476,7 +2481,14 @@ enum mad_error III_decode(struct mad_bitptr *ptr, struct mad_frame *frame,
 
       if (channel->block_type != 2) {
 	/* long blocks */
-	for (sb = 2; sb < sblimit; ++sb, l += 18) {
+	sb = 2;
+# if defined(ASO_SIMD)
+	for (; sb + 4 <= sblimit; sb += 4, l += 4 * 18) {
+	  III_imdct_l4(&xr[ch][l], &(*frame->overlap)[ch][sb], sample, sb,
+		       channel->block_type);
+	}
+# endif
+	for (; sb < sblimit; ++sb, l += 18) {
 	  III_imdct_l(&xr[ch][l], output, channel->block_type);
 	  III_overlap(output, (*frame->overlap)[ch][sb], sample, sb);
 
@@ -0,0 +1,180 @@
+/*
+ * libmad - MPEG audio decoder library
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+
+# include "mad.h"
+
+/*
+ * This is a small benchmark for the MAD low-level API. The whole file is
+ * read into memory and decoded one or more times, timing frame decoding
+ * (mad_frame_decode) and subband synthesis (mad_synth_frame) separately.
+ * A checksum of the synthesized samples is printed so that the output of
+ * different builds (e.g. with and without ASO_SIMD) can be compared; the
+ * samples of the first pass can also be written out raw, as native-endian
+ * mad_fixed_t values with the channels of each frame one after the other.
+ */
+
+static
+double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static
+void usage(char const *name)
+{
+  fprintf(stderr, "Usage: %s [-p passes] [-o output.raw] input.mp3\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+  struct mad_stream stream;
+  struct mad_frame frame;
+  struct mad_synth synth;
+  char const *inname = 0, *outname = 0;
+  FILE *file, *out = 0;
+  unsigned char *data;
+  long length;
+  unsigned int passes = 4, pass;
+  unsigned long frames = 0, samples = 0, errors = 0;
+  unsigned long checksum = 2166136261UL;
+  double t0, t1, t2, tdecode = 0, tsynth = 0;
+  int i;
+
+  for (i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+      passes = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      outname = argv[++i];
+    else if (argv[i][0] != '-' && !inname)
+      inname = argv[i];
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (!inname || passes == 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  file = fopen(inname, "rb");
+  if (!file) {
+    perror(inname);
+    return 2;
+  }
+
+  fseek(file, 0, SEEK_END);
+  length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  /* the stream needs MAD_BUFFER_GUARD zero bytes after the last frame */
+
+  data = calloc(length + MAD_BUFFER_GUARD, 1);
+  if (!data || fread(data, 1, length, file) != (size_t) length) {
+    fprintf(stderr, "%s: read failed\n", inname);
+    return 2;
+  }
+  fclose(file);
+
+  if (outname && !(out = fopen(outname, "wb"))) {
+    perror(outname);
+    return 3;
+  }
+
+  for (pass = 0; pass < passes; ++pass) {
+    mad_stream_init(&stream);
+    mad_frame_init(&frame);
+    mad_synth_init(&synth);
+
+    mad_stream_buffer(&stream, data, length + MAD_BUFFER_GUARD);
+
+    while (1) {
+      unsigned int ch, s;
+
+      t0 = now();
+      if (mad_frame_decode(&frame, &stream) == -1) {
+	if (MAD_RECOVERABLE(stream.error)) {
+	  if (pass == 0 && stream.error != MAD_ERROR_LOSTSYNC)
+	    ++errors;
+	  continue;
+	}
+	break;
+      }
+      t1 = now();
+      mad_synth_frame(&synth, &frame);
+      t2 = now();
+
+      tdecode += t1 - t0;
+      tsynth  += t2 - t1;
+
+      if (pass > 0)
+	continue;
+
+      ++frames;
+      samples += synth.pcm.length;
+
+      for (ch = 0; ch < synth.pcm.channels; ++ch) {
+	for (s = 0; s < synth.pcm.length; ++s) {
+	  unsigned long sample = (unsigned long) synth.pcm.samples[ch][s];
+
+	  checksum = ((checksum ^ ((sample >>  0) & 0xff)) * 16777619UL) & 0xffffffffUL;
+	  checksum = ((checksum ^ ((sample >>  8) & 0xff)) * 16777619UL) & 0xffffffffUL;
+	  checksum = ((checksum ^ ((sample >> 16) & 0xff)) * 16777619UL) & 0xffffffffUL;
+	  checksum = ((checksum ^ ((sample >> 24) & 0xff)) * 16777619UL) & 0xffffffffUL;
+	}
+
+	if (out)
+	  fwrite(synth.pcm.samples[ch], sizeof(mad_fixed_t), synth.pcm.length, out);
+      }
+    }
+
+    mad_synth_finish(&synth);
+    mad_frame_finish(&frame);
+    mad_stream_finish(&stream);
+  }
+
+  if (out)
+    fclose(out);
+  free(data);
+
+  if (frames == 0) {
+    fprintf(stderr, "%s: no frames decoded\n", inname);
+    return 4;
+  }
+
+  printf("build:    %s\n", mad_build);
+  printf("input:    %lu frames, %lu samples per channel, %lu errors\n",
+	 frames, samples, errors);
+  printf("decode:   %8.2f us per frame\n", tdecode * 1e6 / (frames * passes));
+  printf("synth:    %8.2f us per frame\n", tsynth * 1e6 / (frames * passes));
+  printf("total:    %8.2f us per frame, %lu passes\n",
+	 (tdecode + tsynth) * 1e6 / (frames * passes), (unsigned long) passes);
+  printf("checksum: %08lx\n", checksum);
+
+  return 0;
+}
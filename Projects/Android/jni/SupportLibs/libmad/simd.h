@@ -0,0 +1,162 @@
+/*
+ * libmad - MPEG audio decoder library
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+# ifndef LIBMAD_SIMD_H
+# define LIBMAD_SIMD_H
+
+# include "fixed.h"
+
+/*
+ * Four-lane vectors of mad_fixed_t for the ASO_SIMD routines. Everything is
+ * done with 32-bit integer lanes, wrapping the same way the FPM_DEFAULT C
+ * code does, so that the vector routines give exactly the same samples.
+ */
+
+# if !defined(FPM_DEFAULT)
+#  error "ASO_SIMD requires FPM_DEFAULT"
+# endif
+
+# if defined(__SSE2__)
+
+#  include <emmintrin.h>
+#  if defined(__SSE4_1__)
+#   include <smmintrin.h>
+#  endif
+
+typedef __m128i mad_vfixed_t;
+
+#  define v_load(p)	_mm_loadu_si128((__m128i const *) (p))
+#  define v_store(p, x)	_mm_storeu_si128((__m128i *) (p), (x))
+#  define v_set(x)	_mm_set1_epi32(x)
+#  define v_add(x, y)	_mm_add_epi32((x), (y))
+#  define v_sub(x, y)	_mm_sub_epi32((x), (y))
+#  define v_neg(x)	_mm_sub_epi32(_mm_setzero_si128(), (x))
+#  define v_xor(x, y)	_mm_xor_si128((x), (y))
+#  define v_shl(x, n)	_mm_slli_epi32((x), (n))
+#  define v_shr(x, n)	_mm_srai_epi32((x), (n))
+
+/* ((x + (1 << (n - 1))) >> n) without overflowing the lane */
+#  define v_rshr(x, n)	_mm_srai_epi32(_mm_add_epi32(  \
+			  _mm_srai_epi32((x), (n) - 1), _mm_set1_epi32(1)), 1)
+
+/* x / 2, rounding towards zero like the C operator */
+#  define v_div2(x)	_mm_srai_epi32(_mm_add_epi32((x),  \
+			  _mm_srli_epi32((x), 31)), 1)
+
+static inline
+mad_vfixed_t v_mul(mad_vfixed_t x, mad_vfixed_t y)
+{
+#  if defined(__SSE4_1__)
+  return _mm_mullo_epi32(x, y);
+#  else
+  __m128i even, odd;
+
+  even = _mm_mul_epu32(x, y);
+  odd  = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(y, 32));
+
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+			    _mm_shuffle_epi32(odd,  _MM_SHUFFLE(0, 0, 2, 0)));
+#  endif
+}
+
+/* lane i of the result is the sum of the lanes of the i-th argument */
+static inline
+mad_vfixed_t v_hsum4(mad_vfixed_t a, mad_vfixed_t b,
+		     mad_vfixed_t c, mad_vfixed_t d)
+{
+  __m128i ab, cd;
+
+  ab = _mm_add_epi32(_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b));
+  cd = _mm_add_epi32(_mm_unpacklo_epi32(c, d), _mm_unpackhi_epi32(c, d));
+
+  return _mm_add_epi32(_mm_unpacklo_epi64(ab, cd), _mm_unpackhi_epi64(ab, cd));
+}
+
+#  define v_transpose4(a, b, c, d)  \
+    do {  \
+      __m128i t0_ = _mm_unpacklo_epi32((a), (b));  \
+      __m128i t1_ = _mm_unpacklo_epi32((c), (d));  \
+      __m128i t2_ = _mm_unpackhi_epi32((a), (b));  \
+      __m128i t3_ = _mm_unpackhi_epi32((c), (d));  \
+      (a) = _mm_unpacklo_epi64(t0_, t1_);  \
+      (b) = _mm_unpackhi_epi64(t0_, t1_);  \
+      (c) = _mm_unpacklo_epi64(t2_, t3_);  \
+      (d) = _mm_unpackhi_epi64(t2_, t3_);  \
+    } while (0)
+
+# elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+#  include <arm_neon.h>
+
+typedef int32x4_t mad_vfixed_t;
+
+#  define v_load(p)	vld1q_s32(p)
+#  define v_store(p, x)	vst1q_s32((p), (x))
+#  define v_set(x)	vdupq_n_s32(x)
+#  define v_add(x, y)	vaddq_s32((x), (y))
+#  define v_sub(x, y)	vsubq_s32((x), (y))
+#  define v_neg(x)	vnegq_s32(x)
+#  define v_xor(x, y)	veorq_s32((x), (y))
+#  define v_shl(x, n)	vshlq_n_s32((x), (n))
+#  define v_shr(x, n)	vshrq_n_s32((x), (n))
+#  define v_rshr(x, n)	vrshrq_n_s32((x), (n))
+#  define v_mul(x, y)	vmulq_s32((x), (y))
+#  define v_div2(x)	vshrq_n_s32(vaddq_s32((x), vreinterpretq_s32_u32(  \
+			  vshrq_n_u32(vreinterpretq_u32_s32(x), 31))), 1)
+
+static inline
+mad_vfixed_t v_hsum4(mad_vfixed_t a, mad_vfixed_t b,
+		     mad_vfixed_t c, mad_vfixed_t d)
+{
+#  if defined(__aarch64__)
+  return vpaddq_s32(vpaddq_s32(a, b), vpaddq_s32(c, d));
+#  else
+  int32x2_t ab, cd;
+
+  ab = vpadd_s32(vpadd_s32(vget_low_s32(a), vget_high_s32(a)),
+		 vpadd_s32(vget_low_s32(b), vget_high_s32(b)));
+  cd = vpadd_s32(vpadd_s32(vget_low_s32(c), vget_high_s32(c)),
+		 vpadd_s32(vget_low_s32(d), vget_high_s32(d)));
+
+  return vcombine_s32(ab, cd);
+#  endif
+}
+
+#  define v_transpose4(a, b, c, d)  \
+    do {  \
+      int32x4x2_t ab_ = vtrnq_s32((a), (b));  \
+      int32x4x2_t cd_ = vtrnq_s32((c), (d));  \
+      (a) = vcombine_s32(vget_low_s32(ab_.val[0]),  \
+			 vget_low_s32(cd_.val[0]));  \
+      (b) = vcombine_s32(vget_low_s32(ab_.val[1]),  \
+			 vget_low_s32(cd_.val[1]));  \
+      (c) = vcombine_s32(vget_high_s32(ab_.val[0]),  \
+			 vget_high_s32(cd_.val[0]));  \
+      (d) = vcombine_s32(vget_high_s32(ab_.val[1]),  \
+			 vget_high_s32(cd_.val[1]));  \
+    } while (0)
+
+# else
+#  error "ASO_SIMD requires SSE2 or NEON"
+# endif
+
+/* mad_f_mul() */
+# define v_mulf(x, y)  \
+    v_mul(v_rshr((x), 12), v_set((mad_fixed_t) (((y) + (1L << 15)) >> 16)))
+
+# endif
@@ -0,0 +1,535 @@
+/*
+ * libmad - MPEG audio decoder library
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+# ifdef HAVE_CONFIG_H
+#  include "config.h"
+# endif
+
+# include "global.h"
+
+# include "fixed.h"
+# include "frame.h"
+# include "synth.h"
+# include "simd.h"
+
+/*
+ * This is the ASO_SIMD version of synth_full() from synth.c. The DCT is
+ * done for four time slots at once, one slot in each vector lane, and each
+ * PCM sample is then a pair of 8-element vector products of filter rows
+ * with the regrouped coefficients in D_simd.dat. The arithmetic is that of
+ * the OPT_SSO FPM_DEFAULT C code, wrapping the same way, so the samples
+ * are identical to those of synth.c.
+ */
+
+/* costab[i] = cos(PI / (2 * 32) * i) */
+
+# define costab1	MAD_F(0x0ffb10f2)  /* 0.998795456 */
+# define costab2	MAD_F(0x0fec46d2)  /* 0.995184727 */
+# define costab3	MAD_F(0x0fd3aac0)  /* 0.989176510 */
+# define costab4	MAD_F(0x0fb14be8)  /* 0.980785280 */
+# define costab5	MAD_F(0x0f853f7e)  /* 0.970031253 */
+# define costab6	MAD_F(0x0f4fa0ab)  /* 0.956940336 */
+# define costab7	MAD_F(0x0f109082)  /* 0.941544065 */
+# define costab8	MAD_F(0x0ec835e8)  /* 0.923879533 */
+# define costab9	MAD_F(0x0e76bd7a)  /* 0.903989293 */
+# define costab10	MAD_F(0x0e1c5979)  /* 0.881921264 */
+# define costab11	MAD_F(0x0db941a3)  /* 0.857728610 */
+# define costab12	MAD_F(0x0d4db315)  /* 0.831469612 */
+# define costab13	MAD_F(0x0cd9f024)  /* 0.803207531 */
+# define costab14	MAD_F(0x0c5e4036)  /* 0.773010453 */
+# define costab15	MAD_F(0x0bdaef91)  /* 0.740951125 */
+# define costab16	MAD_F(0x0b504f33)  /* 0.707106781 */
+# define costab17	MAD_F(0x0abeb49a)  /* 0.671558955 */
+# define costab18	MAD_F(0x0a267993)  /* 0.634393284 */
+# define costab19	MAD_F(0x0987fbfe)  /* 0.595699304 */
+# define costab20	MAD_F(0x08e39d9d)  /* 0.555570233 */
+# define costab21	MAD_F(0x0839c3cd)  /* 0.514102744 */
+# define costab22	MAD_F(0x078ad74e)  /* 0.471396737 */
+# define costab23	MAD_F(0x06d74402)  /* 0.427555093 */
+# define costab24	MAD_F(0x061f78aa)  /* 0.382683432 */
+# define costab25	MAD_F(0x0563e69d)  /* 0.336889853 */
+# define costab26	MAD_F(0x04a5018c)  /* 0.290284677 */
+# define costab27	MAD_F(0x03e33f2f)  /* 0.242980180 */
+# define costab28	MAD_F(0x031f1708)  /* 0.195090322 */
+# define costab29	MAD_F(0x0259020e)  /* 0.146730474 */
+# define costab30	MAD_F(0x01917a6c)  /* 0.098017140 */
+# define costab31	MAD_F(0x00c8fb30)  /* 0.049067674 */
+
+/* second SSO shift, with rounding */
+
+# define SHIFT(x)	v_rshr((x), 12)
+
+# define MUL(x, y)	v_mulf((x), (y))
+
+/* (x * 2) - y */
+
+# define DSUB(x, y)	v_sub(v_shl((x), 1), (y))
+
+/*
+ * NAME:	dct32_x4()
+ * DESCRIPTION:	perform fast in[32]->out[32] DCT of four time slots
+ */
+static
+void dct32_x4(mad_vfixed_t const in[32],
+	      mad_fixed_t lo[16][4], mad_fixed_t hi[16][4])
+{
+  mad_vfixed_t t0,   t1,   t2,   t3,   t4,   t5,   t6,   t7;
+  mad_vfixed_t t8,   t9,   t10,  t11,  t12,  t13,  t14,  t15;
+  mad_vfixed_t t16,  t17,  t18,  t19,  t20,  t21,  t22,  t23;
+  mad_vfixed_t t24,  t25,  t26,  t27,  t28,  t29,  t30,  t31;
+  mad_vfixed_t t32,  t33,  t34,  t35,  t36,  t37,  t38,  t39;
+  mad_vfixed_t t40,  t41,  t42,  t43,  t44,  t45,  t46,  t47;
+  mad_vfixed_t t48,  t49,  t50,  t51,  t52,  t53,  t54,  t55;
+  mad_vfixed_t t56,  t57,  t58,  t59,  t60,  t61,  t62,  t63;
+  mad_vfixed_t t64,  t65,  t66,  t67,  t68,  t69,  t70,  t71;
+  mad_vfixed_t t72,  t73,  t74,  t75,  t76,  t77,  t78,  t79;
+  mad_vfixed_t t80,  t81,  t82,  t83,  t84,  t85,  t86,  t87;
+  mad_vfixed_t t88,  t89,  t90,  t91,  t92,  t93,  t94,  t95;
+  mad_vfixed_t t96,  t97,  t98,  t99,  t100, t101, t102, t103;
+  mad_vfixed_t t104, t105, t106, t107, t108, t109, t110, t111;
+  mad_vfixed_t t112, t113, t114, t115, t116, t117, t118, t119;
+  mad_vfixed_t t120, t121, t122, t123, t124, t125, t126, t127;
+  mad_vfixed_t t128, t129, t130, t131, t132, t133, t134, t135;
+  mad_vfixed_t t136, t137, t138, t139, t140, t141, t142, t143;
+  mad_vfixed_t t144, t145, t146, t147, t148, t149, t150, t151;
+  mad_vfixed_t t152, t153, t154, t155, t156, t157, t158, t159;
+  mad_vfixed_t t160, t161, t162, t163, t164, t165, t166, t167;
+  mad_vfixed_t t168, t169, t170, t171, t172, t173, t174, t175;
+  mad_vfixed_t t176;
+
+  t0   = v_add(in[0], in[31]);  t16  = MUL(v_sub(in[0], in[31]), costab1);
+  t1   = v_add(in[15], in[16]);  t17  = MUL(v_sub(in[15], in[16]), costab31);
+
+  t41  = v_add(t16, t17);
+  t59  = MUL(v_sub(t16, t17), costab2);
+  t33  = v_add(t0, t1);
+  t50  = MUL(v_sub(t0, t1), costab2);
+
+  t2   = v_add(in[7], in[24]);  t18  = MUL(v_sub(in[7], in[24]), costab15);
+  t3   = v_add(in[8], in[23]);  t19  = MUL(v_sub(in[8], in[23]), costab17);
+
+  t42  = v_add(t18, t19);
+  t60  = MUL(v_sub(t18, t19), costab30);
+  t34  = v_add(t2, t3);
+  t51  = MUL(v_sub(t2, t3), costab30);
+
+  t4   = v_add(in[3], in[28]);  t20  = MUL(v_sub(in[3], in[28]), costab7);
+  t5   = v_add(in[12], in[19]);  t21  = MUL(v_sub(in[12], in[19]), costab25);
+
+  t43  = v_add(t20, t21);
+  t61  = MUL(v_sub(t20, t21), costab14);
+  t35  = v_add(t4, t5);
+  t52  = MUL(v_sub(t4, t5), costab14);
+
+  t6   = v_add(in[4], in[27]);  t22  = MUL(v_sub(in[4], in[27]), costab9);
+  t7   = v_add(in[11], in[20]);  t23  = MUL(v_sub(in[11], in[20]), costab23);
+
+  t44  = v_add(t22, t23);
+  t62  = MUL(v_sub(t22, t23), costab18);
+  t36  = v_add(t6, t7);
+  t53  = MUL(v_sub(t6, t7), costab18);
+
+  t8   = v_add(in[1], in[30]);  t24  = MUL(v_sub(in[1], in[30]), costab3);
+  t9   = v_add(in[14], in[17]);  t25  = MUL(v_sub(in[14], in[17]), costab29);
+
+  t45  = v_add(t24, t25);
+  t63  = MUL(v_sub(t24, t25), costab6);
+  t37  = v_add(t8, t9);
+  t54  = MUL(v_sub(t8, t9), costab6);
+
+  t10  = v_add(in[6], in[25]);  t26  = MUL(v_sub(in[6], in[25]), costab13);
+  t11  = v_add(in[9], in[22]);  t27  = MUL(v_sub(in[9], in[22]), costab19);
+
+  t46  = v_add(t26, t27);
+  t64  = MUL(v_sub(t26, t27), costab26);
+  t38  = v_add(t10, t11);
+  t55  = MUL(v_sub(t10, t11), costab26);
+
+  t12  = v_add(in[2], in[29]);  t28  = MUL(v_sub(in[2], in[29]), costab5);
+  t13  = v_add(in[13], in[18]);  t29  = MUL(v_sub(in[13], in[18]), costab27);
+
+  t47  = v_add(t28, t29);
+  t65  = MUL(v_sub(t28, t29), costab10);
+  t39  = v_add(t12, t13);
+  t56  = MUL(v_sub(t12, t13), costab10);
+
+  t14  = v_add(in[5], in[26]);  t30  = MUL(v_sub(in[5], in[26]), costab11);
+  t15  = v_add(in[10], in[21]);  t31  = MUL(v_sub(in[10], in[21]), costab21);
+
+  t48  = v_add(t30, t31);
+  t66  = MUL(v_sub(t30, t31), costab22);
+  t40  = v_add(t14, t15);
+  t57  = MUL(v_sub(t14, t15), costab22);
+
+  t69  = v_add(t33, t34);  t89  = MUL(v_sub(t33, t34), costab4);
+  t70  = v_add(t35, t36);  t90  = MUL(v_sub(t35, t36), costab28);
+  t71  = v_add(t37, t38);  t91  = MUL(v_sub(t37, t38), costab12);
+  t72  = v_add(t39, t40);  t92  = MUL(v_sub(t39, t40), costab20);
+  t73  = v_add(t41, t42);  t94  = MUL(v_sub(t41, t42), costab4);
+  t74  = v_add(t43, t44);  t95  = MUL(v_sub(t43, t44), costab28);
+  t75  = v_add(t45, t46);  t96  = MUL(v_sub(t45, t46), costab12);
+  t76  = v_add(t47, t48);  t97  = MUL(v_sub(t47, t48), costab20);
+
+  t78  = v_add(t50, t51);  t100 = MUL(v_sub(t50, t51), costab4);
+  t79  = v_add(t52, t53);  t101 = MUL(v_sub(t52, t53), costab28);
+  t80  = v_add(t54, t55);  t102 = MUL(v_sub(t54, t55), costab12);
+  t81  = v_add(t56, t57);  t103 = MUL(v_sub(t56, t57), costab20);
+
+  t83  = v_add(t59, t60);  t106 = MUL(v_sub(t59, t60), costab4);
+  t84  = v_add(t61, t62);  t107 = MUL(v_sub(t61, t62), costab28);
+  t85  = v_add(t63, t64);  t108 = MUL(v_sub(t63, t64), costab12);
+  t86  = v_add(t65, t66);  t109 = MUL(v_sub(t65, t66), costab20);
+
+  t113 = v_add(t69, t70);
+  t114 = v_add(t71, t72);
+
+  /*  0 */ v_store(hi[15], SHIFT(v_add(t113, t114)));
+  /* 16 */ v_store(lo[ 0], SHIFT(MUL(v_sub(t113, t114), costab16)));
+
+  t115 = v_add(t73, t74);
+  t116 = v_add(t75, t76);
+
+  t32  = v_add(t115, t116);
+
+  /*  1 */ v_store(hi[14], SHIFT(t32));
+
+  t118 = v_add(t78, t79);
+  t119 = v_add(t80, t81);
+
+  t58  = v_add(t118, t119);
+
+  /*  2 */ v_store(hi[13], SHIFT(t58));
+
+  t121 = v_add(t83, t84);
+  t122 = v_add(t85, t86);
+
+  t67  = v_add(t121, t122);
+
+  t49  = DSUB(t67, t32);
+
+  /*  3 */ v_store(hi[12], SHIFT(t49));
+
+  t125 = v_add(t89, t90);
+  t126 = v_add(t91, t92);
+
+  t93  = v_add(t125, t126);
+
+  /*  4 */ v_store(hi[11], SHIFT(t93));
+
+  t128 = v_add(t94, t95);
+  t129 = v_add(t96, t97);
+
+  t98  = v_add(t128, t129);
+
+  t68  = DSUB(t98, t49);
+
+  /*  5 */ v_store(hi[10], SHIFT(t68));
+
+  t132 = v_add(t100, t101);
+  t133 = v_add(t102, t103);
+
+  t104 = v_add(t132, t133);
+
+  t82  = DSUB(t104, t58);
+
+  /*  6 */ v_store(hi[ 9], SHIFT(t82));
+
+  t136 = v_add(t106, t107);
+  t137 = v_add(t108, t109);
+
+  t110 = v_add(t136, t137);
+
+  t87  = DSUB(t110, t67);
+
+  t77  = DSUB(t87, t68);
+
+  /*  7 */ v_store(hi[ 8], SHIFT(t77));
+
+  t141 = MUL(v_sub(t69, t70), costab8);
+  t142 = MUL(v_sub(t71, t72), costab24);
+  t143 = v_add(t141, t142);
+
+  /*  8 */ v_store(hi[ 7], SHIFT(t143));
+  /* 24 */ v_store(lo[ 8],
+		   SHIFT(DSUB(MUL(v_sub(t141, t142), costab16), t143)));
+
+  t144 = MUL(v_sub(t73, t74), costab8);
+  t145 = MUL(v_sub(t75, t76), costab24);
+  t146 = v_add(t144, t145);
+
+  t88  = DSUB(t146, t77);
+
+  /*  9 */ v_store(hi[ 6], SHIFT(t88));
+
+  t148 = MUL(v_sub(t78, t79), costab8);
+  t149 = MUL(v_sub(t80, t81), costab24);
+  t150 = v_add(t148, t149);
+
+  t105 = DSUB(t150, t82);
+
+  /* 10 */ v_store(hi[ 5], SHIFT(t105));
+
+  t152 = MUL(v_sub(t83, t84), costab8);
+  t153 = MUL(v_sub(t85, t86), costab24);
+  t154 = v_add(t152, t153);
+
+  t111 = DSUB(t154, t87);
+
+  t99  = DSUB(t111, t88);
+
+  /* 11 */ v_store(hi[ 4], SHIFT(t99));
+
+  t157 = MUL(v_sub(t89, t90), costab8);
+  t158 = MUL(v_sub(t91, t92), costab24);
+  t159 = v_add(t157, t158);
+
+  t127 = DSUB(t159, t93);
+
+  /* 12 */ v_store(hi[ 3], SHIFT(t127));
+
+  t160 = DSUB(MUL(v_sub(t125, t126), costab16), t127);
+
+  /* 20 */ v_store(lo[ 4], SHIFT(t160));
+  /* 28 */ v_store(lo[12],
+		   SHIFT(DSUB(DSUB(MUL(v_sub(t157, t158), costab16),
+				   t159), t160)));
+
+  t161 = MUL(v_sub(t94, t95), costab8);
+  t162 = MUL(v_sub(t96, t97), costab24);
+  t163 = v_add(t161, t162);
+
+  t130 = DSUB(t163, t98);
+
+  t112 = DSUB(t130, t99);
+
+  /* 13 */ v_store(hi[ 2], SHIFT(t112));
+
+  t164 = DSUB(MUL(v_sub(t128, t129), costab16), t130);
+
+  t166 = MUL(v_sub(t100, t101), costab8);
+  t167 = MUL(v_sub(t102, t103), costab24);
+  t168 = v_add(t166, t167);
+
+  t134 = DSUB(t168, t104);
+
+  t120 = DSUB(t134, t105);
+
+  /* 14 */ v_store(hi[ 1], SHIFT(t120));
+
+  t135 = DSUB(MUL(v_sub(t118, t119), costab16), t120);
+
+  /* 18 */ v_store(lo[ 2], SHIFT(t135));
+
+  t169 = DSUB(MUL(v_sub(t132, t133), costab16), t134);
+
+  t151 = DSUB(t169, t135);
+
+  /* 22 */ v_store(lo[ 6], SHIFT(t151));
+
+  t170 = DSUB(DSUB(MUL(v_sub(t148, t149), costab16), t150), t151);
+
+  /* 26 */ v_store(lo[10], SHIFT(t170));
+  /* 30 */ v_store(lo[14],
+		   SHIFT(DSUB(DSUB(DSUB(MUL(v_sub(t166, t167), costab16),
+					t168), t169), t170)));
+
+  t171 = MUL(v_sub(t106, t107), costab8);
+  t172 = MUL(v_sub(t108, t109), costab24);
+  t173 = v_add(t171, t172);
+
+  t138 = DSUB(t173, t110);
+
+  t123 = DSUB(t138, t111);
+
+  t139 = DSUB(MUL(v_sub(t121, t122), costab16), t123);
+
+  t117 = DSUB(t123, t112);
+
+  /* 15 */ v_store(hi[ 0], SHIFT(t117));
+
+  t124 = DSUB(MUL(v_sub(t115, t116), costab16), t117);
+
+  /* 17 */ v_store(lo[ 1], SHIFT(t124));
+
+  t131 = DSUB(t139, t124);
+
+  /* 19 */ v_store(lo[ 3], SHIFT(t131));
+
+  t140 = DSUB(t164, t131);
+
+  /* 21 */ v_store(lo[ 5], SHIFT(t140));
+
+  t174 = DSUB(MUL(v_sub(t136, t137), costab16), t138);
+
+  t155 = DSUB(t174, t139);
+
+  t147 = DSUB(t155, t140);
+
+  /* 23 */ v_store(lo[ 7], SHIFT(t147));
+
+  t156 = DSUB(DSUB(MUL(v_sub(t144, t145), costab16), t146), t147);
+
+  /* 25 */ v_store(lo[ 9], SHIFT(t156));
+
+  t175 = DSUB(DSUB(MUL(v_sub(t152, t153), costab16), t154), t155);
+
+  t165 = DSUB(t175, t156);
+
+  /* 27 */ v_store(lo[11], SHIFT(t165));
+
+  t176 = DSUB(DSUB(DSUB(MUL(v_sub(t161, t162), costab16), t163), t164), t165);
+
+  /* 29 */ v_store(lo[13], SHIFT(t176));
+  /* 31 */ v_store(lo[15],
+		   SHIFT(DSUB(DSUB(DSUB(DSUB(MUL(v_sub(t171, t172), costab16),
+					     t173), t174), t175), t176)));
+}
+
+# undef MUL
+# undef SHIFT
+
+/* third SSO shift and D[] optimization preshift */
+
+# define SHIFT(x)	v_shr((x), 2)
+# define PRESHIFT(x)	((MAD_F(x) + (1L << 13)) >> 14)
+
+static
+mad_fixed_t const Ds[2][8][32][8] = {
+# include "D_simd.dat"
+};
+
+/*
+ * NAME:	window()
+ * DESCRIPTION:	multiply two filter rows with their coefficients
+ */
+static inline
+mad_vfixed_t window(mad_fixed_t const fo[8], mad_fixed_t const fe[8],
+		    mad_fixed_t const co[8], mad_fixed_t const ce[8])
+{
+  mad_vfixed_t o, e;
+
+  o = v_add(v_mul(v_load(&fo[0]), v_load(&co[0])),
+	    v_mul(v_load(&fo[4]), v_load(&co[4])));
+  e = v_add(v_mul(v_load(&fe[0]), v_load(&ce[0])),
+	    v_mul(v_load(&fe[4]), v_load(&ce[4])));
+
+  return v_add(o, e);
+}
+
+/*
+ * NAME:	synth->full()
+ * DESCRIPTION:	perform full frequency PCM synthesis
+ */
+void synth_full(struct mad_synth *synth, struct mad_frame const *frame,
+		unsigned int nch, unsigned int ns)
+{
+  unsigned int phase, ch, s, n, i, sb;
+  mad_fixed_t *pcm, (*filter)[2][2][16][8];
+  mad_fixed_t const (*sbsample)[36][32];
+  mad_fixed_t (*fe)[8], (*fx)[8], (*fo)[8];
+  mad_fixed_t const (*ce)[8], (*co)[8];
+  mad_fixed_t lo[16][4], hi[16][4];
+  mad_vfixed_t in[32], acc0, acc1, acc2, acc3;
+
+  for (ch = 0; ch < nch; ++ch) {
+    sbsample = &frame->sbsample[ch];
+    filter   = &synth->filter[ch];
+    phase    = synth->phase;
+    pcm      = synth->pcm.samples[ch];
+
+    for (s = 0; s < ns; s += 4) {
+      /*
+       * ns is 12, 18 or 36, so the last group may have fewer than four
+       * slots; the extra lanes read slots that are still inside sbsample
+       * and are never used.
+       */
+
+      n = ns - s < 4 ? ns - s : 4;
+
+      for (sb = 0; sb < 32; sb += 4) {
+	in[sb + 0] = v_load(&(*sbsample)[s + 0][sb]);
+	in[sb + 1] = v_load(&(*sbsample)[s + 1][sb]);
+	in[sb + 2] = v_load(&(*sbsample)[s + 2][sb]);
+	in[sb + 3] = v_load(&(*sbsample)[s + 3][sb]);
+
+	v_transpose4(in[sb + 0], in[sb + 1], in[sb + 2], in[sb + 3]);
+      }
+
+      dct32_x4(in, lo, hi);
+
+      for (i = 0; i < n; ++i) {
+	for (sb = 0; sb < 16; ++sb) {
+	  (*filter)[0][phase & 1][sb][phase >> 1] = lo[sb][i];
+	  (*filter)[1][phase & 1][sb][phase >> 1] = hi[sb][i];
+	}
+
+	/* calculate 32 samples */
+
+	fe = &(*filter)[0][ phase & 1][0];
+	fx = &(*filter)[0][~phase & 1][0];
+	fo = &(*filter)[1][~phase & 1][0];
+
+	ce = Ds[0][phase >> 1];
+	co = Ds[1][((phase - 1) & 0xf) >> 1];
+
+	/* samples 0-15 use rows sb of fe and sb - 1 of fo (fx for 0) */
+
+	acc0 = window(fx[0], fe[0], co[0], ce[0]);
+	acc1 = window(fo[0], fe[1], co[1], ce[1]);
+	acc2 = window(fo[1], fe[2], co[2], ce[2]);
+	acc3 = window(fo[2], fe[3], co[3], ce[3]);
+
+	v_store(&pcm[0], SHIFT(v_hsum4(acc0, acc1, acc2, acc3)));
+
+	for (sb = 4; sb < 16; sb += 4) {
+	  acc0 = window(fo[sb - 1], fe[sb + 0], co[sb + 0], ce[sb + 0]);
+	  acc1 = window(fo[sb + 0], fe[sb + 1], co[sb + 1], ce[sb + 1]);
+	  acc2 = window(fo[sb + 1], fe[sb + 2], co[sb + 2], ce[sb + 2]);
+	  acc3 = window(fo[sb + 2], fe[sb + 3], co[sb + 3], ce[sb + 3]);
+
+	  v_store(&pcm[sb], SHIFT(v_hsum4(acc0, acc1, acc2, acc3)));
+	}
+
+	/*
+	 * samples 32 - sb use the same rows; sample 16 only needs row 15 of
+	 * fo, so it is paired with a row of fe whose coefficients are zero
+	 */
+
+	acc0 = window(fo[15], fe[ 0], co[16], ce[16]);
+	acc1 = window(fo[14], fe[15], co[17], ce[17]);
+	acc2 = window(fo[13], fe[14], co[18], ce[18]);
+	acc3 = window(fo[12], fe[13], co[19], ce[19]);
+
+	v_store(&pcm[16], SHIFT(v_hsum4(acc0, acc1, acc2, acc3)));
+
+	for (sb = 20; sb < 32; sb += 4) {
+	  acc0 = window(fo[31 - sb], fe[32 - sb], co[sb + 0], ce[sb + 0]);
+	  acc1 = window(fo[30 - sb], fe[31 - sb], co[sb + 1], ce[sb + 1]);
+	  acc2 = window(fo[29 - sb], fe[30 - sb], co[sb + 2], ce[sb + 2]);
+	  acc3 = window(fo[28 - sb], fe[29 - sb], co[sb + 3], ce[sb + 3]);
+
+	  v_store(&pcm[sb], SHIFT(v_hsum4(acc0, acc1, acc2, acc3)));
+	}
+
+	pcm += 32;
+
+	phase = (phase + 1) % 16;
+      }
+    }
+  }
+}
@@ -70,6 +70,9 @@ char const mad_build[] = ""
 # if defined(ASO_ZEROCHECK)
   "ASO_ZEROCHECK "
 # endif
+# if defined(ASO_SIMD)
+  "ASO_SIMD "
+# endif
 
 # if defined(OPT_SPEED)
   "OPT_SPEED "
@@ -64,21 +64,29 @@ LOCAL_CFLAGS     := -DACCURATE_ROUNDING \
 LOCAL_SRC_FILES +=  synth_arm.S synth_arm_accurate.S
 endif
 
+# The NEON64 decoder is chosen at runtime, with generic kept as a fallback
+# and for comparison through mpg123_decoder().
 ifeq ($(TARGET_ARCH_ABI),arm64-v8a)
 LOCAL_CFLAGS     := -DACCURATE_ROUNDING \
+					-DOPT_MULTI \
 					-DOPT_GENERIC \
-					-DREAL_IS_FIXED \
-					-DNO_REAL \
-					-DNO_32BIT \
+					-DOPT_GENERIC_DITHER \
+					-DOPT_NEON64 \
+					-DREAL_IS_FLOAT \
 					-DHAVE_STRERROR \
-					-DASMALIGN_BYTE \
 					-Wno-int-to-pointer-cast \
 					-Wno-pointer-to-int-cast \
 					-ffast-math -O3
-#LOCAL_SRC_FILES +=  synth_arm.S synth_arm_accurate.S
+LOCAL_SRC_FILES +=  synth_real.c synth_s32.c
+LOCAL_SRC_FILES +=  getcpuflags_arm.c
+LOCAL_SRC_FILES +=  synth_neon64.S synth_neon64_accurate.S synth_neon64_float.S synth_neon64_s32.S
+LOCAL_SRC_FILES +=  synth_stereo_neon64.S synth_stereo_neon64_accurate.S synth_stereo_neon64_float.S synth_stereo_neon64_s32.S
+LOCAL_SRC_FILES +=  dct36_neon64.S dct64_neon64.S dct64_neon64_float.S
 endif
 
-# Removed this optimisation as it made gzdoom lockup on x86
+# Removed this optimisation as it made gzdoom lockup on x86. Note that the
+# assembly decoders all expect REAL_IS_FLOAT; without it the decode tables
+# overrun their buffer.
 #-DOPT_SSE \
 #LOCAL_SRC_FILES +=  synth_sse.S synth_sse_accurate.S synth_sse_float.S synth_sse_s32.S
 #LOCAL_SRC_FILES +=  synth_stereo_sse_accurate.S synth_stereo_sse_float.S synth_stereo_sse_s32.S
@@ -96,10 +104,16 @@ LOCAL_SRC_FILES +=  tabinit_mmx.S
 endif
 
 
+# AVX is used when the CPU and OS support it, the SSE x86-64 decoder otherwise.
 ifeq ($(TARGET_ARCH_ABI),x86_64)
 LOCAL_CFLAGS     := -DACCURATE_ROUNDING \
 					-DHAVE_STRERROR \
+					-DOPT_MULTI \
 					-DOPT_X86_64 \
+					-DOPT_AVX \
+					-DOPT_GENERIC \
+					-DOPT_GENERIC_DITHER \
+					-DREAL_IS_FLOAT \
 					-Wno-int-to-pointer-cast \
 					-Wno-pointer-to-int-cast \
 					-ffast-math
@@ -108,6 +122,8 @@ LOCAL_SRC_FILES +=  getcpuflags_x86_64.S
 LOCAL_SRC_FILES +=  synth_x86_64.S synth_x86_64_s32.S synth_x86_64_accurate.S synth_x86_64_float.S
 LOCAL_SRC_FILES +=  synth_stereo_x86_64_float.S synth_stereo_x86_64.S synth_stereo_x86_64_s32.S synth_stereo_x86_64_accurate.S
 LOCAL_SRC_FILES +=  dct36_x86_64.S dct64_x86_64.S dct64_x86_64_float.S
+LOCAL_SRC_FILES +=  synth_stereo_avx.S synth_stereo_avx_accurate.S synth_stereo_avx_float.S synth_stereo_avx_s32.S
+LOCAL_SRC_FILES +=  dct36_avx.S dct64_avx.S dct64_avx_float.S
 endif
 
 
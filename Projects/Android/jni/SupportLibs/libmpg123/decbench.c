@@ -0,0 +1,193 @@
+/*
+	decbench: standalone decoder throughput benchmark
+
+	free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	Decodes an MP3 with every decoder the build supports, to 16 bit, float and
+	32 bit output, and prints frames per second for each, along with how far
+	the output strays from the generic decoder's (in LSBs for the integer
+	encodings, in fractions of full scale for float).
+
+	Not part of the Android build. On an x86_64 host, with the flags Android.mk
+	uses for that ABI:
+
+	cc -O3 -I. -DACCURATE_ROUNDING -DHAVE_STRERROR -DOPT_MULTI -DOPT_X86_64 \
+		-DOPT_AVX -DOPT_GENERIC -DOPT_GENERIC_DITHER -DREAL_IS_FLOAT -ffast-math \
+		-o decbench decbench.c libmpg123.c compat.c frame.c id3.c format.c \
+		stringbuf.c readers.c icy.c icy2utf8.c index.c layer1.c layer2.c layer3.c \
+		parse.c optimize.c synth.c synth_8bit.c ntom.c dct64.c equalizer.c \
+		tabinit.c feature.c dither.c synth_real.c synth_s32.c \
+		getcpuflags_x86_64.S synth_x86_64*.S synth_stereo_x86_64*.S \
+		dct36_x86_64.S dct64_x86_64*.S synth_stereo_avx*.S dct36_avx.S \
+		dct64_avx*.S -lm
+	./decbench file.mp3 [repeats]
+
+	For the old fixed-point arm64 configuration, build with -DACCURATE_ROUNDING
+	-DHAVE_STRERROR -DOPT_GENERIC -DREAL_IS_FIXED -DNO_REAL -DNO_32BIT
+	-ffast-math, without synth_real.c, synth_s32.c or any assembly; only s16
+	is decoded then. The NEON64 decoders have to be measured on the device.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "mpg123.h"
+
+static const struct { const char *name; int enc; } encodings[] =
+{
+	{ "s16", MPG123_ENC_SIGNED_16 },
+	{ "f32", MPG123_ENC_FLOAT_32 },
+	{ "s32", MPG123_ENC_SIGNED_32 }
+};
+#define ENCODINGS (sizeof(encodings)/sizeof(encodings[0]))
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+/* Decodes the whole file; returns the number of frames, or -1 if the decoder
+   can't do the encoding. Keeps the output in *out if out isn't NULL. */
+static long decode(const char *file, const char *decoder, int enc,
+	double *seconds, unsigned char **out, size_t *outbytes)
+{
+	mpg123_handle *mh;
+	unsigned char *audio;
+	size_t bytes;
+	off_t num;
+	long frames = 0, rate;
+	int err, channels, encoding;
+	double start;
+
+	if((mh = mpg123_new(decoder, &err)) == NULL)
+	{
+		fprintf(stderr, "%s: %s\n", decoder, mpg123_plain_strerror(err));
+		return -1;
+	}
+	mpg123_param(mh, MPG123_FLAGS, MPG123_QUIET, 0);
+	mpg123_format_none(mh);
+	if(mpg123_format(mh, 44100, MPG123_MONO|MPG123_STEREO, enc) != MPG123_OK
+	|| mpg123_format(mh, 48000, MPG123_MONO|MPG123_STEREO, enc) != MPG123_OK
+	|| mpg123_format(mh, 22050, MPG123_MONO|MPG123_STEREO, enc) != MPG123_OK
+	|| mpg123_open(mh, file) != MPG123_OK
+	|| mpg123_getformat(mh, &rate, &channels, &encoding) != MPG123_OK)
+	{
+		mpg123_delete(mh);
+		return -1;
+	}
+
+	if(out) *outbytes = 0;
+	start = now();
+	while((err = mpg123_decode_frame(mh, &num, &audio, &bytes)) == MPG123_OK
+	|| err == MPG123_NEW_FORMAT)
+	{
+		++frames;
+		if(out)
+		{
+			*out = realloc(*out, *outbytes + bytes);
+			memcpy(*out + *outbytes, audio, bytes);
+			*outbytes += bytes;
+		}
+	}
+	*seconds = now() - start;
+	if(err != MPG123_DONE)
+		fprintf(stderr, "%s: %s\n", decoder, mpg123_strerror(mh));
+	mpg123_delete(mh);
+	return err == MPG123_DONE ? frames : -1;
+}
+
+/* Largest difference between two decodings of the same encoding */
+static double difference(int enc, const unsigned char *a, const unsigned char *b, size_t bytes)
+{
+	double diff = 0;
+	size_t i;
+
+	switch(enc)
+	{
+		case MPG123_ENC_SIGNED_16:
+			for(i = 0; i < bytes/2; ++i)
+				diff = fmax(diff, fabs((double)((const short*)a)[i] - ((const short*)b)[i]));
+		break;
+		case MPG123_ENC_FLOAT_32:
+			for(i = 0; i < bytes/4; ++i)
+				diff = fmax(diff, fabs((double)((const float*)a)[i] - ((const float*)b)[i]));
+		break;
+		case MPG123_ENC_SIGNED_32:
+			for(i = 0; i < bytes/4; ++i)
+				diff = fmax(diff, fabs((double)((const int*)a)[i] - ((const int*)b)[i]));
+		break;
+	}
+	return diff;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned char *reference[ENCODINGS] = { NULL }, *out = NULL;
+	size_t refbytes[ENCODINGS], outbytes;
+	const char **decoder;
+	int repeats, r;
+	size_t e;
+
+	if(argc < 2)
+	{
+		fprintf(stderr, "usage: %s file.mp3 [repeats]\n", argv[0]);
+		return 1;
+	}
+	repeats = argc > 2 ? atoi(argv[2]) : 20;
+	if(repeats < 1) repeats = 1;
+	mpg123_init();
+
+	/* The output every decoder is compared with */
+	for(e = 0; e < ENCODINGS; ++e)
+	{
+		double seconds;
+
+		if(decode(argv[1], "generic", encodings[e].enc, &seconds,
+			&reference[e], &refbytes[e]) < 0)
+		{
+			free(reference[e]);
+			reference[e] = NULL;
+		}
+	}
+
+	printf("%-16s %-4s %12s %12s\n", "decoder", "out", "frames/s", "vs generic");
+	for(decoder = mpg123_supported_decoders(); *decoder; ++decoder)
+	for(e = 0; e < ENCODINGS; ++e)
+	{
+		double seconds, total = 0;
+		long frames = 0, f;
+
+		f = decode(argv[1], *decoder, encodings[e].enc, &seconds, &out, &outbytes);
+		if(f < 0) continue;
+		for(r = 0; r < repeats; ++r)
+		{
+			if((f = decode(argv[1], *decoder, encodings[e].enc, &seconds, NULL, NULL)) < 0)
+				break;
+			frames += f;
+			total += seconds;
+		}
+		if(f < 0) continue;
+
+		printf("%-16s %-4s %12.0f ", *decoder, encodings[e].name, frames/total);
+		if(!strcmp(*decoder, "generic"))
+			printf("%12s\n", "-");
+		else if(reference[e] == NULL)
+			printf("%12s\n", "n/a");
+		else if(refbytes[e] != outbytes)
+			printf("%12s\n", "length");
+		else if(encodings[e].enc == MPG123_ENC_FLOAT_32)
+			printf("%12.1e\n", difference(encodings[e].enc, reference[e], out, outbytes));
+		else
+			printf("%12.0f\n", difference(encodings[e].enc, reference[e], out, outbytes));
+	}
+
+	for(e = 0; e < ENCODINGS; ++e) free(reference[e]);
+	free(out);
+	mpg123_exit();
+	return 0;
+}
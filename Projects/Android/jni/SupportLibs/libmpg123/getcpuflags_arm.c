@@ -11,6 +11,7 @@
 #include "mpg123lib_intern.h"
 #include "getcpuflags.h"
 
+#ifndef __aarch64__
 extern void check_neon(void);
 
 static sigjmp_buf jmpbuf;
@@ -20,8 +21,16 @@ static void mpg123_arm_catch_sigill(int sig)
 	siglongjmp(jmpbuf, 1);
 }
 
+#endif
+
 unsigned int getcpuflags(struct cpuflags* cf)
 {
+#ifdef __aarch64__
+	/* NEON is mandatory on AArch64, so there is nothing to probe. This also
+	   keeps our SIGILL handler from stepping on those of a hosting VM. */
+	cf->has_neon = 1;
+	return 0;
+#else
 	struct sigaction act, act_old;
 	act.sa_handler = mpg123_arm_catch_sigill;
 	act.sa_flags = SA_RESTART;
@@ -38,4 +47,5 @@ unsigned int getcpuflags(struct cpuflags* cf)
 	sigaction(SIGILL, &act_old, NULL);
 	
 	return 0;
+#endif
 }
@@ -22,7 +22,9 @@ LOCAL_SRC_FILES = \
 	pngwtran.c \
 	pngwutil.c \
 	arm/arm_init.c  \
-	arm/filter_neon_intrinsics.c
+	arm/filter_neon_intrinsics.c \
+	intel/intel_init.c \
+	intel/filter_sse2_intrinsics.c
 
 
 
@@ -30,5 +32,11 @@ LOCAL_SRC_FILES = \
 LOCAL_LDLIBS := -lz
 LOCAL_EXPORT_LDLIBS := -lz 
 LOCAL_STATIC_LIBRARIES :=  
+
+# the NEON row filters are only compiled in when the compiler targets NEON
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_ARM_NEON := true
+endif
+
 #include $(BUILD_SHARED_LIBRARY)
 include $(BUILD_STATIC_LIBRARY)
\ No newline at end of file
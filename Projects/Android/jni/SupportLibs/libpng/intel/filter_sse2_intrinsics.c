@@ -0,0 +1,250 @@
+/* filter_sse2_intrinsics.c - SSE2 optimised filter functions
+ *
+ * Based on arm/filter_neon_intrinsics.c.
+ *
+ * This code is released under the libpng license.
+ * For conditions of distribution and use, see the disclaimer
+ * and license in png.h
+ */
+
+#include "../pngpriv.h"
+
+#ifdef PNG_READ_SUPPORTED
+
+#if PNG_INTEL_SSE_IMPLEMENTATION > 0
+
+#include <emmintrin.h>
+#if PNG_INTEL_SSE_IMPLEMENTATION >= 3
+#  include <smmintrin.h>
+#elif PNG_INTEL_SSE_IMPLEMENTATION >= 2
+#  include <tmmintrin.h>
+#endif
+
+/* Every pixel depends on the one to its left, so the rows are reconstructed
+ * one pixel at a time with all the bytes of the pixel in one register.  The
+ * pixels are always loaded four bytes at a time: for 3 byte pixels this reads
+ * one byte beyond the end of the row, which is inside the padding libpng
+ * keeps after its row buffers (see png_read_start_row), but only the three
+ * bytes of the pixel are stored back.
+ *
+ * The byte lanes that do not belong to the pixel accumulate junk, which never
+ * reaches the pixel lanes because all the arithmetic is lane by lane.
+ */
+static __m128i
+load4(png_const_bytep p)
+{
+   png_uint_32 tmp;
+
+   memcpy(&tmp, p, sizeof tmp);
+   return _mm_cvtsi32_si128((int)tmp);
+}
+
+static void
+store4(png_bytep p, __m128i v)
+{
+   png_uint_32 tmp = (png_uint_32)_mm_cvtsi128_si32(v);
+
+   memcpy(p, &tmp, sizeof tmp);
+}
+
+static void
+store3(png_bytep p, __m128i v)
+{
+   png_uint_32 tmp = (png_uint_32)_mm_cvtsi128_si32(v);
+
+   memcpy(p, &tmp, 3);
+}
+
+void
+png_read_filter_row_sub3_sse2(png_row_infop row_info, png_bytep row,
+   png_const_bytep prev_row)
+{
+   png_bytep rp = row;
+   png_bytep rp_stop = row + row_info->rowbytes;
+
+   /* The pixel to the left of the first one counts as zero. */
+   __m128i a = _mm_setzero_si128();
+
+   png_debug(1, "in png_read_filter_row_sub3_sse2");
+
+   for (; rp < rp_stop; rp += 3)
+   {
+      a = _mm_add_epi8(a, load4(rp));
+      store3(rp, a);
+   }
+
+   PNG_UNUSED(prev_row)
+}
+
+void
+png_read_filter_row_sub4_sse2(png_row_infop row_info, png_bytep row,
+   png_const_bytep prev_row)
+{
+   png_bytep rp = row;
+   png_bytep rp_stop = row + row_info->rowbytes;
+
+   __m128i a = _mm_setzero_si128();
+
+   png_debug(1, "in png_read_filter_row_sub4_sse2");
+
+   for (; rp < rp_stop; rp += 4)
+   {
+      a = _mm_add_epi8(a, load4(rp));
+      store4(rp, a);
+   }
+
+   PNG_UNUSED(prev_row)
+}
+
+/* (a + b) >> 1 for each byte: pavgb rounds up, so take the rounding off
+ * again where a + b is odd.
+ */
+static __m128i
+avg_floor(__m128i a, __m128i b)
+{
+   __m128i odd = _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1));
+
+   return _mm_sub_epi8(_mm_avg_epu8(a, b), odd);
+}
+
+void
+png_read_filter_row_avg3_sse2(png_row_infop row_info, png_bytep row,
+   png_const_bytep prev_row)
+{
+   png_bytep rp = row;
+   png_bytep rp_stop = row + row_info->rowbytes;
+   png_const_bytep pp = prev_row;
+
+   __m128i a = _mm_setzero_si128();
+
+   png_debug(1, "in png_read_filter_row_avg3_sse2");
+
+   for (; rp < rp_stop; rp += 3, pp += 3)
+   {
+      a = _mm_add_epi8(load4(rp), avg_floor(a, load4(pp)));
+      store3(rp, a);
+   }
+}
+
+void
+png_read_filter_row_avg4_sse2(png_row_infop row_info, png_bytep row,
+   png_const_bytep prev_row)
+{
+   png_bytep rp = row;
+   png_bytep rp_stop = row + row_info->rowbytes;
+   png_const_bytep pp = prev_row;
+
+   __m128i a = _mm_setzero_si128();
+
+   png_debug(1, "in png_read_filter_row_avg4_sse2");
+
+   for (; rp < rp_stop; rp += 4, pp += 4)
+   {
+      a = _mm_add_epi8(load4(rp), avg_floor(a, load4(pp)));
+      store4(rp, a);
+   }
+}
+
+static __m128i
+abs_i16(__m128i x)
+{
+#if PNG_INTEL_SSE_IMPLEMENTATION >= 2
+   return _mm_abs_epi16(x);
+#else
+   __m128i sign = _mm_srai_epi16(x, 15);
+
+   return _mm_sub_epi16(_mm_xor_si128(x, sign), sign);
+#endif
+}
+
+/* mask ? t : e, where each lane of mask is all ones or all zeros */
+static __m128i
+if_then_else(__m128i mask, __m128i t, __m128i e)
+{
+#if PNG_INTEL_SSE_IMPLEMENTATION >= 3
+   return _mm_blendv_epi8(e, t, mask);
+#else
+   return _mm_or_si128(_mm_and_si128(mask, t), _mm_andnot_si128(mask, e));
+#endif
+}
+
+/* The Paeth predictor of the pixel with a to its left, b above it and c above
+ * a, all with the bytes widened to 16 bits.  As in png_read_filter_row_paeth*
+ * ties go to a, then b.
+ */
+static __m128i
+paeth_predictor(__m128i a, __m128i b, __m128i c)
+{
+   __m128i pa, pb, pc, smallest;
+
+   pa = _mm_sub_epi16(b, c);   /* p - a */
+   pb = _mm_sub_epi16(a, c);   /* p - b */
+   pc = _mm_add_epi16(pa, pb); /* p - c */
+
+   pa = abs_i16(pa);
+   pb = abs_i16(pb);
+   pc = abs_i16(pc);
+
+   smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+   return if_then_else(_mm_cmpeq_epi16(smallest, pa), a,
+      if_then_else(_mm_cmpeq_epi16(smallest, pb), b, c));
+}
+
+void
+png_read_filter_row_paeth3_sse2(png_row_infop row_info, png_bytep row,
+   png_const_bytep prev_row)
+{
+   png_bytep rp = row;
+   png_bytep rp_stop = row + row_info->rowbytes;
+   png_const_bytep pp = prev_row;
+
+   const __m128i zero = _mm_setzero_si128();
+
+   /* With a and c zero the first pixel is predicted from b alone, which is
+    * what the PNG specification asks for.
+    */
+   __m128i a = zero, c = zero;
+
+   png_debug(1, "in png_read_filter_row_paeth3_sse2");
+
+   for (; rp < rp_stop; rp += 3, pp += 3)
+   {
+      __m128i b = _mm_unpacklo_epi8(load4(pp), zero);
+
+      /* _epi8, so that the sum wraps at 256 and stays in the low bytes */
+      a = _mm_add_epi8(_mm_unpacklo_epi8(load4(rp), zero),
+         paeth_predictor(a, b, c));
+      store3(rp, _mm_packus_epi16(a, a));
+
+      c = b;
+   }
+}
+
+void
+png_read_filter_row_paeth4_sse2(png_row_infop row_info, png_bytep row,
+   png_const_bytep prev_row)
+{
+   png_bytep rp = row;
+   png_bytep rp_stop = row + row_info->rowbytes;
+   png_const_bytep pp = prev_row;
+
+   const __m128i zero = _mm_setzero_si128();
+   __m128i a = zero, c = zero;
+
+   png_debug(1, "in png_read_filter_row_paeth4_sse2");
+
+   for (; rp < rp_stop; rp += 4, pp += 4)
+   {
+      __m128i b = _mm_unpacklo_epi8(load4(pp), zero);
+
+      a = _mm_add_epi8(_mm_unpacklo_epi8(load4(rp), zero),
+         paeth_predictor(a, b, c));
+      store4(rp, _mm_packus_epi16(a, a));
+
+      c = b;
+   }
+}
+
+#endif /* PNG_INTEL_SSE_IMPLEMENTATION > 0 */
+#endif /* READ */
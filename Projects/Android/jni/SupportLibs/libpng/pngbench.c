@@ -0,0 +1,223 @@
+/* pngbench.c - time the decoding of a set of PNG files
+ *
+ * This code is released under the libpng license.
+ * For conditions of distribution and use, see the disclaimer
+ * and license in png.h
+ *
+ * Usage: pngbench [-r repeat] file.png...
+ *
+ * Every file is loaded into memory and then decoded 'repeat' times (default 5)
+ * with png_read_image into 8-bit RGBA, the way textures are loaded.  The best
+ * time of each file is added up and printed with a checksum of the decoded
+ * pixels, so that differently built libraries (for instance with and without
+ * -DPNG_INTEL_SSE_OPT=0) can be compared; a texture pack can be benchmarked by
+ * unpacking its PNGs and passing them all.
+ *
+ * This is not built with the library; on a POSIX system:
+ *
+ *    cc -O2 -o pngbench pngbench.c libpng.a -lz -lm
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+
+#include "png.h"
+
+typedef struct
+{
+   png_const_bytep data;
+   png_size_t size;
+   png_size_t pos;
+} bench_input;
+
+static void PNGCBAPI
+bench_read(png_structp png_ptr, png_bytep out, png_size_t length)
+{
+   bench_input *in = (bench_input *)png_get_io_ptr(png_ptr);
+
+   if (length > in->size - in->pos)
+      png_error(png_ptr, "read beyond end of file");
+
+   memcpy(out, in->data + in->pos, length);
+   in->pos += length;
+}
+
+static double
+now(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Decode one file; returns 0 on error, otherwise the pixel count.  The time
+ * taken is stored in *elapsed and, if sum is not NULL, the pixels are added
+ * to the checksum.
+ */
+static png_uint_32
+decode(png_const_bytep data, png_size_t size, double *elapsed,
+   unsigned long *sum)
+{
+   bench_input in;
+   png_structp png_ptr;
+   png_infop info_ptr;
+   png_bytep volatile image = NULL;
+   png_bytepp volatile rows = NULL;
+   png_uint_32 width, height, y;
+   png_size_t rowbytes;
+   int color_type;
+   double start = now();
+
+   png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+   if (png_ptr == NULL)
+      return 0;
+
+   info_ptr = png_create_info_struct(png_ptr);
+   if (info_ptr == NULL || setjmp(png_jmpbuf(png_ptr)))
+   {
+      png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+      free(image);
+      free(rows);
+      return 0;
+   }
+
+   in.data = data;
+   in.size = size;
+   in.pos = 0;
+   png_set_read_fn(png_ptr, &in, bench_read);
+
+   png_read_info(png_ptr, info_ptr);
+
+   color_type = png_get_color_type(png_ptr, info_ptr);
+   png_set_expand(png_ptr);
+   png_set_strip_16(png_ptr);
+   if ((color_type & PNG_COLOR_MASK_COLOR) == 0)
+      png_set_gray_to_rgb(png_ptr);
+   png_set_add_alpha(png_ptr, 0xff, PNG_FILLER_AFTER);
+   (void)png_set_interlace_handling(png_ptr);
+   png_read_update_info(png_ptr, info_ptr);
+
+   width = png_get_image_width(png_ptr, info_ptr);
+   height = png_get_image_height(png_ptr, info_ptr);
+   rowbytes = png_get_rowbytes(png_ptr, info_ptr);
+
+   image = (png_bytep)malloc(rowbytes * height);
+   rows = (png_bytepp)malloc(height * sizeof (png_bytep));
+   if (image == NULL || rows == NULL)
+      png_error(png_ptr, "out of memory");
+
+   for (y = 0; y < height; y++)
+      rows[y] = image + y * rowbytes;
+
+   png_read_image(png_ptr, rows);
+   png_read_end(png_ptr, NULL);
+
+   *elapsed = now() - start;
+
+   if (sum != NULL)
+   {
+      png_size_t i;
+      unsigned long s = *sum;
+
+      for (i = 0; i < rowbytes * height; i++)
+         s = s * 31 + image[i];
+
+      *sum = s;
+   }
+
+   png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+   free(image);
+   free(rows);
+
+   return width * height;
+}
+
+int
+main(int argc, char **argv)
+{
+   int repeat = 5, i, files = 0, errors = 0;
+   double total = 0;
+   unsigned long pixels = 0, sum = 0;
+
+   for (i = 1; i < argc && argv[i][0] == '-'; i++)
+   {
+      if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+         repeat = atoi(argv[++i]);
+
+      else
+         break;
+   }
+
+   if (i >= argc || repeat < 1)
+   {
+      fprintf(stderr, "usage: pngbench [-r repeat] file.png...\n");
+      return 1;
+   }
+
+   for (; i < argc; i++)
+   {
+      FILE *fp = fopen(argv[i], "rb");
+      png_bytep data;
+      long size;
+      double best = 0;
+      png_uint_32 count = 0;
+      int r;
+
+      if (fp == NULL || fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) <= 0)
+      {
+         fprintf(stderr, "%s: cannot read\n", argv[i]);
+         if (fp != NULL)
+            fclose(fp);
+         errors++;
+         continue;
+      }
+
+      rewind(fp);
+      data = (png_bytep)malloc(size);
+      if (data == NULL || fread(data, 1, size, fp) != (size_t)size)
+      {
+         fprintf(stderr, "%s: cannot read\n", argv[i]);
+         fclose(fp);
+         free(data);
+         errors++;
+         continue;
+      }
+      fclose(fp);
+
+      for (r = 0; r < repeat && (r == 0 || count != 0); r++)
+      {
+         double t = 0;
+
+         count = decode(data, (png_size_t)size, &t,
+            r == repeat - 1 ? &sum : NULL);
+
+         if (r == 0 || t < best)
+            best = t;
+      }
+
+      free(data);
+
+      if (count == 0)
+      {
+         fprintf(stderr, "%s: decoding failed\n", argv[i]);
+         errors++;
+         continue;
+      }
+
+      files++;
+      pixels += count;
+      total += best;
+   }
+
+   printf("%d files, %.1f Mpixel, %.2f ms, %.1f Mpixel/s, checksum %08lx\n",
+      files, pixels / 1e6, total * 1e3, total > 0 ? pixels / 1e6 / total : 0,
+      sum & 0xffffffffUL);
+
+   return errors != 0;
+}
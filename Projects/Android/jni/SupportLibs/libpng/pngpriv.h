@@ -182,6 +182,45 @@
 #  endif
 #endif /* PNG_ARM_NEON_OPT > 0 */
 
+#ifndef PNG_INTEL_SSE_OPT
+   /* Intel SSE2 optimizations are controlled by the compiler settings in the
+    * same way as the ARM ones above.  SSE2 is part of the x86-64 baseline and
+    * of the Android x86 ABI, so there is no need for a run-time check.  The
+    * code in intel/ relies on the 16-byte padding of ALIGNED_MEMORY when it
+    * loads the last pixel of a row.
+    *
+    * To disable the SSE optimizations put -DPNG_INTEL_SSE_OPT=0 in CPPFLAGS.
+    */
+#  if (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && \
+   defined(PNG_ALIGNED_MEMORY_SUPPORTED)
+#     define PNG_INTEL_SSE_OPT 1
+#  else
+#     define PNG_INTEL_SSE_OPT 0
+#  endif
+#endif
+
+#if PNG_INTEL_SSE_OPT > 0
+   /* PNG_INTEL_SSE_IMPLEMENTATION says which instructions beyond SSE2 the
+    * compiler may use:
+    *
+    *    1  SSE2
+    *    2  SSSE3 (for pabsw; the Android x86 ABI)
+    *    3  SSE4.1 (for pblendvb; the Android x86_64 ABI)
+    */
+#  ifndef PNG_INTEL_SSE_IMPLEMENTATION
+#     if defined(__SSE4_1__) || defined(__AVX__)
+#        define PNG_INTEL_SSE_IMPLEMENTATION 3
+#     elif defined(__SSSE3__)
+#        define PNG_INTEL_SSE_IMPLEMENTATION 2
+#     else
+#        define PNG_INTEL_SSE_IMPLEMENTATION 1
+#     endif
+#  endif
+
+#  define PNG_FILTER_OPTIMIZATIONS png_init_filter_functions_sse2
+#endif /* PNG_INTEL_SSE_OPT > 0 */
+
 /* Is this a build of a DLL where compilation of the object modules requires
  * different preprocessor settings to those required for a simple library?  If
  * so PNG_BUILD_DLL must be set.
@@ -1189,6 +1228,19 @@ PNG_INTERNAL_FUNCTION(void,png_read_filter_row_paeth3_neon,(png_row_infop
 PNG_INTERNAL_FUNCTION(void,png_read_filter_row_paeth4_neon,(png_row_infop
     row_info, png_bytep row, png_const_bytep prev_row),PNG_EMPTY);
 
+PNG_INTERNAL_FUNCTION(void,png_read_filter_row_sub3_sse2,(png_row_infop
+    row_info, png_bytep row, png_const_bytep prev_row),PNG_EMPTY);
+PNG_INTERNAL_FUNCTION(void,png_read_filter_row_sub4_sse2,(png_row_infop
+    row_info, png_bytep row, png_const_bytep prev_row),PNG_EMPTY);
+PNG_INTERNAL_FUNCTION(void,png_read_filter_row_avg3_sse2,(png_row_infop
+    row_info, png_bytep row, png_const_bytep prev_row),PNG_EMPTY);
+PNG_INTERNAL_FUNCTION(void,png_read_filter_row_avg4_sse2,(png_row_infop
+    row_info, png_bytep row, png_const_bytep prev_row),PNG_EMPTY);
+PNG_INTERNAL_FUNCTION(void,png_read_filter_row_paeth3_sse2,(png_row_infop
+    row_info, png_bytep row, png_const_bytep prev_row),PNG_EMPTY);
+PNG_INTERNAL_FUNCTION(void,png_read_filter_row_paeth4_sse2,(png_row_infop
+    row_info, png_bytep row, png_const_bytep prev_row),PNG_EMPTY);
+
 /* Choose the best filter to use and filter the row data */
 PNG_INTERNAL_FUNCTION(void,png_write_find_filter,(png_structrp png_ptr,
     png_row_infop row_info),PNG_EMPTY);
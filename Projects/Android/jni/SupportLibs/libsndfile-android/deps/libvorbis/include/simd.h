@@ -0,0 +1,103 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis SOFTWARE CODEC SOURCE CODE.   *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis SOURCE CODE IS (C) COPYRIGHT 1994-2009             *
+ * by the Xiph.Org Foundation http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: four lane float vectors for the decode side (SSE2/NEON)
+
+ Every routine built on these does the same multiplies and adds in
+ the same order as the scalar code it replaces (no fused
+ multiply-add), so on x86 the output is identical to the C path.
+
+ ********************************************************************/
+
+#ifndef _V_SIMD_H_
+#define _V_SIMD_H_
+
+#if defined(__SSE2__)
+
+#define VORBIS_SIMD
+#include <emmintrin.h>
+
+typedef __m128 v4sf;
+
+#define v4_ld(p)         _mm_loadu_ps(p)
+#define v4_st(p,x)       _mm_storeu_ps((p),(x))
+#define v4_set(a,b,c,d)  _mm_setr_ps((a),(b),(c),(d))
+#define v4_zero()        _mm_setzero_ps()
+#define v4_add(x,y)      _mm_add_ps((x),(y))
+#define v4_sub(x,y)      _mm_sub_ps((x),(y))
+#define v4_mul(x,y)      _mm_mul_ps((x),(y))
+#define v4_xor(x,y)      _mm_xor_ps((x),(y))
+
+/* (p[0],p[1],q[0],q[1]) */
+#define v4_ld2x2(p,q)    _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(),  \
+                           (const __m64 *)(p)),(const __m64 *)(q))
+
+/* even and odd lanes of a:b, and the inverse of that */
+#define v4_even(a,b)     _mm_shuffle_ps((a),(b),_MM_SHUFFLE(2,0,2,0))
+#define v4_odd(a,b)      _mm_shuffle_ps((a),(b),_MM_SHUFFLE(3,1,3,1))
+#define v4_ziplo(a,b)    _mm_unpacklo_ps((a),(b))
+#define v4_ziphi(a,b)    _mm_unpackhi_ps((a),(b))
+
+#define v4_rev(x)        _mm_shuffle_ps((x),(x),_MM_SHUFFLE(0,1,2,3))
+#define v4_swappair(x)   _mm_shuffle_ps((x),(x),_MM_SHUFFLE(2,3,0,1))
+#define v4_swaphalf(x)   _mm_shuffle_ps((x),(x),_MM_SHUFFLE(1,0,3,2))
+#define v4_dupeven(x)    _mm_shuffle_ps((x),(x),_MM_SHUFFLE(2,2,0,0))
+#define v4_dupodd(x)     _mm_shuffle_ps((x),(x),_MM_SHUFFLE(3,3,1,1))
+
+/* lanewise x>0 ? a : b */
+#define v4_gtz(x)        _mm_cmpgt_ps((x),_mm_setzero_ps())
+#define v4_sel(m,a,b)    _mm_or_ps(_mm_and_ps((m),(a)),_mm_andnot_ps((m),(b)))
+#define v4_and(m,x)      _mm_and_ps((m),(x))
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+#define VORBIS_SIMD
+#include <arm_neon.h>
+
+typedef float32x4_t v4sf;
+
+#define v4_ld(p)         vld1q_f32(p)
+#define v4_st(p,x)       vst1q_f32((p),(x))
+#define v4_zero()        vdupq_n_f32(0.f)
+#define v4_add(x,y)      vaddq_f32((x),(y))
+#define v4_sub(x,y)      vsubq_f32((x),(y))
+#define v4_mul(x,y)      vmulq_f32((x),(y))
+#define v4_xor(x,y)      vreinterpretq_f32_u32(veorq_u32(  \
+                           vreinterpretq_u32_f32(x),vreinterpretq_u32_f32(y)))
+
+static inline v4sf v4_set(float a,float b,float c,float d){
+  float t[4];
+  t[0]=a; t[1]=b; t[2]=c; t[3]=d;
+  return vld1q_f32(t);
+}
+
+#define v4_ld2x2(p,q)    vcombine_f32(vld1_f32(p),vld1_f32(q))
+
+#define v4_even(a,b)     (vuzpq_f32((a),(b)).val[0])
+#define v4_odd(a,b)      (vuzpq_f32((a),(b)).val[1])
+#define v4_ziplo(a,b)    (vzipq_f32((a),(b)).val[0])
+#define v4_ziphi(a,b)    (vzipq_f32((a),(b)).val[1])
+
+#define v4_swaphalf(x)   vextq_f32((x),(x),2)
+#define v4_swappair(x)   vrev64q_f32(x)
+#define v4_rev(x)        v4_swaphalf(vrev64q_f32(x))
+#define v4_dupeven(x)    (vtrnq_f32((x),(x)).val[0])
+#define v4_dupodd(x)     (vtrnq_f32((x),(x)).val[1])
+
+#define v4_gtz(x)        vreinterpretq_f32_u32(vcgtq_f32((x),vdupq_n_f32(0.f)))
+#define v4_sel(m,a,b)    vbslq_f32(vreinterpretq_u32_f32(m),(a),(b))
+#define v4_and(m,x)      vreinterpretq_f32_u32(vandq_u32(  \
+                           vreinterpretq_u32_f32(m),vreinterpretq_u32_f32(x)))
+
+#endif
+
+#endif
@@ -30,6 +30,7 @@
 #include "lpc.h"
 #include "registry.h"
 #include "misc.h"
+#include "simd.h"
 
 static int ilog2(unsigned int v){
   int ret=0;
@@ -714,6 +715,21 @@ int vorbis_synthesis_init(vorbis_dsp_state *v,vorbis_info *vi){
   return 0;
 }
 
+/* lap the rising half of the window over p onto the falling half
+   already in pcm */
+static void _overlap_add(float *pcm,const float *p,const float *w,int n){
+  int i=0;
+#ifdef VORBIS_SIMD
+  for(;i+4<=n;i+=4){
+    v4sf l=v4_mul(v4_ld(pcm+i),v4_rev(v4_ld(w+n-i-4)));
+    v4sf r=v4_mul(v4_ld(p+i),v4_ld(w+i));
+    v4_st(pcm+i,v4_add(l,r));
+  }
+#endif
+  for(;i<n;i++)
+    pcm[i]=pcm[i]*w[n-i-1] + p[i]*w[i];
+}
+
 /* Unlike in analysis, the window is only partially applied for each
    block.  The time domain envelope is not yet handled at the point of
    calling (as it relies on the previous block). */
@@ -723,7 +739,7 @@ int vorbis_synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb){
   codec_setup_info *ci=vi->codec_setup;
   private_state *b=v->backend_state;
   int hs=ci->halfrate_flag;
-  int i,j;
+  int j;
 
   if(!vb)return(OV_EINVAL);
   if(v->pcm_current>v->pcm_returned  && v->pcm_returned!=-1)return(OV_EINVAL);
@@ -774,15 +790,13 @@ int vorbis_synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb){
           float *w=_vorbis_window_get(b->window[1]-hs);
           float *pcm=v->pcm[j]+prevCenter;
           float *p=vb->pcm[j];
-          for(i=0;i<n1;i++)
-            pcm[i]=pcm[i]*w[n1-i-1] + p[i]*w[i];
+          _overlap_add(pcm,p,w,n1);
         }else{
           /* large/small */
           float *w=_vorbis_window_get(b->window[0]-hs);
           float *pcm=v->pcm[j]+prevCenter+n1/2-n0/2;
           float *p=vb->pcm[j];
-          for(i=0;i<n0;i++)
-            pcm[i]=pcm[i]*w[n0-i-1] +p[i]*w[i];
+          _overlap_add(pcm,p,w,n0);
         }
       }else{
         if(v->W){
@@ -790,27 +804,19 @@ int vorbis_synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb){
           float *w=_vorbis_window_get(b->window[0]-hs);
           float *pcm=v->pcm[j]+prevCenter;
           float *p=vb->pcm[j]+n1/2-n0/2;
-          for(i=0;i<n0;i++)
-            pcm[i]=pcm[i]*w[n0-i-1] +p[i]*w[i];
-          for(;i<n1/2+n0/2;i++)
-            pcm[i]=p[i];
+          _overlap_add(pcm,p,w,n0);
+          memcpy(pcm+n0,p+n0,sizeof(*pcm)*(n1/2-n0/2));
         }else{
           /* small/small */
           float *w=_vorbis_window_get(b->window[0]-hs);
           float *pcm=v->pcm[j]+prevCenter;
           float *p=vb->pcm[j];
-          for(i=0;i<n0;i++)
-            pcm[i]=pcm[i]*w[n0-i-1] +p[i]*w[i];
+          _overlap_add(pcm,p,w,n0);
         }
       }
 
       /* the copy section */
-      {
-        float *pcm=v->pcm[j]+thisCenter;
-        float *p=vb->pcm[j]+n;
-        for(i=0;i<n;i++)
-          pcm[i]=p[i];
-      }
+      memcpy(v->pcm[j]+thisCenter,vb->pcm[j]+n,sizeof(**v->pcm)*n);
     }
 
     if(v->centerW)
@@ -27,6 +27,7 @@
 #include "registry.h"
 #include "psy.h"
 #include "misc.h"
+#include "simd.h"
 
 /* simplistic, wasteful way of doing this (unique lookup for each
    mode/submapping); there should be a central repository for
@@ -763,7 +764,27 @@ static int mapping0_inverse(vorbis_block *vb,vorbis_info_mapping *l){
     float *pcmM=vb->pcm[info->coupling_mag[i]];
     float *pcmA=vb->pcm[info->coupling_ang[i]];
 
-    for(j=0;j<n/2;j++){
+    j=0;
+#ifdef VORBIS_SIMD
+    {
+      /* the loop below without the branches: ang>0 decides which
+         channel keeps mag, and with t being ang negated where mag>0
+         the other one gets mag+t (ang channel) or mag-t (mag
+         channel) */
+      v4sf sign=v4_set(-0.f,-0.f,-0.f,-0.f);
+
+      for(;j+4<=n/2;j+=4){
+        v4sf mag=v4_ld(pcmM+j);
+        v4sf ang=v4_ld(pcmA+j);
+        v4sf t=v4_xor(ang,v4_and(v4_gtz(mag),sign));
+        v4sf angp=v4_gtz(ang);
+
+        v4_st(pcmM+j,v4_sel(angp,mag,v4_sub(mag,t)));
+        v4_st(pcmA+j,v4_sel(angp,v4_add(mag,t),mag));
+      }
+    }
+#endif
+    for(;j<n/2;j++){
       float mag=pcmM[j];
       float ang=pcmA[j];
 
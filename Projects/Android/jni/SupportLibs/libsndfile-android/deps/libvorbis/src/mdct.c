@@ -45,6 +45,11 @@
 #include "mdct.h"
 #include "os.h"
 #include "misc.h"
+#include "simd.h"
+
+#if defined(VORBIS_SIMD) && !defined(MDCT_INTEGERIZED)
+#define MDCT_SIMD
+#endif
 
 /* build lookups for trig functions; also pre-figure scaling and
    some window function algebra. */
@@ -213,6 +218,32 @@ STIN void mdct_butterfly_32(DATA_TYPE *x){
 
 }
 
+#ifdef MDCT_SIMD
+/* one step of the first/generic stage butterflies below: the sums go
+   back to x1, the differences are rotated into x2.  lo holds the
+   trig pairs for x2[0..1] and x2[2..3], hi the ones for x2[4..5] and
+   x2[6..7] */
+STIN void mdct_butterfly_8x2(DATA_TYPE *x1,DATA_TYPE *x2,v4sf lo,v4sf hi){
+  v4sf a0 = v4_ld(x1);
+  v4sf a1 = v4_ld(x1+4);
+  v4sf b0 = v4_ld(x2);
+  v4sf b1 = v4_ld(x2+4);
+  v4sf d0 = v4_sub(a0,b0);
+  v4sf d1 = v4_sub(a1,b1);
+  v4sf r0 = v4_even(d0,d1);
+  v4sf r1 = v4_odd(d0,d1);
+  v4sf t0 = v4_even(lo,hi);
+  v4sf t1 = v4_odd(lo,hi);
+  v4sf e  = v4_add(v4_mul(r1,t1),v4_mul(r0,t0));
+  v4sf o  = v4_sub(v4_mul(r1,t0),v4_mul(r0,t1));
+
+  v4_st(x1,  v4_add(a0,b0));
+  v4_st(x1+4,v4_add(a1,b1));
+  v4_st(x2,  v4_ziplo(e,o));
+  v4_st(x2+4,v4_ziphi(e,o));
+}
+#endif
+
 /* N point first stage butterfly (in place, 2 register) */
 STIN void mdct_butterfly_first(DATA_TYPE *T,
                                         DATA_TYPE *x,
@@ -220,6 +251,17 @@ STIN void mdct_butterfly_first(DATA_TYPE *T,
 
   DATA_TYPE *x1        = x          + points      - 8;
   DATA_TYPE *x2        = x          + (points>>1) - 8;
+#ifdef MDCT_SIMD
+
+  do{
+    mdct_butterfly_8x2(x1,x2,v4_ld2x2(T+12,T+8),v4_ld2x2(T+4,T));
+
+    x1-=8;
+    x2-=8;
+    T+=16;
+
+  }while(x2>=x);
+#else
   REG_TYPE   r0;
   REG_TYPE   r1;
 
@@ -258,6 +300,7 @@ STIN void mdct_butterfly_first(DATA_TYPE *T,
     T+=16;
 
   }while(x2>=x);
+#endif
 }
 
 /* N/stage point generic N stage butterfly (in place, 2 register) */
@@ -268,6 +311,18 @@ STIN void mdct_butterfly_generic(DATA_TYPE *T,
 
   DATA_TYPE *x1        = x          + points      - 8;
   DATA_TYPE *x2        = x          + (points>>1) - 8;
+#ifdef MDCT_SIMD
+
+  do{
+    mdct_butterfly_8x2(x1,x2,v4_ld2x2(T+trigint*3,T+trigint*2),
+                       v4_ld2x2(T+trigint,T));
+
+    T+=trigint*4;
+    x1-=8;
+    x2-=8;
+
+  }while(x2>=x);
+#else
   REG_TYPE   r0;
   REG_TYPE   r1;
 
@@ -312,6 +367,7 @@ STIN void mdct_butterfly_generic(DATA_TYPE *T,
     x2-=8;
 
   }while(x2>=x);
+#endif
 }
 
 STIN void mdct_butterflies(mdct_lookup *init,
@@ -405,6 +461,23 @@ void mdct_backward(mdct_lookup *init, DATA_TYPE *in, DATA_TYPE *out){
   DATA_TYPE *oX = out+n2+n4;
   DATA_TYPE *T  = init->trig+n4;
 
+#ifdef MDCT_SIMD
+  {
+    /* the first step loads in[n2], which is never used */
+    v4sf sign=v4_set(-0.f,0.f,-0.f,0.f);
+
+    do{
+      v4sf e = v4_even(v4_ld(iX),v4_ld(iX+4));
+      v4sf t = v4_swaphalf(v4_ld(T));
+
+      oX         -= 4;
+      v4_st(oX,v4_sub(v4_mul(v4_swappair(e),v4_xor(v4_dupodd(t),sign)),
+                      v4_mul(e,v4_dupeven(t))));
+      iX         -= 8;
+      T          += 4;
+    }while(iX>=in);
+  }
+#else
   do{
     oX         -= 4;
     oX[0]       = MULT_NORM(-iX[2] * T[3] - iX[0]  * T[2]);
@@ -414,11 +487,29 @@ void mdct_backward(mdct_lookup *init, DATA_TYPE *in, DATA_TYPE *out){
     iX         -= 8;
     T          += 4;
   }while(iX>=in);
+#endif
 
   iX            = in+n2-8;
   oX            = out+n2+n4;
   T             = init->trig+n4;
 
+#ifdef MDCT_SIMD
+  {
+    v4sf sign=v4_set(0.f,-0.f,0.f,-0.f);
+
+    do{
+      v4sf e = v4_swaphalf(v4_even(v4_ld(iX),v4_ld(iX+4)));
+      v4sf t;
+
+      T          -= 4;
+      t           = v4_ld(T);
+      v4_st(oX,v4_add(v4_mul(v4_dupeven(e),v4_rev(t)),
+                      v4_mul(v4_dupodd(e),v4_xor(v4_swaphalf(t),sign))));
+      iX         -= 8;
+      oX         += 4;
+    }while(iX>=in);
+  }
+#else
   do{
     T          -= 4;
     oX[0]       =  MULT_NORM (iX[4] * T[3] + iX[6] * T[2]);
@@ -428,6 +519,7 @@ void mdct_backward(mdct_lookup *init, DATA_TYPE *in, DATA_TYPE *out){
     iX         -= 8;
     oX         += 4;
   }while(iX>=in);
+#endif
 
   mdct_butterflies(init,out+n2,n2);
   mdct_bitreverse(init,out);
@@ -438,8 +530,57 @@ void mdct_backward(mdct_lookup *init, DATA_TYPE *in, DATA_TYPE *out){
     DATA_TYPE *oX1=out+n2+n4;
     DATA_TYPE *oX2=out+n2+n4;
     DATA_TYPE *iX =out;
+#ifdef MDCT_SIMD
+    v4sf sign     =v4_set(-0.f,-0.f,-0.f,-0.f);
+#endif
     T             =init->trig+n2;
 
+#ifdef MDCT_SIMD
+    do{
+      v4sf i0 = v4_ld(iX);
+      v4sf i1 = v4_ld(iX+4);
+      v4sf t0 = v4_ld(T);
+      v4sf t1 = v4_ld(T+4);
+      v4sf e  = v4_even(i0,i1);
+      v4sf o  = v4_odd(i0,i1);
+      v4sf te = v4_even(t0,t1);
+      v4sf to = v4_odd(t0,t1);
+
+      oX1-=4;
+      v4_st(oX1,v4_rev(v4_sub(v4_mul(e,to),v4_mul(o,te))));
+      v4_st(oX2,v4_xor(v4_add(v4_mul(e,te),v4_mul(o,to)),sign));
+
+      oX2+=4;
+      iX    +=   8;
+      T     +=   8;
+    }while(iX<oX1);
+
+    iX=out+n2+n4;
+    oX1=out+n4;
+    oX2=oX1;
+
+    do{
+      v4sf x;
+
+      oX1-=4;
+      iX-=4;
+
+      x=v4_ld(iX);
+      v4_st(oX1,x);
+      v4_st(oX2,v4_xor(v4_rev(x),sign));
+
+      oX2+=4;
+    }while(oX2<iX);
+
+    iX=out+n2+n4;
+    oX1=out+n2+n4;
+    oX2=out+n2;
+    do{
+      oX1-=4;
+      v4_st(oX1,v4_rev(v4_ld(iX)));
+      iX+=4;
+    }while(oX1>oX2);
+#else
     do{
       oX1-=4;
 
@@ -487,6 +628,7 @@ void mdct_backward(mdct_lookup *init, DATA_TYPE *in, DATA_TYPE *out){
       oX1[3]= iX[0];
       iX+=4;
     }while(oX1>oX2);
+#endif
   }
 }
 
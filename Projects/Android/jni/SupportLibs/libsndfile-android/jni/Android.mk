@@ -42,5 +42,10 @@ LOCAL_SRC_FILES := mat5.c windows.c G72x/g723_24.c G72x/g72x.c \
 
 #LOCAL_LDLIBS += -llog -ldl
 LOCAL_STATIC_LIBRARIES := flac
-include $(BUILD_STATIC_LIBRARY)
 
+# the Vorbis MDCT, overlap-add and sample conversion use SSE2/NEON
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_ARM_NEON := true
+endif
+
+include $(BUILD_STATIC_LIBRARY)
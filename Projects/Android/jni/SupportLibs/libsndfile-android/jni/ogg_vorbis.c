@@ -76,6 +76,12 @@
 
 #include "ogg.h"
 
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 typedef int convert_func (int, void *, int, int, float **) ;
 
 static int	vorbis_read_header (SF_PRIVATE *psf, int log_data) ;
@@ -578,12 +584,124 @@ vorbis_rnull (int samples, void *UNUSED (vptr), int UNUSED (off) , int channels,
 	return samples * channels ;
 } /* vorbis_rnull */
 
+/*
+** Mono and stereo make up nearly everything, so those get vector loops
+** that convert and interleave straight out of the decoder's channel
+** buffers. The short conversion rounds like lrintf and keeps the low 16
+** bits, exactly as the scalar loops do.
+*/
+
+#if defined (__SSE2__)
+
+static inline __m128i
+vorbis_f2s4 (const float *src)
+{	__m128i x = _mm_cvtps_epi32 (_mm_mul_ps (_mm_loadu_ps (src), _mm_set1_ps (32767.0f))) ;
+	return _mm_srai_epi32 (_mm_slli_epi32 (x, 16), 16) ;
+} /* vorbis_f2s4 */
+
+static int
+vorbis_rshort_simd (int samples, short *ptr, int channels, float **pcm)
+{	int j = 0 ;
+
+	if (channels == 1)
+	{	for ( ; j + 8 <= samples ; j += 8)
+			_mm_storeu_si128 ((__m128i *) (ptr + j),
+					_mm_packs_epi32 (vorbis_f2s4 (pcm [0] + j), vorbis_f2s4 (pcm [0] + j + 4))) ;
+		}
+	else if (channels == 2)
+	{	for ( ; j + 8 <= samples ; j += 8)
+		{	__m128i l = _mm_packs_epi32 (vorbis_f2s4 (pcm [0] + j), vorbis_f2s4 (pcm [0] + j + 4)) ;
+			__m128i r = _mm_packs_epi32 (vorbis_f2s4 (pcm [1] + j), vorbis_f2s4 (pcm [1] + j + 4)) ;
+			_mm_storeu_si128 ((__m128i *) (ptr + 2 * j), _mm_unpacklo_epi16 (l, r)) ;
+			_mm_storeu_si128 ((__m128i *) (ptr + 2 * j + 8), _mm_unpackhi_epi16 (l, r)) ;
+			} ;
+		} ;
+
+	return j ;
+} /* vorbis_rshort_simd */
+
+static int
+vorbis_rfloat_simd (int samples, float *ptr, int channels, float **pcm)
+{	int j = 0 ;
+
+	if (channels == 2)
+	{	for ( ; j + 4 <= samples ; j += 4)
+		{	__m128 l = _mm_loadu_ps (pcm [0] + j) ;
+			__m128 r = _mm_loadu_ps (pcm [1] + j) ;
+			_mm_storeu_ps (ptr + 2 * j, _mm_unpacklo_ps (l, r)) ;
+			_mm_storeu_ps (ptr + 2 * j + 4, _mm_unpackhi_ps (l, r)) ;
+			} ;
+		} ;
+
+	return j ;
+} /* vorbis_rfloat_simd */
+
+#define VORBIS_RSHORT_SIMD
+#define VORBIS_RFLOAT_SIMD
+
+#elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+
+#if defined (__aarch64__)
+/* 32-bit ARM has no round-to-nearest conversion, that one stays scalar. */
+
+static inline int16x4_t
+vorbis_f2s4 (const float *src)
+{	return vmovn_s32 (vcvtnq_s32_f32 (vmulq_n_f32 (vld1q_f32 (src), 32767.0f))) ;
+} /* vorbis_f2s4 */
+
+static int
+vorbis_rshort_simd (int samples, short *ptr, int channels, float **pcm)
+{	int j = 0 ;
+
+	if (channels == 1)
+	{	for ( ; j + 8 <= samples ; j += 8)
+			vst1q_s16 (ptr + j, vcombine_s16 (vorbis_f2s4 (pcm [0] + j), vorbis_f2s4 (pcm [0] + j + 4))) ;
+		}
+	else if (channels == 2)
+	{	for ( ; j + 8 <= samples ; j += 8)
+		{	int16x8x2_t lr ;
+			lr.val [0] = vcombine_s16 (vorbis_f2s4 (pcm [0] + j), vorbis_f2s4 (pcm [0] + j + 4)) ;
+			lr.val [1] = vcombine_s16 (vorbis_f2s4 (pcm [1] + j), vorbis_f2s4 (pcm [1] + j + 4)) ;
+			vst2q_s16 (ptr + 2 * j, lr) ;
+			} ;
+		} ;
+
+	return j ;
+} /* vorbis_rshort_simd */
+
+#define VORBIS_RSHORT_SIMD
+#endif
+
+static int
+vorbis_rfloat_simd (int samples, float *ptr, int channels, float **pcm)
+{	int j = 0 ;
+
+	if (channels == 2)
+	{	for ( ; j + 4 <= samples ; j += 4)
+		{	float32x4x2_t lr ;
+			lr.val [0] = vld1q_f32 (pcm [0] + j) ;
+			lr.val [1] = vld1q_f32 (pcm [1] + j) ;
+			vst2q_f32 (ptr + 2 * j, lr) ;
+			} ;
+		} ;
+
+	return j ;
+} /* vorbis_rfloat_simd */
+
+#define VORBIS_RFLOAT_SIMD
+
+#endif
+
 static int
 vorbis_rshort (int samples, void *vptr, int off, int channels, float **pcm)
 {
 	short *ptr = (short*) vptr + off ;
-	int i = 0, j, n ;
-	for (j = 0 ; j < samples ; j++)
+	int i = 0, j = 0, n ;
+#ifdef VORBIS_RSHORT_SIMD
+	j = vorbis_rshort_simd (samples, ptr, channels, pcm) ;
+	i = j * channels ;
+#endif
+	for ( ; j < samples ; j++)
 		for (n = 0 ; n < channels ; n++)
 			ptr [i++] = lrintf (pcm [n][j] * 32767.0f) ;
 	return i ;
@@ -605,8 +723,17 @@ static int
 vorbis_rfloat (int samples, void *vptr, int off, int channels, float **pcm)
 {
 	float *ptr = (float*) vptr + off ;
-	int i = 0, j, n ;
-	for (j = 0 ; j < samples ; j++)
+	int i = 0, j = 0, n ;
+
+	if (channels == 1)
+	{	memcpy (ptr, pcm [0], samples * sizeof (float)) ;
+		return samples ;
+		} ;
+#ifdef VORBIS_RFLOAT_SIMD
+	j = vorbis_rfloat_simd (samples, ptr, channels, pcm) ;
+	i = j * channels ;
+#endif
+	for ( ; j < samples ; j++)
 		for (n = 0 ; n < channels ; n++)
 			ptr [i++] = pcm [n][j] ;
 	return i ;
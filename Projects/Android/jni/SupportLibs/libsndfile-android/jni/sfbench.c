@@ -0,0 +1,184 @@
+/*
+** Copyright (C) 2008-2011 Erik de Castro Lopo <erikd@mega-nerd.com>
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation; either version 2.1 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+/*
+** Decode throughput benchmark for sf_readf_short / sf_readf_float, mostly
+** for the Ogg Vorbis path (ogg_vorbis.c and the libvorbis copy in deps).
+** Each file is read to the end in blocks of BLOCK_FRAMES frames the given
+** number of times and the fastest pass is reported. The first pass of each
+** file is folded into a checksum of the output bytes, so that builds (e.g.
+** with and without the SSE2/NEON code) can be compared, and can be written
+** out raw with -o.
+**
+** This is not part of the Android build. Build it against the static
+** libraries ndk-build leaves in obj/local/<abi> and run it on the device:
+**
+**	$CC -O2 -I. -o sfbench sfbench.c libsndfile.a libflac.a -lm
+**	./sfbench [-f] [-p passes] [-o output.raw] file.ogg ...
+**
+** or on a host the same way, with the sources of both Android.mk files
+** compiled for the host into libsndfile.a and libflac.a; glibc needs
+** -D_GNU_SOURCE for the off64_t in sndfile.h.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sndfile.h"
+
+#define	BLOCK_FRAMES	1024
+#define	MAX_CHANNELS	8
+
+static double
+now (void)
+{	struct timespec ts ;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts) ;
+	return ts.tv_sec + ts.tv_nsec / 1e9 ;
+} /* now */
+
+static unsigned long
+checksum_bytes (unsigned long checksum, const unsigned char *data, size_t len)
+{	size_t k ;
+
+	for (k = 0 ; k < len ; k++)
+		checksum = ((checksum ^ data [k]) * 16777619UL) & 0xffffffffUL ;
+	return checksum ;
+} /* checksum_bytes */
+
+/* One pass over the file, returns the seconds it took or -1 on error. The
+** output is only checksummed and written when checksum is not NULL.
+*/
+static double
+read_file (const char *filename, int use_float, FILE *out, SF_INFO *info,
+			sf_count_t *frames, unsigned long *checksum)
+{	static float fbuf [BLOCK_FRAMES * MAX_CHANNELS] ;
+	static short sbuf [BLOCK_FRAMES * MAX_CHANNELS] ;
+	SNDFILE *file ;
+	sf_count_t count ;
+	size_t bytes ;
+	double t ;
+
+	memset (info, 0, sizeof (*info)) ;
+	if ((file = sf_open (filename, SFM_READ, info)) == NULL)
+	{	fprintf (stderr, "%s: %s\n", filename, sf_strerror (NULL)) ;
+		return -1 ;
+		} ;
+	if (info->channels > MAX_CHANNELS)
+	{	fprintf (stderr, "%s: %d channels, at most %d\n", filename, info->channels, MAX_CHANNELS) ;
+		sf_close (file) ;
+		return -1 ;
+		} ;
+
+	*frames = 0 ;
+	if (checksum != NULL)
+		*checksum = 2166136261UL ;
+	t = now () ;
+	while (1)
+	{	if (use_float)
+			count = sf_readf_float (file, fbuf, BLOCK_FRAMES) ;
+		else
+			count = sf_readf_short (file, sbuf, BLOCK_FRAMES) ;
+		if (count <= 0)
+			break ;
+		*frames += count ;
+
+		if (checksum != NULL)
+		{	bytes = count * info->channels * (use_float ? sizeof (float) : sizeof (short)) ;
+			*checksum = checksum_bytes (*checksum, use_float ? (void *) fbuf : (void *) sbuf, bytes) ;
+			if (out != NULL)
+				fwrite (use_float ? (void *) fbuf : (void *) sbuf, 1, bytes, out) ;
+			} ;
+		} ;
+	t = now () - t ;
+
+	if (sf_error (file) != SF_ERR_NO_ERROR)
+	{	fprintf (stderr, "%s: %s\n", filename, sf_strerror (file)) ;
+		sf_close (file) ;
+		return -1 ;
+		} ;
+	sf_close (file) ;
+	return t ;
+} /* read_file */
+
+static void
+usage (const char *name)
+{	fprintf (stderr, "usage: %s [-f] [-p passes] [-o output.raw] file ...\n", name) ;
+} /* usage */
+
+int
+main (int argc, char *argv [])
+{	const char *outname = NULL ;
+	FILE *out = NULL ;
+	SF_INFO info ;
+	sf_count_t frames, total_frames = 0, pass_frames ;
+	unsigned long checksum = 0 ;
+	double t, best, total = 0 ;
+	int use_float = 0, passes = 5, pass, k ;
+
+	for (k = 1 ; k < argc && argv [k][0] == '-' ; k++)
+	{	if (strcmp (argv [k], "-f") == 0)
+			use_float = 1 ;
+		else if (strcmp (argv [k], "-p") == 0 && k + 1 < argc)
+			passes = atoi (argv [++k]) ;
+		else if (strcmp (argv [k], "-o") == 0 && k + 1 < argc)
+			outname = argv [++k] ;
+		else
+		{	usage (argv [0]) ;
+			return 1 ;
+			} ;
+		} ;
+	if (k == argc || passes <= 0)
+	{	usage (argv [0]) ;
+		return 1 ;
+		} ;
+	if (outname != NULL && (out = fopen (outname, "wb")) == NULL)
+	{	perror (outname) ;
+		return 2 ;
+		} ;
+
+	printf ("%s, best of %d passes\n", use_float ? "sf_readf_float" : "sf_readf_short", passes) ;
+	printf ("%-32s %3s %6s %10s %10s %10s %8s\n", "file", "ch", "rate", "frames", "best ms", "Mframes/s", "checksum") ;
+	for ( ; k < argc ; k++)
+	{	best = -1 ;
+		frames = 0 ;
+		for (pass = 0 ; pass < passes ; pass++)
+		{	t = read_file (argv [k], use_float, pass == 0 ? out : NULL, &info,
+							&pass_frames, pass == 0 ? &checksum : NULL) ;
+			if (t < 0)
+				return 3 ;
+			if (pass == 0)
+				frames = pass_frames ;
+			if (best < 0 || t < best)
+				best = t ;
+			} ;
+		printf ("%-32s %3d %6d %10ld %10.3f %10.2f %08lx\n", argv [k], info.channels, info.samplerate,
+					(long) frames, best * 1e3, frames / best / 1e6, checksum) ;
+		total += best ;
+		total_frames += frames ;
+		} ;
+	printf ("total %.3f ms, %.2f Mframes/s\n", total * 1e3, total_frames / total / 1e6) ;
+
+	if (out != NULL && (ferror (out) | fclose (out)))
+	{	perror (outname) ;
+		return 2 ;
+		} ;
+	return 0 ;
+} /* main */
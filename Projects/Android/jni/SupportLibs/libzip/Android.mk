@@ -47,6 +47,7 @@ LOCAL_SRC_FILES :=\
 	zip_get_file_comment.c \
 	zip_get_num_files.c \
 	zip_get_name.c \
+	zip_hash.c \
 	zip_memdup.c \
 	zip_name_locate.c \
 	zip_new.c \
@@ -74,6 +74,8 @@ _zip_free(struct zip *za)
     }
 
     free(za->file);
+
+    _zip_hash_free(za->hash);
     
     free(za);
 
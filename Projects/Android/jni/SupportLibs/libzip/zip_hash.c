@@ -0,0 +1,286 @@
+/*
+  zip_hash.c -- index of entry names for _zip_name_locate
+  Copyright (C) 1999-2007 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <libzip@nih.at>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+ 
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zipint.h"
+
+static const char *_zip_hash_basename(const char *);
+static unsigned int _zip_hash_string(const char *);
+static const char *_zip_hash_name(struct zip *, int);
+static void _zip_hash_insert(struct zip_hash *, int, const char *);
+static void _zip_hash_remove(struct zip_hash *, int);
+
+
+
+/* _zip_hash_build:
+   (re)creates the name index of za from its current entries.  On
+   failure za is left without an index and lookups fall back to
+   scanning all entries. */
+
+void
+_zip_hash_build(struct zip *za)
+{
+    struct zip_hash *zh;
+    int i, nbucket;
+
+    _zip_hash_free(za->hash);
+    za->hash = NULL;
+
+    for (nbucket=16; nbucket<za->nentry; nbucket*=2)
+	;
+
+    if ((zh=(struct zip_hash *)malloc(sizeof(*zh))) == NULL)
+	return;
+    zh->nbucket = nbucket;
+    zh->nalloc = za->nentry_alloc;
+    zh->name_bucket = (int *)malloc(sizeof(int) * 2 * nbucket);
+    zh->base_bucket = zh->name_bucket + nbucket;
+    zh->entry = (struct zip_hash_entry *)malloc(sizeof(*(zh->entry))
+						 * (zh->nalloc ? zh->nalloc : 1));
+    if (zh->name_bucket == NULL || zh->entry == NULL) {
+	_zip_hash_free(zh);
+	return;
+    }
+
+    for (i=0; i<2*nbucket; i++)
+	zh->name_bucket[i] = -1;
+    for (i=0; i<zh->nalloc; i++)
+	zh->entry[i].indexed = 0;
+
+    /* inserting from the back keeps each chain in index order */
+    for (i=za->nentry-1; i>=0; i--)
+	_zip_hash_insert(zh, i, _zip_hash_name(za, i));
+
+    za->hash = zh;
+}
+
+
+
+void
+_zip_hash_free(struct zip_hash *zh)
+{
+    if (zh == NULL)
+	return;
+
+    free(zh->name_bucket);
+    free(zh->entry);
+    free(zh);
+}
+
+
+
+/* _zip_hash_lookup:
+   returns the lowest index of a non-deleted entry whose name matches
+   fname under flags (ZIP_FL_NOCASE, ZIP_FL_NODIR), or -1.  Only
+   valid for current names, not with ZIP_FL_UNCHANGED. */
+
+int
+_zip_hash_lookup(struct zip *za, const char *fname, int flags)
+{
+    struct zip_hash *zh;
+    const char *fn;
+    unsigned int h;
+    int i;
+
+    zh = za->hash;
+    h = _zip_hash_string(fname);
+
+    if (flags & ZIP_FL_NODIR)
+	i = zh->base_bucket[h & (zh->nbucket-1)];
+    else
+	i = zh->name_bucket[h & (zh->nbucket-1)];
+
+    while (i != -1) {
+	if (((flags & ZIP_FL_NODIR) ? zh->entry[i].base_hash
+	     : zh->entry[i].name_hash) == h
+	    && za->entry[i].state != ZIP_ST_DELETED) {
+	    fn = _zip_hash_name(za, i);
+	    if (flags & ZIP_FL_NODIR)
+		fn = _zip_hash_basename(fn);
+
+	    if (((flags & ZIP_FL_NOCASE) ? strcasecmp(fname, fn)
+		 : strcmp(fname, fn)) == 0)
+		return i;
+	}
+
+	i = (flags & ZIP_FL_NODIR) ? zh->entry[i].base_next
+	    : zh->entry[i].name_next;
+    }
+
+    return -1;
+}
+
+
+
+/* _zip_hash_update:
+   reindexes entry idx after its name changed or it was added. */
+
+void
+_zip_hash_update(struct zip *za, int idx)
+{
+    struct zip_hash *zh;
+    struct zip_hash_entry *entry;
+    int i;
+
+    if ((zh=za->hash) == NULL)
+	return;
+
+    if (idx >= zh->nalloc) {
+	/* keep chains short as the archive grows */
+	if (za->nentry > 2*zh->nbucket) {
+	    _zip_hash_build(za);
+	    return;
+	}
+
+	if ((entry=(struct zip_hash_entry *)
+	     realloc(zh->entry, sizeof(*entry) * za->nentry_alloc)) == NULL) {
+	    _zip_hash_free(zh);
+	    za->hash = NULL;
+	    return;
+	}
+	for (i=zh->nalloc; i<za->nentry_alloc; i++)
+	    entry[i].indexed = 0;
+	zh->entry = entry;
+	zh->nalloc = za->nentry_alloc;
+    }
+
+    _zip_hash_remove(zh, idx);
+    _zip_hash_insert(zh, idx, _zip_hash_name(za, idx));
+}
+
+
+
+static const char *
+_zip_hash_basename(const char *fn)
+{
+    const char *p;
+
+    if ((p=strrchr(fn, '/')) != NULL)
+	return p+1;
+    return fn;
+}
+
+
+
+/* FNV-1a over the case-folded name, so that names equal under
+   strcasecmp land in the same bucket */
+
+static unsigned int
+_zip_hash_string(const char *s)
+{
+    unsigned int h;
+
+    h = 2166136261u;
+    while (*s) {
+	h ^= (unsigned char)tolower((unsigned char)*s++);
+	h *= 16777619u;
+    }
+
+    return h;
+}
+
+
+
+/* current name of entry idx, including that of a deleted entry, since
+   it can be undeleted without its name being set again */
+
+static const char *
+_zip_hash_name(struct zip *za, int idx)
+{
+    if (za->entry[idx].ch_filename)
+	return za->entry[idx].ch_filename;
+    if (za->cdir && idx < za->cdir->nentry)
+	return za->cdir->entry[idx].filename;
+    return NULL;
+}
+
+
+
+static void
+_zip_hash_insert(struct zip_hash *zh, int idx, const char *fn)
+{
+    struct zip_hash_entry *ze;
+    int *p;
+
+    /* newly added (partially filled) entry */
+    if (fn == NULL)
+	return;
+
+    ze = zh->entry+idx;
+    ze->name_hash = _zip_hash_string(fn);
+    ze->base_hash = _zip_hash_string(_zip_hash_basename(fn));
+
+    for (p=zh->name_bucket+(ze->name_hash & (zh->nbucket-1));
+	 *p != -1 && *p < idx; p=&zh->entry[*p].name_next)
+	;
+    ze->name_next = *p;
+    *p = idx;
+
+    for (p=zh->base_bucket+(ze->base_hash & (zh->nbucket-1));
+	 *p != -1 && *p < idx; p=&zh->entry[*p].base_next)
+	;
+    ze->base_next = *p;
+    *p = idx;
+
+    ze->indexed = 1;
+}
+
+
+
+static void
+_zip_hash_remove(struct zip_hash *zh, int idx)
+{
+    struct zip_hash_entry *ze;
+    int *p;
+
+    ze = zh->entry+idx;
+    if (!ze->indexed)
+	return;
+
+    for (p=zh->name_bucket+(ze->name_hash & (zh->nbucket-1));
+	 *p != idx; p=&zh->entry[*p].name_next)
+	;
+    *p = ze->name_next;
+
+    for (p=zh->base_bucket+(ze->base_hash & (zh->nbucket-1));
+	 *p != idx; p=&zh->entry[*p].base_next)
+	;
+    *p = ze->base_next;
+
+    ze->indexed = 0;
+}
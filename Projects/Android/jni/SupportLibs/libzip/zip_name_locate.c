@@ -60,6 +60,12 @@ _zip_name_locate(struct zip *za, const char *fname, int flags,
 	return -1;
     }
     
+    if (za->hash && (flags & ZIP_FL_UNCHANGED) == 0) {
+	if ((i=_zip_hash_lookup(za, fname, flags)) == -1)
+	    _zip_error_set(error, ZIP_ER_NOENT, 0);
+	return i;
+    }
+
     cmp = (flags & ZIP_FL_NOCASE) ? strcasecmp : strcmp;
 
     n = (flags & ZIP_FL_UNCHANGED) ? za->cdir->nentry : za->nentry;
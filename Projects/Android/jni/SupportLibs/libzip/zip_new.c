@@ -64,6 +64,7 @@ _zip_new(struct zip_error *error)
     za->entry = NULL;
     za->nfile = za->nfile_alloc = 0;
     za->file = NULL;
+    za->hash = NULL;
     za->flags = za->ch_flags = 0;
     
     return za;
@@ -115,6 +115,7 @@ zip_open(const char *fn, int flags, int *zep)
     }
     for (i=0; i<cdir->nentry; i++)
 	_zip_entry_new(za);
+    _zip_hash_build(za);
 
     _zip_check_torrentzip(za);
     za->ch_flags = za->flags;
@@ -433,6 +434,7 @@ _zip_allocate_new(const char *fn, int *zep)
 	set_error(zep, NULL, ZIP_ER_MEMORY);
 	return NULL;
     }
+    _zip_hash_build(za);
     return za;
 }
 
@@ -70,6 +70,7 @@ _zip_set_name(struct zip *za, int idx, const char *name)
 
     free(za->entry[idx].ch_filename);
     za->entry[idx].ch_filename = s;
+    _zip_hash_update(za, idx);
 
     return 0;
 }
@@ -70,6 +70,7 @@ _zip_unchange(struct zip *za, int idx, int allow_duplicates)
 
 	free(za->entry[idx].ch_filename);
 	za->entry[idx].ch_filename = NULL;
+	_zip_hash_update(za, idx);
     }
 
     free(za->entry[idx].ch_comment);
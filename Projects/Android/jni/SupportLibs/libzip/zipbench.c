@@ -0,0 +1,281 @@
+/*
+  zipbench.c -- time zip_name_locate on an archive with many entries
+  Copyright (C) 1999-2007 Dieter Baron and Thomas Klausner
+
+  This file is part of libzip, a library to manipulate ZIP archives.
+  The authors can be contacted at <libzip@nih.at>
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  1. Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+  3. The names of the authors may not be used to endorse or promote
+     products derived from this software without specific prior
+     written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+  GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+  Writes an archive of empty stored entries laid out like a large pk3
+  (default 50000 entries, in directories of 500, with base names that
+  repeat across directories), opens it and looks up every entry by its
+  name, with no flags, ZIP_FL_NOCASE on the upper-cased name and
+  ZIP_FL_NODIR on the base name.  Every lookup is checked against the
+  expected index.  The same lookups with ZIP_FL_UNCHANGED, which scans
+  the central directory, are timed on every 100th name and scaled up;
+  -l scans for all of them.  Exits 1 on a wrong result.
+
+  This is not built with the library; on a POSIX system, from this
+  directory:
+
+	cc -O2 -I. -o zipbench zipbench.c zip_*.c mkstemp.c -lz
+	./zipbench [-l] [-n entries] [archive.zip]
+*/
+
+
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zip.h"
+
+#define DIR_SIZE 500
+#define SAMPLE 100
+
+
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+
+static void
+entry_name(char *buf, int i)
+{
+    sprintf(buf, "textures/set%03d/Tex%03d.png", i / DIR_SIZE, i % DIR_SIZE);
+}
+
+
+
+static void
+put16(FILE *fp, unsigned int v)
+{
+    putc(v & 0xff, fp);
+    putc((v >> 8) & 0xff, fp);
+}
+
+
+
+static void
+put32(FILE *fp, unsigned long v)
+{
+    put16(fp, v & 0xffff);
+    put16(fp, (v >> 16) & 0xffff);
+}
+
+
+
+/* empty stored entries: local headers, central directory, end record */
+
+static int
+write_archive(const char *path, int n)
+{
+    char name[64];
+    unsigned long *offset, cdir, size;
+    FILE *fp;
+    int i, len;
+
+    if ((fp=fopen(path, "wb")) == NULL) {
+	perror(path);
+	return -1;
+    }
+    if ((offset=malloc(n * sizeof(*offset))) == NULL) {
+	fclose(fp);
+	return -1;
+    }
+
+    for (i=0; i<n; i++) {
+	entry_name(name, i);
+	len = strlen(name);
+	offset[i] = ftell(fp);
+	put32(fp, 0x04034b50);
+	put16(fp, 10);			/* version needed */
+	put16(fp, 0);			/* flags */
+	put16(fp, 0);			/* stored */
+	put32(fp, 0);			/* dos time and date */
+	put32(fp, 0);			/* crc */
+	put32(fp, 0);			/* compressed size */
+	put32(fp, 0);			/* size */
+	put16(fp, len);
+	put16(fp, 0);			/* extra field */
+	fwrite(name, 1, len, fp);
+    }
+
+    cdir = ftell(fp);
+    for (i=0; i<n; i++) {
+	entry_name(name, i);
+	len = strlen(name);
+	put32(fp, 0x02014b50);
+	put16(fp, 20);			/* version made by */
+	put16(fp, 10);			/* version needed */
+	put16(fp, 0);
+	put16(fp, 0);
+	put32(fp, 0);
+	put32(fp, 0);
+	put32(fp, 0);
+	put32(fp, 0);
+	put16(fp, len);
+	put16(fp, 0);			/* extra field */
+	put16(fp, 0);			/* comment */
+	put16(fp, 0);			/* disk number */
+	put16(fp, 0);			/* internal attributes */
+	put32(fp, 0);			/* external attributes */
+	put32(fp, offset[i]);
+	fwrite(name, 1, len, fp);
+    }
+
+    size = ftell(fp) - cdir;
+    put32(fp, 0x06054b50);
+    put16(fp, 0);
+    put16(fp, 0);
+    put16(fp, n);
+    put16(fp, n);
+    put32(fp, size);
+    put32(fp, cdir);
+    put16(fp, 0);
+
+    free(offset);
+    if (ferror(fp) | fclose(fp)) {
+	perror(path);
+	return -1;
+    }
+    return 0;
+}
+
+
+
+enum { PLAIN, NOCASE, NODIR, NMODES };
+
+static const char *mode_name[NMODES] = { "plain", "nocase", "nodir" };
+static const int mode_flags[NMODES] = { 0, ZIP_FL_NOCASE, ZIP_FL_NODIR };
+
+
+
+/* the name looked up for entry i, and the index it should give */
+
+static int
+query(char *buf, int mode, int i)
+{
+    char *p;
+
+    entry_name(buf, i);
+    switch (mode) {
+    case NOCASE:
+	for (p=buf; *p; p++)
+	    *p = toupper((unsigned char)*p);
+	break;
+    case NODIR:
+	p = strrchr(buf, '/');
+	memmove(buf, p+1, strlen(p));
+	return i % DIR_SIZE;		/* first directory wins */
+    }
+    return i;
+}
+
+
+
+int
+main(int argc, char *argv[])
+{
+    const char *path = "zipbench.zip";
+    struct zip *za;
+    char name[64];
+    double t, indexed, scan;
+    int i, m, n = 50000, all = 0, err, bad = 0, step;
+    volatile int sink = 0;
+
+    for (i=1; i<argc; i++) {
+	if (strcmp(argv[i], "-l") == 0)
+	    all = 1;
+	else if (strcmp(argv[i], "-n") == 0 && i+1 < argc)
+	    n = atoi(argv[++i]);
+	else if (argv[i][0] == '-') {
+	    fprintf(stderr, "usage: %s [-l] [-n entries] [archive.zip]\n",
+		    argv[0]);
+	    return 2;
+	}
+	else
+	    path = argv[i];
+    }
+    if (n < 1 || n > 0xffff) {
+	fprintf(stderr, "%s: entries must be 1 to 65535\n", argv[0]);
+	return 2;
+    }
+
+    if (write_archive(path, n) < 0)
+	return 1;
+    t = now();
+    if ((za=zip_open(path, 0, &err)) == NULL) {
+	fprintf(stderr, "%s: can't open %s: error %d\n", argv[0], path, err);
+	return 1;
+    }
+    printf("%d entries, opened in %.1f ms\n", zip_get_num_files(za),
+	   (now() - t) * 1e3);
+
+    step = all ? 1 : SAMPLE;
+    printf("%-8s %12s %12s%s\n", "lookup", "indexed ms", "scan ms",
+	   all ? "" : " (scaled)");
+    for (m=0; m<NMODES; m++) {
+	t = now();
+	for (i=0; i<n; i++) {
+	    int want = query(name, m, i);
+
+	    if (zip_name_locate(za, name, mode_flags[m]) != want) {
+		if (bad++ < 5)
+		    printf("%s: %s gives %d, not %d\n", mode_name[m], name,
+			   zip_name_locate(za, name, mode_flags[m]), want);
+	    }
+	}
+	indexed = now() - t;
+
+	t = now();
+	for (i=0; i<n; i+=step) {
+	    query(name, m, i);
+	    sink += zip_name_locate(za, name, mode_flags[m]|ZIP_FL_UNCHANGED);
+	}
+	scan = (now() - t) * step;
+
+	printf("%-8s %12.1f %12.1f\n", mode_name[m], indexed * 1e3, scan * 1e3);
+    }
+
+    zip_close(za);
+    remove(path);
+    if (bad)
+	printf("%d wrong lookups\n", bad);
+    return bad ? 1 : 0;
+}
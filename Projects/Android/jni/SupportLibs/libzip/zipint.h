@@ -128,6 +128,7 @@ struct zip {
     int nfile;			/* number of opened files within archive */
     int nfile_alloc;		/* number of files allocated */
     struct zip_file **file;	/* opened files within archive */
+    struct zip_hash *hash;	/* name index, NULL if unavailable */
 };
 
 /* file in zip archive, part of API */
@@ -191,6 +192,26 @@ struct zip_source {
     void *ud;
 };
 
+/* name index entry, parallel to struct zip's entries */
+
+struct zip_hash_entry {
+    unsigned int name_hash;	/* hash of case-folded name */
+    unsigned int base_hash;	/* same, without directory */
+    int name_next;		/* next entry in name bucket, -1 at end */
+    int base_next;		/* next entry in base bucket, -1 at end */
+    int indexed;		/* whether entry is in the buckets */
+};
+
+/* name index of zip archive; buckets are chained in index order */
+
+struct zip_hash {
+    int nbucket;		/* number of buckets, a power of 2 */
+    int nalloc;			/* number of entries allocated */
+    int *name_bucket;		/* first entry for each name hash */
+    int *base_bucket;		/* first entry for each base hash */
+    struct zip_hash_entry *entry;	/* per-entry hashes and links */
+};
+
 /* entry in zip archive directory */
 
 struct zip_entry {
@@ -249,6 +270,10 @@ struct zip_source *_zip_source_file_or_p(struct zip *, const char *, FILE *,
 					 off_t, off_t);
 
 void _zip_free(struct zip *);
+void _zip_hash_build(struct zip *);
+void _zip_hash_free(struct zip_hash *);
+int _zip_hash_lookup(struct zip *, const char *, int);
+void _zip_hash_update(struct zip *, int);
 const char *_zip_get_name(struct zip *, int, int, struct zip_error *);
 int _zip_local_header_read(struct zip *, int);
 void *_zip_memdup(const void *, size_t, struct zip_error *);
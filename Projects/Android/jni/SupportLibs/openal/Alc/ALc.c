@@ -293,6 +293,9 @@ static const ALCenums enumeration[] = {
     { "ALC_FORMAT_CHANNELS_SOFT",             ALC_FORMAT_CHANNELS_SOFT            },
     { "ALC_FORMAT_TYPE_SOFT",                 ALC_FORMAT_TYPE_SOFT                },
 
+    // Device statistics
+    { "ALC_XRUN_COUNT_SOFTX",                 ALC_XRUN_COUNT_SOFTX                },
+
     // Buffer Channel Configurations
     { "ALC_MONO_SOFT",                        ALC_MONO_SOFT                       },
     { "ALC_STEREO_SOFT",                      ALC_STEREO_SOFT                     },
@@ -346,7 +349,7 @@ static const ALCchar alcNoDeviceExtList[] =
 static const ALCchar alcExtensionList[] =
     "ALC_ENUMERATE_ALL_EXT ALC_ENUMERATION_EXT ALC_EXT_CAPTURE "
     "ALC_EXT_DEDICATED ALC_EXT_disconnect ALC_EXT_EFX "
-    "ALC_EXT_thread_local_context ALC_SOFT_loopback";
+    "ALC_EXT_thread_local_context ALC_SOFT_loopback ALC_SOFTX_xrun_count";
 static const ALCint alcMajorVersion = 1;
 static const ALCint alcMinorVersion = 1;
 
@@ -558,6 +561,7 @@ static void alc_deinit(void)
 static void alc_initconfig(void)
 {
     const char *devs, *str;
+    ALuint capfilter;
     float valf;
     int i, n;
 
@@ -579,6 +583,39 @@ static void alc_initconfig(void)
 
     ReadALConfig();
 
+    capfilter = CPU_CAP_SSE | CPU_CAP_NEON;
+    if(ConfigValueStr(NULL, "disable-cpu-exts", &str))
+    {
+        if(strcasecmp(str, "all") == 0)
+            capfilter = 0;
+        else
+        {
+            size_t len;
+            const char *next = str;
+
+            do {
+                str = next;
+                next = strchr(str, ',');
+
+                while(isspace(str[0]))
+                    str++;
+                if(!str[0] || str[0] == ',')
+                    continue;
+
+                len = (next ? ((size_t)(next-str)) : strlen(str));
+                while(len > 0 && isspace(str[len-1]))
+                    len--;
+                if(len == 3 && strncasecmp(str, "sse", len) == 0)
+                    capfilter &= ~CPU_CAP_SSE;
+                else if(len == 4 && strncasecmp(str, "neon", len) == 0)
+                    capfilter &= ~CPU_CAP_NEON;
+                else
+                    WARN("Invalid CPU extension \"%.*s\"\n", (int)len, str);
+            } while(next++);
+        }
+    }
+    FillCPUCaps(capfilter);
+
     InitHrtf();
 
 #ifdef _WIN32
@@ -1317,6 +1354,8 @@ static ALCenum UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
         {
             ALsource *source = context->SourceMap.array[pos].value;
             ALuint s = device->NumAuxSends;
+
+            ApplySourceProps(source, context);
             while(s < MAX_SENDS)
             {
                 if(source->Send[s].Slot)
@@ -1324,9 +1363,11 @@ static ALCenum UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
                 source->Send[s].Slot = NULL;
                 source->Send[s].WetGain = 1.0f;
                 source->Send[s].WetGainHF = 1.0f;
+                source->Props.Send[s].Slot = NULL;
+                source->Props.Send[s].WetGain = 1.0f;
+                source->Props.Send[s].WetGainHF = 1.0f;
                 s++;
             }
-            source->NeedsUpdate = AL_FALSE;
             ALsource_Update(source, context);
         }
         UnlockUIntMapRead(&context->SourceMap);
@@ -1477,6 +1518,9 @@ static ALvoid InitContext(ALCcontext *pContext)
     pContext->ActiveSourceCount = 0;
     InitUIntMap(&pContext->SourceMap, pContext->Device->MaxNoOfSources);
     InitUIntMap(&pContext->EffectSlotMap, pContext->Device->AuxiliaryEffectSlotMax);
+    InitializeCriticalSection(&pContext->PropLock);
+    pContext->FreeSourceProps = NULL;
+    pContext->SpareSourceProps = NULL;
 
     //Set globals
     pContext->DistanceModel = AL_INVERSE_DISTANCE_CLAMPED;
@@ -1523,6 +1567,20 @@ static ALCvoid FreeContext(ALCcontext *context)
     context->ActiveEffectSlots = NULL;
     context->MaxActiveEffectSlots = 0;
 
+    while(context->FreeSourceProps)
+    {
+        ALsourceProps *props = context->FreeSourceProps;
+        context->FreeSourceProps = props->next;
+        free(props);
+    }
+    while(context->SpareSourceProps)
+    {
+        ALsourceProps *props = context->SpareSourceProps;
+        context->SpareSourceProps = props->next;
+        free(props);
+    }
+    DeleteCriticalSection(&context->PropLock);
+
     ALCdevice_DecRef(context->Device);
     context->Device = NULL;
 
@@ -2003,6 +2061,7 @@ ALC_API ALCvoid ALC_APIENTRY alcGetIntegerv(ALCdevice *device,ALCenum param,ALsi
             case ALC_CAPTURE_SAMPLES:
             case ALC_FORMAT_CHANNELS_SOFT:
             case ALC_FORMAT_TYPE_SOFT:
+            case ALC_XRUN_COUNT_SOFTX:
                 alcSetError(NULL, ALC_INVALID_DEVICE);
                 break;
 
@@ -2147,6 +2206,10 @@ ALC_API ALCvoid ALC_APIENTRY alcGetIntegerv(ALCdevice *device,ALCenum param,ALsi
                 *data = device->Connected;
                 break;
 
+            case ALC_XRUN_COUNT_SOFTX:
+                *data = device->XrunCount;
+                break;
+
             default:
                 alcSetError(device, ALC_INVALID_ENUM);
                 break;
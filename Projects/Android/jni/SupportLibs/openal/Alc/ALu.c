@@ -133,12 +133,12 @@ ALvoid CalcNonAttnSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     ListenerGain = ALContext->Listener.Gain;
 
     /* Get source properties */
-    SourceVolume    = ALSource->flGain;
-    MinVolume       = ALSource->flMinGain;
-    MaxVolume       = ALSource->flMaxGain;
-    Pitch           = ALSource->flPitch;
+    SourceVolume    = ALSource->Props.Gain;
+    MinVolume       = ALSource->Props.MinGain;
+    MaxVolume       = ALSource->Props.MaxGain;
+    Pitch           = ALSource->Props.Pitch;
     Resampler       = ALSource->Resampler;
-    DirectChannels  = ALSource->DirectChannels;
+    DirectChannels  = ALSource->Props.DirectChannels;
 
     /* Calculate the stepping value */
     Channels = FmtMono;
@@ -178,13 +178,13 @@ ALvoid CalcNonAttnSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
 
     /* Calculate gains */
     DryGain  = clampf(SourceVolume, MinVolume, MaxVolume);
-    DryGain *= ALSource->DirectGain;
-    DryGainHF = ALSource->DirectGainHF;
+    DryGain *= ALSource->Props.DirectGain;
+    DryGainHF = ALSource->Props.DirectGainHF;
     for(i = 0;i < NumSends;i++)
     {
         WetGain[i]  = clampf(SourceVolume, MinVolume, MaxVolume);
-        WetGain[i] *= ALSource->Send[i].WetGain;
-        WetGainHF[i] = ALSource->Send[i].WetGainHF;
+        WetGain[i] *= ALSource->Props.Send[i].WetGain;
+        WetGainHF[i] = ALSource->Props.Send[i].WetGainHF;
     }
 
     SrcMatrix = ALSource->Params.DryGains;
@@ -281,11 +281,11 @@ ALvoid CalcNonAttnSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
             {
                 /* Get the static HRIR coefficients and delays for this
                  * channel. */
-                GetLerpedHrtfCoeffs(Device->Hrtf,
-                                    0.0f, chans[c].angle,
-                                    DryGain*ListenerGain,
-                                    ALSource->Params.HrtfCoeffs[c],
-                                    ALSource->Params.HrtfDelay[c]);
+                GetHrtfCoeffs(Device->Hrtf,
+                              0.0f, chans[c].angle,
+                              DryGain*ListenerGain,
+                              ALSource->Params.HrtfCoeffs[c],
+                              ALSource->Params.HrtfDelay[c]);
             }
             ALSource->HrtfCounter = 0;
         }
@@ -312,7 +312,7 @@ ALvoid CalcNonAttnSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     }
     for(i = 0;i < NumSends;i++)
     {
-        ALeffectslot *Slot = ALSource->Send[i].Slot;
+        ALeffectslot *Slot = ALSource->Props.Send[i].Slot;
 
         if(!Slot && i == 0)
             Slot = Device->DefaultSlot;
@@ -376,7 +376,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
         WetGainHF[i] = 1.0f;
 
     //Get context properties
-    DopplerFactor = ALContext->DopplerFactor * ALSource->DopplerFactor;
+    DopplerFactor = ALContext->DopplerFactor * ALSource->Props.DopplerFactor;
     SpeedOfSound  = ALContext->flSpeedOfSound * ALContext->DopplerVelocity;
     NumSends      = Device->NumAuxSends;
     Frequency     = Device->Frequency;
@@ -389,33 +389,33 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     ListenerVel[2] = ALContext->Listener.Velocity[2];
 
     //Get source properties
-    SourceVolume   = ALSource->flGain;
-    MinVolume      = ALSource->flMinGain;
-    MaxVolume      = ALSource->flMaxGain;
-    Pitch          = ALSource->flPitch;
+    SourceVolume   = ALSource->Props.Gain;
+    MinVolume      = ALSource->Props.MinGain;
+    MaxVolume      = ALSource->Props.MaxGain;
+    Pitch          = ALSource->Props.Pitch;
     Resampler      = ALSource->Resampler;
-    Position[0]    = ALSource->vPosition[0] * MetersPerUnit;
-    Position[1]    = ALSource->vPosition[1] * MetersPerUnit;
-    Position[2]    = ALSource->vPosition[2] * MetersPerUnit;
-    Direction[0]   = ALSource->vOrientation[0];
-    Direction[1]   = ALSource->vOrientation[1];
-    Direction[2]   = ALSource->vOrientation[2];
-    Velocity[0]    = ALSource->vVelocity[0];
-    Velocity[1]    = ALSource->vVelocity[1];
-    Velocity[2]    = ALSource->vVelocity[2];
-    MinDist        = ALSource->flRefDistance * MetersPerUnit;
-    MaxDist        = ALSource->flMaxDistance * MetersPerUnit;
-    Rolloff        = ALSource->flRollOffFactor;
-    InnerAngle     = ALSource->flInnerAngle * ConeScale;
-    OuterAngle     = ALSource->flOuterAngle * ConeScale;
-    AirAbsorptionFactor = ALSource->AirAbsorptionFactor;
-    DryGainHFAuto   = ALSource->DryGainHFAuto;
-    WetGainAuto     = ALSource->WetGainAuto;
-    WetGainHFAuto   = ALSource->WetGainHFAuto;
-    RoomRolloffBase = ALSource->RoomRolloffFactor;
+    Position[0]    = ALSource->Props.Position[0] * MetersPerUnit;
+    Position[1]    = ALSource->Props.Position[1] * MetersPerUnit;
+    Position[2]    = ALSource->Props.Position[2] * MetersPerUnit;
+    Direction[0]   = ALSource->Props.Orientation[0];
+    Direction[1]   = ALSource->Props.Orientation[1];
+    Direction[2]   = ALSource->Props.Orientation[2];
+    Velocity[0]    = ALSource->Props.Velocity[0];
+    Velocity[1]    = ALSource->Props.Velocity[1];
+    Velocity[2]    = ALSource->Props.Velocity[2];
+    MinDist        = ALSource->Props.RefDistance * MetersPerUnit;
+    MaxDist        = ALSource->Props.MaxDistance * MetersPerUnit;
+    Rolloff        = ALSource->Props.RollOffFactor;
+    InnerAngle     = ALSource->Props.InnerAngle * ConeScale;
+    OuterAngle     = ALSource->Props.OuterAngle * ConeScale;
+    AirAbsorptionFactor = ALSource->Props.AirAbsorptionFactor;
+    DryGainHFAuto   = ALSource->Props.DryGainHFAuto;
+    WetGainAuto     = ALSource->Props.WetGainAuto;
+    WetGainHFAuto   = ALSource->Props.WetGainHFAuto;
+    RoomRolloffBase = ALSource->Props.RoomRolloffFactor;
     for(i = 0;i < NumSends;i++)
     {
-        ALeffectslot *Slot = ALSource->Send[i].Slot;
+        ALeffectslot *Slot = ALSource->Props.Send[i].Slot;
 
         if(!Slot && i == 0)
             Slot = Device->DefaultSlot;
@@ -461,7 +461,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     }
 
     //1. Translate Listener to origin (convert to head relative)
-    if(ALSource->bHeadRelative == AL_FALSE)
+    if(ALSource->Props.HeadRelative == AL_FALSE)
     {
         /* Translate position */
         Position[0] -= ALContext->Listener.Position[0] * MetersPerUnit;
@@ -498,7 +498,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     Attenuation = 1.0f;
     for(i = 0;i < NumSends;i++)
         RoomAttenuation[i] = 1.0f;
-    switch(ALContext->SourceDistanceModel ? ALSource->DistanceModel :
+    switch(ALContext->SourceDistanceModel ? ALSource->Props.DistanceModel :
                                             ALContext->DistanceModel)
     {
         case InverseDistanceClamped:
@@ -592,13 +592,13 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     if(Angle >= InnerAngle && Angle <= OuterAngle)
     {
         ALfloat scale = (Angle-InnerAngle) / (OuterAngle-InnerAngle);
-        ConeVolume = lerp(1.0f, ALSource->flOuterGain, scale);
-        ConeHF = lerp(1.0f, ALSource->OuterGainHF, scale);
+        ConeVolume = lerp(1.0f, ALSource->Props.OuterGain, scale);
+        ConeHF = lerp(1.0f, ALSource->Props.OuterGainHF, scale);
     }
     else if(Angle > OuterAngle)
     {
-        ConeVolume = ALSource->flOuterGain;
-        ConeHF = ALSource->OuterGainHF;
+        ConeVolume = ALSource->Props.OuterGain;
+        ConeHF = ALSource->Props.OuterGainHF;
     }
     else
     {
@@ -626,12 +626,12 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
         WetGain[i] = clampf(WetGain[i], MinVolume, MaxVolume);
 
     // Apply filter gains and filters
-    DryGain   *= ALSource->DirectGain * ListenerGain;
-    DryGainHF *= ALSource->DirectGainHF;
+    DryGain   *= ALSource->Props.DirectGain * ListenerGain;
+    DryGainHF *= ALSource->Props.DirectGainHF;
     for(i = 0;i < NumSends;i++)
     {
-        WetGain[i]   *= ALSource->Send[i].WetGain * ListenerGain;
-        WetGainHF[i] *= ALSource->Send[i].WetGainHF;
+        WetGain[i]   *= ALSource->Props.Send[i].WetGain * ListenerGain;
+        WetGainHF[i] *= ALSource->Props.Send[i].WetGainHF;
     }
 
     // Calculate Velocity
@@ -724,9 +724,9 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
         else
         {
             // Get the initial (static) HRIR coefficients and delays.
-            GetLerpedHrtfCoeffs(Device->Hrtf, ev, az, DryGain,
-                                ALSource->Params.HrtfCoeffs[0],
-                                ALSource->Params.HrtfDelay[0]);
+            GetHrtfCoeffs(Device->Hrtf, ev, az, DryGain,
+                          ALSource->Params.HrtfCoeffs[0],
+                          ALSource->Params.HrtfDelay[0]);
             ALSource->HrtfCounter = 0;
             ALSource->Params.HrtfGain = DryGain;
             ALSource->Params.HrtfDir[0] = Position[0];
@@ -809,17 +809,16 @@ static __inline ALubyte aluF2UB(ALfloat val)
 static void Write_##T##_##N(ALCdevice *device, T *RESTRICT buffer,            \
                             ALuint SamplesToDo)                               \
 {                                                                             \
-    ALfloat (*RESTRICT DryBuffer)[MAXCHANNELS] = device->DryBuffer;           \
     const enum Channel *ChanMap = device->DevChannels;                        \
     ALuint i, j;                                                              \
                                                                               \
     for(j = 0;j < N;j++)                                                      \
     {                                                                         \
+        const ALfloat *RESTRICT in = device->DryBuffer[ChanMap[j]];           \
         T *RESTRICT out = buffer + j;                                         \
-        enum Channel chan = ChanMap[j];                                       \
                                                                               \
         for(i = 0;i < SamplesToDo;i++)                                        \
-            out[i*N] = func(DryBuffer[i][chan]);                              \
+            out[i*N] = func(in[i]);                                           \
     }                                                                         \
 }
 
@@ -928,7 +927,8 @@ ALvoid aluMixData(ALCdevice *device, ALvoid *buffer, ALsizei size)
         SamplesToDo = minu(size, BUFFERSIZE);
 
         /* Clear mixing buffer */
-        memset(device->DryBuffer, 0, SamplesToDo*MAXCHANNELS*sizeof(ALfloat));
+        for(c = 0;c < MAXCHANNELS;c++)
+            memset(device->DryBuffer[c], 0, SamplesToDo*sizeof(ALfloat));
 
         LockDevice(device);
         ctx = device->ContextList;
@@ -951,7 +951,7 @@ ALvoid aluMixData(ALCdevice *device, ALvoid *buffer, ALsizei size)
                     continue;
                 }
 
-                if(!DeferUpdates && (ExchangeInt(&(*src)->NeedsUpdate, AL_FALSE) ||
+                if(!DeferUpdates && (ApplySourceProps(*src, ctx) ||
                                      UpdateSources))
                     ALsource_Update(*src, ctx);
 
@@ -1014,7 +1014,7 @@ ALvoid aluMixData(ALCdevice *device, ALvoid *buffer, ALsizei size)
         {
             for(i = 0;i < SamplesToDo;i++)
             {
-                device->DryBuffer[i][FRONT_CENTER] += device->ClickRemoval[FRONT_CENTER];
+                device->DryBuffer[FRONT_CENTER][i] += device->ClickRemoval[FRONT_CENTER];
                 device->ClickRemoval[FRONT_CENTER] -= device->ClickRemoval[FRONT_CENTER] * (1.0f/256.0f);
             }
             device->ClickRemoval[FRONT_CENTER] += device->PendingClicks[FRONT_CENTER];
@@ -1023,11 +1023,11 @@ ALvoid aluMixData(ALCdevice *device, ALvoid *buffer, ALsizei size)
         else if(device->FmtChans == DevFmtStereo)
         {
             /* Assumes the first two channels are FRONT_LEFT and FRONT_RIGHT */
-            for(i = 0;i < SamplesToDo;i++)
+            for(c = 0;c < 2;c++)
             {
-                for(c = 0;c < 2;c++)
+                for(i = 0;i < SamplesToDo;i++)
                 {
-                    device->DryBuffer[i][c] += device->ClickRemoval[c];
+                    device->DryBuffer[c][i] += device->ClickRemoval[c];
                     device->ClickRemoval[c] -= device->ClickRemoval[c] * (1.0f/256.0f);
                 }
             }
@@ -1038,17 +1038,24 @@ ALvoid aluMixData(ALCdevice *device, ALvoid *buffer, ALsizei size)
             }
             if(device->Bs2b)
             {
+                ALfloat samples[2];
                 for(i = 0;i < SamplesToDo;i++)
-                    bs2b_cross_feed(device->Bs2b, &device->DryBuffer[i][0]);
+                {
+                    samples[0] = device->DryBuffer[FRONT_LEFT][i];
+                    samples[1] = device->DryBuffer[FRONT_RIGHT][i];
+                    bs2b_cross_feed(device->Bs2b, samples);
+                    device->DryBuffer[FRONT_LEFT][i] = samples[0];
+                    device->DryBuffer[FRONT_RIGHT][i] = samples[1];
+                }
             }
         }
         else
         {
-            for(i = 0;i < SamplesToDo;i++)
+            for(c = 0;c < MAXCHANNELS;c++)
             {
-                for(c = 0;c < MAXCHANNELS;c++)
+                for(i = 0;i < SamplesToDo;i++)
                 {
-                    device->DryBuffer[i][c] += device->ClickRemoval[c];
+                    device->DryBuffer[c][i] += device->ClickRemoval[c];
                     device->ClickRemoval[c] -= device->ClickRemoval[c] * (1.0f/256.0f);
                 }
             }
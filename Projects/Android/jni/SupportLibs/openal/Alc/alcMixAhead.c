@@ -0,0 +1,177 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 1999-2007 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "alMain.h"
+
+
+/* A mixer thread that keeps up to NumPeriods periods of UpdateSize frames
+ * mixed ahead of a callback driven backend. The ring is single producer,
+ * single consumer: only the mixer thread advances WriteCount and only the
+ * reader advances ReadCount, each publishing a private position, so the
+ * reader never blocks and never touches the device lock. The mixer thread
+ * polls for free periods, as the wave writer does for elapsed time, which
+ * keeps the reader down to a copy and an atomic increment. */
+struct MixAhead {
+    ALCdevice *Device;
+
+    ALubyte *Periods;
+    ALuint PeriodSize;
+    ALuint NumPeriods;
+
+    volatile RefCount WriteCount;
+    volatile RefCount ReadCount;
+    ALuint ReadPos;
+    ALuint ReadIdx;
+
+    ALuint RestTime;
+    volatile int killNow;
+    ALvoid *thread;
+};
+
+
+static ALuint MixAheadProc(ALvoid *ptr)
+{
+    MixAhead *mix = (MixAhead*)ptr;
+    ALCdevice *device = mix->Device;
+    ALuint writePos = 0;
+    ALuint writeIdx = 0;
+
+    SetRTPriority();
+
+    while(!mix->killNow && device->Connected)
+    {
+        if(writePos - ReadRef(&mix->ReadCount) >= mix->NumPeriods)
+        {
+            Sleep(mix->RestTime);
+            continue;
+        }
+
+        aluMixData(device, mix->Periods + writeIdx*mix->PeriodSize,
+                   device->UpdateSize);
+        writeIdx = (writeIdx+1) % mix->NumPeriods;
+        writePos++;
+        IncrementRef(&mix->WriteCount);
+    }
+
+    return 0;
+}
+
+
+MixAhead *StartMixAhead(ALCdevice *device, ALuint numPeriods)
+{
+    ALuint frameSize = FrameSizeFromDevFmt(device->FmtChans, device->FmtType);
+    MixAhead *mix;
+
+    numPeriods = maxu(numPeriods, 1);
+    mix = calloc(1, sizeof(*mix) + numPeriods*device->UpdateSize*frameSize);
+    if(!mix)
+        return NULL;
+
+    mix->Device = device;
+    mix->Periods = (ALubyte*)(mix+1);
+    mix->PeriodSize = device->UpdateSize * frameSize;
+    mix->NumPeriods = numPeriods;
+    mix->WriteCount = 0;
+    mix->ReadCount = 0;
+    mix->ReadPos = 0;
+    mix->ReadIdx = 0;
+    /* Check back about twice a period for room to mix into */
+    mix->RestTime = maxu((ALuint64)device->UpdateSize * 1000 /
+                         device->Frequency / 2, 1);
+    mix->killNow = 0;
+
+    mix->thread = StartThread(MixAheadProc, mix);
+    if(mix->thread == NULL)
+    {
+        free(mix);
+        return NULL;
+    }
+
+    TRACE("Mixing up to %u periods of %u frames ahead\n", numPeriods,
+          device->UpdateSize);
+    return mix;
+}
+
+void StopMixAhead(MixAhead *mix)
+{
+    if(!mix)
+        return;
+
+    mix->killNow = 1;
+    StopThread(mix->thread);
+    mix->thread = NULL;
+
+    free(mix);
+}
+
+
+static void SilencePeriod(ALCdevice *device, ALvoid *buffer, ALuint size)
+{
+    ALuint i;
+
+    switch(device->FmtType)
+    {
+        case DevFmtUByte:
+            memset(buffer, 0x80, size);
+            return;
+        case DevFmtUShort:
+            for(i = 0;i < size/sizeof(ALushort);i++)
+                ((ALushort*)buffer)[i] = 0x8000;
+            return;
+        case DevFmtUInt:
+            for(i = 0;i < size/sizeof(ALuint);i++)
+                ((ALuint*)buffer)[i] = 0x80000000u;
+            return;
+        case DevFmtByte:
+        case DevFmtShort:
+        case DevFmtInt:
+        case DevFmtFloat:
+            break;
+    }
+    memset(buffer, 0, size);
+}
+
+/* Copies the next mixed period into buffer, which must hold UpdateSize
+ * frames. Safe to call from a real-time callback. If the mixer thread fell
+ * behind, buffer gets silence, the device's xrun count goes up and
+ * ALC_FALSE is returned. */
+ALCboolean ReadMixAhead(MixAhead *mix, ALvoid *buffer)
+{
+    if(ReadRef(&mix->WriteCount) == mix->ReadPos)
+    {
+        SilencePeriod(mix->Device, buffer, mix->PeriodSize);
+        /* A disconnected device stops mixing for good; that's not an xrun */
+        if(mix->Device->Connected)
+            IncrementRef(&mix->Device->XrunCount);
+        return ALC_FALSE;
+    }
+
+    memcpy(buffer, mix->Periods + mix->ReadIdx*mix->PeriodSize,
+           mix->PeriodSize);
+    mix->ReadIdx = (mix->ReadIdx+1) % mix->NumPeriods;
+    mix->ReadPos++;
+    IncrementRef(&mix->ReadCount);
+    return ALC_TRUE;
+}
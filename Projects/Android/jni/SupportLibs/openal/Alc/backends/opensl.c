@@ -84,6 +84,11 @@ typedef struct SLDataLocator_AndroidSimpleBufferQueue {
 #define SLPlayItf_SetPlayState(a,b) ((*(a))->SetPlayState((a),(b)))
 
 
+/* Number of buffers handed to the OpenSL queue. Any further periods the
+ * device asks for are mixed ahead by the mixer thread instead. */
+#define OSL_QUEUE_BUFFERS 2
+
+
 typedef struct {
     /* engine interfaces */
     SLObjectItf engineObject;
@@ -95,10 +100,12 @@ typedef struct {
     /* buffer queue player interfaces */
     SLObjectItf bufferQueueObject;
 
-    void *buffer;
-    ALuint bufferSize;
+    /* mixer thread feeding the queue */
+    MixAhead *mix;
 
-    ALuint frameSize;
+    void *buffers[OSL_QUEUE_BUFFERS];
+    ALuint bufferSize;
+    ALuint bufferIdx;
 } osl_data;
 
 
@@ -166,16 +173,21 @@ static const char *res_str(SLresult result)
         ERR("%s: %s\n", (s), res_str((x)));                                      \
 } while(0)
 
-/* this callback handler is called every time a buffer finishes playing */
+/* this callback handler is called every time a buffer finishes playing. It
+ * runs on the audio system's thread, so it only copies out a period the mixer
+ * thread already made and never waits on the device lock. */
 static void opensl_callback(SLAndroidSimpleBufferQueueItf bq, void *context)
 {
     ALCdevice *Device = context;
     osl_data *data = Device->ExtraData;
+    void *buffer = data->buffers[data->bufferIdx];
     SLresult result;
 
-    aluMixData(Device, data->buffer, data->bufferSize/data->frameSize);
+    data->bufferIdx = (data->bufferIdx+1) % OSL_QUEUE_BUFFERS;
 
-    result = (*bq)->Enqueue(bq, data->buffer, data->bufferSize);
+    ReadMixAhead(data->mix, buffer);
+
+    result = (*bq)->Enqueue(bq, buffer, data->bufferSize);
     PRINTERR(result, "bq->Enqueue");
 }
 
@@ -272,9 +284,10 @@ static ALCboolean opensl_reset_playback(ALCdevice *Device)
     SLresult result;
 
 
+    /* Keep the requested period size and count; OpenSL only ever holds
+     * OSL_QUEUE_BUFFERS of them and the rest are mixed ahead. */
     Device->UpdateSize = (ALuint64)Device->UpdateSize * 44100 / Device->Frequency;
-    Device->UpdateSize = Device->UpdateSize * Device->NumUpdates / 2;
-    Device->NumUpdates = 2;
+    Device->NumUpdates = maxu(Device->NumUpdates, OSL_QUEUE_BUFFERS);
 
     Device->Frequency = 44100;
     Device->FmtChans = DevFmtStereo;
@@ -287,7 +300,7 @@ static ALCboolean opensl_reset_playback(ALCdevice *Device)
     req = SL_BOOLEAN_TRUE;
 
     loc_bufq.locatorType = SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE;
-    loc_bufq.numBuffers = Device->NumUpdates;
+    loc_bufq.numBuffers = OSL_QUEUE_BUFFERS;
 
     format_pcm.formatType = SL_DATAFORMAT_PCM;
     format_pcm.numChannels = ChannelsFromDevFmt(Device->FmtChans);
@@ -353,21 +366,36 @@ static ALCboolean opensl_start_playback(ALCdevice *Device)
     }
     if(SL_RESULT_SUCCESS == result)
     {
-        data->frameSize = FrameSizeFromDevFmt(Device->FmtChans, Device->FmtType);
-        data->bufferSize = Device->UpdateSize * data->frameSize;
-        data->buffer = calloc(1, data->bufferSize);
-        if(!data->buffer)
+        data->bufferSize = Device->UpdateSize *
+                           FrameSizeFromDevFmt(Device->FmtChans, Device->FmtType);
+        data->bufferIdx = 0;
+        for(i = 0;i < OSL_QUEUE_BUFFERS;i++)
+        {
+            data->buffers[i] = calloc(1, data->bufferSize);
+            if(!data->buffers[i])
+            {
+                result = SL_RESULT_MEMORY_FAILURE;
+                PRINTERR(result, "calloc");
+                break;
+            }
+        }
+    }
+    if(SL_RESULT_SUCCESS == result)
+    {
+        data->mix = StartMixAhead(Device, Device->NumUpdates - OSL_QUEUE_BUFFERS);
+        if(!data->mix)
         {
-            result = SL_RESULT_MEMORY_FAILURE;
-            PRINTERR(result, "calloc");
+            result = SL_RESULT_RESOURCE_ERROR;
+            PRINTERR(result, "StartMixAhead");
         }
     }
-    /* enqueue the first buffer to kick off the callbacks */
-    for(i = 0;i < Device->NumUpdates;i++)
+    /* enqueue silence to kick off the callbacks, giving the mixer thread a
+     * head start */
+    for(i = 0;i < OSL_QUEUE_BUFFERS;i++)
     {
         if(SL_RESULT_SUCCESS == result)
         {
-            result = (*bufferQueue)->Enqueue(bufferQueue, data->buffer, data->bufferSize);
+            result = (*bufferQueue)->Enqueue(bufferQueue, data->buffers[i], data->bufferSize);
             PRINTERR(result, "bufferQueue->Enqueue");
         }
     }
@@ -388,8 +416,14 @@ static ALCboolean opensl_start_playback(ALCdevice *Device)
             SLObjectItf_Destroy(data->bufferQueueObject);
         data->bufferQueueObject = NULL;
 
-        free(data->buffer);
-        data->buffer = NULL;
+        StopMixAhead(data->mix);
+        data->mix = NULL;
+
+        for(i = 0;i < OSL_QUEUE_BUFFERS;i++)
+        {
+            free(data->buffers[i]);
+            data->buffers[i] = NULL;
+        }
         data->bufferSize = 0;
 
         return ALC_FALSE;
@@ -402,9 +436,36 @@ static ALCboolean opensl_start_playback(ALCdevice *Device)
 static void opensl_stop_playback(ALCdevice *Device)
 {
     osl_data *data = Device->ExtraData;
+    SLAndroidSimpleBufferQueueItf bufferQueue;
+    SLPlayItf player;
+    SLresult result;
+    ALuint i;
+
+    /* Make sure the callback is done with the buffers and the mixer before
+     * they go away */
+    result = SLObjectItf_GetInterface(data->bufferQueueObject, SL_IID_PLAY, &player);
+    PRINTERR(result, "bufferQueue->GetInterface");
+    if(SL_RESULT_SUCCESS == result)
+    {
+        result = SLPlayItf_SetPlayState(player, SL_PLAYSTATE_STOPPED);
+        PRINTERR(result, "player->SetPlayState");
+    }
+    result = SLObjectItf_GetInterface(data->bufferQueueObject, SL_IID_BUFFERQUEUE, &bufferQueue);
+    PRINTERR(result, "bufferQueue->GetInterface");
+    if(SL_RESULT_SUCCESS == result)
+    {
+        result = (*bufferQueue)->Clear(bufferQueue);
+        PRINTERR(result, "bufferQueue->Clear");
+    }
+
+    StopMixAhead(data->mix);
+    data->mix = NULL;
 
-    free(data->buffer);
-    data->buffer = NULL;
+    for(i = 0;i < OSL_QUEUE_BUFFERS;i++)
+    {
+        free(data->buffers[i]);
+        data->buffers[i] = NULL;
+    }
     data->bufferSize = 0;
 }
 
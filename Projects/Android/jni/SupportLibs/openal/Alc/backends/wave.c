@@ -35,6 +35,8 @@ typedef struct {
     ALvoid *buffer;
     ALuint size;
 
+    MixAhead *mix;
+
     volatile int killNow;
     ALvoid *thread;
 } wave_data;
@@ -114,7 +116,10 @@ static ALuint WaveProc(ALvoid *ptr)
 
         while(avail-done >= pDevice->UpdateSize)
         {
-            aluMixData(pDevice, data->buffer, pDevice->UpdateSize);
+            if(data->mix)
+                ReadMixAhead(data->mix, data->buffer);
+            else
+                aluMixData(pDevice, data->buffer, pDevice->UpdateSize);
             done += pDevice->UpdateSize;
 
             if(!IS_LITTLE_ENDIAN)
@@ -277,9 +282,24 @@ static ALCboolean wave_start_playback(ALCdevice *device)
         return ALC_FALSE;
     }
 
+    /* Mixing ahead on a separate thread, like the OpenSL backend does, lets
+     * the writer thread stand in for an audio callback */
+    if(GetConfigValueBool("wave", "mix-ahead", 0))
+    {
+        data->mix = StartMixAhead(device, device->NumUpdates-1);
+        if(!data->mix)
+        {
+            free(data->buffer);
+            data->buffer = NULL;
+            return ALC_FALSE;
+        }
+    }
+
     data->thread = StartThread(WaveProc, device);
     if(data->thread == NULL)
     {
+        StopMixAhead(data->mix);
+        data->mix = NULL;
         free(data->buffer);
         data->buffer = NULL;
         return ALC_FALSE;
@@ -303,6 +323,9 @@ static void wave_stop_playback(ALCdevice *device)
 
     data->killNow = 0;
 
+    StopMixAhead(data->mix);
+    data->mix = NULL;
+
     free(data->buffer);
     data->buffer = NULL;
 
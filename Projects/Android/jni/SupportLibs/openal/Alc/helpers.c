@@ -54,6 +54,39 @@ DEFINE_DEVPROPKEY(DEVPKEY_Device_FriendlyName, 0xa45c254e, 0xdf1c, 0x4efd, 0x80,
 
 #include "alMain.h"
 
+#if defined(HAVE_CPUID_H) && (defined(__i386__) || defined(__x86_64__))
+#include <cpuid.h>
+#endif
+
+
+ALuint CPUCapFlags = 0;
+
+void FillCPUCaps(ALuint capfilter)
+{
+    ALuint caps = 0;
+
+#if defined(HAVE_CPUID_H) && (defined(__i386__) || defined(__x86_64__))
+    unsigned int eax, ebx, ecx, edx;
+    if(__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        if((edx&(1<<25)))
+            caps |= CPU_CAP_SSE;
+    }
+#elif defined(__SSE__)
+    caps |= CPU_CAP_SSE;
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    /* NEON is either mandatory (AArch64) or the whole library was built
+     * assuming it, so there's nothing left to probe for. */
+    caps |= CPU_CAP_NEON;
+#endif
+
+    TRACE("Got caps:%s%s%s\n", ((caps&CPU_CAP_SSE)?((capfilter&CPU_CAP_SSE)?" SSE":" (SSE)"):""),
+                               ((caps&CPU_CAP_NEON)?((capfilter&CPU_CAP_NEON)?" NEON":" (NEON)"):""),
+                               ((!caps)?" none":""));
+    CPUCapFlags = caps & capfilter;
+}
+
 #ifdef _WIN32
 void pthread_once(pthread_once_t *once, void (*callback)(void))
 {
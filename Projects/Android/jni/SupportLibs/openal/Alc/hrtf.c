@@ -22,12 +22,17 @@
 
 #include <stdlib.h>
 #include <ctype.h>
+#include <math.h>
 
 #include "AL/al.h"
 #include "AL/alc.h"
 #include "alMain.h"
 #include "alSource.h"
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
 
 static const ALchar magicMarker[8] = "MinPHR00";
 
@@ -38,19 +43,136 @@ static const ALushort evOffset[ELEV_COUNT] = { 0, 1, 13, 37, 73, 118, 174, 234,
 static const ALubyte azCount[ELEV_COUNT] = { 1, 12, 24, 36, 45, 56, 60, 72, 72, 72, 72, 72, 60, 56, 45, 36, 24, 12, 1 };
 
 
-static const struct Hrtf {
+/* An HRIR data set as it's stored: one ear's impulse responses for each
+ * measured direction, at the rate they were measured at. The other ear uses
+ * the mirrored azimuth. */
+struct HrtfTable {
     ALuint sampleRate;
     ALshort coeffs[HRIR_COUNT][HRIR_LENGTH];
     ALubyte delays[HRIR_COUNT];
-} DefaultHrtf = {
+};
+
+static const struct HrtfTable DefaultHrtf = {
     44100,
 #include "hrtf_tables.inc"
 };
 
-static struct Hrtf *LoadedHrtfs = NULL;
+static struct HrtfTable *LoadedHrtfs = NULL;
 static ALuint NumLoadedHrtfs = 0;
 
 
+/* Zero crossings on either side of the sinc used to resample HRIRs */
+#define HRIR_SINC_ZEROS 16
+/* Samples a response resampled to a lower rate starts early by, so that it
+ * keeps the pre-ringing of the band-limiting sinc. Its delays are lengthened
+ * to match. */
+#define HRIR_LEAD 6
+
+/* An HRIR data set resampled to a device's rate and normalized, with each
+ * direction's left ear response interleaved with its mirror for the right
+ * ear, so both ears come out of one blend. These are built the first time a
+ * device asks for a rate, and kept until the library is unloaded. */
+struct Hrtf {
+    ALuint sampleRate;
+    const struct HrtfTable *table;
+
+    ALfloat coeffs[HRIR_COUNT][HRIR_LENGTH][2];
+    ALfloat delays[HRIR_COUNT][2];
+
+    struct Hrtf *next;
+};
+
+static struct Hrtf *BuiltHrtfs = NULL;
+
+
+/* Resamples one impulse response with a Blackman windowed sinc, starting
+ * lead samples early. The result is scaled so the filter keeps its gain at
+ * the new rate. When going to a higher rate the response is cut off at
+ * HRIR_LENGTH samples, which loses the end of the tail: at 48khz some
+ * directions are off by up to 6dB around 8khz (utils/hrtftest.c). */
+static void ResampleHrir(const ALshort *src, ALuint srcRate, ALuint dstRate, ALuint lead, ALfloat *dst)
+{
+    const ALdouble ratio = (ALdouble)srcRate / dstRate;
+    const ALdouble cutoff = (dstRate < srcRate) ? 1.0/ratio : 1.0;
+    const ALdouble width = HRIR_SINC_ZEROS / cutoff;
+    ALuint i, j;
+
+    for(i = 0;i < HRIR_LENGTH;i++)
+    {
+        ALdouble pos = ((ALint)i - (ALint)lead) * ratio;
+        ALdouble sum = 0.0;
+
+        for(j = 0;j < HRIR_LENGTH;j++)
+        {
+            ALdouble x = pos - j;
+            ALdouble w, sinc;
+
+            if(fabs(x) >= width)
+                continue;
+            w = 0.42 + 0.5*cos(M_PI * x/width) + 0.08*cos(2.0*M_PI * x/width);
+            sinc = (fabs(x) < 1e-9) ? 1.0 : sin(M_PI*cutoff*x) / (M_PI*cutoff*x);
+            sum += src[j] * cutoff * sinc * w;
+        }
+        dst[i] = (ALfloat)(sum * ratio / 32767.0);
+    }
+}
+
+/* Builds the coefficient table for the given data set at the given rate. */
+static struct Hrtf *CreateHrtf(const struct HrtfTable *table, ALuint rate)
+{
+    const ALfloat maxDelay = SRC_HISTORY_LENGTH-1;
+    const ALuint lead = (rate < table->sampleRate) ? HRIR_LEAD : 0;
+    struct Hrtf *hrtf;
+    ALuint ev, az, i, c;
+
+    hrtf = malloc(sizeof(*hrtf));
+    if(!hrtf)
+        return NULL;
+
+    if(rate != table->sampleRate)
+        TRACE("Resampling HRTF from %uhz to %uhz\n", table->sampleRate, rate);
+    for(i = 0;i < HRIR_COUNT;i++)
+    {
+        ALfloat hrir[HRIR_LENGTH];
+
+        if(rate == table->sampleRate)
+        {
+            for(c = 0;c < HRIR_LENGTH;c++)
+                hrir[c] = table->coeffs[i][c] * (1.0f/32767.0f);
+            hrtf->delays[i][0] = table->delays[i];
+        }
+        else
+        {
+            ResampleHrir(table->coeffs[i], table->sampleRate, rate, lead, hrir);
+            hrtf->delays[i][0] = minf((ALfloat)table->delays[i] * rate /
+                                      table->sampleRate + lead, maxDelay);
+        }
+        for(c = 0;c < HRIR_LENGTH;c++)
+            hrtf->coeffs[i][c][0] = hrir[c];
+    }
+
+    /* The right ear hears each direction the way the left ear hears its
+     * mirror, which is measured at the same elevation. */
+    for(ev = 0;ev < ELEV_COUNT;ev++)
+    {
+        for(az = 0;az < azCount[ev];az++)
+        {
+            ALuint lidx = evOffset[ev] + az;
+            ALuint ridx = evOffset[ev] + ((azCount[ev]-az) % azCount[ev]);
+
+            for(c = 0;c < HRIR_LENGTH;c++)
+                hrtf->coeffs[lidx][c][1] = hrtf->coeffs[ridx][c][0];
+            hrtf->delays[lidx][1] = hrtf->delays[ridx][0];
+        }
+    }
+
+    hrtf->sampleRate = rate;
+    hrtf->table = table;
+    hrtf->next = NULL;
+    return hrtf;
+}
+
+
 // Calculate the elevation indices given the polar elevation in radians.
 // This will return two indices between 0 and (ELEV_COUNT-1) and an
 // interpolation factor between 0.0 and 1.0.
@@ -107,171 +229,92 @@ ALfloat CalcHrtfDelta(ALfloat oldGain, ALfloat newGain, const ALfloat olddir[3],
 }
 
 // Calculates static HRIR coefficients and delays for the given polar
-// elevation and azimuth in radians.  Linear interpolation is used to
-// increase the apparent resolution of the HRIR dataset.  The coefficients
-// are also normalized and attenuated by the specified gain.
-void GetLerpedHrtfCoeffs(const struct Hrtf *Hrtf, ALfloat elevation, ALfloat azimuth, ALfloat gain, ALfloat (*coeffs)[2], ALuint *delays)
+// elevation and azimuth in radians, by blending the four surrounding
+// measured directions.  The coefficients are also attenuated by the
+// specified gain.
+void GetHrtfCoeffs(const struct Hrtf *Hrtf, ALfloat elevation, ALfloat azimuth, ALfloat gain, ALfloat (*coeffs)[2], ALuint *delays)
 {
+    const ALfloat *c0, *c1, *c2, *c3;
+    ALfloat *out = &coeffs[0][0];
     ALuint evidx[2], azidx[2];
+    ALuint idx[4];
     ALfloat mu[3];
-    ALuint lidx[4], ridx[4];
+    ALfloat blend[4];
     ALuint i;
 
-    // Claculate elevation indices and interpolation factor.
+    // Calculate the elevation indices, and the indices of the two nearest
+    // azimuths on each elevation, along with their interpolation factors.
     CalcEvIndices(elevation, evidx, &mu[2]);
-
-    // Calculate azimuth indices and interpolation factor for the first
-    // elevation.
     CalcAzIndices(evidx[0], azimuth, azidx, &mu[0]);
-
-    // Calculate the first set of linear HRIR indices for left and right
-    // channels.
-    lidx[0] = evOffset[evidx[0]] + azidx[0];
-    lidx[1] = evOffset[evidx[0]] + azidx[1];
-    ridx[0] = evOffset[evidx[0]] + ((azCount[evidx[0]]-azidx[0]) % azCount[evidx[0]]);
-    ridx[1] = evOffset[evidx[0]] + ((azCount[evidx[0]]-azidx[1]) % azCount[evidx[0]]);
-
-    // Calculate azimuth indices and interpolation factor for the second
-    // elevation.
+    idx[0] = evOffset[evidx[0]] + azidx[0];
+    idx[1] = evOffset[evidx[0]] + azidx[1];
     CalcAzIndices(evidx[1], azimuth, azidx, &mu[1]);
-
-    // Calculate the second set of linear HRIR indices for left and right
-    // channels.
-    lidx[2] = evOffset[evidx[1]] + azidx[0];
-    lidx[3] = evOffset[evidx[1]] + azidx[1];
-    ridx[2] = evOffset[evidx[1]] + ((azCount[evidx[1]]-azidx[0]) % azCount[evidx[1]]);
-    ridx[3] = evOffset[evidx[1]] + ((azCount[evidx[1]]-azidx[1]) % azCount[evidx[1]]);
-
-    // Calculate the normalized and attenuated HRIR coefficients using linear
-    // interpolation when there is enough gain to warrant it.  Zero the
-    // coefficients if gain is too low.
-    if(gain > 0.0001f)
+    idx[2] = evOffset[evidx[1]] + azidx[0];
+    idx[3] = evOffset[evidx[1]] + azidx[1];
+
+    blend[0] = (1.0f-mu[0]) * (1.0f-mu[2]);
+    blend[1] = (     mu[0]) * (1.0f-mu[2]);
+    blend[2] = (1.0f-mu[1]) * (     mu[2]);
+    blend[3] = (     mu[1]) * (     mu[2]);
+
+    // Calculate the HRIR delays.
+    for(i = 0;i < 2;i++)
+        delays[i] = fastf2u((Hrtf->delays[idx[0]][i]*blend[0] +
+                             Hrtf->delays[idx[1]][i]*blend[1] +
+                             Hrtf->delays[idx[2]][i]*blend[2] +
+                             Hrtf->delays[idx[3]][i]*blend[3]) * 65536.0f);
+
+    // Zero the coefficients if gain is too low to warrant calculating them.
+    if(!(gain > 0.0001f))
     {
-        gain *= 1.0f/32767.0f;
-        for(i = 0;i < HRIR_LENGTH;i++)
-        {
-            coeffs[i][0] = lerp(lerp(Hrtf->coeffs[lidx[0]][i], Hrtf->coeffs[lidx[1]][i], mu[0]),
-                                lerp(Hrtf->coeffs[lidx[2]][i], Hrtf->coeffs[lidx[3]][i], mu[1]),
-                                mu[2]) * gain;
-            coeffs[i][1] = lerp(lerp(Hrtf->coeffs[ridx[0]][i], Hrtf->coeffs[ridx[1]][i], mu[0]),
-                                lerp(Hrtf->coeffs[ridx[2]][i], Hrtf->coeffs[ridx[3]][i], mu[1]),
-                                mu[2]) * gain;
-        }
-    }
-    else
-    {
-        for(i = 0;i < HRIR_LENGTH;i++)
-        {
-            coeffs[i][0] = 0.0f;
-            coeffs[i][1] = 0.0f;
-        }
+        for(i = 0;i < HRIR_LENGTH*2;i++)
+            out[i] = 0.0f;
+        return;
     }
 
-    // Calculate the HRIR delays using linear interpolation.
-    delays[0] = fastf2u(lerp(lerp(Hrtf->delays[lidx[0]], Hrtf->delays[lidx[1]], mu[0]),
-                             lerp(Hrtf->delays[lidx[2]], Hrtf->delays[lidx[3]], mu[1]),
-                             mu[2]) * 65536.0f);
-    delays[1] = fastf2u(lerp(lerp(Hrtf->delays[ridx[0]], Hrtf->delays[ridx[1]], mu[0]),
-                             lerp(Hrtf->delays[ridx[2]], Hrtf->delays[ridx[3]], mu[1]),
-                             mu[2]) * 65536.0f);
+    for(i = 0;i < 4;i++)
+        blend[i] *= gain;
+    c0 = &Hrtf->coeffs[idx[0]][0][0];
+    c1 = &Hrtf->coeffs[idx[1]][0][0];
+    c2 = &Hrtf->coeffs[idx[2]][0][0];
+    c3 = &Hrtf->coeffs[idx[3]][0][0];
+    for(i = 0;i < HRIR_LENGTH*2;i++)
+        out[i] = c0[i]*blend[0] + c1[i]*blend[1] + c2[i]*blend[2] + c3[i]*blend[3];
 }
 
 // Calculates the moving HRIR target coefficients, target delays, and
 // stepping values for the given polar elevation and azimuth in radians.
-// Linear interpolation is used to increase the apparent resolution of the
-// HRIR dataset.  The coefficients are also normalized and attenuated by the
-// specified gain.  Stepping resolution and count is determined using the
-// given delta factor between 0.0 and 1.0.
+// The coefficients are normalized and attenuated by the specified gain.
+// Stepping resolution and count is determined using the given delta factor
+// between 0.0 and 1.0.
 ALuint GetMovingHrtfCoeffs(const struct Hrtf *Hrtf, ALfloat elevation, ALfloat azimuth, ALfloat gain, ALfloat delta, ALint counter, ALfloat (*coeffs)[2], ALuint *delays, ALfloat (*coeffStep)[2], ALint *delayStep)
 {
-    ALuint evidx[2], azidx[2];
-    ALuint lidx[4], ridx[4];
+    ALfloat running[HRIR_LENGTH][2];
     ALfloat left, right;
-    ALfloat mu[3];
     ALfloat step;
     ALuint i;
 
-    // Claculate elevation indices and interpolation factor.
-    CalcEvIndices(elevation, evidx, &mu[2]);
-
-    // Calculate azimuth indices and interpolation factor for the first
-    // elevation.
-    CalcAzIndices(evidx[0], azimuth, azidx, &mu[0]);
-
-    // Calculate the first set of linear HRIR indices for left and right
-    // channels.
-    lidx[0] = evOffset[evidx[0]] + azidx[0];
-    lidx[1] = evOffset[evidx[0]] + azidx[1];
-    ridx[0] = evOffset[evidx[0]] + ((azCount[evidx[0]]-azidx[0]) % azCount[evidx[0]]);
-    ridx[1] = evOffset[evidx[0]] + ((azCount[evidx[0]]-azidx[1]) % azCount[evidx[0]]);
-
-    // Calculate azimuth indices and interpolation factor for the second
-    // elevation.
-    CalcAzIndices(evidx[1], azimuth, azidx, &mu[1]);
-
-    // Calculate the second set of linear HRIR indices for left and right
-    // channels.
-    lidx[2] = evOffset[evidx[1]] + azidx[0];
-    lidx[3] = evOffset[evidx[1]] + azidx[1];
-    ridx[2] = evOffset[evidx[1]] + ((azCount[evidx[1]]-azidx[0]) % azCount[evidx[1]]);
-    ridx[3] = evOffset[evidx[1]] + ((azCount[evidx[1]]-azidx[1]) % azCount[evidx[1]]);
-
     // Calculate the stepping parameters.
     delta = maxf(aluFloor(delta*(Hrtf->sampleRate*0.015f) + 0.5f), 1.0f);
     step = 1.0f / delta;
 
-    // Calculate the normalized and attenuated target HRIR coefficients using
-    // linear interpolation when there is enough gain to warrant it.  Zero
-    // the target coefficients if gain is too low.  Then calculate the
-    // coefficient stepping values using the target and previous running
-    // coefficients.
-    if(gain > 0.0001f)
+    // Get the previous running coefficients and delays, then the new targets
+    // and the stepping values to get to them.
+    for(i = 0;i < HRIR_LENGTH;i++)
     {
-        gain *= 1.0f/32767.0f;
-        for(i = 0;i < HRIR_LENGTH;i++)
-        {
-            left = coeffs[i][0] - (coeffStep[i][0] * counter);
-            right = coeffs[i][1] - (coeffStep[i][1] * counter);
-
-            coeffs[i][0] = lerp(lerp(Hrtf->coeffs[lidx[0]][i], Hrtf->coeffs[lidx[1]][i], mu[0]),
-                                lerp(Hrtf->coeffs[lidx[2]][i], Hrtf->coeffs[lidx[3]][i], mu[1]),
-                                mu[2]) * gain;
-            coeffs[i][1] = lerp(lerp(Hrtf->coeffs[ridx[0]][i], Hrtf->coeffs[ridx[1]][i], mu[0]),
-                                lerp(Hrtf->coeffs[ridx[2]][i], Hrtf->coeffs[ridx[3]][i], mu[1]),
-                                mu[2]) * gain;
-
-            coeffStep[i][0] = step * (coeffs[i][0] - left);
-            coeffStep[i][1] = step * (coeffs[i][1] - right);
-        }
+        running[i][0] = coeffs[i][0] - (coeffStep[i][0] * counter);
+        running[i][1] = coeffs[i][1] - (coeffStep[i][1] * counter);
     }
-    else
-    {
-        for(i = 0;i < HRIR_LENGTH;i++)
-        {
-            left = coeffs[i][0] - (coeffStep[i][0] * counter);
-            right = coeffs[i][1] - (coeffStep[i][1] * counter);
-
-            coeffs[i][0] = 0.0f;
-            coeffs[i][1] = 0.0f;
-
-            coeffStep[i][0] = step * -left;
-            coeffStep[i][1] = step * -right;
-        }
-    }
-
-    // Calculate the HRIR delays using linear interpolation.  Then calculate
-    // the delay stepping values using the target and previous running
-    // delays.
     left = (ALfloat)(delays[0] - (delayStep[0] * counter));
     right = (ALfloat)(delays[1] - (delayStep[1] * counter));
 
-    delays[0] = fastf2u(lerp(lerp(Hrtf->delays[lidx[0]], Hrtf->delays[lidx[1]], mu[0]),
-                             lerp(Hrtf->delays[lidx[2]], Hrtf->delays[lidx[3]], mu[1]),
-                             mu[2]) * 65536.0f);
-    delays[1] = fastf2u(lerp(lerp(Hrtf->delays[ridx[0]], Hrtf->delays[ridx[1]], mu[0]),
-                             lerp(Hrtf->delays[ridx[2]], Hrtf->delays[ridx[3]], mu[1]),
-                             mu[2]) * 65536.0f);
+    GetHrtfCoeffs(Hrtf, elevation, azimuth, gain, coeffs, delays);
 
+    for(i = 0;i < HRIR_LENGTH;i++)
+    {
+        coeffStep[i][0] = step * (coeffs[i][0] - running[i][0]);
+        coeffStep[i][1] = step * (coeffs[i][1] - running[i][1]);
+    }
     delayStep[0] = fastf2i(step * (delays[0] - left));
     delayStep[1] = fastf2i(step * (delays[1] - right));
 
@@ -281,22 +324,48 @@ ALuint GetMovingHrtfCoeffs(const struct Hrtf *Hrtf, ALfloat elevation, ALfloat a
     return fastf2u(delta);
 }
 
+/* Returns the HRTF to use for the device, or NULL if it can't use one. A
+ * data set loaded for the device's rate is used as is. Otherwise the one
+ * with the closest rate (preferring loaded ones over the built-in set) is
+ * resampled to it. Called with the list lock held, from device setup. */
 const struct Hrtf *GetHrtf(ALCdevice *device)
 {
-    if(device->FmtChans == DevFmtStereo)
+    const struct HrtfTable *table = NULL;
+    struct Hrtf *hrtf;
+    ALuint i;
+
+    if(device->FmtChans != DevFmtStereo)
     {
-        ALuint i;
-        for(i = 0;i < NumLoadedHrtfs;i++)
-        {
-            if(device->Frequency == LoadedHrtfs[i].sampleRate)
-                return &LoadedHrtfs[i];
-        }
-        if(device->Frequency == DefaultHrtf.sampleRate)
-            return &DefaultHrtf;
+        ERR("Incompatible format: %s %uhz\n",
+            DevFmtChannelsString(device->FmtChans), device->Frequency);
+        return NULL;
     }
-    ERR("Incompatible format: %s %uhz\n",
-        DevFmtChannelsString(device->FmtChans), device->Frequency);
-    return NULL;
+
+    for(i = 0;i < NumLoadedHrtfs;i++)
+    {
+        if(!table || abs((ALint)(LoadedHrtfs[i].sampleRate - device->Frequency)) <
+                     abs((ALint)(table->sampleRate - device->Frequency)))
+            table = &LoadedHrtfs[i];
+    }
+    if(!table || (table->sampleRate != device->Frequency &&
+                  DefaultHrtf.sampleRate == device->Frequency))
+        table = &DefaultHrtf;
+
+    for(hrtf = BuiltHrtfs;hrtf;hrtf = hrtf->next)
+    {
+        if(hrtf->table == table && hrtf->sampleRate == device->Frequency)
+            return hrtf;
+    }
+
+    hrtf = CreateHrtf(table, device->Frequency);
+    if(!hrtf)
+    {
+        ERR("Failed to allocate HRTF for %uhz\n", device->Frequency);
+        return NULL;
+    }
+    hrtf->next = BuiltHrtfs;
+    BuiltHrtfs = hrtf;
+    return hrtf;
 }
 
 void InitHrtf(void)
@@ -309,7 +378,7 @@ void InitHrtf(void)
     while(next && *next)
     {
         const ALubyte maxDelay = SRC_HISTORY_LENGTH-1;
-        struct Hrtf newdata;
+        struct HrtfTable newdata;
         ALboolean failed;
         ALchar magic[9];
         ALsizei i, j;
@@ -451,6 +520,13 @@ void InitHrtf(void)
 
 void FreeHrtf(void)
 {
+    while(BuiltHrtfs)
+    {
+        struct Hrtf *next = BuiltHrtfs->next;
+        free(BuiltHrtfs);
+        BuiltHrtfs = next;
+    }
+
     NumLoadedHrtfs = 0;
     free(LoadedHrtfs);
     LoadedHrtfs = NULL;
@@ -53,12 +53,134 @@ static __inline ALfloat cubic32(const ALfloat *vals, ALint step, ALint frac)
 #define UNLIKELY(x) (x)
 #endif
 
-#if defined(__ARM_NEON__) && defined(HAVE_ARM_NEON_H)
+#if defined(HAVE_XMMINTRIN_H) && defined(__SSE__)
+#include <xmmintrin.h>
+#define HAVE_SSE_MIXER
+#endif
+
+#if defined(HAVE_ARM_NEON_H) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
 #include <arm_neon.h>
+#define HAVE_NEON_MIXER
+#endif
+
+
+/* Resamples BufferSize+1 samples of one channel from the interleaved source
+ * data. The extra sample is the one the next update starts with, which the
+ * click removal needs. */
+#define DECL_TEMPLATE(sampler)                                                \
+static void Resample_##sampler(const ALfloat *RESTRICT data, ALuint step,     \
+  ALuint frac, ALuint increment, ALfloat *RESTRICT OutBuffer,                 \
+  ALuint BufferSize)                                                          \
+{                                                                             \
+    ALuint pos = 0;                                                           \
+    ALuint i;                                                                 \
+                                                                              \
+    for(i = 0;i <= BufferSize;i++)                                            \
+    {                                                                         \
+        OutBuffer[i] = sampler(data + pos*step, step, frac);                  \
+                                                                              \
+        frac += increment;                                                    \
+        pos  += frac>>FRACTIONBITS;                                           \
+        frac &= FRACTIONMASK;                                                 \
+    }                                                                         \
+}
+
+DECL_TEMPLATE(point32)
+DECL_TEMPLATE(lerp32)
+DECL_TEMPLATE(cubic32)
+
+#undef DECL_TEMPLATE
+
 
-static __inline void ApplyCoeffs(ALuint Offset, ALfloat (*RESTRICT Values)[2],
-                                 ALfloat (*RESTRICT Coeffs)[2],
-                                 ALfloat left, ALfloat right)
+static __inline void ApplyGain_C(ALfloat *RESTRICT OutBuffer,
+                                 const ALfloat *RESTRICT data, ALfloat gain,
+                                 ALuint BufferSize)
+{
+    ALuint pos;
+    for(pos = 0;pos < BufferSize;pos++)
+        OutBuffer[pos] += data[pos]*gain;
+}
+
+static __inline void ApplyCoeffs_C(ALuint Offset, ALfloat (*RESTRICT Values)[2],
+                                   ALfloat (*RESTRICT Coeffs)[2],
+                                   ALfloat left, ALfloat right)
+{
+    ALuint c;
+    for(c = 0;c < HRIR_LENGTH;c++)
+    {
+        const ALuint off = (Offset+c)&HRIR_MASK;
+        Values[off][0] += Coeffs[c][0] * left;
+        Values[off][1] += Coeffs[c][1] * right;
+    }
+}
+
+#ifdef HAVE_SSE_MIXER
+static __inline void ApplyGain_SSE(ALfloat *RESTRICT OutBuffer,
+                                   const ALfloat *RESTRICT data, ALfloat gain,
+                                   ALuint BufferSize)
+{
+    const __m128 gain4 = _mm_set1_ps(gain);
+    ALuint pos;
+
+    for(pos = 0;pos+4 <= BufferSize;pos += 4)
+    {
+        __m128 val4 = _mm_loadu_ps(&data[pos]);
+        __m128 dry4 = _mm_loadu_ps(&OutBuffer[pos]);
+        dry4 = _mm_add_ps(dry4, _mm_mul_ps(val4, gain4));
+        _mm_storeu_ps(&OutBuffer[pos], dry4);
+    }
+    for(;pos < BufferSize;pos++)
+        OutBuffer[pos] += data[pos]*gain;
+}
+
+static __inline void ApplyCoeffs_SSE(ALuint Offset, ALfloat (*RESTRICT Values)[2],
+                                     ALfloat (*RESTRICT Coeffs)[2],
+                                     ALfloat left, ALfloat right)
+{
+    const __m128 lrlr = _mm_setr_ps(left, right, left, right);
+    __m128 vals = _mm_setzero_ps();
+    __m128 coeffs;
+    ALuint c;
+
+    for(c = 0;c < HRIR_LENGTH;c += 2)
+    {
+        const ALuint o0 = (Offset+c)&HRIR_MASK;
+        const ALuint o1 = (o0+1)&HRIR_MASK;
+
+        coeffs = _mm_loadu_ps(&Coeffs[c][0]);
+        vals = _mm_loadl_pi(vals, (__m64*)&Values[o0][0]);
+        vals = _mm_loadh_pi(vals, (__m64*)&Values[o1][0]);
+
+        vals = _mm_add_ps(vals, _mm_mul_ps(coeffs, lrlr));
+
+        _mm_storel_pi((__m64*)&Values[o0][0], vals);
+        _mm_storeh_pi((__m64*)&Values[o1][0], vals);
+    }
+}
+#endif
+
+#ifdef HAVE_NEON_MIXER
+static __inline void ApplyGain_Neon(ALfloat *RESTRICT OutBuffer,
+                                    const ALfloat *RESTRICT data, ALfloat gain,
+                                    ALuint BufferSize)
+{
+    const float32x4_t gain4 = vdupq_n_f32(gain);
+    ALuint pos;
+
+    for(pos = 0;pos+4 <= BufferSize;pos += 4)
+    {
+        float32x4_t val4 = vld1q_f32((const float32_t*)&data[pos]);
+        float32x4_t dry4 = vld1q_f32((float32_t*)&OutBuffer[pos]);
+        dry4 = vmlaq_f32(dry4, val4, gain4);
+        vst1q_f32((float32_t*)&OutBuffer[pos], dry4);
+    }
+    for(;pos < BufferSize;pos++)
+        OutBuffer[pos] += data[pos]*gain;
+}
+
+static __inline void ApplyCoeffs_Neon(ALuint Offset, ALfloat (*RESTRICT Values)[2],
+                                      ALfloat (*RESTRICT Coeffs)[2],
+                                      ALfloat left, ALfloat right)
 {
     ALuint c;
     float32x4_t leftright4;
@@ -82,35 +204,24 @@ static __inline void ApplyCoeffs(ALuint Offset, ALfloat (*RESTRICT Values)[2],
         vst1_f32((float32_t*)&Values[o1][0], vget_high_f32(vals));
     }
 }
-
-#else
-
-static __inline void ApplyCoeffs(ALuint Offset, ALfloat (*RESTRICT Values)[2],
-                                 ALfloat (*RESTRICT Coeffs)[2],
-                                 ALfloat left, ALfloat right)
-{
-    ALuint c;
-    for(c = 0;c < HRIR_LENGTH;c++)
-    {
-        const ALuint off = (Offset+c)&HRIR_MASK;
-        Values[off][0] += Coeffs[c][0] * left;
-        Values[off][1] += Coeffs[c][1] * right;
-    }
-}
-
 #endif
 
-#define DECL_TEMPLATE(T, sampler)                                             \
-static void Mix_Hrtf_##T##_##sampler(ALsource *Source, ALCdevice *Device,     \
-  const ALvoid *srcdata, ALuint *DataPosInt, ALuint *DataPosFrac,             \
-  ALuint OutPos, ALuint SamplesToDo, ALuint BufferSize)                       \
+
+/* Each source channel is resampled once into a contiguous buffer, which then
+ * feeds the dry path and every send. */
+#define DECL_TEMPLATE(T, sampler, acc)                                        \
+static void Mix_Hrtf_##T##_##sampler##_##acc(ALsource *Source,                \
+  ALCdevice *Device, const ALvoid *srcdata, ALuint *DataPosInt,               \
+  ALuint *DataPosFrac, ALuint OutPos, ALuint SamplesToDo, ALuint BufferSize)  \
 {                                                                             \
     const ALuint NumChannels = Source->NumChannels;                           \
     const T *RESTRICT data = srcdata;                                         \
     const ALint *RESTRICT DelayStep = Source->Params.HrtfDelayStep;           \
-    ALfloat (*RESTRICT DryBuffer)[MAXCHANNELS];                               \
+    ALfloat (*RESTRICT DryBuffer)[BUFFERSIZE];                                \
     ALfloat *RESTRICT ClickRemoval, *RESTRICT PendingClicks;                  \
     ALfloat (*RESTRICT CoeffStep)[2] = Source->Params.HrtfCoeffStep;          \
+    ALfloat ResampledData[BUFFERSIZE+1];                                      \
+    ALfloat FilteredData[BUFFERSIZE];                                         \
     ALuint pos, frac;                                                         \
     FILTER *DryFilter;                                                        \
     ALuint BufferIdx;                                                         \
@@ -125,9 +236,6 @@ static void Mix_Hrtf_##T##_##sampler(ALsource *Source, ALCdevice *Device,     \
     PendingClicks = Device->PendingClicks;                                    \
     DryFilter = &Source->Params.iirFilter;                                    \
                                                                               \
-    pos = 0;                                                                  \
-    frac = *DataPosFrac;                                                      \
-                                                                              \
     for(i = 0;i < NumChannels;i++)                                            \
     {                                                                         \
         ALfloat (*RESTRICT TargetCoeffs)[2] = Source->Params.HrtfCoeffs[i];   \
@@ -140,8 +248,8 @@ static void Mix_Hrtf_##T##_##sampler(ALsource *Source, ALCdevice *Device,     \
         ALuint Delay[2];                                                      \
         ALfloat left, right;                                                  \
                                                                               \
-        pos = 0;                                                              \
-        frac = *DataPosFrac;                                                  \
+        Resample_##sampler(data + i, NumChannels, *DataPosFrac, increment,    \
+                           ResampledData, BufferSize);                        \
                                                                               \
         for(c = 0;c < HRIR_LENGTH;c++)                                        \
         {                                                                     \
@@ -154,8 +262,7 @@ static void Mix_Hrtf_##T##_##sampler(ALsource *Source, ALCdevice *Device,     \
                                                                               \
         if(LIKELY(OutPos == 0))                                               \
         {                                                                     \
-            value = sampler(data + pos*NumChannels + i, NumChannels, frac);   \
-            value = lpFilter2PC(DryFilter, i, value);                         \
+            value = lpFilter2PC(DryFilter, i, ResampledData[0]);              \
                                                                               \
             History[Offset&SRC_HISTORY_MASK] = value;                         \
             left = History[(Offset-(Delay[0]>>16))&SRC_HISTORY_MASK];         \
@@ -168,8 +275,7 @@ static void Mix_Hrtf_##T##_##sampler(ALsource *Source, ALCdevice *Device,     \
         }                                                                     \
         for(BufferIdx = 0;BufferIdx < BufferSize && Counter > 0;BufferIdx++)  \
         {                                                                     \
-            value = sampler(data + pos*NumChannels + i, NumChannels, frac);   \
-            value = lpFilter2P(DryFilter, i, value);                          \
+            value = lpFilter2P(DryFilter, i, ResampledData[BufferIdx]);       \
                                                                               \
             History[Offset&SRC_HISTORY_MASK] = value;                         \
             left = History[(Offset-(Delay[0]>>16))&SRC_HISTORY_MASK];         \
@@ -191,12 +297,9 @@ static void Mix_Hrtf_##T##_##sampler(ALsource *Source, ALCdevice *Device,     \
                 Coeffs[c][1] += CoeffStep[c][1];                              \
             }                                                                 \
                                                                               \
-            DryBuffer[OutPos][FRONT_LEFT]  += Values[Offset&HRIR_MASK][0];    \
-            DryBuffer[OutPos][FRONT_RIGHT] += Values[Offset&HRIR_MASK][1];    \
+            DryBuffer[FRONT_LEFT][OutPos]  += Values[Offset&HRIR_MASK][0];    \
+            DryBuffer[FRONT_RIGHT][OutPos] += Values[Offset&HRIR_MASK][1];    \
                                                                               \
-            frac += increment;                                                \
-            pos  += frac>>FRACTIONBITS;                                       \
-            frac &= FRACTIONMASK;                                             \
             OutPos++;                                                         \
             Counter--;                                                        \
         }                                                                     \
@@ -205,8 +308,7 @@ static void Mix_Hrtf_##T##_##sampler(ALsource *Source, ALCdevice *Device,     \
         Delay[1] >>= 16;                                                      \
         for(;BufferIdx < BufferSize;BufferIdx++)                              \
         {                                                                     \
-            value = sampler(data + pos*NumChannels + i, NumChannels, frac);   \
-            value = lpFilter2P(DryFilter, i, value);                          \
+            value = lpFilter2P(DryFilter, i, ResampledData[BufferIdx]);       \
                                                                               \
             History[Offset&SRC_HISTORY_MASK] = value;                         \
             left = History[(Offset-Delay[0])&SRC_HISTORY_MASK];               \
@@ -216,19 +318,15 @@ static void Mix_Hrtf_##T##_##sampler(ALsource *Source, ALCdevice *Device,     \
             Values[Offset&HRIR_MASK][1] = 0.0f;                               \
             Offset++;                                                         \
                                                                               \
-            ApplyCoeffs(Offset, Values, Coeffs, left, right);                 \
-            DryBuffer[OutPos][FRONT_LEFT]  += Values[Offset&HRIR_MASK][0];    \
-            DryBuffer[OutPos][FRONT_RIGHT] += Values[Offset&HRIR_MASK][1];    \
+            ApplyCoeffs_##acc(Offset, Values, Coeffs, left, right);           \
+            DryBuffer[FRONT_LEFT][OutPos]  += Values[Offset&HRIR_MASK][0];    \
+            DryBuffer[FRONT_RIGHT][OutPos] += Values[Offset&HRIR_MASK][1];    \
                                                                               \
-            frac += increment;                                                \
-            pos  += frac>>FRACTIONBITS;                                       \
-            frac &= FRACTIONMASK;                                             \
             OutPos++;                                                         \
         }                                                                     \
         if(LIKELY(OutPos == SamplesToDo))                                     \
         {                                                                     \
-            value = sampler(data + pos*NumChannels + i, NumChannels, frac);   \
-            value = lpFilter2PC(DryFilter, i, value);                         \
+            value = lpFilter2PC(DryFilter, i, ResampledData[BufferSize]);     \
                                                                               \
             History[Offset&SRC_HISTORY_MASK] = value;                         \
             left = History[(Offset-Delay[0])&SRC_HISTORY_MASK];               \
@@ -240,81 +338,73 @@ static void Mix_Hrtf_##T##_##sampler(ALsource *Source, ALCdevice *Device,     \
                                           Coeffs[0][1] * right;               \
         }                                                                     \
         OutPos -= BufferSize;                                                 \
-    }                                                                         \
                                                                               \
-    for(out = 0;out < Device->NumAuxSends;out++)                              \
-    {                                                                         \
-        ALeffectslot *Slot = Source->Params.Send[out].Slot;                   \
-        ALfloat  WetSend;                                                     \
-        ALfloat *RESTRICT WetBuffer;                                          \
-        ALfloat *RESTRICT WetClickRemoval;                                    \
-        ALfloat *RESTRICT WetPendingClicks;                                   \
-        FILTER  *WetFilter;                                                   \
-                                                                              \
-        if(Slot == NULL)                                                      \
-            continue;                                                         \
-                                                                              \
-        WetBuffer = Slot->WetBuffer;                                          \
-        WetClickRemoval = Slot->ClickRemoval;                                 \
-        WetPendingClicks = Slot->PendingClicks;                               \
-        WetFilter = &Source->Params.Send[out].iirFilter;                      \
-        WetSend = Source->Params.Send[out].WetGain;                           \
-                                                                              \
-        for(i = 0;i < NumChannels;i++)                                        \
+        for(out = 0;out < Device->NumAuxSends;out++)                          \
         {                                                                     \
-            pos = 0;                                                          \
-            frac = *DataPosFrac;                                              \
+            ALeffectslot *Slot = Source->Params.Send[out].Slot;               \
+            ALfloat  WetSend;                                                 \
+            FILTER  *WetFilter;                                               \
+                                                                              \
+            if(Slot == NULL)                                                  \
+                continue;                                                     \
+                                                                              \
+            WetFilter = &Source->Params.Send[out].iirFilter;                  \
+            WetSend = Source->Params.Send[out].WetGain;                       \
                                                                               \
             if(LIKELY(OutPos == 0))                                           \
             {                                                                 \
-                value = sampler(data + pos*NumChannels + i, NumChannels,frac);\
-                value = lpFilter1PC(WetFilter, i, value);                     \
-                                                                              \
-                WetClickRemoval[0] -= value * WetSend;                        \
+                value = lpFilter1PC(WetFilter, i, ResampledData[0]);          \
+                Slot->ClickRemoval[0] -= value * WetSend;                     \
             }                                                                 \
             for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)             \
+                FilteredData[BufferIdx] = lpFilter1P(WetFilter, i,            \
+                                                 ResampledData[BufferIdx]);   \
+            ApplyGain_##acc(&Slot->WetBuffer[OutPos], FilteredData, WetSend,  \
+                            BufferSize);                                      \
+            if(LIKELY(OutPos+BufferSize == SamplesToDo))                      \
             {                                                                 \
-                value = sampler(data + pos*NumChannels + i, NumChannels,frac);\
-                value = lpFilter1P(WetFilter, i, value);                      \
-                                                                              \
-                WetBuffer[OutPos] += value * WetSend;                         \
-                                                                              \
-                frac += increment;                                            \
-                pos  += frac>>FRACTIONBITS;                                   \
-                frac &= FRACTIONMASK;                                         \
-                OutPos++;                                                     \
-            }                                                                 \
-            if(LIKELY(OutPos == SamplesToDo))                                 \
-            {                                                                 \
-                value = sampler(data + pos*NumChannels + i, NumChannels,frac);\
-                value = lpFilter1PC(WetFilter, i, value);                     \
-                                                                              \
-                WetPendingClicks[0] += value * WetSend;                       \
+                value = lpFilter1PC(WetFilter, i, ResampledData[BufferSize]); \
+                Slot->PendingClicks[0] += value * WetSend;                    \
             }                                                                 \
-            OutPos -= BufferSize;                                             \
         }                                                                     \
     }                                                                         \
+                                                                              \
+    frac = *DataPosFrac + increment*BufferSize;                               \
+    pos  = frac>>FRACTIONBITS;                                                \
+    frac &= FRACTIONMASK;                                                     \
     *DataPosInt += pos;                                                       \
     *DataPosFrac = frac;                                                      \
 }
 
-DECL_TEMPLATE(ALfloat, point32)
-DECL_TEMPLATE(ALfloat, lerp32)
-DECL_TEMPLATE(ALfloat, cubic32)
+DECL_TEMPLATE(ALfloat, point32, C)
+DECL_TEMPLATE(ALfloat, lerp32, C)
+DECL_TEMPLATE(ALfloat, cubic32, C)
+#ifdef HAVE_SSE_MIXER
+DECL_TEMPLATE(ALfloat, point32, SSE)
+DECL_TEMPLATE(ALfloat, lerp32, SSE)
+DECL_TEMPLATE(ALfloat, cubic32, SSE)
+#endif
+#ifdef HAVE_NEON_MIXER
+DECL_TEMPLATE(ALfloat, point32, Neon)
+DECL_TEMPLATE(ALfloat, lerp32, Neon)
+DECL_TEMPLATE(ALfloat, cubic32, Neon)
+#endif
 
 #undef DECL_TEMPLATE
 
 
-#define DECL_TEMPLATE(T, sampler)                                             \
-static void Mix_##T##_##sampler(ALsource *Source, ALCdevice *Device,          \
+#define DECL_TEMPLATE(T, sampler, acc)                                        \
+static void Mix_##T##_##sampler##_##acc(ALsource *Source, ALCdevice *Device,  \
   const ALvoid *srcdata, ALuint *DataPosInt, ALuint *DataPosFrac,             \
   ALuint OutPos, ALuint SamplesToDo, ALuint BufferSize)                       \
 {                                                                             \
     const ALuint NumChannels = Source->NumChannels;                           \
     const T *RESTRICT data = srcdata;                                         \
-    ALfloat (*RESTRICT DryBuffer)[MAXCHANNELS];                               \
+    ALfloat (*RESTRICT DryBuffer)[BUFFERSIZE];                                \
     ALfloat *RESTRICT ClickRemoval, *RESTRICT PendingClicks;                  \
-    ALfloat DrySend[MAXCHANNELS];                                             \
+    ALfloat ResampledData[BUFFERSIZE+1];                                      \
+    ALfloat FilteredData[BUFFERSIZE];                                         \
+    const ALfloat *DrySend;                                                   \
     FILTER *DryFilter;                                                        \
     ALuint pos, frac;                                                         \
     ALuint BufferIdx;                                                         \
@@ -329,142 +419,146 @@ static void Mix_##T##_##sampler(ALsource *Source, ALCdevice *Device,          \
     PendingClicks = Device->PendingClicks;                                    \
     DryFilter = &Source->Params.iirFilter;                                    \
                                                                               \
-    pos = 0;                                                                  \
-    frac = *DataPosFrac;                                                      \
-                                                                              \
     for(i = 0;i < NumChannels;i++)                                            \
     {                                                                         \
-        for(c = 0;c < MAXCHANNELS;c++)                                        \
-            DrySend[c] = Source->Params.DryGains[i][c];                       \
+        DrySend = Source->Params.DryGains[i];                                 \
                                                                               \
-        pos = 0;                                                              \
-        frac = *DataPosFrac;                                                  \
+        Resample_##sampler(data + i, NumChannels, *DataPosFrac, increment,    \
+                           ResampledData, BufferSize);                        \
                                                                               \
         if(OutPos == 0)                                                       \
         {                                                                     \
-            value = sampler(data + pos*NumChannels + i, NumChannels, frac);   \
-                                                                              \
-            value = lpFilter2PC(DryFilter, i, value);                         \
+            value = lpFilter2PC(DryFilter, i, ResampledData[0]);              \
             for(c = 0;c < MAXCHANNELS;c++)                                    \
                 ClickRemoval[c] -= value*DrySend[c];                          \
         }                                                                     \
         for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)                 \
+            FilteredData[BufferIdx] = lpFilter2P(DryFilter, i,                \
+                                                 ResampledData[BufferIdx]);   \
+        for(c = 0;c < MAXCHANNELS;c++)                                        \
         {                                                                     \
-            value = sampler(data + pos*NumChannels + i, NumChannels, frac);   \
-                                                                              \
-            value = lpFilter2P(DryFilter, i, value);                          \
-            for(c = 0;c < MAXCHANNELS;c++)                                    \
-                DryBuffer[OutPos][c] += value*DrySend[c];                     \
-                                                                              \
-            frac += increment;                                                \
-            pos  += frac>>FRACTIONBITS;                                       \
-            frac &= FRACTIONMASK;                                             \
-            OutPos++;                                                         \
+            /* Channels the source isn't panned to are left alone */          \
+            if(DrySend[c] == 0.0f)                                            \
+                continue;                                                     \
+            ApplyGain_##acc(&DryBuffer[c][OutPos], FilteredData, DrySend[c],  \
+                            BufferSize);                                      \
         }                                                                     \
-        if(OutPos == SamplesToDo)                                             \
+        if(OutPos+BufferSize == SamplesToDo)                                  \
         {                                                                     \
-            value = sampler(data + pos*NumChannels + i, NumChannels, frac);   \
-                                                                              \
-            value = lpFilter2PC(DryFilter, i, value);                         \
+            value = lpFilter2PC(DryFilter, i, ResampledData[BufferSize]);     \
             for(c = 0;c < MAXCHANNELS;c++)                                    \
                 PendingClicks[c] += value*DrySend[c];                         \
         }                                                                     \
-        OutPos -= BufferSize;                                                 \
-    }                                                                         \
                                                                               \
-    for(out = 0;out < Device->NumAuxSends;out++)                              \
-    {                                                                         \
-        ALeffectslot *Slot = Source->Params.Send[out].Slot;                   \
-        ALfloat  WetSend;                                                     \
-        ALfloat *WetBuffer;                                                   \
-        ALfloat *WetClickRemoval;                                             \
-        ALfloat *WetPendingClicks;                                            \
-        FILTER  *WetFilter;                                                   \
-                                                                              \
-        if(Slot == NULL)                                                      \
-            continue;                                                         \
-                                                                              \
-        WetBuffer = Slot->WetBuffer;                                          \
-        WetClickRemoval = Slot->ClickRemoval;                                 \
-        WetPendingClicks = Slot->PendingClicks;                               \
-        WetFilter = &Source->Params.Send[out].iirFilter;                      \
-        WetSend = Source->Params.Send[out].WetGain;                           \
-                                                                              \
-        for(i = 0;i < NumChannels;i++)                                        \
+        for(out = 0;out < Device->NumAuxSends;out++)                          \
         {                                                                     \
-            pos = 0;                                                          \
-            frac = *DataPosFrac;                                              \
+            ALeffectslot *Slot = Source->Params.Send[out].Slot;               \
+            ALfloat  WetSend;                                                 \
+            FILTER  *WetFilter;                                               \
+                                                                              \
+            if(Slot == NULL)                                                  \
+                continue;                                                     \
+                                                                              \
+            WetFilter = &Source->Params.Send[out].iirFilter;                  \
+            WetSend = Source->Params.Send[out].WetGain;                       \
                                                                               \
             if(OutPos == 0)                                                   \
             {                                                                 \
-                value = sampler(data + pos*NumChannels + i, NumChannels,frac);\
-                                                                              \
-                value = lpFilter1PC(WetFilter, i, value);                     \
-                WetClickRemoval[0] -= value * WetSend;                        \
+                value = lpFilter1PC(WetFilter, i, ResampledData[0]);          \
+                Slot->ClickRemoval[0] -= value * WetSend;                     \
             }                                                                 \
             for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)             \
+                FilteredData[BufferIdx] = lpFilter1P(WetFilter, i,            \
+                                                 ResampledData[BufferIdx]);   \
+            ApplyGain_##acc(&Slot->WetBuffer[OutPos], FilteredData, WetSend,  \
+                            BufferSize);                                      \
+            if(OutPos+BufferSize == SamplesToDo)                              \
             {                                                                 \
-                value = sampler(data + pos*NumChannels + i, NumChannels,frac);\
-                                                                              \
-                value = lpFilter1P(WetFilter, i, value);                      \
-                WetBuffer[OutPos] += value * WetSend;                         \
-                                                                              \
-                frac += increment;                                            \
-                pos  += frac>>FRACTIONBITS;                                   \
-                frac &= FRACTIONMASK;                                         \
-                OutPos++;                                                     \
+                value = lpFilter1PC(WetFilter, i, ResampledData[BufferSize]); \
+                Slot->PendingClicks[0] += value * WetSend;                    \
             }                                                                 \
-            if(OutPos == SamplesToDo)                                         \
-            {                                                                 \
-                value = sampler(data + pos*NumChannels + i, NumChannels,frac);\
-                                                                              \
-                value = lpFilter1PC(WetFilter, i, value);                     \
-                WetPendingClicks[0] += value * WetSend;                       \
-            }                                                                 \
-            OutPos -= BufferSize;                                             \
         }                                                                     \
     }                                                                         \
+                                                                              \
+    frac = *DataPosFrac + increment*BufferSize;                               \
+    pos  = frac>>FRACTIONBITS;                                                \
+    frac &= FRACTIONMASK;                                                     \
     *DataPosInt += pos;                                                       \
     *DataPosFrac = frac;                                                      \
 }
 
-DECL_TEMPLATE(ALfloat, point32)
-DECL_TEMPLATE(ALfloat, lerp32)
-DECL_TEMPLATE(ALfloat, cubic32)
+DECL_TEMPLATE(ALfloat, point32, C)
+DECL_TEMPLATE(ALfloat, lerp32, C)
+DECL_TEMPLATE(ALfloat, cubic32, C)
+#ifdef HAVE_SSE_MIXER
+DECL_TEMPLATE(ALfloat, point32, SSE)
+DECL_TEMPLATE(ALfloat, lerp32, SSE)
+DECL_TEMPLATE(ALfloat, cubic32, SSE)
+#endif
+#ifdef HAVE_NEON_MIXER
+DECL_TEMPLATE(ALfloat, point32, Neon)
+DECL_TEMPLATE(ALfloat, lerp32, Neon)
+DECL_TEMPLATE(ALfloat, cubic32, Neon)
+#endif
 
 #undef DECL_TEMPLATE
 
 
+static const MixerFunc Mixers_C[ResamplerMax] = {
+    Mix_ALfloat_point32_C, Mix_ALfloat_lerp32_C, Mix_ALfloat_cubic32_C
+};
+static const MixerFunc HrtfMixers_C[ResamplerMax] = {
+    Mix_Hrtf_ALfloat_point32_C, Mix_Hrtf_ALfloat_lerp32_C,
+    Mix_Hrtf_ALfloat_cubic32_C
+};
+#ifdef HAVE_SSE_MIXER
+static const MixerFunc Mixers_SSE[ResamplerMax] = {
+    Mix_ALfloat_point32_SSE, Mix_ALfloat_lerp32_SSE, Mix_ALfloat_cubic32_SSE
+};
+static const MixerFunc HrtfMixers_SSE[ResamplerMax] = {
+    Mix_Hrtf_ALfloat_point32_SSE, Mix_Hrtf_ALfloat_lerp32_SSE,
+    Mix_Hrtf_ALfloat_cubic32_SSE
+};
+#endif
+#ifdef HAVE_NEON_MIXER
+static const MixerFunc Mixers_Neon[ResamplerMax] = {
+    Mix_ALfloat_point32_Neon, Mix_ALfloat_lerp32_Neon,
+    Mix_ALfloat_cubic32_Neon
+};
+static const MixerFunc HrtfMixers_Neon[ResamplerMax] = {
+    Mix_Hrtf_ALfloat_point32_Neon, Mix_Hrtf_ALfloat_lerp32_Neon,
+    Mix_Hrtf_ALfloat_cubic32_Neon
+};
+#endif
+
 MixerFunc SelectMixer(enum Resampler Resampler)
 {
-    switch(Resampler)
-    {
-        case PointResampler:
-            return Mix_ALfloat_point32;
-        case LinearResampler:
-            return Mix_ALfloat_lerp32;
-        case CubicResampler:
-            return Mix_ALfloat_cubic32;
-        case ResamplerMax:
-            break;
-    }
-    return NULL;
+    if(Resampler < PointResampler || Resampler >= ResamplerMax)
+        return NULL;
+#ifdef HAVE_SSE_MIXER
+    if((CPUCapFlags&CPU_CAP_SSE))
+        return Mixers_SSE[Resampler];
+#endif
+#ifdef HAVE_NEON_MIXER
+    if((CPUCapFlags&CPU_CAP_NEON))
+        return Mixers_Neon[Resampler];
+#endif
+    return Mixers_C[Resampler];
 }
 
 MixerFunc SelectHrtfMixer(enum Resampler Resampler)
 {
-    switch(Resampler)
-    {
-        case PointResampler:
-            return Mix_Hrtf_ALfloat_point32;
-        case LinearResampler:
-            return Mix_Hrtf_ALfloat_lerp32;
-        case CubicResampler:
-            return Mix_Hrtf_ALfloat_cubic32;
-        case ResamplerMax:
-            break;
-    }
-    return NULL;
+    if(Resampler < PointResampler || Resampler >= ResamplerMax)
+        return NULL;
+#ifdef HAVE_SSE_MIXER
+    if((CPUCapFlags&CPU_CAP_SSE))
+        return HrtfMixers_SSE[Resampler];
+#endif
+#ifdef HAVE_NEON_MIXER
+    if((CPUCapFlags&CPU_CAP_NEON))
+        return HrtfMixers_Neon[Resampler];
+#endif
+    return HrtfMixers_C[Resampler];
 }
 
 
@@ -28,6 +28,7 @@ LOCAL_SRC_FILES :=\
               Alc/alcConfig.c \
               Alc/alcDedicated.c \
               Alc/alcEcho.c \
+              Alc/alcMixAhead.c \
               Alc/alcModulator.c \
               Alc/alcReverb.c \
               Alc/alcRing.c \
@@ -28,6 +28,11 @@ AL_API ALvoid AL_APIENTRY alProcessUpdatesSOFT(void);
 #endif
 #endif
 
+#ifndef ALC_SOFTX_xrun_count
+#define ALC_SOFTX_xrun_count 1
+#define ALC_XRUN_COUNT_SOFTX                     0x19F0
+#endif
+
 
 #if defined(HAVE_STDINT_H)
 #include <stdint.h>
@@ -134,6 +139,8 @@ static __inline RefCount IncrementRef(volatile RefCount *ptr)
 { return __sync_add_and_fetch(ptr, 1); }
 static __inline RefCount DecrementRef(volatile RefCount *ptr)
 { return __sync_sub_and_fetch(ptr, 1); }
+static __inline RefCount ReadRef(volatile RefCount *ptr)
+{ return __sync_fetch_and_add(ptr, 0); }
 
 static __inline int ExchangeInt(volatile int *ptr, int newval)
 {
@@ -169,6 +176,8 @@ static __inline RefCount IncrementRef(volatile RefCount *ptr)
 { return xaddl(ptr, 1)+1; }
 static __inline RefCount DecrementRef(volatile RefCount *ptr)
 { return xaddl(ptr, -1)-1; }
+static __inline RefCount ReadRef(volatile RefCount *ptr)
+{ RefCount ret = *ptr; __asm__ __volatile__("" ::: "memory"); return ret; }
 
 static __inline int ExchangeInt(volatile int *dest, int newval)
 {
@@ -229,6 +238,8 @@ static __inline RefCount IncrementRef(volatile RefCount *ptr)
 { return InterlockedIncrement(ptr); }
 static __inline RefCount DecrementRef(volatile RefCount *ptr)
 { return InterlockedDecrement(ptr); }
+static __inline RefCount ReadRef(volatile RefCount *ptr)
+{ RefCount ret = *ptr; MemoryBarrier(); return ret; }
 
 extern ALbyte LONG_size_does_not_match_int[(sizeof(LONG)==sizeof(int))?1:-1];
 
@@ -266,6 +277,8 @@ static __inline RefCount IncrementRef(volatile RefCount *ptr)
 { return OSAtomicIncrement32Barrier(ptr); }
 static __inline RefCount DecrementRef(volatile RefCount *ptr)
 { return OSAtomicDecrement32Barrier(ptr); }
+static __inline RefCount ReadRef(volatile RefCount *ptr)
+{ RefCount ret = *ptr; OSMemoryBarrier(); return ret; }
 
 static __inline int ExchangeInt(volatile int *ptr, int newval)
 {
@@ -534,6 +547,10 @@ struct ALCdevice_struct
     ALCboolean Connected;
     enum DeviceType Type;
 
+    // Number of periods the backend had to play silence for, because the
+    // mixer didn't have one ready in time
+    volatile RefCount XrunCount;
+
     CRITICAL_SECTION Mutex;
 
     ALuint       Frequency;
@@ -574,8 +591,8 @@ struct ALCdevice_struct
     // Device flags
     ALuint       Flags;
 
-    // Dry path buffer mix
-    ALfloat DryBuffer[BUFFERSIZE][MAXCHANNELS];
+    // Dry path buffer mix, one plane per output channel
+    ALfloat DryBuffer[MAXCHANNELS][BUFFERSIZE];
 
     enum Channel DevChannels[MAXCHANNELS];
 
@@ -651,6 +668,14 @@ struct ALCcontext_struct
     volatile ALfloat flSpeedOfSound;
     volatile ALenum  DeferUpdates;
 
+    /* Serializes property calls on the context's sources. Only taken by the
+     * API, never by the mixer, and always before the device lock. The mixer
+     * returns used property records to FreeSourceProps, which the API moves
+     * over to SpareSourceProps in one go when it runs out. */
+    CRITICAL_SECTION PropLock;
+    struct ALsourceProps *volatile FreeSourceProps;
+    struct ALsourceProps *SpareSourceProps;
+
     struct ALsource **ActiveSources;
     ALsizei           ActiveSourceCount;
     ALsizei           MaxActiveSources;
@@ -688,6 +713,11 @@ static __inline void LockContext(ALCcontext *context)
 static __inline void UnlockContext(ALCcontext *context)
 { UnlockDevice(context->Device); }
 
+static __inline void LockProps(ALCcontext *context)
+{ EnterCriticalSection(&context->PropLock); }
+static __inline void UnlockProps(ALCcontext *context)
+{ LeaveCriticalSection(&context->PropLock); }
+
 
 ALvoid *StartThread(ALuint (*func)(ALvoid*), ALvoid *ptr);
 ALuint StopThread(ALvoid *thread);
@@ -699,6 +729,11 @@ ALsizei RingBufferSize(RingBuffer *ring);
 void WriteRingBuffer(RingBuffer *ring, const ALubyte *data, ALsizei len);
 void ReadRingBuffer(RingBuffer *ring, ALubyte *data, ALsizei len);
 
+typedef struct MixAhead MixAhead;
+MixAhead *StartMixAhead(ALCdevice *device, ALuint numPeriods);
+void StopMixAhead(MixAhead *mix);
+ALCboolean ReadMixAhead(MixAhead *mix, ALvoid *buffer);
+
 void ReadALConfig(void);
 void FreeALConfig(void);
 int ConfigValueExists(const char *blockName, const char *keyName);
@@ -724,7 +759,7 @@ void InitHrtf(void);
 void FreeHrtf(void);
 const struct Hrtf *GetHrtf(ALCdevice *device);
 ALfloat CalcHrtfDelta(ALfloat oldGain, ALfloat newGain, const ALfloat olddir[3], const ALfloat newdir[3]);
-void GetLerpedHrtfCoeffs(const struct Hrtf *Hrtf, ALfloat elevation, ALfloat azimuth, ALfloat gain, ALfloat (*coeffs)[2], ALuint *delays);
+void GetHrtfCoeffs(const struct Hrtf *Hrtf, ALfloat elevation, ALfloat azimuth, ALfloat gain, ALfloat (*coeffs)[2], ALuint *delays);
 ALuint GetMovingHrtfCoeffs(const struct Hrtf *Hrtf, ALfloat elevation, ALfloat azimuth, ALfloat gain, ALfloat delta, ALint counter, ALfloat (*coeffs)[2], ALuint *delays, ALfloat (*coeffStep)[2], ALint *delayStep);
 
 void al_print(const char *func, const char *fmt, ...) PRINTF_STYLE(2,3);
@@ -740,6 +775,15 @@ enum LogLevel {
 };
 extern enum LogLevel LogLevel;
 
+/* SIMD extensions the mixer may use, filled in by FillCPUCaps() */
+enum {
+    CPU_CAP_SSE  = 1<<0,
+    CPU_CAP_NEON = 1<<1,
+};
+extern ALuint CPUCapFlags;
+
+void FillCPUCaps(ALuint capfilter);
+
 #define TRACEREF(...) do {                                                    \
     if(LogLevel >= LogRef)                                                    \
         AL_PRINT(__VA_ARGS__);                                                \
@@ -28,6 +28,50 @@ typedef struct ALbufferlistitem
     struct ALbufferlistitem *prev;
 } ALbufferlistitem;
 
+/* A copy of the source properties the mixer works from. Property calls fill
+ * in a fresh one and hand it over through the source's NewProps pointer, so
+ * they never have to wait for the mixer to let go of the device lock. Spare
+ * ones are kept on the context's FreeSourceProps list. */
+typedef struct ALsourceProps
+{
+    ALfloat   Pitch;
+    ALfloat   Gain;
+    ALfloat   OuterGain;
+    ALfloat   MinGain;
+    ALfloat   MaxGain;
+    ALfloat   InnerAngle;
+    ALfloat   OuterAngle;
+    ALfloat   RefDistance;
+    ALfloat   MaxDistance;
+    ALfloat   RollOffFactor;
+    ALfloat   Position[3];
+    ALfloat   Velocity[3];
+    ALfloat   Orientation[3];
+    ALboolean HeadRelative;
+    enum DistanceModel DistanceModel;
+    ALboolean DirectChannels;
+
+    ALfloat DirectGain;
+    ALfloat DirectGainHF;
+
+    struct {
+        struct ALeffectslot *Slot;
+        ALfloat WetGain;
+        ALfloat WetGainHF;
+    } Send[MAX_SENDS];
+
+    ALboolean DryGainHFAuto;
+    ALboolean WetGainAuto;
+    ALboolean WetGainHFAuto;
+    ALfloat   OuterGainHF;
+
+    ALfloat AirAbsorptionFactor;
+    ALfloat RoomRolloffFactor;
+    ALfloat DopplerFactor;
+
+    struct ALsourceProps *next;
+} ALsourceProps;
+
 typedef struct ALsource
 {
     volatile ALfloat   flPitch;
@@ -121,7 +165,10 @@ typedef struct ALsource
             ALfloat history[MAXCHANNELS];
         } Send[MAX_SENDS];
     } Params;
-    volatile ALenum NeedsUpdate;
+
+    /* Properties last taken by the mixer, and the newest ones waiting for it */
+    ALsourceProps Props;
+    ALsourceProps *volatile NewProps;
 
     ALvoid (*Update)(struct ALsource *self, const ALCcontext *context);
 
@@ -132,6 +179,7 @@ typedef struct ALsource
 
 ALvoid SetSourceState(ALsource *Source, ALCcontext *Context, ALenum state);
 ALboolean ApplyOffset(ALsource *Source);
+ALboolean ApplySourceProps(ALsource *Source, ALCcontext *Context);
 
 ALvoid ReleaseALSources(ALCcontext *Context);
 
@@ -437,7 +437,7 @@ static ALvoid NoneUpdate(ALeffectState *State, ALCdevice *Device, const ALeffect
     (void)Device;
     (void)Slot;
 }
-static ALvoid NoneProcess(ALeffectState *State, ALuint SamplesToDo, const ALfloat *SamplesIn, ALfloat (*SamplesOut)[MAXCHANNELS])
+static ALvoid NoneProcess(ALeffectState *State, ALuint SamplesToDo, const ALfloat *SamplesIn, ALfloat (*SamplesOut)[BUFFERSIZE])
 {
     (void)State;
     (void)SamplesToDo;
@@ -506,8 +506,11 @@ ALenum InitializeEffect(ALCdevice *Device, ALeffectslot *EffectSlot, ALeffect *e
     ALenum newtype = (effect ? effect->type : AL_EFFECT_NULL);
     ALeffectState *State = NULL;
     ALenum err = AL_NO_ERROR;
+    ALuint frequency;
 
-    LockDevice(Device);
+    /* Create and size the new state before taking the device lock, since
+     * allocating a reverb's delay lines can take a while and the mixer would
+     * be stuck waiting on it. Only the swap needs the lock. */
     if(newtype == AL_EFFECT_NULL && EffectSlot->effect.type != AL_EFFECT_NULL)
     {
         State = NoneCreate();
@@ -541,20 +544,28 @@ ALenum InitializeEffect(ALCdevice *Device, ALeffectslot *EffectSlot, ALeffect *e
     }
 
     if(err != AL_NO_ERROR)
-    {
-        UnlockDevice(Device);
         return err;
-    }
 
     if(State)
     {
         int oldMode;
         oldMode = SetMixerFPUMode();
 
+        frequency = Device->Frequency;
         if(ALeffectState_DeviceUpdate(State, Device) == AL_FALSE)
         {
             RestoreFPUMode(oldMode);
+            ALeffectState_Destroy(State);
+            return AL_OUT_OF_MEMORY;
+        }
+
+        LockDevice(Device);
+        /* The device may have been reset in the meantime */
+        if(Device->Frequency != frequency &&
+           ALeffectState_DeviceUpdate(State, Device) == AL_FALSE)
+        {
             UnlockDevice(Device);
+            RestoreFPUMode(oldMode);
             ALeffectState_Destroy(State);
             return AL_OUT_OF_MEMORY;
         }
@@ -578,6 +589,7 @@ ALenum InitializeEffect(ALCdevice *Device, ALeffectslot *EffectSlot, ALeffect *e
     }
     else
     {
+        LockDevice(Device);
         if(!effect)
             memset(&EffectSlot->effect, 0, sizeof(EffectSlot->effect));
         else
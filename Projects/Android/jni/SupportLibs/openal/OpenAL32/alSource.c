@@ -47,6 +47,7 @@ const ALsizei ResamplerPrePadding[ResamplerMax] = {
 
 
 static ALvoid InitSourceParams(ALsource *Source);
+static ALvoid UpdateSourceProps(ALsource *Source, ALCcontext *Context);
 static ALvoid GetSourceOffset(ALsource *Source, ALenum eName, ALdouble *Offsets, ALdouble updateLen);
 static ALint GetSampleOffset(ALsource *Source);
 
@@ -77,6 +78,9 @@ AL_API ALvoid AL_APIENTRY alGenSources(ALsizei n,ALuint *sources)
                 break;
             }
             InitSourceParams(source);
+            LockProps(Context);
+            UpdateSourceProps(source, Context);
+            UnlockProps(Context);
 
             err = NewThunkEntry(&source->source);
             if(err == AL_NO_ERROR)
@@ -84,6 +88,7 @@ AL_API ALvoid AL_APIENTRY alGenSources(ALsizei n,ALuint *sources)
             if(err != AL_NO_ERROR)
             {
                 FreeThunkEntry(source->source);
+                free(source->NewProps);
                 memset(source, 0, sizeof(ALsource));
                 free(source);
 
@@ -168,6 +173,7 @@ AL_API ALvoid AL_APIENTRY alDeleteSources(ALsizei n, const ALuint *sources)
                     DecrementRef(&Source->Send[j].Slot->ref);
                 Source->Send[j].Slot = NULL;
             }
+            free(Source->NewProps);
 
             memset(Source,0,sizeof(ALsource));
             free(Source);
@@ -204,13 +210,14 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
 
     if((Source=LookupSource(pContext, source)) != NULL)
     {
+        LockProps(pContext);
         switch(eParam)
         {
             case AL_PITCH:
                 if(flValue >= 0.0f)
                 {
                     Source->flPitch = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -220,7 +227,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f && flValue <= 360.0f)
                 {
                     Source->flInnerAngle = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -230,7 +237,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f && flValue <= 360.0f)
                 {
                     Source->flOuterAngle = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -240,7 +247,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f)
                 {
                     Source->flGain = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -250,7 +257,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f)
                 {
                     Source->flMaxDistance = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -260,7 +267,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f)
                 {
                     Source->flRollOffFactor = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -270,7 +277,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f)
                 {
                     Source->flRefDistance = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -280,7 +287,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f && flValue <= 1.0f)
                 {
                     Source->flMinGain = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -290,7 +297,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f && flValue <= 1.0f)
                 {
                     Source->flMaxGain = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -300,7 +307,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f && flValue <= 1.0f)
                 {
                     Source->flOuterGain = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -310,7 +317,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f && flValue <= 1.0f)
                 {
                     Source->OuterGainHF = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -320,7 +327,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f && flValue <= 10.0f)
                 {
                     Source->AirAbsorptionFactor = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -330,7 +337,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f && flValue <= 10.0f)
                 {
                     Source->RoomRolloffFactor = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -340,7 +347,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 if(flValue >= 0.0f && flValue <= 1.0f)
                 {
                     Source->DopplerFactor = flValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -376,6 +383,7 @@ AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValu
                 alSetError(pContext, AL_INVALID_ENUM);
                 break;
         }
+        UnlockProps(pContext);
     }
     else
     {
@@ -397,17 +405,16 @@ AL_API ALvoid AL_APIENTRY alSource3f(ALuint source, ALenum eParam, ALfloat flVal
 
     if((Source=LookupSource(pContext, source)) != NULL)
     {
+        LockProps(pContext);
         switch(eParam)
         {
             case AL_POSITION:
                 if(isfinite(flValue1) && isfinite(flValue2) && isfinite(flValue3))
                 {
-                    LockContext(pContext);
                     Source->vPosition[0] = flValue1;
                     Source->vPosition[1] = flValue2;
                     Source->vPosition[2] = flValue3;
-                    UnlockContext(pContext);
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -416,12 +423,10 @@ AL_API ALvoid AL_APIENTRY alSource3f(ALuint source, ALenum eParam, ALfloat flVal
             case AL_VELOCITY:
                 if(isfinite(flValue1) && isfinite(flValue2) && isfinite(flValue3))
                 {
-                    LockContext(pContext);
                     Source->vVelocity[0] = flValue1;
                     Source->vVelocity[1] = flValue2;
                     Source->vVelocity[2] = flValue3;
-                    UnlockContext(pContext);
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -430,12 +435,10 @@ AL_API ALvoid AL_APIENTRY alSource3f(ALuint source, ALenum eParam, ALfloat flVal
             case AL_DIRECTION:
                 if(isfinite(flValue1) && isfinite(flValue2) && isfinite(flValue3))
                 {
-                    LockContext(pContext);
                     Source->vOrientation[0] = flValue1;
                     Source->vOrientation[1] = flValue2;
                     Source->vOrientation[2] = flValue3;
-                    UnlockContext(pContext);
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -445,6 +448,7 @@ AL_API ALvoid AL_APIENTRY alSource3f(ALuint source, ALenum eParam, ALfloat flVal
                 alSetError(pContext, AL_INVALID_ENUM);
                 break;
         }
+        UnlockProps(pContext);
     }
     else
         alSetError(pContext, AL_INVALID_NAME);
@@ -536,13 +540,14 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
     {
         ALCdevice *device = pContext->Device;
 
+        LockProps(pContext);
         switch(eParam)
         {
             case AL_SOURCE_RELATIVE:
                 if(lValue == AL_FALSE || lValue == AL_TRUE)
                 {
                     Source->bHeadRelative = (ALboolean)lValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -592,7 +597,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                                 Source->Update = CalcSourceParams;
                             else
                                 Source->Update = CalcNonAttnSourceParams;
-                            Source->NeedsUpdate = AL_TRUE;
+                            UpdateSourceProps(Source, pContext);
                         }
                         else
                         {
@@ -656,7 +661,6 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
 
                 if(lValue == 0 || (filter=LookupFilter(pContext->Device, lValue)) != NULL)
                 {
-                    LockContext(pContext);
                     if(!filter)
                     {
                         Source->DirectGain = 1.0f;
@@ -667,8 +671,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                         Source->DirectGain = filter->Gain;
                         Source->DirectGainHF = filter->GainHF;
                     }
-                    UnlockContext(pContext);
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -678,7 +681,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                 if(lValue == AL_TRUE || lValue == AL_FALSE)
                 {
                     Source->DryGainHFAuto = lValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -688,7 +691,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                 if(lValue == AL_TRUE || lValue == AL_FALSE)
                 {
                     Source->WetGainAuto = lValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -698,7 +701,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                 if(lValue == AL_TRUE || lValue == AL_FALSE)
                 {
                     Source->WetGainHFAuto = lValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -708,7 +711,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                 if(lValue == AL_TRUE || lValue == AL_FALSE)
                 {
                     Source->DirectChannels = lValue;
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -725,7 +728,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                 {
                     Source->DistanceModel = lValue;
                     if(pContext->SourceDistanceModel)
-                        Source->NeedsUpdate = AL_TRUE;
+                        UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -735,6 +738,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                 alSetError(pContext, AL_INVALID_ENUM);
                 break;
         }
+        UnlockProps(pContext);
     }
     else
         alSetError(pContext, AL_INVALID_NAME);
@@ -764,6 +768,7 @@ AL_API void AL_APIENTRY alSource3i(ALuint source, ALenum eParam, ALint lValue1,
     {
         ALCdevice *device = pContext->Device;
 
+        LockProps(pContext);
         switch(eParam)
         {
             case AL_AUXILIARY_SEND_FILTER: {
@@ -792,7 +797,7 @@ AL_API void AL_APIENTRY alSource3i(ALuint source, ALenum eParam, ALint lValue1,
                         Source->Send[lValue2].WetGain = ALFilter->Gain;
                         Source->Send[lValue2].WetGainHF = ALFilter->GainHF;
                     }
-                    Source->NeedsUpdate = AL_TRUE;
+                    UpdateSourceProps(Source, pContext);
                 }
                 else
                     alSetError(pContext, AL_INVALID_VALUE);
@@ -803,6 +808,7 @@ AL_API void AL_APIENTRY alSource3i(ALuint source, ALenum eParam, ALint lValue1,
                 alSetError(pContext, AL_INVALID_ENUM);
                 break;
         }
+        UnlockProps(pContext);
     }
     else
         alSetError(pContext, AL_INVALID_NAME);
@@ -986,27 +992,27 @@ AL_API ALvoid AL_APIENTRY alGetSource3f(ALuint source, ALenum eParam, ALfloat* p
             switch(eParam)
             {
                 case AL_POSITION:
-                    LockContext(pContext);
+                    LockProps(pContext);
                     *pflValue1 = Source->vPosition[0];
                     *pflValue2 = Source->vPosition[1];
                     *pflValue3 = Source->vPosition[2];
-                    UnlockContext(pContext);
+                    UnlockProps(pContext);
                     break;
 
                 case AL_VELOCITY:
-                    LockContext(pContext);
+                    LockProps(pContext);
                     *pflValue1 = Source->vVelocity[0];
                     *pflValue2 = Source->vVelocity[1];
                     *pflValue3 = Source->vVelocity[2];
-                    UnlockContext(pContext);
+                    UnlockProps(pContext);
                     break;
 
                 case AL_DIRECTION:
-                    LockContext(pContext);
+                    LockProps(pContext);
                     *pflValue1 = Source->vOrientation[0];
                     *pflValue2 = Source->vOrientation[1];
                     *pflValue3 = Source->vOrientation[2];
-                    UnlockContext(pContext);
+                    UnlockProps(pContext);
                     break;
 
                 default:
@@ -1247,27 +1253,27 @@ AL_API void AL_APIENTRY alGetSource3i(ALuint source, ALenum eParam, ALint* plVal
             switch(eParam)
             {
                 case AL_POSITION:
-                    LockContext(pContext);
+                    LockProps(pContext);
                     *plValue1 = (ALint)Source->vPosition[0];
                     *plValue2 = (ALint)Source->vPosition[1];
                     *plValue3 = (ALint)Source->vPosition[2];
-                    UnlockContext(pContext);
+                    UnlockProps(pContext);
                     break;
 
                 case AL_VELOCITY:
-                    LockContext(pContext);
+                    LockProps(pContext);
                     *plValue1 = (ALint)Source->vVelocity[0];
                     *plValue2 = (ALint)Source->vVelocity[1];
                     *plValue3 = (ALint)Source->vVelocity[2];
-                    UnlockContext(pContext);
+                    UnlockProps(pContext);
                     break;
 
                 case AL_DIRECTION:
-                    LockContext(pContext);
+                    LockProps(pContext);
                     *plValue1 = (ALint)Source->vOrientation[0];
                     *plValue2 = (ALint)Source->vOrientation[1];
                     *plValue3 = (ALint)Source->vOrientation[2];
-                    UnlockContext(pContext);
+                    UnlockProps(pContext);
                     break;
 
                 default:
@@ -1605,11 +1611,13 @@ AL_API ALvoid AL_APIENTRY alSourceQueueBuffers(ALuint source, ALsizei n, const A
         goto error;
     }
 
+    LockProps(Context);
     LockContext(Context);
     // Check that this is not a STATIC Source
     if(Source->lSourceType == AL_STATIC)
     {
         UnlockContext(Context);
+        UnlockProps(Context);
         // Invalid Source Type (can't queue on a Static Source)
         alSetError(Context, AL_INVALID_OPERATION);
         goto error;
@@ -1637,6 +1645,7 @@ AL_API ALvoid AL_APIENTRY alSourceQueueBuffers(ALuint source, ALsizei n, const A
         if(buffers[i] && (buffer=LookupBuffer(device, buffers[i])) == NULL)
         {
             UnlockContext(Context);
+            UnlockProps(Context);
             alSetError(Context, AL_INVALID_NAME);
             goto error;
         }
@@ -1673,7 +1682,7 @@ AL_API ALvoid AL_APIENTRY alSourceQueueBuffers(ALuint source, ALsizei n, const A
             else
                 Source->Update = CalcNonAttnSourceParams;
 
-            Source->NeedsUpdate = AL_TRUE;
+            UpdateSourceProps(Source, Context);
         }
         else if(BufferFmt->Frequency != buffer->Frequency ||
                 BufferFmt->OriginalChannels != buffer->OriginalChannels ||
@@ -1681,6 +1690,7 @@ AL_API ALvoid AL_APIENTRY alSourceQueueBuffers(ALuint source, ALsizei n, const A
         {
             ReadUnlock(&buffer->lock);
             UnlockContext(Context);
+            UnlockProps(Context);
             alSetError(Context, AL_INVALID_OPERATION);
             goto error;
         }
@@ -1707,6 +1717,7 @@ AL_API ALvoid AL_APIENTRY alSourceQueueBuffers(ALuint source, ALsizei n, const A
     Source->BuffersInQueue += n;
 
     UnlockContext(Context);
+    UnlockProps(Context);
     ALCcontext_DecRef(Context);
     return;
 
@@ -1841,13 +1852,117 @@ static ALvoid InitSourceParams(ALsource *Source)
         Source->Send[i].WetGainHF = 1.0f;
     }
 
-    Source->NeedsUpdate = AL_TRUE;
-
     Source->HrtfMoving = AL_FALSE;
     Source->HrtfCounter = 0;
 }
 
 
+/*
+ * UpdateSourceProps
+ *
+ * Hands the source's current properties to the mixer. Must be called with
+ * the context's property lock held. The mixer never waits on that lock; it
+ * picks up the latest record with ApplySourceProps the next time it mixes the
+ * source.
+ */
+static ALvoid UpdateSourceProps(ALsource *Source, ALCcontext *Context)
+{
+    ALsourceProps *props, *old;
+    ALuint i;
+
+    /* Reuse a record the mixer is done with, if there is one */
+    if(!Context->SpareSourceProps)
+        Context->SpareSourceProps = ExchangePtr((XchgPtr*)&Context->FreeSourceProps, NULL);
+    props = Context->SpareSourceProps;
+    if(props)
+        Context->SpareSourceProps = props->next;
+    else
+    {
+        props = malloc(sizeof(*props));
+        if(!props)
+        {
+            ERR("Failed to allocate source properties\n");
+            return;
+        }
+    }
+
+    props->Pitch = Source->flPitch;
+    props->Gain = Source->flGain;
+    props->OuterGain = Source->flOuterGain;
+    props->MinGain = Source->flMinGain;
+    props->MaxGain = Source->flMaxGain;
+    props->InnerAngle = Source->flInnerAngle;
+    props->OuterAngle = Source->flOuterAngle;
+    props->RefDistance = Source->flRefDistance;
+    props->MaxDistance = Source->flMaxDistance;
+    props->RollOffFactor = Source->flRollOffFactor;
+    for(i = 0;i < 3;i++)
+    {
+        props->Position[i] = Source->vPosition[i];
+        props->Velocity[i] = Source->vVelocity[i];
+        props->Orientation[i] = Source->vOrientation[i];
+    }
+    props->HeadRelative = Source->bHeadRelative;
+    props->DistanceModel = Source->DistanceModel;
+    props->DirectChannels = Source->DirectChannels;
+
+    props->DirectGain = Source->DirectGain;
+    props->DirectGainHF = Source->DirectGainHF;
+    for(i = 0;i < MAX_SENDS;i++)
+    {
+        props->Send[i].Slot = Source->Send[i].Slot;
+        props->Send[i].WetGain = Source->Send[i].WetGain;
+        props->Send[i].WetGainHF = Source->Send[i].WetGainHF;
+    }
+
+    props->DryGainHFAuto = Source->DryGainHFAuto;
+    props->WetGainAuto = Source->WetGainAuto;
+    props->WetGainHFAuto = Source->WetGainHFAuto;
+    props->OuterGainHF = Source->OuterGainHF;
+
+    props->AirAbsorptionFactor = Source->AirAbsorptionFactor;
+    props->RoomRolloffFactor = Source->RoomRolloffFactor;
+    props->DopplerFactor = Source->DopplerFactor;
+
+    /* Swap in the new record with a full barrier, so the mixer sees it filled
+     * in. A record it hadn't gotten to yet can be reused right away. */
+    do {
+        old = Source->NewProps;
+    } while(!CompExchangePtr((XchgPtr*)&Source->NewProps, old, props));
+    if(old)
+    {
+        old->next = Context->SpareSourceProps;
+        Context->SpareSourceProps = old;
+    }
+}
+
+/*
+ * ApplySourceProps
+ *
+ * Copies the latest properties given to the source into Source->Props, for
+ * the mixer to calculate its parameters from. Called with the device lock
+ * held, but never waits on the property lock. Returns AL_TRUE if there was
+ * anything new.
+ */
+ALboolean ApplySourceProps(ALsource *Source, ALCcontext *Context)
+{
+    ALsourceProps *props;
+
+    props = ExchangePtr((XchgPtr*)&Source->NewProps, NULL);
+    if(!props)
+        return AL_FALSE;
+
+    Source->Props = *props;
+    Source->Props.next = NULL;
+
+    do {
+        props->next = Context->FreeSourceProps;
+    } while(!CompExchangePtr((XchgPtr*)&Context->FreeSourceProps,
+                             props->next, props));
+    return AL_TRUE;
+}
+
+
 /*
  * SetSourceState
  *
@@ -2208,6 +2323,7 @@ ALvoid ReleaseALSources(ALCcontext *Context)
                 DecrementRef(&temp->Send[j].Slot->ref);
             temp->Send[j].Slot = NULL;
         }
+        free(temp->NewProps);
 
         // Release source structure
         FreeThunkEntry(temp->source);
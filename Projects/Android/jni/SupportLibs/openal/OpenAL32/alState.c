@@ -606,7 +606,7 @@ AL_API ALvoid AL_APIENTRY alDeferUpdatesSOFT(void)
                 continue;
             }
 
-            if(ExchangeInt(&(*src)->NeedsUpdate, AL_FALSE) || UpdateSources)
+            if(ApplySourceProps(*src, Context) || UpdateSources)
                 ALsource_Update(*src, Context);
 
             src++;
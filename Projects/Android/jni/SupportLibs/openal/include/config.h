@@ -47,6 +47,12 @@
 /* Define if we have fenv.h */
 #define HAVE_FENV_H
 
+/* Define if we have arm_neon.h */
+#define HAVE_ARM_NEON_H
+
+/* Define if we have xmmintrin.h */
+#define HAVE_XMMINTRIN_H
+
 /* Define if we have pthread_setschedparam() */
 #define HAVE_PTHREAD_SETSCHEDPARAM
 
@@ -0,0 +1,188 @@
+/*
+ * OpenAL HRTF Resampling Test
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Checks the HRTF filters GetHrtf builds from the built-in data set, with
+ * Alc/hrtf.c compiled in and the rest of the library stubbed out:
+ *  - at the data set's own rate, the coefficients and delays are the stored
+ *    ones, with the right ear taken from the mirrored azimuth,
+ *  - at other rates, the magnitude response of every measured direction
+ *    stays close to the one at 44.1khz over the band both rates can carry,
+ *    leaving out notches deeper than NOTCH_DB below the peak, and the
+ *    delays are scaled to the new rate, plus HRIR_LEAD going down,
+ *  - a rate is built once and then reused.
+ * Prints the largest deviation found for each rate, and exits 1 if a check
+ * fails. */
+
+#include "../Alc/hrtf.c"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+/* the parts of the library hrtf.c refers to */
+enum LogLevel LogLevel = NoLog;
+void al_print(const char *func, const char *fmt, ...)
+{
+    (void)func;
+    (void)fmt;
+}
+int ConfigValueStr(const char *blockName, const char *keyName, const char **ret)
+{
+    (void)blockName;
+    (void)keyName;
+    (void)ret;
+    return 0;
+}
+const ALCchar *DevFmtChannelsString(enum DevFmtChannels chans)
+{
+    (void)chans;
+    return "";
+}
+
+/* Deepest notch still compared, below the peak of a response */
+#define NOTCH_DB 20.0
+
+/* Going up, the filters stay HRIR_LENGTH long and lose the end of the tail,
+ * which is what the larger deviation at 48khz comes from. */
+static const struct {
+    ALuint rate;
+    ALdouble band;      /* highest frequency compared */
+    ALdouble max_dev;   /* largest deviation allowed, in dB */
+} rates[] = {
+    { 48000, 16000.0, 6.0 },
+    { 32000, 12000.0, 1.0 },
+    { 22050,  9000.0, 1.0 },
+};
+
+static int failed = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAILED");
+    if(!ok)
+        failed = 1;
+}
+
+static ALdouble magnitude_db(const ALfloat (*coeffs)[2], ALuint ear, ALuint rate, ALdouble freq)
+{
+    ALdouble re = 0.0, im = 0.0;
+    ALuint i;
+
+    for(i = 0;i < HRIR_LENGTH;i++)
+    {
+        re += coeffs[i][ear] * cos(2.0*M_PI * freq * i / rate);
+        im -= coeffs[i][ear] * sin(2.0*M_PI * freq * i / rate);
+    }
+    return 10.0 * log10(re*re + im*im + 1e-30);
+}
+
+static const struct Hrtf *hrtf_at(ALuint rate)
+{
+    static ALCdevice device;
+
+    device.FmtChans = DevFmtStereo;
+    device.Frequency = rate;
+    return GetHrtf(&device);
+}
+
+static void same_rate(void)
+{
+    const struct Hrtf *hrtf = hrtf_at(44100);
+    ALdouble maxerr = 0.0;
+    ALuint ev, az, i, c;
+    int delays_ok = 1;
+    char what[80];
+
+    for(ev = 0;ev < ELEV_COUNT;ev++)
+    {
+        for(az = 0;az < azCount[ev];az++)
+        {
+            ALuint lidx = evOffset[ev] + az;
+            ALuint ridx = evOffset[ev] + ((azCount[ev]-az) % azCount[ev]);
+
+            for(c = 0;c < HRIR_LENGTH;c++)
+            {
+                maxerr = fmax(maxerr, fabs(hrtf->coeffs[lidx][c][0] -
+                                           DefaultHrtf.coeffs[lidx][c]/32767.0));
+                maxerr = fmax(maxerr, fabs(hrtf->coeffs[lidx][c][1] -
+                                           DefaultHrtf.coeffs[ridx][c]/32767.0));
+            }
+            if(hrtf->delays[lidx][0] != DefaultHrtf.delays[lidx] ||
+               hrtf->delays[lidx][1] != DefaultHrtf.delays[ridx])
+                delays_ok = 0;
+        }
+    }
+    sprintf(what, "44100hz: stored coefficients, max error %.1e", maxerr);
+    check(maxerr <= 2e-7, what);
+    check(delays_ok, "44100hz: stored delays, right ear mirrored");
+
+    for(i = 0;i < sizeof(rates)/sizeof(rates[0]);i++)
+        hrtf_at(rates[i].rate);
+    check(hrtf_at(44100) == hrtf, "44100hz: built once and reused");
+}
+
+static void other_rate(ALuint rate, ALdouble band, ALdouble max_dev)
+{
+    const struct Hrtf *ref = hrtf_at(44100);
+    const struct Hrtf *hrtf = hrtf_at(rate);
+    const ALfloat maxDelay = SRC_HISTORY_LENGTH-1;
+    const ALuint lead = (rate < 44100) ? HRIR_LEAD : 0;
+    ALdouble maxdev = 0.0, maxdelay = 0.0, freq;
+    ALuint i, ear;
+    char what[80];
+
+    for(i = 0;i < HRIR_COUNT;i++)
+    {
+        for(ear = 0;ear < 2;ear++)
+        {
+            ALdouble peak = -1e30, want, got;
+
+            for(freq = 0.0;freq <= band;freq += 100.0)
+                peak = fmax(peak, magnitude_db(ref->coeffs[i], ear, 44100, freq));
+            for(freq = 0.0;freq <= band;freq += 100.0)
+            {
+                want = magnitude_db(ref->coeffs[i], ear, 44100, freq);
+                if(want < peak - NOTCH_DB)
+                    continue;
+                got = magnitude_db(hrtf->coeffs[i], ear, rate, freq);
+                maxdev = fmax(maxdev, fabs(got - want));
+            }
+            maxdelay = fmax(maxdelay, fabs(hrtf->delays[i][ear] -
+                            fmin(ref->delays[i][ear] * rate / 44100.0 + lead, maxDelay)));
+        }
+    }
+    sprintf(what, "%uhz: response to %.0fhz within %.2fdB", rate, band, maxdev);
+    check(maxdev <= max_dev, what);
+    sprintf(what, "%uhz: delays scaled, max error %.1e", rate, maxdelay);
+    check(maxdelay <= 1e-4, what);
+}
+
+int main(void)
+{
+    ALuint i;
+
+    same_rate();
+    for(i = 0;i < sizeof(rates)/sizeof(rates[0]);i++)
+        other_rate(rates[i].rate, rates[i].band, rates[i].max_dev);
+
+    FreeHrtf();
+    return failed;
+}
@@ -0,0 +1,300 @@
+/*
+ * OpenAL Mix-Ahead Test
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Tests the mixer thread that feeds the OpenSL buffer queue, through the wave
+ * writer's mix-ahead option, which pulls periods from the same ring. Each run
+ * is a child process with its own ALSOFT_CONF, since the config is only read
+ * once. It checks that
+ *  - mixing ahead writes the same samples as mixing in the writer thread,
+ *    once both are lined up on the first sound,
+ *  - neither run reports an xrun through ALC_XRUN_COUNT_SOFTX, and
+ *  - a mixer that can't keep up does.
+ * The wave writer runs in real time, so this takes a few seconds. Exits 1 if
+ * a check fails. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "AL/alc.h"
+#include "AL/al.h"
+#include "AL/alext.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BUFFER_RATE 22050
+#define FREQUENCY 44100
+
+/* Compared once lined up, out of a bit more than that played */
+#define COMPARE_FRAMES FREQUENCY
+
+typedef struct {
+    const char *name;
+    ALCint sources, period_size, periods;
+    ALCboolean mix_ahead;
+    ALCuint play_ms;
+} TestRun;
+
+static char tmpdir[64];
+
+static void run_path(char *path, const TestRun *run, const char *ext)
+{
+    sprintf(path, "%s/%s.%s", tmpdir, run->name, ext);
+}
+
+/* In the child: plays the sources into the wave file and returns the number
+ * of xruns, or -1 */
+static int play(const TestRun *run)
+{
+    ALCdevice *device;
+    ALCcontext *context;
+    ALCenum xrun_count;
+    ALCint xruns = -1;
+    ALuint buffer, *sources;
+    ALshort *data;
+    char conf[96], wave[96];
+    FILE *f;
+    int i;
+
+    run_path(conf, run, "conf");
+    run_path(wave, run, "wav");
+    if(!(f=fopen(conf, "w")))
+        return -1;
+    fprintf(f, "drivers = wave\nfrequency = %d\nchannels = stereo\n"
+               "sample-type = int16\nperiods = %d\nperiod_size = %d\n"
+               "sources = %d\nhrtf = false\n[wave]\nfile = %s\nmix-ahead = %s\n",
+            FREQUENCY, run->periods, run->period_size, run->sources, wave,
+            run->mix_ahead ? "true" : "false");
+    fclose(f);
+    setenv("ALSOFT_CONF", conf, 1);
+
+    device = alcOpenDevice(NULL);
+    if(!device)
+    {
+        printf("!!! Failed to open the wave writer !!!\n");
+        return -1;
+    }
+    if(!alcIsExtensionPresent(device, "ALC_SOFTX_xrun_count"))
+    {
+        printf("!!! ALC_SOFTX_xrun_count not supported !!!\n");
+        alcCloseDevice(device);
+        return -1;
+    }
+    xrun_count = alcGetEnumValue(device, "ALC_XRUN_COUNT_SOFTX");
+
+    context = alcCreateContext(device, NULL);
+    if(!context || alcMakeContextCurrent(context) == ALC_FALSE)
+    {
+        if(context)
+            alcDestroyContext(context);
+        alcCloseDevice(device);
+        printf("!!! Failed to set a context !!!\n");
+        return -1;
+    }
+
+    /* The decaying chirp of mixbench */
+    data = malloc(BUFFER_RATE * sizeof(ALshort));
+    for(i = 0;i < BUFFER_RATE;i++)
+    {
+        double t = (double)i / BUFFER_RATE;
+        data[i] = (ALshort)(16000.0 * exp(-2.0*t) *
+                            sin(2.0*M_PI * (220.0 + 440.0*t) * t));
+    }
+    alGenBuffers(1, &buffer);
+    alBufferData(buffer, AL_FORMAT_MONO16, data, BUFFER_RATE*sizeof(ALshort),
+                 BUFFER_RATE);
+    free(data);
+
+    sources = malloc(run->sources * sizeof(ALuint));
+    alGenSources(run->sources, sources);
+    if(alGetError() != AL_NO_ERROR)
+        printf("!!! Failed to create %d sources !!!\n", run->sources);
+    else
+    {
+        for(i = 0;i < run->sources;i++)
+        {
+            double angle = 2.0*M_PI * i / run->sources;
+
+            alSourcei(sources[i], AL_BUFFER, buffer);
+            alSourcei(sources[i], AL_LOOPING, AL_TRUE);
+            alSourcef(sources[i], AL_PITCH, 0.9f + 0.2f*i/run->sources);
+            alSourcef(sources[i], AL_GAIN, 1.0f/run->sources);
+            alSource3f(sources[i], AL_POSITION, (ALfloat)sin(angle), 0.0f,
+                       -(ALfloat)cos(angle));
+            alSourcei(sources[i], AL_SAMPLE_OFFSET, (i*997) % BUFFER_RATE);
+        }
+        /* alSourcePlayv holds the context lock, so every source starts in
+         * the same update */
+        alSourcePlayv(run->sources, sources);
+        usleep(run->play_ms * 1000);
+
+        alcGetIntegerv(device, xrun_count, 1, &xruns);
+        alSourceStopv(run->sources, sources);
+        alDeleteSources(run->sources, sources);
+    }
+    alDeleteBuffers(1, &buffer);
+    free(sources);
+
+    alcMakeContextCurrent(NULL);
+    alcDestroyContext(context);
+    alcCloseDevice(device);
+    return xruns;
+}
+
+/* Runs play() in a child, whose exit status carries the xruns, up to 254 */
+static int spawn(const TestRun *run)
+{
+    int status;
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+    if(pid == 0)
+    {
+        int xruns = play(run);
+        fflush(stdout);
+        _exit(xruns < 0 ? 255 : xruns > 254 ? 254 : xruns);
+    }
+    if(pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+       WEXITSTATUS(status) == 255)
+        return -1;
+    return WEXITSTATUS(status);
+}
+
+/* Reads the samples of a wave file the writer made, starting at the first
+ * one that isn't silent. Returns the number of frames. */
+static long read_sound(const TestRun *run, ALshort **samples)
+{
+    char path[96], id[4];
+    unsigned char len[4];
+    long size, frames, start;
+    FILE *f;
+
+    *samples = NULL;
+    run_path(path, run, "wav");
+    if(!(f=fopen(path, "rb")))
+        return 0;
+    fseek(f, 12, SEEK_SET);
+    while(fread(id, 1, 4, f) == 4 && fread(len, 1, 4, f) == 4 &&
+          memcmp(id, "data", 4) != 0)
+        fseek(f, len[0] | len[1]<<8 | len[2]<<16 | (long)len[3]<<24, SEEK_CUR);
+    start = ftell(f);
+    fseek(f, 0, SEEK_END);
+    size = ftell(f) - start;
+    fseek(f, start, SEEK_SET);
+
+    frames = size / (2*sizeof(ALshort));
+    *samples = malloc(frames*2*sizeof(ALshort) + 1);
+    frames = fread(*samples, 2*sizeof(ALshort), frames, f);
+    fclose(f);
+
+    for(start = 0;start < frames;start++)
+    {
+        if((*samples)[start*2] != 0 || (*samples)[start*2 + 1] != 0)
+            break;
+    }
+    memmove(*samples, *samples + start*2, (frames-start)*2*sizeof(ALshort));
+    return frames - start;
+}
+
+int main(void)
+{
+    static const TestRun runs[] = {
+        { "direct",    16, 1024, 4, AL_FALSE, 1500 },
+        { "mixahead",  16, 1024, 4, AL_TRUE,  1500 },
+        { "overload", 3000,  64, 4, AL_TRUE,  1000 },
+    };
+    int xruns[3], failed = 0, i;
+    ALshort *direct, *ahead;
+    long ndirect, nahead, diff = -1;
+    char path[96];
+
+    strcpy(tmpdir, "/tmp/mixaheadtestXXXXXX");
+    if(!mkdtemp(tmpdir))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    for(i = 0;i < 3;i++)
+    {
+        xruns[i] = spawn(&runs[i]);
+        printf("%-9s %4d sources, %d periods of %4d frames, %s: ",
+               runs[i].name, runs[i].sources, runs[i].periods,
+               runs[i].period_size, runs[i].mix_ahead ? "mix-ahead" : "direct");
+        if(xruns[i] < 0)
+            printf("FAILED to play\n");
+        else
+            printf("%d xruns\n", xruns[i]);
+    }
+
+    ndirect = read_sound(&runs[0], &direct);
+    nahead = read_sound(&runs[1], &ahead);
+    if(ndirect >= COMPARE_FRAMES && nahead >= COMPARE_FRAMES)
+    {
+        for(diff = 0;diff < COMPARE_FRAMES*2;diff++)
+        {
+            if(direct[diff] != ahead[diff])
+                break;
+        }
+    }
+    if(diff == COMPARE_FRAMES*2)
+        printf("mix-ahead output identical to direct over %d frames\n",
+               COMPARE_FRAMES);
+    else
+    {
+        if(diff < 0)
+            printf("FAILED: only %ld and %ld frames of sound written\n",
+                   ndirect, nahead);
+        else
+            printf("FAILED: mix-ahead output differs at frame %ld\n", diff/2);
+        failed = 1;
+    }
+    free(direct);
+    free(ahead);
+
+    if(xruns[0] != 0 || xruns[1] != 0)
+    {
+        printf("FAILED: xruns reported at the normal load\n");
+        failed = 1;
+    }
+    if(xruns[2] <= 0)
+    {
+        printf("FAILED: no xruns reported with an overloaded mixer\n");
+        failed = 1;
+    }
+
+    for(i = 0;i < 3;i++)
+    {
+        run_path(path, &runs[i], "conf");
+        remove(path);
+        run_path(path, &runs[i], "wav");
+        remove(path);
+    }
+    rmdir(tmpdir);
+    return failed;
+}
@@ -0,0 +1,233 @@
+/*
+ * OpenAL Mixer Benchmark
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Renders a number of looping, pitched and panned sources through a loopback
+ * device and reports how fast the mixer gets through them. The mixer selects
+ * its SIMD paths from the disable-cpu-exts and resampler config options, so
+ * set those through ALSOFT_CONF to compare them. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "AL/alc.h"
+#include "AL/al.h"
+#include "AL/alext.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BUFFER_RATE 22050
+
+static LPALCLOOPBACKOPENDEVICESOFT palcLoopbackOpenDeviceSOFT;
+static LPALCRENDERSAMPLESSOFT palcRenderSamplesSOFT;
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <sources>   number of playing sources (default 64)\n"
+           "  -c <channels>  output channels: mono, stereo, quad, 5.1, 6.1, 7.1\n"
+           "                 (default stereo)\n"
+           "  -u <frames>    frames rendered per update (default 1024)\n"
+           "  -s <seconds>   seconds of audio to render (default 10)\n"
+           "  -o <file>      write the rendered float samples to file\n",
+           name);
+}
+
+int main(int argc, char *argv[])
+{
+    static const struct {
+        const char name[8];
+        ALCenum chans;
+        ALCint count;
+    } chanlist[] = {
+        { "mono",   ALC_MONO_SOFT,    1 },
+        { "stereo", ALC_STEREO_SOFT,  2 },
+        { "quad",   ALC_QUAD_SOFT,    4 },
+        { "5.1",    ALC_5POINT1_SOFT, 6 },
+        { "6.1",    ALC_6POINT1_SOFT, 7 },
+        { "7.1",    ALC_7POINT1_SOFT, 8 },
+    };
+    ALCint numsources = 64, update = 1024, seconds = 10, freq = 44100;
+    ALCint chanidx = 1;
+    const char *outname = NULL;
+    FILE *outfile = NULL;
+    ALCdevice *device;
+    ALCcontext *context;
+    ALuint buffer, *sources;
+    ALshort *data;
+    ALfloat *out;
+    ALCint attrs[16];
+    ALCint updates, i;
+    clock_t start, end;
+    double ms;
+
+    for(i = 1;i < argc;i++)
+    {
+        if(strcmp(argv[i], "-n") == 0 && i+1 < argc)
+            numsources = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-u") == 0 && i+1 < argc)
+            update = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-s") == 0 && i+1 < argc)
+            seconds = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-o") == 0 && i+1 < argc)
+            outname = argv[++i];
+        else if(strcmp(argv[i], "-c") == 0 && i+1 < argc)
+        {
+            i++;
+            for(chanidx = 0;chanidx < (ALCint)(sizeof(chanlist)/sizeof(chanlist[0]));chanidx++)
+            {
+                if(strcmp(argv[i], chanlist[chanidx].name) == 0)
+                    break;
+            }
+            if(chanidx == (ALCint)(sizeof(chanlist)/sizeof(chanlist[0])))
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else
+        {
+            usage(argv[0]);
+            return (strcmp(argv[i], "-h") == 0) ? 0 : 1;
+        }
+    }
+    if(numsources <= 0 || update <= 0 || seconds <= 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if(!alcIsExtensionPresent(NULL, "ALC_SOFT_loopback"))
+    {
+        printf("!!! ALC_SOFT_loopback not supported !!!\n");
+        return 1;
+    }
+    palcLoopbackOpenDeviceSOFT = (LPALCLOOPBACKOPENDEVICESOFT)alcGetProcAddress(NULL, "alcLoopbackOpenDeviceSOFT");
+    palcRenderSamplesSOFT = (LPALCRENDERSAMPLESSOFT)alcGetProcAddress(NULL, "alcRenderSamplesSOFT");
+
+    device = palcLoopbackOpenDeviceSOFT(NULL);
+    if(!device)
+    {
+        printf("!!! Failed to open a loopback device !!!\n");
+        return 1;
+    }
+
+    i = 0;
+    attrs[i++] = ALC_FORMAT_CHANNELS_SOFT;
+    attrs[i++] = chanlist[chanidx].chans;
+    attrs[i++] = ALC_FORMAT_TYPE_SOFT;
+    attrs[i++] = ALC_FLOAT_SOFT;
+    attrs[i++] = ALC_FREQUENCY;
+    attrs[i++] = freq;
+    attrs[i++] = ALC_MONO_SOURCES;
+    attrs[i++] = numsources;
+    attrs[i++] = 0;
+
+    context = alcCreateContext(device, attrs);
+    if(!context || alcMakeContextCurrent(context) == ALC_FALSE)
+    {
+        if(context)
+            alcDestroyContext(context);
+        alcCloseDevice(device);
+        printf("!!! Failed to set a context !!!\n");
+        return 1;
+    }
+
+    /* One second of a decaying chirp, so every source has something to
+     * resample that isn't silence. */
+    data = malloc(BUFFER_RATE * sizeof(ALshort));
+    for(i = 0;i < BUFFER_RATE;i++)
+    {
+        double t = (double)i / BUFFER_RATE;
+        data[i] = (ALshort)(16000.0 * exp(-2.0*t) *
+                            sin(2.0*M_PI * (220.0 + 440.0*t) * t));
+    }
+    alGenBuffers(1, &buffer);
+    alBufferData(buffer, AL_FORMAT_MONO16, data, BUFFER_RATE*sizeof(ALshort),
+                 BUFFER_RATE);
+    free(data);
+
+    sources = malloc(numsources * sizeof(ALuint));
+    alGenSources(numsources, sources);
+    if(alGetError() != AL_NO_ERROR)
+    {
+        printf("!!! Failed to create %d sources !!!\n", numsources);
+        return 1;
+    }
+    for(i = 0;i < numsources;i++)
+    {
+        double angle = 2.0*M_PI * i / numsources;
+
+        alSourcei(sources[i], AL_BUFFER, buffer);
+        alSourcei(sources[i], AL_LOOPING, AL_TRUE);
+        alSourcef(sources[i], AL_PITCH, 0.9f + 0.2f*i/numsources);
+        alSourcef(sources[i], AL_GAIN, 1.0f/numsources);
+        alSource3f(sources[i], AL_POSITION, (ALfloat)sin(angle), 0.0f,
+                   -(ALfloat)cos(angle));
+        alSourcei(sources[i], AL_SAMPLE_OFFSET, (i*997) % BUFFER_RATE);
+    }
+    alSourcePlayv(numsources, sources);
+
+    if(outname && !(outfile=fopen(outname, "wb")))
+        printf("!!! Failed to open %s !!!\n", outname);
+
+    out = malloc(update * chanlist[chanidx].count * sizeof(ALfloat));
+    updates = (ALCint)((double)seconds * freq / update);
+
+    start = clock();
+    for(i = 0;i < updates;i++)
+    {
+        palcRenderSamplesSOFT(device, out, update);
+        if(outfile)
+            fwrite(out, sizeof(ALfloat)*chanlist[chanidx].count, update, outfile);
+    }
+    end = clock();
+
+    ms = (double)(end-start) * 1000.0 / CLOCKS_PER_SEC;
+    if(ms <= 0.0) ms = 1.0;
+    printf("%d sources, %s output, %d updates of %d frames\n", numsources,
+           chanlist[chanidx].name, updates, update);
+    printf("%.1f ms for %.1f ms of audio (%.1fx realtime)\n", ms,
+           (double)updates*update * 1000.0 / freq,
+           (double)updates*update * 1000.0 / freq / ms);
+    printf("%.1f mixed sources per ms (source updates of %d frames)\n",
+           (double)numsources*updates / ms, update);
+
+    if(outfile)
+        fclose(outfile);
+    free(out);
+
+    alSourceStopv(numsources, sources);
+    alDeleteSources(numsources, sources);
+    alDeleteBuffers(1, &buffer);
+    free(sources);
+
+    alcMakeContextCurrent(NULL);
+    alcDestroyContext(context);
+    alcCloseDevice(device);
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+/*
+ * OpenAL Property Update Benchmark
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Keeps a loopback device rendering on one thread while the main thread
+ * changes source properties as fast as it can, the way a game updates every
+ * sound's position, gain and pitch each frame. Reports how long the property
+ * calls took and how far the mixer got in the meantime, which shows how much
+ * the two sides get in each other's way. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "AL/alc.h"
+#include "AL/al.h"
+#include "AL/alext.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BUFFER_RATE 22050
+
+static LPALCLOOPBACKOPENDEVICESOFT palcLoopbackOpenDeviceSOFT;
+static LPALCRENDERSAMPLESSOFT palcRenderSamplesSOFT;
+
+static ALCdevice *device;
+static ALCint update = 1024;
+static volatile int quit;
+static volatile unsigned long rendered;
+
+static double now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec*1000000.0 + tv.tv_usec;
+}
+
+static void *render_proc(void *arg)
+{
+    ALfloat *out = malloc(update * 2 * sizeof(ALfloat));
+    (void)arg;
+
+    while(!quit)
+    {
+        palcRenderSamplesSOFT(device, out, update);
+        rendered++;
+    }
+    free(out);
+    return NULL;
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <sources>   number of playing sources (default 64)\n"
+           "  -c <calls>     property calls per frame (default 4096)\n"
+           "  -f <frames>    frames to run (default 200)\n"
+           "  -u <frames>    frames rendered per update (default 1024)\n",
+           name);
+}
+
+int main(int argc, char *argv[])
+{
+    ALCint numsources = 64, calls = 4096, frames = 200, freq = 44100;
+    ALCcontext *context;
+    ALuint buffer, *sources;
+    ALshort *data;
+    ALCint attrs[16];
+    ALCint i, f;
+    pthread_t thread;
+    double start, end, total, worst;
+    unsigned long stalls, startrendered;
+
+    for(i = 1;i < argc;i++)
+    {
+        if(strcmp(argv[i], "-n") == 0 && i+1 < argc)
+            numsources = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-c") == 0 && i+1 < argc)
+            calls = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-f") == 0 && i+1 < argc)
+            frames = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-u") == 0 && i+1 < argc)
+            update = atoi(argv[++i]);
+        else
+        {
+            usage(argv[0]);
+            return (strcmp(argv[i], "-h") == 0) ? 0 : 1;
+        }
+    }
+    if(numsources <= 0 || calls <= 0 || frames <= 0 || update <= 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if(!alcIsExtensionPresent(NULL, "ALC_SOFT_loopback"))
+    {
+        printf("!!! ALC_SOFT_loopback not supported !!!\n");
+        return 1;
+    }
+    palcLoopbackOpenDeviceSOFT = (LPALCLOOPBACKOPENDEVICESOFT)alcGetProcAddress(NULL, "alcLoopbackOpenDeviceSOFT");
+    palcRenderSamplesSOFT = (LPALCRENDERSAMPLESSOFT)alcGetProcAddress(NULL, "alcRenderSamplesSOFT");
+
+    device = palcLoopbackOpenDeviceSOFT(NULL);
+    if(!device)
+    {
+        printf("!!! Failed to open a loopback device !!!\n");
+        return 1;
+    }
+
+    i = 0;
+    attrs[i++] = ALC_FORMAT_CHANNELS_SOFT;
+    attrs[i++] = ALC_STEREO_SOFT;
+    attrs[i++] = ALC_FORMAT_TYPE_SOFT;
+    attrs[i++] = ALC_FLOAT_SOFT;
+    attrs[i++] = ALC_FREQUENCY;
+    attrs[i++] = freq;
+    attrs[i++] = ALC_MONO_SOURCES;
+    attrs[i++] = numsources;
+    attrs[i++] = 0;
+
+    context = alcCreateContext(device, attrs);
+    if(!context || alcMakeContextCurrent(context) == ALC_FALSE)
+    {
+        if(context)
+            alcDestroyContext(context);
+        alcCloseDevice(device);
+        printf("!!! Failed to set a context !!!\n");
+        return 1;
+    }
+
+    data = malloc(BUFFER_RATE * sizeof(ALshort));
+    for(i = 0;i < BUFFER_RATE;i++)
+        data[i] = (ALshort)(16000.0 * sin(2.0*M_PI * 440.0 * i / BUFFER_RATE));
+    alGenBuffers(1, &buffer);
+    alBufferData(buffer, AL_FORMAT_MONO16, data, BUFFER_RATE*sizeof(ALshort),
+                 BUFFER_RATE);
+    free(data);
+
+    sources = malloc(numsources * sizeof(ALuint));
+    alGenSources(numsources, sources);
+    if(alGetError() != AL_NO_ERROR)
+    {
+        printf("!!! Failed to create %d sources !!!\n", numsources);
+        return 1;
+    }
+    for(i = 0;i < numsources;i++)
+    {
+        alSourcei(sources[i], AL_BUFFER, buffer);
+        alSourcei(sources[i], AL_LOOPING, AL_TRUE);
+        alSourcef(sources[i], AL_GAIN, 1.0f/numsources);
+    }
+    alSourcePlayv(numsources, sources);
+
+    if(pthread_create(&thread, NULL, render_proc, NULL) != 0)
+    {
+        printf("!!! Failed to start the render thread !!!\n");
+        return 1;
+    }
+
+    total = 0.0;
+    worst = 0.0;
+    stalls = 0;
+    startrendered = rendered;
+    start = now_us();
+    for(f = 0;f < frames;f++)
+    {
+        for(i = 0;i < calls;i++)
+        {
+            ALuint src = sources[i % numsources];
+            ALfloat t = (ALfloat)(f*calls + i) * 0.001f;
+            double t0, t1;
+
+            t0 = now_us();
+            switch(i%3)
+            {
+                case 0:
+                    alSource3f(src, AL_POSITION, (ALfloat)sin(t), 0.0f,
+                               -(ALfloat)cos(t));
+                    break;
+                case 1:
+                    alSourcef(src, AL_GAIN, (0.5f + 0.5f*(ALfloat)sin(t)) /
+                                            numsources);
+                    break;
+                case 2:
+                    alSourcef(src, AL_PITCH, 0.9f + 0.2f*(ALfloat)sin(t));
+                    break;
+            }
+            t1 = now_us();
+
+            total += t1-t0;
+            if(t1-t0 > worst)
+                worst = t1-t0;
+            if(t1-t0 >= 1000.0)
+                stalls++;
+        }
+    }
+    end = now_us();
+    quit = 1;
+    pthread_join(thread, NULL);
+
+    printf("%d sources, %d frames of %d property calls\n", numsources, frames,
+           calls);
+    printf("%.1f ms total, %.3f us per call, worst call %.1f us, %lu calls over 1 ms\n",
+           (end-start) / 1000.0, total / ((double)frames*calls), worst, stalls);
+    printf("mixer rendered %.1f ms of audio meanwhile (%.1fx realtime)\n",
+           (double)(rendered-startrendered)*update * 1000.0 / freq,
+           (double)(rendered-startrendered)*update * 1000000.0 / freq /
+           (end-start));
+
+    alSourceStopv(numsources, sources);
+    alDeleteSources(numsources, sources);
+    alDeleteBuffers(1, &buffer);
+    free(sources);
+
+    alcMakeContextCurrent(NULL);
+    alcDestroyContext(context);
+    alcCloseDevice(device);
+
+    return 0;
+}
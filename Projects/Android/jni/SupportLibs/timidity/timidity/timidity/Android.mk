@@ -24,6 +24,7 @@ LOCAL_SRC_FILES+= droid_a.c
 LOCAL_SRC_FILES+= effect.c
 LOCAL_SRC_FILES+= filter.c
 LOCAL_SRC_FILES+= freq.c
+LOCAL_SRC_FILES+= instcache.c
 LOCAL_SRC_FILES+= instrum.c
 LOCAL_SRC_FILES+= list_a.c
 LOCAL_SRC_FILES+= loadtab.c
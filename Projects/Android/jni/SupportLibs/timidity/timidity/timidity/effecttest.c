@@ -0,0 +1,272 @@
+/*
+    TiMidity++ -- MIDI to WAVE converter and player
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    effecttest.c
+
+    Golden output test of the GS system effects: Freeverb, stereo chorus,
+    the three system delays and the EQ.  Each case feeds a fixed signal,
+    a burst followed by silence to get the tails, through one effect with
+    the fixed-point and then with the floating-point (--float-effect)
+    version, and checks that
+     - the fixed-point output, including what the effect sends on to the
+       reverb and delay, hashes to the value recorded before the float
+       versions were added, and
+     - the floating-point output is within the given SNR of it.
+    The largest difference is also shown in LSBs of 16-bit output.  The
+    EQ cases differ the most, up to about 1.4 LSB at full boost; with
+    doubles in the float EQ it is hardly less, so most of it is the
+    truncation in the fixed-point filters.
+    Exits 1 if a case fails.  The float versions run back to back with
+    the fixed ones, so the delay lines are reallocated between them.
+
+    Not part of the Android build; reverb.c is compiled in, the rest of
+    the player is stubbed out.  On a host, from this directory:
+
+	cc -O2 -DHAVE_CONFIG_H -I. -I.. -I../utils -I../libarc \
+	    -o effecttest effecttest.c tables.c mt19937ar.c ../utils/timer.c -lm
+	./effecttest [-v]
+*/
+
+#include "reverb.c"
+
+/* the parts of the player reverb.c refers to */
+static PlayMode test_play_mode;
+static ControlMode test_ctl;
+PlayMode *play_mode = &test_play_mode;
+ControlMode *ctl = &test_ctl;
+int opt_reverb_control = 3;	/* Freeverb */
+void *safe_malloc(size_t count) { return malloc(count ? count : 1); }
+
+#define TEST_RATE 44100
+#define TEST_BLOCK 1024				/* frames per call */
+#define TEST_BURST (TEST_RATE / 2)	/* frames of input */
+#define TEST_LENGTH (TEST_RATE * 3)	/* frames of output */
+
+enum { REVERB, CHORUS, DELAY, EQ };
+
+static const struct effect_case {
+	const char *name;
+	int effect, param[4];
+	uint32 golden;		/* hash of the fixed-point output */
+	double min_snr;		/* of the float output against it, in dB */
+} cases[] = {
+	/* character, time, level, pre-delay */
+	{"reverb room1", REVERB, {0, 0x40, 0x40, 0}, 0x2bc71e68, 80},
+	{"reverb hall2", REVERB, {4, 0x60, 0x7f, 0x20}, 0x82625df8, 85},
+	/* level, feedback, send to reverb, send to delay */
+	{"chorus", CHORUS, {0x40, 0x08, 0, 0}, 0x42460400, 110},
+	{"chorus sends", CHORUS, {0x7f, 0x60, 0x40, 0x40}, 0xc7424d9a, 110},
+	/* type, level left, level right, feedback */
+	{"delay normal", DELAY, {0, 0, 0, 0x50}, 0x986fab60, 120},
+	{"delay 3-tap", DELAY, {1, 0x7f, 0x40, 0x60}, 0x9854018d, 120},
+	{"delay cross", DELAY, {2, 0, 0, 0x70}, 0x766a293b, 120},
+	/* low freq, low gain, high freq, high gain */
+	{"eq boost", EQ, {0, 0x4c, 0, 0x4c}, 0xa9d65cfd, 65},
+	{"eq cut", EQ, {1, 0x34, 1, 0x34}, 0x5d74e9fd, 75},
+};
+#define NCASES (int)(sizeof(cases) / sizeof(cases[0]))
+
+static int32 input[TEST_LENGTH * 2], out_fixed[TEST_LENGTH * 4],
+	out_float[TEST_LENGTH * 4];
+
+/* left and right a little apart, with noise so that every delay line
+   and filter state gets something */
+static void make_input(void)
+{
+	int32 i;
+	uint32 seed = 1;
+
+	for (i = 0; i < TEST_LENGTH; i++) {
+		double x = 0, y = 0;
+
+		if (i < TEST_BURST) {
+			seed = seed * 1103515245 + 12345;
+			x = sin(i * 0.031) * 0.5 + sin(i * 0.17) * 0.2
+				+ (double)(seed >> 16 & 0x7fff) / 0x7fff * 0.2 - 0.1;
+			y = sin(i * 0.029 + 1) * 0.5 + sin(i * 0.23) * 0.2;
+		}
+		input[2 * i] = (int32)(x * (1 << 26));
+		input[2 * i + 1] = (int32)(y * (1 << 26));
+	}
+}
+
+static void setup(const struct effect_case *c)
+{
+	struct delay_status_gs_t *d = &delay_status_gs;
+
+	switch (c->effect) {
+	case REVERB:
+		reverb_status_gs.character = c->param[0];
+		reverb_status_gs.pre_lpf = 0;
+		reverb_status_gs.time = c->param[1];
+		reverb_status_gs.level = c->param[2];
+		reverb_status_gs.delay_feedback = 0;
+		reverb_status_gs.pre_delay_time = c->param[3];
+		init_reverb();
+		break;
+	case CHORUS:
+		chorus_status_gs.pre_lpf = 0;
+		chorus_status_gs.level = c->param[0];
+		chorus_status_gs.feedback = c->param[1];
+		chorus_status_gs.delay = 0x50;
+		chorus_status_gs.rate = 0x03;
+		chorus_status_gs.depth = 0x13;
+		chorus_status_gs.send_reverb = c->param[2];
+		chorus_status_gs.send_delay = c->param[3];
+		init_ch_chorus();
+		break;
+	case DELAY:
+		/* as init_delay_status_gs() and recompute_delay_status_gs() */
+		d->type = c->param[0];
+		d->level = 0x40;
+		d->level_center = 0x7f;
+		d->level_left = c->param[1];
+		d->level_right = c->param[2];
+		d->feedback = c->param[3];
+		d->pre_lpf = 0;
+		d->send_reverb = 0x20;
+		d->time_center = delay_time_center_table[0x61];
+		d->time_ratio_left = d->time_ratio_right = 0.5;
+		d->sample[0] = d->time_center * play_mode->rate / 1000.0f;
+		d->sample[1] = d->sample[0] * d->time_ratio_left;
+		d->sample[2] = d->sample[0] * d->time_ratio_right;
+		d->level_ratio[0] = d->level * d->level_center / (127.0f * 127.0f);
+		d->level_ratio[1] = d->level * d->level_left / (127.0f * 127.0f);
+		d->level_ratio[2] = d->level * d->level_right / (127.0f * 127.0f);
+		d->feedback_ratio = (double)(d->feedback - 64) * (0.763f * 2.0f / 100.0f);
+		d->send_reverb_ratio = (double)d->send_reverb * (0.787f / 100.0f);
+		init_ch_delay();
+		break;
+	case EQ:
+		/* as recompute_eq_status_gs() */
+		memset(&eq_status_gs, 0, sizeof(eq_status_gs));
+		eq_status_gs.lsf.freq = c->param[0] ? 400 : 200;
+		eq_status_gs.lsf.gain = c->param[1] - 0x40;
+		eq_status_gs.hsf.freq = c->param[2] ? 6000 : 3000;
+		eq_status_gs.hsf.gain = c->param[3] - 0x40;
+		calc_filter_shelving_low(&eq_status_gs.lsf);
+		calc_filter_shelving_high(&eq_status_gs.hsf);
+		init_eq_gs();
+		break;
+	}
+	memset(reverb_effect_buffer, 0, sizeof(reverb_effect_buffer));
+	memset(delay_effect_buffer, 0, sizeof(delay_effect_buffer));
+}
+
+/* out gets the effect output, then what it left in the reverb and delay
+   send buffers, interleaved per block */
+static void run(const struct effect_case *c, int32 *out)
+{
+	int32 i, n, *buf, *in;
+
+	setup(c);
+	for (i = 0; i < TEST_LENGTH; i += TEST_BLOCK) {
+		n = (TEST_LENGTH - i < TEST_BLOCK ? TEST_LENGTH - i : TEST_BLOCK) * 2;
+		in = input + 2 * i;
+		buf = out + 4 * i;
+		memset(buf, 0, sizeof(int32) * n);
+		switch (c->effect) {
+		case REVERB:
+			set_ch_reverb(in, n, 0x7f);
+			do_ch_reverb(buf, n);
+			break;
+		case CHORUS:
+			set_ch_chorus(in, n, 0x7f);
+			do_ch_chorus(buf, n);
+			break;
+		case DELAY:
+			set_ch_delay(in, n, 0x7f);
+			do_ch_delay(buf, n);
+			break;
+		case EQ:
+			set_ch_eq_gs(in, n);
+			do_ch_eq_gs(buf, n);
+			break;
+		}
+		memcpy(buf + n, reverb_effect_buffer, sizeof(int32) * n);
+		memset(reverb_effect_buffer, 0, sizeof(int32) * n);
+		if (c->effect == CHORUS) {
+			/* the chorus send to the delay */
+			int32 j;
+			for (j = 0; j < n; j++)
+				buf[n + j] += delay_effect_buffer[j];
+		}
+		memset(delay_effect_buffer, 0, sizeof(int32) * n);
+	}
+}
+
+/* FNV-1a over the values, independent of the byte order */
+static uint32 hash(const int32 *p, int32 n)
+{
+	uint32 h = 2166136261U, v;
+	int32 i;
+	int k;
+
+	for (i = 0; i < n; i++)
+		for (v = (uint32)p[i], k = 0; k < 4; k++, v >>= 8)
+			h = (h ^ (v & 0xff)) * 16777619U;
+	return h;
+}
+
+static double snr(const int32 *ref, const int32 *x, int32 n, int32 *max_diff)
+{
+	double signal = 0, noise = 0, d;
+	int32 i;
+
+	*max_diff = 0;
+	for (i = 0; i < n; i++) {
+		d = (double)x[i] - ref[i];
+		signal += (double)ref[i] * ref[i];
+		noise += d * d;
+		if (fabs(d) > *max_diff)
+			*max_diff = (int32)fabs(d);
+	}
+	if (noise == 0)
+		return 999;
+	return signal == 0 ? -999 : 10 * log10(signal / noise);
+}
+
+int main(int argc, char *argv[])
+{
+	int k, failures = 0, verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+	int32 max_diff;
+	uint32 h;
+	double s;
+
+	test_play_mode.rate = TEST_RATE;
+	test_play_mode.encoding = PE_16BIT | PE_SIGNED;
+	test_ctl.verbosity = VERB_NORMAL;
+	make_input();
+
+	printf("%-14s %10s %8s %10s %9s %8s\n", "", "fixed", "", "float SNR",
+		   "max diff", "16-bit");
+	for (k = 0; k < NCASES; k++) {
+		opt_float_effect = 0;
+		run(&cases[k], out_fixed);
+		opt_float_effect = 1;
+		run(&cases[k], out_float);
+		opt_float_effect = 0;
+
+		h = hash(out_fixed, TEST_LENGTH * 4);
+		s = snr(out_fixed, out_float, TEST_LENGTH * 4, &max_diff);
+		printf("%-14s 0x%08x %8s %7.1f dB %9d %4.2f LSB\n", cases[k].name, h,
+			   h == cases[k].golden ? "golden" : "CHANGED", s, max_diff,
+			   (double)max_diff / (1L << (32 - 16 - GUARD_BITS)));
+		if (h != cases[k].golden || s < cases[k].min_snr) {
+			failures++;
+			if (verbose && h != cases[k].golden)
+				printf("    expected 0x%08x\n", cases[k].golden);
+		}
+	}
+	return failures ? 1 : 0;
+}
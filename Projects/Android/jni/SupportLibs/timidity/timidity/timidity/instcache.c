@@ -0,0 +1,577 @@
+/*
+    TiMidity++ -- MIDI to WAVE converter and player
+    Copyright (C) 1999-2002 Masanao Izumo <mo@goice.co.jp>
+    Copyright (C) 1995 Tuukka Toivonen <tt@cgs.fi>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    instcache.c
+
+    On-disk cache of converted instruments.
+
+    Loading a SoundFont or GUS instrument means reading the wave data,
+    converting it, anti-aliasing and pre-resampling it.  The result
+    only depends on the source file and a few options, so it is kept
+    in the cache directory and mapped straight back in the next time.
+
+    Each instrument is a file of its own, named after a hash of the
+    source file (path, size and mtime), the instrument selection and
+    the conversion options.  It holds a header and one record: the
+    Sample structures followed by their wave data, where sample data
+    shared between samples is stored once.  Files are written under a
+    temporary name and renamed into place, so a player never maps a
+    half written one, even with several of them sharing the directory.
+    Records of changed source files are not reused and can be deleted
+    at any time.  When the files take more than opt_inst_cache_size
+    bytes, the least recently used ones are deleted.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#ifndef NO_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+#include <sys/types.h>
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif /* HAVE_SYS_STAT_H */
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#include <time.h>
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif /* HAVE_DIRENT_H */
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#ifndef MAP_FAILED
+#define MAP_FAILED ((caddr_t)-1)
+#endif /* MAP_FAILED */
+#endif /* HAVE_MMAP */
+
+#include "timidity.h"
+#include "common.h"
+#include "instrum.h"
+#include "playmidi.h"
+#include "output.h"
+#include "controls.h"
+#include "resample.h"
+#include "instcache.h"
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#define INST_CACHE_PREFIX "timidity-inst-"
+#define INST_CACHE_SUFFIX ".cache"
+#define INST_CACHE_MAGIC "TiMInstC"
+#define INST_CACHE_VERSION 1
+#define INST_CACHE_RECORD 0x52747349	/* "IstR" */
+#define INST_CACHE_LIMIT (256L << 20)	/* largest file mapped back */
+#define INST_CACHE_TMP_AGE 3600		/* seconds before a .tmp is stale */
+#define INST_CACHE_ALIGN(n) (((n) + 15) & ~(size_t)15)
+#define INST_CACHE_RECORD_OFS INST_CACHE_ALIGN(sizeof(struct cache_header))
+
+struct cache_header {
+    char magic[8];
+    uint32 version, byte_order;
+    /* anything that changes the layout of a record */
+    uint32 sample_size, sample_t_size, fraction_bits, reserved;
+};
+
+struct cache_record {
+    uint32 magic, size;		/* size includes this header */
+    uint64 h1, h2;
+    int32 type, samples;
+    /* Sample sample[samples], uint32 data_ofs[samples], wave data */
+};
+
+/* An instrument mapped from the cache */
+struct cache_map {
+    Instrument *ip;
+    void *base;
+    size_t len;
+    struct cache_map *next;
+};
+
+char *opt_inst_cache_dir = NULL;
+int32 opt_inst_cache_size = INST_CACHE_DEFAULT_SIZE;
+
+static int store_failed = 0;	/* after a write error, only load */
+static long cache_total = -1;	/* bytes in the directory, -1 if not known */
+static struct cache_map *cache_maps;
+
+/*----------------------------------------------------------------
+ * keys
+ *----------------------------------------------------------------*/
+
+void inst_cache_key_add(InstCacheKey *key, const void *data, size_t len)
+{
+    const uint8 *p = (const uint8 *)data;
+    uint64 h1 = key->h1, h2 = key->h2;
+
+    /* FNV-1a, and a second independent hash to make collisions moot */
+    while (len--) {
+	h1 = (h1 ^ *p) * (uint64)0x100000001b3ULL;
+	h2 = (h2 + *p++ + 1) * (uint64)0x9e3779b97f4a7c15ULL;
+	h2 ^= h2 >> 29;
+    }
+    key->h1 = h1;
+    key->h2 = h2;
+}
+
+int inst_cache_file_key(InstCacheKey *key, const char *path)
+{
+#if defined(LOOKUP_HACK) || !defined(HAVE_SYS_STAT_H)
+    /* no stat(), or squashed 8-bit data, which records can't hold */
+    return -1;
+#else
+    struct stat st;
+    int64 id[2];
+
+    if (opt_inst_cache_dir == NULL || path == NULL)
+	return -1;
+    if (stat(path, &st) < 0 || !S_ISREG(st.st_mode))
+	return -1;
+    key->h1 = (uint64)0xcbf29ce484222325ULL;
+    key->h2 = 0;
+    inst_cache_key_add(key, path, strlen(path));
+    id[0] = st.st_size;
+    id[1] = st.st_mtime;
+    inst_cache_key_add(key, id, sizeof(id));
+    return 0;
+#endif
+}
+
+/* Mix in the options the converted data depends on */
+static void add_options(InstCacheKey *key)
+{
+    int32 opt[8];
+
+    opt[0] = play_mode->rate;
+    opt[1] = antialiasing_allowed;
+    opt[2] = opt_surround_chorus;
+    opt[3] = get_current_resampler();	/* pre_resample() */
+    opt[4] = get_resampler_parm();
+    opt[5] = fast_decay;
+    opt[6] = control_ratio;
+    opt[7] = modify_release;
+    inst_cache_key_add(key, opt, sizeof(opt));
+}
+
+/*----------------------------------------------------------------
+ * cache files
+ *----------------------------------------------------------------*/
+
+static void init_header(struct cache_header *hdr)
+{
+    memset(hdr, 0, sizeof(*hdr));
+    memcpy(hdr->magic, INST_CACHE_MAGIC, sizeof(hdr->magic));
+    hdr->version = INST_CACHE_VERSION;
+    hdr->byte_order = 0x01020304;
+    hdr->sample_size = sizeof(Sample);
+    hdr->sample_t_size = sizeof(sample_t);
+    hdr->fraction_bits = FRACTION_BITS;
+}
+
+static int read_all(int fd, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    long n;
+
+    while (len > 0) {
+	if ((n = read(fd, p, len)) <= 0)
+	    return -1;
+	p += n;
+	len -= n;
+    }
+    return 0;
+}
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    long n;
+
+    while (len > 0) {
+	if ((n = write(fd, p, len)) <= 0)
+	    return -1;
+	p += n;
+	len -= n;
+    }
+    return 0;
+}
+
+/* The file of the record `key', `tmp' adds a name unique to this process */
+static char *record_path(const InstCacheKey *key, int tmp)
+{
+    char *path;
+    int len = strlen(opt_inst_cache_dir);
+
+    path = (char *)safe_malloc(len + sizeof(PATH_STRING INST_CACHE_PREFIX
+					    INST_CACHE_SUFFIX) + 32 + 32);
+    strcpy(path, opt_inst_cache_dir);
+    if (len && !IS_PATH_SEP(path[len - 1]))
+	strcat(path, PATH_STRING);
+    len = strlen(path);
+    sprintf(path + len, INST_CACHE_PREFIX "%08lx%08lx%08lx%08lx"
+	    INST_CACHE_SUFFIX,
+	    (unsigned long)(key->h1 >> 32), (unsigned long)(key->h1 & 0xffffffff),
+	    (unsigned long)(key->h2 >> 32), (unsigned long)(key->h2 & 0xffffffff));
+    if (tmp)
+	sprintf(path + strlen(path), ".%ld.tmp", (long)getpid());
+    return path;
+}
+
+/*----------------------------------------------------------------
+ * pruning
+ *----------------------------------------------------------------*/
+
+#ifdef HAVE_DIRENT_H
+struct cache_file {
+    char *path;
+    time_t used;
+    long size;
+};
+
+static int cmp_used(const void *a, const void *b)
+{
+    time_t ta = ((const struct cache_file *)a)->used,
+	tb = ((const struct cache_file *)b)->used;
+
+    return ta < tb ? -1 : ta > tb;
+}
+#endif /* HAVE_DIRENT_H */
+
+/* Add up the cache files in the directory into cache_total, and if
+   that is more than opt_inst_cache_size, delete the least recently
+   used ones until it is down to 3/4 of it.  A file was last used when
+   it was last read (atime, which relatime updates at least daily) or
+   written.  A player that has a deleted file mapped keeps its copy.
+   Temporary files of players that died while writing are deleted
+   once they are an hour old. */
+static void prune_cache(void)
+{
+#ifdef HAVE_DIRENT_H
+    struct cache_file *files = NULL;
+    struct dirent *d;
+    struct stat st;
+    DIR *dir;
+    char *path;
+    int nfiles = 0, max_files = 0, dirlen, namelen, i;
+    time_t now = time(NULL);
+
+    if ((dir = opendir(opt_inst_cache_dir)) == NULL) {
+	cache_total = 0;
+	return;
+    }
+    cache_total = 0;
+    dirlen = strlen(opt_inst_cache_dir);
+    while ((d = readdir(dir)) != NULL) {
+	namelen = strlen(d->d_name);
+	if (strncmp(d->d_name, INST_CACHE_PREFIX,
+		    sizeof(INST_CACHE_PREFIX) - 1) != 0)
+	    continue;
+	path = (char *)safe_malloc(dirlen + namelen + 2);
+	strcpy(path, opt_inst_cache_dir);
+	if (dirlen && !IS_PATH_SEP(path[dirlen - 1]))
+	    strcat(path, PATH_STRING);
+	strcat(path, d->d_name);
+	if (stat(path, &st) < 0 || !S_ISREG(st.st_mode)) {
+	    free(path);
+	    continue;
+	}
+	if (namelen > 4 && strcmp(d->d_name + namelen - 4, ".tmp") == 0) {
+	    if (now - st.st_mtime > INST_CACHE_TMP_AGE)
+		unlink(path);
+	    free(path);
+	    continue;
+	}
+	if (namelen <= (int)sizeof(INST_CACHE_SUFFIX) - 1 ||
+	    strcmp(d->d_name + namelen - (sizeof(INST_CACHE_SUFFIX) - 1),
+		   INST_CACHE_SUFFIX) != 0) {
+	    free(path);
+	    continue;
+	}
+	if (nfiles == max_files) {
+	    max_files = max_files ? max_files * 2 : 64;
+	    files = (struct cache_file *)safe_realloc(files,
+				max_files * sizeof(struct cache_file));
+	}
+	files[nfiles].path = path;
+	files[nfiles].used = st.st_atime > st.st_mtime ?
+	    st.st_atime : st.st_mtime;
+	files[nfiles].size = st.st_size;
+	cache_total += st.st_size;
+	nfiles++;
+    }
+    closedir(dir);
+
+    if (cache_total > opt_inst_cache_size) {
+	qsort(files, nfiles, sizeof(struct cache_file), cmp_used);
+	for (i = 0; i < nfiles &&
+		 cache_total > opt_inst_cache_size / 4 * 3; i++)
+	    if (unlink(files[i].path) == 0)
+		cache_total -= files[i].size;
+    }
+    for (i = 0; i < nfiles; i++)
+	free(files[i].path);
+    free(files);
+#else
+    cache_total = 0;
+#endif /* HAVE_DIRENT_H */
+}
+
+/*----------------------------------------------------------------
+ * load and store
+ *----------------------------------------------------------------*/
+
+static int check_record(const struct cache_record *rec, size_t size,
+			const InstCacheKey *key)
+{
+    const Sample *sp;
+    const uint32 *data_ofs;
+    size_t hdr_size;
+    int i;
+
+    if (rec->magic != INST_CACHE_RECORD || rec->size != size ||
+	rec->h1 != key->h1 || rec->h2 != key->h2 ||
+	rec->samples <= 0 || rec->samples > 0xffff)
+	return -1;
+    hdr_size = sizeof(*rec) + rec->samples * (sizeof(Sample) + 4);
+    if (hdr_size > size)
+	return -1;
+    sp = (const Sample *)(rec + 1);
+    data_ofs = (const uint32 *)(sp + rec->samples);
+    for (i = 0; i < rec->samples; i++) {
+	if (sp[i].loop_start > sp[i].loop_end ||
+	    sp[i].loop_end > sp[i].data_length)
+	    return -1;
+	if (data_ofs[i] == 0)
+	    continue;
+	/* the resamplers read one sample past data_length */
+	if (data_ofs[i] < hdr_size || data_ofs[i] > size ||
+	    (sp[i].data_length >> FRACTION_BITS) + 1 >
+	    (size - data_ofs[i]) / sizeof(sample_t))
+	    return -1;
+    }
+    return 0;
+}
+
+static void unmap_record(void *base, size_t len)
+{
+#ifdef HAVE_MMAP
+    munmap(base, len);
+#else
+    free(base);
+#endif
+}
+
+Instrument *inst_cache_load(const InstCacheKey *key)
+{
+    InstCacheKey k = *key;
+    struct cache_header hdr, want;
+    struct cache_record *rec;
+    struct cache_map *m;
+    struct stat st;
+    const uint32 *data_ofs;
+    Instrument *ip;
+    void *base;
+    size_t len;
+    char *path;
+    int fd, i;
+
+    add_options(&k);
+    path = record_path(&k, 0);
+    fd = open(path, O_RDONLY | O_BINARY);
+    free(path);
+    if (fd < 0)
+	return NULL;
+
+    /* a stale or broken file is replaced by inst_cache_store() */
+    init_header(&want);
+    if (fstat(fd, &st) < 0 || st.st_size > INST_CACHE_LIMIT ||
+	st.st_size < (off_t)(INST_CACHE_RECORD_OFS + sizeof(*rec)) ||
+	read_all(fd, &hdr, sizeof(hdr)) || memcmp(&hdr, &want, sizeof(hdr))) {
+	close(fd);
+	return NULL;
+    }
+    len = st.st_size;
+#ifdef HAVE_MMAP
+    base = mmap(0, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == (void *)MAP_FAILED)
+	return NULL;
+#else
+    base = safe_large_malloc(len);
+    if (lseek(fd, 0, SEEK_SET) != 0 || read_all(fd, base, len)) {
+	close(fd);
+	free(base);
+	return NULL;
+    }
+    close(fd);
+#endif
+    rec = (struct cache_record *)((char *)base + INST_CACHE_RECORD_OFS);
+    if (check_record(rec, len - INST_CACHE_RECORD_OFS, &k)) {
+	unmap_record(base, len);
+	return NULL;
+    }
+
+    ip = (Instrument *)safe_malloc(sizeof(Instrument));
+    ip->type = rec->type;
+    ip->samples = rec->samples;
+    ip->instname = NULL;
+    ip->sample = (Sample *)safe_malloc(sizeof(Sample) * ip->samples);
+    memcpy(ip->sample, rec + 1, sizeof(Sample) * ip->samples);
+    data_ofs = (const uint32 *)((char *)(rec + 1) +
+				ip->samples * sizeof(Sample));
+    for (i = 0; i < ip->samples; i++) {
+	ip->sample[i].data = data_ofs[i] ?
+	    (sample_t *)((char *)rec + data_ofs[i]) : NULL;
+	ip->sample[i].data_alloced = 0;
+    }
+
+    m = (struct cache_map *)safe_malloc(sizeof(struct cache_map));
+    m->ip = ip;
+    m->base = base;
+    m->len = len;
+    m->next = cache_maps;
+    cache_maps = m;
+    return ip;
+}
+
+void inst_cache_store(const InstCacheKey *key, Instrument *ip,
+		      const int32 *lens)
+{
+    InstCacheKey k = *key;
+    struct cache_record *rec;
+    Sample *sp;
+    uint32 *data_ofs;
+    size_t size;
+    char *buf, *path, *tmp;
+    int fd, err, i, j;
+
+    if (ip->samples <= 0 || ip->samples > 0xffff || store_failed)
+	return;
+    add_options(&k);
+
+    /* lay out the record, storing shared data once */
+    data_ofs = (uint32 *)safe_malloc(ip->samples * sizeof(uint32));
+    size = INST_CACHE_ALIGN(sizeof(*rec) +
+			    ip->samples * (sizeof(Sample) + sizeof(uint32)));
+    for (i = 0; i < ip->samples; i++) {
+	data_ofs[i] = 0;
+	if (ip->sample[i].data == NULL)
+	    continue;
+	for (j = 0; j < i; j++)
+	    if (ip->sample[j].data == ip->sample[i].data)
+		break;
+	if (j < i)
+	    data_ofs[i] = data_ofs[j];
+	else {
+	    data_ofs[i] = size;
+	    size += INST_CACHE_ALIGN(lens[i] * sizeof(sample_t));
+	}
+    }
+    if (INST_CACHE_RECORD_OFS + size > INST_CACHE_LIMIT) {
+	free(data_ofs);
+	return;
+    }
+
+    buf = (char *)safe_large_malloc(INST_CACHE_RECORD_OFS + size);
+    memset(buf, 0, INST_CACHE_RECORD_OFS + size);
+    init_header((struct cache_header *)buf);
+    rec = (struct cache_record *)(buf + INST_CACHE_RECORD_OFS);
+    rec->magic = INST_CACHE_RECORD;
+    rec->size = size;
+    rec->h1 = k.h1;
+    rec->h2 = k.h2;
+    rec->type = ip->type;
+    rec->samples = ip->samples;
+    sp = (Sample *)(rec + 1);
+    memcpy(sp, ip->sample, sizeof(Sample) * ip->samples);
+    memcpy(sp + ip->samples, data_ofs, sizeof(uint32) * ip->samples);
+    for (i = 0; i < ip->samples; i++) {
+	sp[i].data = NULL;
+	sp[i].data_alloced = 0;
+	for (j = 0; j < i; j++)
+	    if (data_ofs[j] == data_ofs[i])
+		break;
+	if (data_ofs[i] && j == i)
+	    memcpy((char *)rec + data_ofs[i], ip->sample[i].data,
+		   lens[i] * sizeof(sample_t));
+    }
+
+    /* write it aside and rename it into place, so that no reader ever
+       sees a partial record */
+    path = record_path(&k, 0);
+    tmp = record_path(&k, 1);
+    err = 0;
+    if ((fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644)) < 0)
+	err = errno;
+    else {
+	if (write_all(fd, buf, INST_CACHE_RECORD_OFS + size))
+	    err = errno ? errno : EIO;
+	if (close(fd) < 0 && !err)
+	    err = errno;
+#ifdef __W32__
+	/* rename() doesn't replace an existing file */
+	if (!err && unlink(path) < 0 && errno != ENOENT)
+	    err = errno;
+#endif
+	if (!err && rename(tmp, path) < 0)
+	    err = errno;
+	if (err)
+	    unlink(tmp);
+    }
+    if (err) {
+	ctl->cmsg(CMSG_WARNING, VERB_NORMAL,
+		  "Can't write instrument cache %s: %s", path, strerror(err));
+	store_failed = 1;
+    } else if (cache_total < 0 ||
+	       (cache_total += INST_CACHE_RECORD_OFS + size) >
+	       opt_inst_cache_size)
+	prune_cache();
+    free(tmp);
+    free(path);
+    free(buf);
+    free(data_ofs);
+}
+
+void inst_cache_release(Instrument *ip)
+{
+    struct cache_map **p, *m;
+
+    for (p = &cache_maps; (m = *p) != NULL; p = &m->next)
+	if (m->ip == ip) {
+	    *p = m->next;
+	    unmap_record(m->base, m->len);
+	    free(m);
+	    return;
+	}
+}
+
+void inst_cache_close(void)
+{
+    store_failed = 0;
+    cache_total = -1;
+}
@@ -0,0 +1,57 @@
+/*
+    TiMidity++ -- MIDI to WAVE converter and player
+    Copyright (C) 1999-2002 Masanao Izumo <mo@goice.co.jp>
+    Copyright (C) 1995 Tuukka Toivonen <tt@cgs.fi>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    instcache.h
+
+    On-disk cache of converted instruments.
+*/
+
+#ifndef ___INSTCACHE_H_
+#define ___INSTCACHE_H_
+
+typedef struct _InstCacheKey {
+    uint64 h1, h2;
+} InstCacheKey;
+
+/* Directory of the cache files, NULL if the cache is disabled */
+extern char *opt_inst_cache_dir;
+/* Size the cache files are kept under, in bytes */
+#define INST_CACHE_DEFAULT_SIZE (256L << 20)
+extern int32 opt_inst_cache_size;
+
+/* Start a key for an instrument converted from the file `path'.
+ * Returns -1 if the cache is disabled or the file can't be stat'ed.
+ */
+extern int inst_cache_file_key(InstCacheKey *key, const char *path);
+extern void inst_cache_key_add(InstCacheKey *key, const void *data, size_t len);
+
+/* Map an instrument from the cache, NULL if it isn't there.
+ * instname is left NULL.
+ */
+extern Instrument *inst_cache_load(const InstCacheKey *key);
+/* Add a freshly loaded instrument to the cache.  lens[i] is the number
+ * of sample_t allocated for ip->sample[i].data, padding included.
+ */
+extern void inst_cache_store(const InstCacheKey *key, Instrument *ip,
+			     const int32 *lens);
+/* Called by free_instrument(), unmaps ip if it came from the cache */
+extern void inst_cache_release(Instrument *ip);
+extern void inst_cache_close(void);
+
+#endif /* ___INSTCACHE_H_ */
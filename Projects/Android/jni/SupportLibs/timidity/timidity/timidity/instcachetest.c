@@ -0,0 +1,324 @@
+/*
+    TiMidity++ -- MIDI to WAVE converter and player
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    instcachetest.c
+
+    Test of the on-disk instrument cache, in a scratch directory:
+     - an instrument stored and loaded back has the same samples and
+       wave data, with shared data still shared,
+     - other conversion options, another source file and a truncated
+       file are misses,
+     - after a write error nothing more is stored, but records already
+       there still load,
+     - beyond opt_inst_cache_size the least recently used files and
+       stale temporary files are deleted, and the newer ones are kept.
+    Exits 1 if a check fails.
+
+    Not part of the Android build; instcache.c is compiled in, the rest
+    of the player is stubbed out.  On a host, from this directory:
+
+	cc -O2 -DHAVE_CONFIG_H -I. -I.. -I../utils -I../libarc \
+	    -o instcachetest instcachetest.c
+	./instcachetest
+*/
+
+#include "instcache.c"
+#include <utime.h>
+
+/* the parts of the player instcache.c refers to */
+static PlayMode test_play_mode;
+static int test_cmsg(int type, int verbosity_level, char *fmt, ...)
+{
+	return 0;
+}
+static ControlMode test_ctl;
+PlayMode *play_mode = &test_play_mode;
+ControlMode *ctl = &test_ctl;
+int antialiasing_allowed = 0, fast_decay = 0, opt_surround_chorus = 0;
+int32 control_ratio = 44, modify_release = 0;
+int get_current_resampler(void) { return 1; }
+int get_resampler_parm(void) { return 0; }
+void *safe_malloc(size_t count) { return malloc(count ? count : 1); }
+void *safe_large_malloc(size_t count) { return safe_malloc(count); }
+void *safe_realloc(void *old_ptr, size_t new_size)
+{
+	return realloc(old_ptr, new_size ? new_size : 1);
+}
+
+#define TEST_LEN 1000		/* sample_t per sample, padding included */
+
+static char dir[64], source[96];
+static int failed = 0;
+
+static void check(int ok, const char *what)
+{
+	printf("%-48s %s\n", what, ok ? "ok" : "FAILED");
+	if (!ok)
+		failed = 1;
+}
+
+/* Three samples, the first two sharing their data, the third without */
+static Instrument *make_instrument(int seed, int32 *lens)
+{
+	Instrument *ip = (Instrument *)safe_malloc(sizeof(Instrument));
+	sample_t *data = (sample_t *)safe_malloc(TEST_LEN * sizeof(sample_t));
+	int i;
+
+	for (i = 0; i < TEST_LEN; i++)
+		data[i] = (sample_t)(i * 37 + seed * 1001);
+	ip->type = INST_SF2;
+	ip->samples = 3;
+	ip->instname = NULL;
+	ip->sample = (Sample *)safe_malloc(3 * sizeof(Sample));
+	memset(ip->sample, 0, 3 * sizeof(Sample));
+	for (i = 0; i < 3; i++) {
+		Sample *sp = &ip->sample[i];
+
+		sp->data_length = (splen_t)(TEST_LEN - 1) << FRACTION_BITS;
+		sp->loop_start = (splen_t)(100 + i) << FRACTION_BITS;
+		sp->loop_end = (splen_t)(900 - i) << FRACTION_BITS;
+		sp->sample_rate = 44100;
+		sp->root_freq = 261626 + seed;
+		sp->volume = 0.5 + i;
+		sp->low_vel = i;
+		sp->high_vel = 127;
+		sp->data = i < 2 ? data : NULL;
+		lens[i] = i < 2 ? TEST_LEN : 0;
+	}
+	return ip;
+}
+
+static void free_test_instrument(Instrument *ip)
+{
+	free(ip->sample[0].data);
+	free(ip->sample);
+	free(ip);
+}
+
+static int same_instrument(const Instrument *a, const Instrument *b)
+{
+	int i;
+
+	if (a->type != b->type || a->samples != b->samples)
+		return 0;
+	for (i = 0; i < a->samples; i++) {
+		Sample x = a->sample[i], y = b->sample[i];
+
+		if ((x.data == NULL) != (y.data == NULL) || (x.data != NULL &&
+		    memcmp(x.data, y.data, TEST_LEN * sizeof(sample_t))))
+			return 0;
+		x.data = y.data = NULL;
+		x.data_alloced = y.data_alloced = 0;
+		if (memcmp(&x, &y, sizeof(Sample)))
+			return 0;
+	}
+	return 1;
+}
+
+static int key_for(InstCacheKey *key, const char *path, int preset)
+{
+	if (inst_cache_file_key(key, path))
+		return -1;
+	inst_cache_key_add(key, &preset, sizeof(preset));
+	return 0;
+}
+
+static int count_files(const char *suffix)
+{
+	DIR *d = opendir(dir);
+	struct dirent *e;
+	int n = 0, len;
+
+	while ((e = readdir(d)) != NULL) {
+		len = strlen(e->d_name);
+		if (len > (int)strlen(suffix) &&
+		    strcmp(e->d_name + len - strlen(suffix), suffix) == 0)
+			n++;
+	}
+	closedir(d);
+	return n;
+}
+
+/* Set the time of last use of the record of key, 0 deletes it;
+   returns its size */
+static long set_used(const InstCacheKey *key, time_t t)
+{
+	InstCacheKey k = *key;
+	struct utimbuf times;
+	struct stat st;
+	char *path;
+
+	add_options(&k);
+	path = record_path(&k, 0);
+	if (stat(path, &st) < 0)
+		st.st_size = 0;
+	times.actime = times.modtime = t;
+	if (t == 0)
+		unlink(path);
+	else
+		utime(path, &times);
+	free(path);
+	return st.st_size;
+}
+
+static void round_trip(void)
+{
+	InstCacheKey key, other;
+	Instrument *ip, *loaded;
+	int32 lens[3];
+	char *path;
+
+	ip = make_instrument(1, lens);
+	check(key_for(&key, source, 0) == 0, "key of the source file");
+	check(inst_cache_load(&key) == NULL, "miss before the store");
+	inst_cache_store(&key, ip, lens);
+	loaded = inst_cache_load(&key);
+	check(loaded != NULL && same_instrument(ip, loaded),
+	      "stored instrument loads back the same");
+	check(loaded != NULL && loaded->sample[0].data == loaded->sample[1].data,
+	      "shared wave data is still shared");
+	if (loaded != NULL) {
+		inst_cache_release(loaded);
+		free(loaded->sample);
+		free(loaded);
+	}
+
+	play_mode->rate = 22050;
+	check(inst_cache_load(&key) == NULL, "miss at another output rate");
+	play_mode->rate = 44100;
+	check(key_for(&other, source, 1) == 0 && inst_cache_load(&other) == NULL,
+	      "miss for another preset");
+
+	/* cut the record short */
+	other = key;
+	add_options(&other);
+	path = record_path(&other, 0);
+	truncate(path, INST_CACHE_RECORD_OFS + sizeof(struct cache_record) + 8);
+	check(inst_cache_load(&key) == NULL, "miss for a truncated file");
+	free(path);
+	set_used(&key, 0);
+	free_test_instrument(ip);
+}
+
+static void write_error(void)
+{
+	InstCacheKey key, key2;
+	Instrument *ip, *loaded;
+	int32 lens[3];
+
+	ip = make_instrument(2, lens);
+	key_for(&key, source, 10);
+	key_for(&key2, source, 11);
+	inst_cache_store(&key, ip, lens);
+
+	/* the next store fails, in a directory that isn't there */
+	opt_inst_cache_dir = "/nonexistent/instcachetest";
+	inst_cache_store(&key2, ip, lens);
+	opt_inst_cache_dir = dir;
+	check(store_failed, "write error is noticed");
+	inst_cache_store(&key2, ip, lens);
+	check(inst_cache_load(&key2) == NULL, "no store after a write error");
+	loaded = inst_cache_load(&key);
+	check(loaded != NULL && same_instrument(ip, loaded),
+	      "records still load after a write error");
+	if (loaded != NULL) {
+		inst_cache_release(loaded);
+		free(loaded->sample);
+		free(loaded);
+	}
+	set_used(&key, 0);
+	inst_cache_close();
+	free_test_instrument(ip);
+}
+
+static void pruning(void)
+{
+	InstCacheKey key[6];
+	Instrument *ip;
+	int32 lens[3];
+	char *tmp;
+	int i, kept;
+	long size;
+	time_t now = time(NULL);
+	struct utimbuf times;
+
+	/* a temporary file of a player that died an hour ago, and one of
+	   a player still writing */
+	for (i = 0; i < 2; i++) {
+		key_for(&key[0], source, 100 + i);
+		add_options(&key[0]);
+		tmp = record_path(&key[0], 1);
+		close(open(tmp, O_WRONLY | O_CREAT, 0644));
+		times.actime = times.modtime = now - (i ? 10 : 2 * INST_CACHE_TMP_AGE);
+		utime(tmp, &times);
+		free(tmp);
+	}
+
+	/* six records, each one used before the next, except that the
+	   first was used last; then room for four and a half, so that
+	   pruning down to 3/4 of that keeps three */
+	ip = make_instrument(3, lens);
+	for (i = 0; i < 6; i++) {
+		key_for(&key[i], source, 20 + i);
+		inst_cache_store(&key[i], ip, lens);
+		size = set_used(&key[i], now - 1000 + i);
+	}
+	set_used(&key[0], now);
+	opt_inst_cache_size = size * 9 / 2;
+	inst_cache_close();
+	inst_cache_store(&key[5], ip, lens);	/* rescans and prunes */
+
+	check(count_files(".tmp") == 1, "stale temporary file deleted");
+	check(cache_total <= opt_inst_cache_size, "cache is under its size");
+	kept = 0;
+	for (i = 0; i < 6; i++) {
+		Instrument *loaded = inst_cache_load(&key[i]);
+
+		if (loaded != NULL) {
+			kept |= 1 << i;
+			inst_cache_release(loaded);
+			free(loaded->sample);
+			free(loaded);
+		}
+	}
+	check(kept == 0x31, "least recently used files deleted");
+	free_test_instrument(ip);
+}
+
+int main(void)
+{
+	FILE *fp;
+	char cmd[96];
+
+	test_ctl.cmsg = test_cmsg;
+	test_play_mode.rate = 44100;
+	strcpy(dir, "/tmp/instcachetestXXXXXX");
+	if (mkdtemp(dir) == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+	sprintf(source, "%s/source.sf2", dir);
+	if ((fp = fopen(source, "w")) == NULL)
+		return 1;
+	fputs("not really a SoundFont", fp);
+	fclose(fp);
+	opt_inst_cache_dir = dir;
+
+	round_trip();
+	write_error();
+	pruning();
+
+	sprintf(cmd, "rm -rf %s", dir);
+	system(cmd);
+	return failed;
+}
@@ -47,6 +47,7 @@
 #include "filter.h"
 #include "quantity.h"
 #include "freq.h"
+#include "instcache.h"
 #include "android/log.h"
 
 #define INSTRUMENT_HASH_SIZE 128
@@ -139,6 +140,7 @@ void free_instrument(Instrument *ip)
       if(sp->data_alloced)
 	  free(sp->data);
     }
+  inst_cache_release(ip);
   free(ip->sample);
   free(ip);
 }
@@ -624,7 +626,9 @@ static Instrument *load_gus_instrument(char *name,
 	struct timidity_file *tf;
 	uint8 tmp[1024], fractions;
 	Sample *sp;
-	int i, j, noluck = 0;
+	InstCacheKey key;
+	int32 *lens = NULL;
+	int i, j, noluck = 0, use_cache = 0;
 	
 	if (! name)
 		return 0;
@@ -694,6 +698,24 @@ static Instrument *load_gus_instrument(char *name,
 				"Instrument `%s' can't be found.", name);
 		return 0;
 	}
+	/* current_filename is the patch open_file_r() found */
+	if (inst_cache_file_key(&key, url_expand_home_dir(current_filename)) == 0) {
+		int32 opt[7];
+
+		opt[0] = dr, opt[1] = panning, opt[2] = amp;
+		opt[3] = note_to_use, opt[4] = strip_loop;
+		opt[5] = strip_envelope, opt[6] = strip_tail;
+		inst_cache_key_add(&key, opt, sizeof(opt));
+		if ((ip = inst_cache_load(&key)) != NULL) {
+			ctl->cmsg(CMSG_INFO, VERB_DEBUG,
+					" * Mapped from the instrument cache");
+			close_file(tf);
+			store_instrument_cache(ip, name, panning, amp, note_to_use,
+					strip_loop, strip_envelope, strip_tail);
+			return ip;
+		}
+		use_cache = 1;
+	}
 	/* Read some headers and do cursory sanity checks. There are loads
 	 * of magic offsets.  This could be rewritten...
 	 */
@@ -729,6 +751,8 @@ static Instrument *load_gus_instrument(char *name,
 	ip->samples = tmp[198];
 	ip->sample = (Sample *) safe_malloc(sizeof(Sample) * ip->samples);
 	memset(ip->sample, 0, sizeof(Sample) * ip->samples);
+	if (use_cache)	/* allocated length of each sample */
+		lens = (int32 *) safe_malloc(sizeof(int32) * (ip->samples + 1));
 	for (i = 0; i < ip->samples; i++) {
 		skip(tf, 7);	/* Skip the wave name */
 		if (tf_read(&fractions, 1, 1, tf) != 1) {
@@ -738,6 +762,7 @@ fail:
 				free(ip->sample[j].data);
 			free(ip->sample);
 			free(ip);
+			free(lens);
 			close_file(tf);
 			return 0;
 		}
@@ -988,8 +1013,15 @@ fail:
 		/* If this instrument will always be played on the same note,
 		 * and it's not looped, we can resample it now.
 		 */
-		if (sp->note_to_use && ! (sp->modes & MODES_LOOPING))
+		if (lens)
+			lens[i] = (sp->data_length >> FRACTION_BITS) + 2;
+		if (sp->note_to_use && ! (sp->modes & MODES_LOOPING)) {
+			sample_t *data = sp->data;
+			
 			pre_resample(sp);
+			if (lens && sp->data != data)
+				lens[i] = (sp->data_length >> FRACTION_BITS) + 1;
+		}
 
 		/* do pitch detection on drums if surround chorus is used */
 		if (dr && opt_surround_chorus)
@@ -1011,6 +1043,10 @@ fail:
 		}
 	}
 	close_file(tf);
+	if (lens) {
+		inst_cache_store(&key, ip, lens);
+		free(lens);
+	}
 	store_instrument_cache(ip, name, panning, amp, note_to_use,
 			strip_loop, strip_envelope, strip_tail);
 	return ip;
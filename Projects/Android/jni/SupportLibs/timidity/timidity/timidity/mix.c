@@ -26,6 +26,11 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifndef NO_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
 
 #include "timidity.h"
 #include "common.h"
@@ -67,7 +72,7 @@ typedef int32 mix_t;
 	pan_delay_buf[pan_delay_wpt] = (a) * s;	\
 	if (++pan_delay_wpt == PAN_DELAY_BUF_MAX) {pan_delay_wpt = 0;}
 
-void mix_voice(int32 *, int, int32);
+void mix_voice(int32 *, int, int32, mix_scratch_t *);
 static inline int do_voice_filter(int, resample_t*, mix_t*, int32);
 static inline void recalc_voice_resonance(int);
 static inline void recalc_voice_fc(int);
@@ -97,10 +102,22 @@ static inline void compute_mix_smoothing(Voice *);
 
 int min_sustain_time = 5000;
 
-static mix_t filter_buffer[AUDIO_BUFFER_SIZE];
+struct mix_scratch {
+	resample_scratch_t rs;
+	mix_t filter_buffer[AUDIO_BUFFER_SIZE];
+};
+
+/**************** interface function ****************/
+mix_scratch_t *new_mix_scratch(void)
+{
+	mix_scratch_t *ms = (mix_scratch_t *) safe_malloc(sizeof(mix_scratch_t));
+
+	memset(ms, 0, sizeof(mix_scratch_t));
+	return ms;
+}
 
 /**************** interface function ****************/
-void mix_voice(int32 *buf, int v, int32 c)
+void mix_voice(int32 *buf, int v, int32 c, mix_scratch_t *ms)
 {
 	Voice *vp = voice + v;
 	resample_t *sp;
@@ -108,8 +125,8 @@ void mix_voice(int32 *buf, int v, int32 c)
 	if (vp->status == VOICE_DIE) {
 		if (c >= MAX_DIE_TIME)
 			c = MAX_DIE_TIME;
-		sp = resample_voice(v, &c);
-		if (do_voice_filter(v, sp, filter_buffer, c)) {sp = filter_buffer;}
+		sp = resample_voice(v, &c, &ms->rs);
+		if (do_voice_filter(v, sp, ms->filter_buffer, c)) {sp = ms->filter_buffer;}
 		if (c > 0)
 			ramp_out(sp, buf, v, c);
 		free_voice(v);
@@ -131,8 +148,8 @@ void mix_voice(int32 *buf, int v, int32 c)
 			c -= vp->delay;
 			vp->delay = 0;
 		}
-		sp = resample_voice(v, &c);
-		if (do_voice_filter(v, sp, filter_buffer, c)) {sp = filter_buffer;}
+		sp = resample_voice(v, &c, &ms->rs);
+		if (do_voice_filter(v, sp, ms->filter_buffer, c)) {sp = ms->filter_buffer;}
 
 		if (play_mode->encoding & PE_MONO) {
 			/* Mono output. */
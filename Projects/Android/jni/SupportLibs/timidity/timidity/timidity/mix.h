@@ -24,7 +24,10 @@
 
 #ifndef ___MIX_H_
 #define ___MIX_H_
-extern void mix_voice(int32 *, int, int32);
+/* scratch state of mix_voice(), one for each thread that mixes voices */
+typedef struct mix_scratch mix_scratch_t;
+extern mix_scratch_t *new_mix_scratch(void);
+extern void mix_voice(int32 *, int, int32, mix_scratch_t *);
 extern int recompute_envelope(int);
 extern int apply_envelope_to_amp(int);
 extern int recompute_modulation_envelope(int);
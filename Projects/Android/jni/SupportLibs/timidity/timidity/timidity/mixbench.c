@@ -0,0 +1,238 @@
+/*
+    TiMidity++ -- MIDI to WAVE converter and player
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    mixbench.c
+
+    Times the voice mixer (--mix-threads) on a dense 16 channel GS file.
+    Writes mixbench.mid to the current directory, renders it with each
+    thread count to mixbench_N.wav and checks that every rendering is
+    identical to the one of the first thread count.
+
+    Not part of the Android build; on a POSIX host, with a timidity built
+    from this tree:
+
+	cc -O2 -o mixbench mixbench.c
+	./mixbench "timidity -c timidity.cfg" 1 2 4 8
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define DIVISION 480
+#define BEATS 80
+#define MAX_EVENTS 65536
+
+typedef struct {
+    long tick;
+    int len;
+    unsigned char b[12];
+} Event;
+
+static Event events[MAX_EVENTS];
+static int nevents;
+static unsigned long seed = 1;
+
+static int rnd(int lo, int hi)
+{
+    seed = seed * 1103515245 + 12345;
+    return lo + (int)((seed >> 16) % (unsigned long)(hi - lo + 1));
+}
+
+static void add_event(long tick, int len, const unsigned char *b)
+{
+    if (nevents == MAX_EVENTS)
+	return;
+    events[nevents].tick = tick;
+    events[nevents].len = len;
+    memcpy(events[nevents].b, b, len);
+    nevents++;
+}
+
+static void add3(long tick, int a, int b, int c)
+{
+    unsigned char e[3];
+
+    e[0] = a; e[1] = b; e[2] = c;
+    add_event(tick, 3, e);
+}
+
+static int cmp_event(const void *a, const void *b)
+{
+    const Event *x = (const Event *)a, *y = (const Event *)b;
+
+    if (x->tick != y->tick)
+	return x->tick < y->tick ? -1 : 1;
+    return x < y ? -1 : 1;
+}
+
+static void put_vlq(FILE *fp, unsigned long n)
+{
+    unsigned char b[4];
+    int i = 0;
+
+    b[i++] = n & 0x7f;
+    while (n >>= 7)
+	b[i++] = (n & 0x7f) | 0x80;
+    while (i--)
+	putc(b[i], fp);
+}
+
+static void put_be(FILE *fp, unsigned long n, int bytes)
+{
+    while (bytes--)
+	putc((n >> (bytes * 8)) & 0xff, fp);
+}
+
+/* Up to seven notes per beat on most channels, with pitch bends,
+ * modulation, portamento and the reverb and chorus sends, so that
+ * all the resample_voice() paths get their share.
+ */
+static int write_midi(const char *name)
+{
+    static const unsigned char gs_reset[] =
+	{0xf0, 0x41, 0x10, 0x42, 0x12, 0x40, 0x00, 0x7f, 0x00, 0x41, 0xf7};
+    FILE *fp;
+    long t, last, start, length;
+    int ch, beat, k, s, i;
+
+    nevents = 0;
+    add_event(0, sizeof(gs_reset), gs_reset);
+    for (ch = 0; ch < 16; ch++) {
+	add3(0, 0xb0 | ch, 91, 40 + ch * 5);
+	add3(0, 0xb0 | ch, 93, ch * 8);
+	add3(0, 0xb0 | ch, 10, ch * 8);
+	if (ch % 4 == 1) {
+	    add3(0, 0xb0 | ch, 65, 127);
+	    add3(0, 0xb0 | ch, 5, 20);
+	}
+    }
+    for (beat = 0; beat < BEATS; beat++) {
+	t = (long)beat * DIVISION;
+	for (ch = 0; ch < 16; ch++) {
+	    if (rnd(0, 9) < 7)
+		for (k = rnd(3, 7); k > 0; k--) {
+		    int note = rnd(36, 84);
+		    long d = rnd(DIVISION / 2, 4 * DIVISION);
+
+		    add3(t + k * 7, 0x90 | ch, note, rnd(60, 127));
+		    add3(t + k * 7 + d, 0x80 | ch, note, 0);
+		}
+	    if (ch % 3 == 0)
+		for (s = 0; s < 8; s++) {
+		    int v = rnd(0, 16383);
+
+		    add3(t + s * 60, 0xe0 | ch, v & 0x7f, v >> 7);
+		}
+	    if (ch % 5 == 2)
+		add3(t, 0xb0 | ch, 1, rnd(0, 127));
+	}
+    }
+    qsort(events, nevents, sizeof(Event), cmp_event);
+
+    if ((fp = fopen(name, "wb")) == NULL) {
+	perror(name);
+	return -1;
+    }
+    fwrite("MThd", 1, 4, fp);
+    put_be(fp, 6, 4);
+    put_be(fp, 0, 2);
+    put_be(fp, 1, 2);
+    put_be(fp, DIVISION, 2);
+    fwrite("MTrk", 1, 4, fp);
+    start = ftell(fp);
+    put_be(fp, 0, 4);
+    for (i = 0, last = 0; i < nevents; i++) {
+	put_vlq(fp, events[i].tick - last);
+	last = events[i].tick;
+	if (events[i].b[0] == 0xf0) {
+	    putc(0xf0, fp);
+	    put_vlq(fp, events[i].len - 1);
+	    fwrite(events[i].b + 1, 1, events[i].len - 1, fp);
+	} else
+	    fwrite(events[i].b, 1, events[i].len, fp);
+    }
+    put_vlq(fp, DIVISION * 4);
+    fwrite("\xff\x2f\x00", 1, 3, fp);
+    length = ftell(fp) - start - 4;
+    fseek(fp, start, SEEK_SET);
+    put_be(fp, length, 4);
+    return fclose(fp);
+}
+
+static double now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/* returns 1 if the files have the same contents */
+static int same_file(const char *a, const char *b)
+{
+    FILE *fa = fopen(a, "rb"), *fb = fopen(b, "rb");
+    int ca, cb, same = fa != NULL && fb != NULL;
+
+    while (same) {
+	ca = getc(fa);
+	cb = getc(fb);
+	if (ca != cb)
+	    same = 0;
+	else if (ca == EOF)
+	    break;
+    }
+    if (fa != NULL)
+	fclose(fa);
+    if (fb != NULL)
+	fclose(fb);
+    return same;
+}
+
+int main(int argc, char *argv[])
+{
+    char cmd[1024], wav[64], first[64];
+    double t, t1 = 0;
+    int i, n, failed = 0;
+
+    if (argc < 3) {
+	fprintf(stderr, "usage: mixbench \"timidity [options]\" threads...\n");
+	return 2;
+    }
+    if (write_midi("mixbench.mid") != 0)
+	return 1;
+
+    printf("%8s %10s %8s %10s\n", "threads", "seconds", "speedup", "output");
+    for (i = 2; i < argc; i++) {
+	n = atoi(argv[i]);
+	sprintf(wav, "mixbench_%d.wav", n);
+	snprintf(cmd, sizeof(cmd), "%s -idqqq --mix-threads=%d -Ow -o %s mixbench.mid",
+		 argv[1], n, wav);
+	t = now();
+	if (system(cmd) != 0) {
+	    fprintf(stderr, "failed: %s\n", cmd);
+	    return 1;
+	}
+	t = now() - t;
+	if (i == 2) {
+	    strcpy(first, wav);
+	    t1 = t;
+	}
+	printf("%8d %10.3f %8.2f %10s\n", n, t, t1 / t,
+	       i == 2 ? "-" : same_file(first, wav) ? "identical" : "DIFFERENT");
+	if (i > 2 && !same_file(first, wav))
+	    failed = 1;
+    }
+    return failed;
+}
@@ -60,6 +60,9 @@
 #include "aq.h"
 #include "freq.h"
 #include "quantity.h"
+#ifdef ENABLE_MIX_THREADS
+#include <pthread.h>
+#endif /* ENABLE_MIX_THREADS */
 extern int convert_mod_to_midi_file(MidiEvent * ev);
 
 #define ABORT_AT_FATAL 1 /*#################*/
@@ -223,6 +226,7 @@ int opt_pan_delay = 0;	/* phase difference between left ear and right ear. */
 int opt_user_volume_curve = 0;
 int opt_default_module = MODULE_TIMIDITY_DEFAULT;
 int opt_preserve_silence = 1;
+int opt_mix_threads = 1;	/* number of threads mixing the voices */
 
 int voices=DEFAULT_VOICES, upper_voices;
 
@@ -6710,6 +6714,274 @@ static void mix_signal(int32 *dest, int32 *src, int32 count)
 	}
 }
 
+/* Per-voice state of the mixer: the buffer each voice is mixed into
+ * during this block, NULL if it isn't playing.
+ */
+static int32 **mix_vpb = NULL;
+static int mix_vpb_size = 0;
+static mix_scratch_t *mix_scratch = NULL;	/* of the calling thread */
+
+#ifdef ENABLE_MIX_THREADS
+/* Multithreaded voice mixing (--mix-threads).
+ *
+ * The voices of a channel share its controller state, and recompute_freq()
+ * even caches the pitch factor in the channel, so a channel is the unit of
+ * work: all its voices are mixed in order by the same thread.  The calling
+ * thread mixes straight into the output buffers, the workers into private
+ * int32 buffers which are added back once everybody is done.  Integer sums
+ * don't depend on the order, so the output is the same as with one thread.
+ * Note events are held back until then too, ctl->event() isn't reentrant.
+ */
+#define MIX_MIN_VOICES_PER_THREAD 8
+
+typedef struct {
+	pthread_t thread;
+	int generation;
+	int nbuf, maxbuf;
+	int32 **dest, **buf;	/* private buffer for each output buffer */
+	mix_scratch_t *scratch;
+} MixWorker;
+
+static MixWorker mix_worker[MAX_MIX_THREADS - 1];
+static int mix_nworkers = 0;
+static pthread_mutex_t mix_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t mix_wakeup = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t mix_finished = PTHREAD_COND_INITIALIZER;
+static int mix_generation = 0, mix_pending = 0, mix_quit = 0;
+static int mix_threads_busy = 0;
+
+static int8 *mix_note_events = NULL;	/* ctl_note_event()s held back */
+static int *mix_jobs = NULL;		/* voices sorted by channel */
+static int mix_unit_start[MAX_CHANNELS + 1];
+static int mix_unit_order[MAX_CHANNELS];
+static int mix_nunits, mix_next_unit;
+static int32 mix_count, mix_nbytes;
+
+static int32 *mix_worker_buffer(MixWorker *w, int32 *dest)
+{
+	int i;
+
+	for (i = 0; i < w->nbuf; i++)
+		if (w->dest[i] == dest)
+			return w->buf[i];
+	if (w->nbuf == w->maxbuf) {
+		w->maxbuf += 8;
+		w->dest = (int32 **) safe_realloc(w->dest, w->maxbuf * sizeof(int32 *));
+		w->buf = (int32 **) safe_realloc(w->buf, w->maxbuf * sizeof(int32 *));
+		for (i = w->nbuf; i < w->maxbuf; i++)
+			w->buf[i] = (int32 *) safe_malloc(AUDIO_BUFFER_SIZE * 8);
+	}
+	w->dest[w->nbuf] = dest;
+	memset(w->buf[w->nbuf], 0, mix_nbytes);
+	return w->buf[w->nbuf++];
+}
+
+/* w is NULL for the calling thread */
+static void mix_units(MixWorker *w)
+{
+	int u, j, v;
+	int32 *buf;
+
+	while ((u = __sync_fetch_and_add(&mix_next_unit, 1)) < mix_nunits) {
+		u = mix_unit_order[u];
+		for (j = mix_unit_start[u]; j < mix_unit_start[u + 1]; j++) {
+			v = mix_jobs[j];
+			buf = mix_vpb[v];
+			if (w != NULL)
+				mix_voice(mix_worker_buffer(w, buf), v, mix_count,
+						w->scratch);
+			else
+				mix_voice(buf, v, mix_count, mix_scratch);
+		}
+	}
+}
+
+static void *mix_thread(void *arg)
+{
+	MixWorker *w = (MixWorker *) arg;
+
+	pthread_mutex_lock(&mix_lock);
+	for (;;) {
+		while (w->generation == mix_generation && !mix_quit)
+			pthread_cond_wait(&mix_wakeup, &mix_lock);
+		if (mix_quit)
+			break;
+		w->generation = mix_generation;
+		pthread_mutex_unlock(&mix_lock);
+		mix_units(w);
+		pthread_mutex_lock(&mix_lock);
+		if (--mix_pending == 0)
+			pthread_cond_signal(&mix_finished);
+	}
+	pthread_mutex_unlock(&mix_lock);
+	return NULL;
+}
+
+/* returns 1 if the voices have been mixed, 0 if it isn't worth the bother */
+static int mix_voices_parallel(int uv, int32 count, int32 n)
+{
+	int i, j, ch, njobs, nthreads;
+	int size[MAX_CHANNELS];
+
+	if (opt_mix_threads <= 1)
+		return 0;
+
+	/* group the voices by channel, keeping their order */
+	memset(size, 0, sizeof(size));
+	for (i = njobs = 0; i < uv; i++)
+		if (mix_vpb[i] != NULL
+				&& !IS_SET_CHANNELMASK(channel_mute, voice[i].channel)) {
+			size[voice[i].channel]++;
+			njobs++;
+		}
+	mix_nunits = 0;
+	for (ch = j = 0; ch < MAX_CHANNELS; ch++) {
+		mix_unit_start[ch] = j;
+		j += size[ch];
+		if (size[ch] == 0)
+			continue;
+		/* biggest channels first, it evens out the load */
+		for (i = mix_nunits++; i > 0 && size[mix_unit_order[i - 1]] < size[ch]; i--)
+			mix_unit_order[i] = mix_unit_order[i - 1];
+		mix_unit_order[i] = ch;
+	}
+	mix_unit_start[MAX_CHANNELS] = j;
+
+	nthreads = opt_mix_threads;
+	if (nthreads > njobs / MIX_MIN_VOICES_PER_THREAD)
+		nthreads = njobs / MIX_MIN_VOICES_PER_THREAD;
+	if (nthreads > mix_nunits)
+		nthreads = mix_nunits;
+	while (mix_nworkers < nthreads - 1) {
+		MixWorker *w = &mix_worker[mix_nworkers];
+
+		w->generation = mix_generation;
+		w->scratch = new_mix_scratch();
+		if (pthread_create(&w->thread, NULL, mix_thread, w) != 0) {
+			free(w->scratch);
+			w->scratch = NULL;
+			break;
+		}
+		mix_nworkers++;
+	}
+	if (nthreads <= 1 || mix_nworkers == 0)
+		return 0;
+
+	for (i = 0; i < uv; i++)
+		if (mix_vpb[i] != NULL
+				&& !IS_SET_CHANNELMASK(channel_mute, voice[i].channel))
+			mix_jobs[mix_unit_start[voice[i].channel]++] = i;
+	for (ch = MAX_CHANNELS; ch > 0; ch--)
+		mix_unit_start[ch] = mix_unit_start[ch - 1];
+	mix_unit_start[0] = 0;
+	mix_count = count;
+	mix_nbytes = n;
+	mix_next_unit = 0;
+
+	pthread_mutex_lock(&mix_lock);
+	mix_threads_busy = 1;
+	mix_pending = mix_nworkers;
+	mix_generation++;
+	pthread_cond_broadcast(&mix_wakeup);
+	pthread_mutex_unlock(&mix_lock);
+
+	mix_units(NULL);
+
+	pthread_mutex_lock(&mix_lock);
+	while (mix_pending > 0)
+		pthread_cond_wait(&mix_finished, &mix_lock);
+	mix_threads_busy = 0;
+	pthread_mutex_unlock(&mix_lock);
+
+	for (i = 0; i < mix_nworkers; i++) {
+		MixWorker *w = &mix_worker[i];
+
+		for (j = 0; j < w->nbuf; j++)
+			mix_signal(w->dest[j], w->buf[j], n / 4);
+		w->nbuf = 0;
+	}
+	return 1;
+}
+#endif /* ENABLE_MIX_THREADS */
+
+/* Mix the voices into the buffers chosen in mix_vpb[], then get rid of the
+ * muted and finished ones.
+ */
+static void mix_voices(int uv, int32 count, int32 n)
+{
+	int i, mixed = 0;
+
+#ifdef ENABLE_MIX_THREADS
+	mixed = mix_voices_parallel(uv, count, n);
+#endif /* ENABLE_MIX_THREADS */
+	for (i = 0; i < uv; i++) {
+		if (mix_vpb[i] == NULL)
+			continue;
+		if (IS_SET_CHANNELMASK(channel_mute, voice[i].channel)) {
+			free_voice(i);
+			ctl_note_event(i);
+		} else if (! mixed)
+			mix_voice(mix_vpb[i], i, count, mix_scratch);
+#ifdef ENABLE_MIX_THREADS
+		for (; mix_note_events[i] > 0; mix_note_events[i]--)
+			ctl_note_event(i);
+#endif /* ENABLE_MIX_THREADS */
+		if (voice[i].timeout == 1 && voice[i].timeout < current_sample) {
+			free_voice(i);
+			ctl_note_event(i);
+		}
+	}
+}
+
+static void alloc_mix_voices(void)
+{
+	if (mix_scratch == NULL)
+		mix_scratch = new_mix_scratch();
+	if (mix_vpb_size >= max_voices)
+		return;
+	mix_vpb_size = max_voices;
+	mix_vpb = (int32 **) safe_realloc(mix_vpb, mix_vpb_size * sizeof(int32 *));
+#ifdef ENABLE_MIX_THREADS
+	mix_jobs = (int *) safe_realloc(mix_jobs, mix_vpb_size * sizeof(int));
+	mix_note_events = (int8 *) safe_realloc(mix_note_events, mix_vpb_size);
+	memset(mix_note_events, 0, mix_vpb_size);
+#endif /* ENABLE_MIX_THREADS */
+}
+
+void free_voice_mixer(void)
+{
+#ifdef ENABLE_MIX_THREADS
+	int i, j;
+
+	pthread_mutex_lock(&mix_lock);
+	mix_quit = 1;
+	pthread_cond_broadcast(&mix_wakeup);
+	pthread_mutex_unlock(&mix_lock);
+	for (i = 0; i < mix_nworkers; i++) {
+		MixWorker *w = &mix_worker[i];
+
+		pthread_join(w->thread, NULL);
+		for (j = 0; j < w->maxbuf; j++)
+			free(w->buf[j]);
+		free(w->buf);
+		free(w->dest);
+		free(w->scratch);
+		memset(w, 0, sizeof(MixWorker));
+	}
+	mix_nworkers = 0;
+	mix_quit = 0;
+	free(mix_jobs);
+	mix_jobs = NULL;
+	free(mix_note_events);
+	mix_note_events = NULL;
+#endif /* ENABLE_MIX_THREADS */
+	free(mix_vpb);
+	mix_vpb = NULL;
+	mix_vpb_size = 0;
+	free(mix_scratch);
+	mix_scratch = NULL;
+}
+
 #ifdef __BORLANDC__
 static int is_insertion_effect_xg(int ch)
 #else
@@ -6811,7 +7083,9 @@ static void do_compute_data_midi(int32 count)
 	}
 	if(voice!=NULL)
 	{
+	alloc_mix_voices();
 	for (i = 0; i < uv; i++) {
+		mix_vpb[i] = NULL;
 			if(voice[i].status!=(int)NULL)
 			{
 		if (voice[i].status != VOICE_FREE) {
@@ -6837,21 +7111,11 @@ static void do_compute_data_midi(int32 count)
 			} else {
 				vpb = buffer_pointer;
 			}
-
-			if(!IS_SET_CHANNELMASK(channel_mute, voice[i].channel)) {
-				mix_voice(vpb, i, count);
-			} else {
-				free_voice(i);
-				ctl_note_event(i);
-			}
-
-			if(voice[i].timeout == 1 && voice[i].timeout < current_sample) {
-				free_voice(i);
-				ctl_note_event(i);
-			}
+			mix_vpb[i] = vpb;
 		}
 		}
 	}
+	mix_voices(uv, count, n);
 	}
 
 	while(uv > 0 && voice[uv - 1].status == VOICE_FREE)	{uv--;}
@@ -7045,7 +7309,9 @@ static void do_compute_data_midi(int32 count)
 		if (chbufidx)
 			memset(reverb_buffer, 0, chbufidx);
 	}
-	for (i = 0; i < uv; i++)
+	alloc_mix_voices();
+	for (i = 0; i < uv; i++) {
+		mix_vpb[i] = NULL;
 		if (voice[i].status != VOICE_FREE) {
 			int32 *vpb;
 			
@@ -7056,17 +7322,10 @@ static void do_compute_data_midi(int32 count)
 				vc[ch] = 1;
 			} else
 				vpb = buffer_pointer;
-			if (! IS_SET_CHANNELMASK(channel_mute, voice[i].channel))
-				mix_voice(vpb, i, count);
-			else {
-				free_voice(i);
-				ctl_note_event(i);
-			}
-			if (voice[i].timeout == 1 && voice[i].timeout < current_sample) {
-				free_voice(i);
-				ctl_note_event(i);
-			}
+			mix_vpb[i] = vpb;
 		}
+	}
+	mix_voices(uv, count, n);
 
 	while (uv > 0 && voice[uv - 1].status == VOICE_FREE)
 		uv--;
@@ -8398,6 +8657,7 @@ static int play_midi(MidiEvent *eventlist, int32 samples)
 	if (midi_restart_time)    /* don't skip the first event if == 0 */
 	    current_event++;
     }
+    report_effect_cost();
 
     if(play_count++ > 3)
     {
@@ -8774,6 +9034,14 @@ void ctl_mode_event(int type, int trace, long arg1, long arg2)
 void ctl_note_event(int noteID)
 {
     CtlEvent ce;
+#ifdef ENABLE_MIX_THREADS
+    if(mix_threads_busy)
+    {
+	/* Sent by mix_voices() when the mixer threads are done */
+	mix_note_events[noteID]++;
+	return;
+    }
+#endif /* ENABLE_MIX_THREADS */
     ce.type = CTLE_NOTE;
     ce.v1 = voice[noteID].status;
     ce.v2 = voice[noteID].channel;
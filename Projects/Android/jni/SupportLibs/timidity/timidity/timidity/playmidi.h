@@ -475,6 +475,9 @@ typedef struct {
 
 #define ISDRUMCHANNEL(c)  IS_SET_CHANNELMASK(drumchannels, c)
 
+/* Upper limit of --mix-threads */
+#define MAX_MIX_THREADS 16
+
 extern Channel channel[];
 extern Voice *voice;
 
@@ -578,6 +581,7 @@ extern int opt_realtime_priority;	/* interface/alsaseq_c.c */
 extern int opt_sequencer_ports;		/* interface/alsaseq_c.c */
 extern int opt_user_volume_curve;
 extern int opt_pan_delay;
+extern int opt_mix_threads;
 
 extern int play_midi_file(char *fn);
 extern int dumb_pass_playing_list(int number_of_files, char *list_of_files[]);
@@ -596,6 +600,7 @@ extern void midi_program_change(int ch, int prog);
 extern void midi_volume_change(int ch, int vol);
 extern void free_voice(int v);
 extern void free_reverb_buffer(void);
+extern void free_voice_mixer(void);
 extern void play_midi_setup_drums(int ch,int note);
 
 /* For stream player */
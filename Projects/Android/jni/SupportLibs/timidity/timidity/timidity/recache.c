@@ -424,6 +424,7 @@ static int cache_resampling(struct cache_hash *p)
 	resrc.loop_start = ls = sp->loop_start;
 	resrc.loop_end = le = sp->loop_end;
 	resrc.data_length = sp->data_length;
+	resrc.newt = NULL;
 	ll = sp->loop_end - sp->loop_start;
 	dest = cache_data + cache_data_len;
 	src = sp->data;
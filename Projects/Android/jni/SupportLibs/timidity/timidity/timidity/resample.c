@@ -44,6 +44,44 @@
 #include "recache.h"
 
 
+/* 4-wide float vectors for the gauss resampler, through the GCC/clang
+   vector extensions, which become NEON on ARM and SSE on x86.  Older GCC
+   lacks __builtin_convertvector. */
+#if defined(__GNUC__) && !defined(LOOKUP_HACK) && \
+    (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__SSE2__)) && \
+    (defined(__clang__) || __GNUC__ >= 9)
+#define RESAMPLE_SIMD
+typedef float rs_v4sf __attribute__((vector_size(16)));
+typedef int32 rs_v4si __attribute__((vector_size(16)));
+typedef int16 rs_v4hi __attribute__((vector_size(8)));
+
+/* neither the samples nor the table rows are aligned */
+static inline rs_v4sf rs_v4sf_load(const float *p)
+{
+    rs_v4sf v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline rs_v4sf rs_v4sf_load_s(const sample_t *p)
+{
+#ifdef __SSE2__
+    /* SSE2 has no 4 x 16 bit vectors, GCC would convert them lane by lane */
+    rs_v4si v = {p[0], p[1], p[2], p[3]};
+#else
+    rs_v4hi v;
+    memcpy(&v, p, sizeof(v));
+#endif
+    return __builtin_convertvector(v, rs_v4sf);
+}
+
+static inline rs_v4sf rs_v4sf_splat(float f)
+{
+    rs_v4sf v = {f, f, f, f};
+    return v;
+}
+#endif /* RESAMPLE_SIMD */
+
 /* for start/end of samples */
 static float newt_coeffs[58][58] = {
 #include "newton_table.c"
@@ -92,9 +130,27 @@ static resample_t resample_cspline(sample_t *src, splen_t ofs, resample_rec_t *r
    just keep this labeled as resample_lagrange(), even if it really is the
    Newton form of the polynomial. */
 
+static inline resample_t lagrange_interp(int32 v0, int32 v1, int32 v2, int32 v3,
+					 int32 ofsf)
+{
+    ofsf += (1<<FRACTION_BITS);
+    v3 += -3*v2 + 3*v1 - v0;
+    v3 *= (ofsf - (2<<FRACTION_BITS)) / 6;
+    v3 >>= FRACTION_BITS;
+    v3 += v2 - v1 - v1 + v0;
+    v3 *= (ofsf - (1<<FRACTION_BITS)) >> 1;
+    v3 >>= FRACTION_BITS;
+    v3 += v1 - v0;
+    v3 *= ofsf;
+    v3 >>= FRACTION_BITS;
+    v3 += v0;
+    return ((v3 > sample_bounds_max) ? sample_bounds_max :
+	    ((v3 < sample_bounds_min) ? sample_bounds_min : v3));
+}
+
 static resample_t resample_lagrange(sample_t *src, splen_t ofs, resample_rec_t *rec)
 {
-    int32 ofsi, ofsf, v0, v1, v2, v3;
+    int32 ofsi, v1, v2;
 
     ofsi = ofs >> FRACTION_BITS;
     v1 = (int32)src[ofsi];
@@ -102,23 +158,9 @@ static resample_t resample_lagrange(sample_t *src, splen_t ofs, resample_rec_t *
     if((ofs<rec->loop_start+(1L<<FRACTION_BITS))||
        ((ofs+(2L<<FRACTION_BITS))>rec->loop_end)) {
 	return (v1 + ((resample_t)((v2 - v1) * (ofs & FRACTION_MASK)) >> FRACTION_BITS));
-    } else {
-	v0 = (int32)src[ofsi - 1];
-	v3 = (int32)src[ofsi + 2];
-	ofsf = (ofs & FRACTION_MASK) + (1<<FRACTION_BITS);
-	v3 += -3*v2 + 3*v1 - v0;
-	v3 *= (ofsf - (2<<FRACTION_BITS)) / 6;
-	v3 >>= FRACTION_BITS;
-	v3 += v2 - v1 - v1 + v0;
-	v3 *= (ofsf - (1<<FRACTION_BITS)) >> 1;
-	v3 >>= FRACTION_BITS;
-	v3 += v1 - v0;
-	v3 *= ofsf;
-	v3 >>= FRACTION_BITS;
-	v3 += v0;
-	return ((v3 > sample_bounds_max) ? sample_bounds_max :
-		((v3 < sample_bounds_min) ? sample_bounds_min : v3));
-    }
+    } else
+	return lagrange_interp((int32)src[ofsi - 1], v1, v2, (int32)src[ofsi + 2],
+			       ofs & FRACTION_MASK);
 }
 
 
@@ -149,6 +191,37 @@ static resample_t resample_lagrange(sample_t *src, splen_t ofs, resample_rec_t *
 static float *gauss_table[(1<<FRACTION_BITS)] = {0};	/* don't need doubles */
 static int gauss_n = DEFAULT_GAUSS_ORDER;
 
+/* The gauss_n + 1 point dot product.  It is summed as 4 interleaved
+   partial sums, which breaks up the dependency chain and is a 4-wide
+   vector multiply-add as is.  The scalar version adds up the same way, so
+   the output doesn't depend on RESAMPLE_SIMD. */
+
+static inline float gauss_sum(sample_t *sptr, float *gptr)
+{
+    int32 j, n = gauss_n + 1;
+    float y;
+#ifdef RESAMPLE_SIMD
+    rs_v4sf yv = rs_v4sf_splat(0);
+
+    for (j = 0; j + 4 <= n; j += 4)
+	yv += rs_v4sf_load_s(sptr + j) * rs_v4sf_load(gptr + j);
+    y = yv[0] + yv[1] + yv[2] + yv[3];
+#else
+    float y0 = 0, y1 = 0, y2 = 0, y3 = 0;
+
+    for (j = 0; j + 4 <= n; j += 4) {
+	y0 += sptr[j] * gptr[j];
+	y1 += sptr[j + 1] * gptr[j + 1];
+	y2 += sptr[j + 2] * gptr[j + 2];
+	y3 += sptr[j + 3] * gptr[j + 3];
+    }
+    y = y0 + y1 + y2 + y3;
+#endif
+    for (; j < n; j++)
+	y += sptr[j] * gptr[j];
+    return y;
+}
+
 static resample_t resample_gauss(sample_t *src, splen_t ofs, resample_rec_t *rec)
 {
     sample_t *sptr;
@@ -178,56 +251,14 @@ static resample_t resample_gauss(sample_t *src, splen_t ofs, resample_rec_t *rec
 	return ((y > sample_bounds_max) ? sample_bounds_max :
 		((y < sample_bounds_min) ? sample_bounds_min : y));
     } else {
-	float *gptr, *gend;
 	float y;
-	y = 0;
 	sptr = src + left - (gauss_n>>1);
-	gptr = gauss_table[ofs&FRACTION_MASK];
-	if (gauss_n == DEFAULT_GAUSS_ORDER) {
-	    /* expanding the loop for the default case.
-	     * this will allow intensive optimization when compiled
-	     * with SSE2 capability.
-	     */
-#define do_gauss  y += *(sptr++) * *(gptr++);
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    do_gauss;
-	    y += *sptr * *gptr;
-#undef do_gauss
-	} else {
-	    gend = gptr + gauss_n;
-	    do {
-		y += *(sptr++) * *(gptr++);
-	    } while (gptr <= gend);
-	}
+	y = gauss_sum(sptr, gauss_table[ofs&FRACTION_MASK]);
 	return ((y > sample_bounds_max) ? sample_bounds_max :
 		((y < sample_bounds_min) ? sample_bounds_min : y));
     }
 }
 
-
 /* (at least) n+1 point interpolation using Newton polynomials.
    n can be set with a command line option, and
    must be an odd number from 1 to 57 (57 is as high as double precision
@@ -237,10 +268,7 @@ static resample_t resample_gauss(sample_t *src, splen_t ofs, resample_rec_t *rec
    accuracy and save CPU. */
 
 static int newt_n = 11;
-static int32 newt_old_trunc_x = -1;
-static int newt_grow = -1;
 static int newt_max = 13;
-static double newt_divd[60][60];
 static double newt_recip[60] = { 0, 1, 1.0/2, 1.0/3, 1.0/4, 1.0/5, 1.0/6, 1.0/7,
 			1.0/8, 1.0/9, 1.0/10, 1.0/11, 1.0/12, 1.0/13, 1.0/14,
 			1.0/15, 1.0/16, 1.0/17, 1.0/18, 1.0/19, 1.0/20, 1.0/21,
@@ -250,7 +278,8 @@ static double newt_recip[60] = { 0, 1, 1.0/2, 1.0/3, 1.0/4, 1.0/5, 1.0/6, 1.0/7,
 			1.0/43, 1.0/44, 1.0/45, 1.0/46, 1.0/47, 1.0/48, 1.0/49,
 			1.0/50, 1.0/51, 1.0/52, 1.0/53, 1.0/54, 1.0/55, 1.0/56,
 			1.0/57, 1.0/58, 1.0/59 };
-static sample_t *newt_old_src = NULL;
+/* for the callers without a cache of their own, see resample_rec_t */
+static newton_cache_t newt_cache = { -1, -1, NULL };
 
 static resample_t resample_newton(sample_t *src, splen_t ofs, resample_rec_t *rec)
 {
@@ -260,6 +289,7 @@ static resample_t resample_newton(sample_t *src, splen_t ofs, resample_rec_t *re
     double y, xd;
     int32 left, right, temp_n;
     int ii, jj;
+    newton_cache_t *nc = rec->newt != NULL ? rec->newt : &newt_cache;
 
     left = (ofs>>FRACTION_BITS);
     right = (rec->data_length>>FRACTION_BITS)-(ofs>>FRACTION_BITS)-1;
@@ -280,44 +310,44 @@ static resample_t resample_newton(sample_t *src, splen_t ofs, resample_rec_t *re
 	    y *= xd - --ii;
 	} y += *sptr;
     }else{
-	if (newt_grow >= 0 && src == newt_old_src &&
-	    (diff = (ofs>>FRACTION_BITS) - newt_old_trunc_x) > 0){
-	    n_new = newt_n + ((newt_grow + diff)<<1);
+	if (nc->grow >= 0 && src == nc->old_src &&
+	    (diff = (ofs>>FRACTION_BITS) - nc->old_trunc_x) > 0){
+	    n_new = newt_n + ((nc->grow + diff)<<1);
 	    if (n_new <= newt_max){
-		n_old = newt_n + (newt_grow<<1);
-		newt_grow += diff;
+		n_old = newt_n + (nc->grow<<1);
+		nc->grow += diff;
 		for (v1=(ofs>>FRACTION_BITS)+(n_new>>1)+1,v2=n_new;
 		     v2 > n_old; --v1, --v2){
-		    newt_divd[0][v2] = src[v1];
+		    nc->divd[0][v2] = src[v1];
 		}for (v1 = 1; v1 <= n_new; v1++)
 		    for (v2 = n_new; v2 > n_old; --v2)
-			newt_divd[v1][v2] = (newt_divd[v1-1][v2] -
-					     newt_divd[v1-1][v2-1]) *
+			nc->divd[v1][v2] = (nc->divd[v1-1][v2] -
+					     nc->divd[v1-1][v2-1]) *
 			    newt_recip[v1];
-	    }else newt_grow = -1;
+	    }else nc->grow = -1;
 	}
-	if (newt_grow < 0 || src != newt_old_src || diff < 0){
-	    newt_grow = 0;
+	if (nc->grow < 0 || src != nc->old_src || diff < 0){
+	    nc->grow = 0;
 	    for (v1=(ofs>>FRACTION_BITS)-(newt_n>>1),v2=0;
 		 v2 <= newt_n; v1++, v2++){
-		newt_divd[0][v2] = src[v1];
+		nc->divd[0][v2] = src[v1];
 	    }for (v1 = 1; v1 <= newt_n; v1++)
 		for (v2 = newt_n; v2 >= v1; --v2)
-		    newt_divd[v1][v2] = (newt_divd[v1-1][v2] -
-					 newt_divd[v1-1][v2-1]) *
+		    nc->divd[v1][v2] = (nc->divd[v1-1][v2] -
+					 nc->divd[v1-1][v2-1]) *
 			newt_recip[v1];
 	}
-	n_new = newt_n + (newt_grow<<1);
+	n_new = newt_n + (nc->grow<<1);
 	v2 = n_new;
-	y = newt_divd[v2][v2];
+	y = nc->divd[v2][v2];
 	xd = (double)(ofs&FRACTION_MASK) / (1L<<FRACTION_BITS) +
-	    (newt_n>>1) + newt_grow;
+	    (newt_n>>1) + nc->grow;
 	for (--v2; v2; --v2){
 	    y *= xd - v2;
-	    y += newt_divd[v2][v2];
-	}y = y*xd + **newt_divd;
-	newt_old_src = src;
-	newt_old_trunc_x = (ofs>>FRACTION_BITS);
+	    y += nc->divd[v2][v2];
+	}y = y*xd + **nc->divd;
+	nc->old_src = src;
+	nc->old_trunc_x = (ofs>>FRACTION_BITS);
     }
     return ((y > sample_bounds_max) ? sample_bounds_max :
     	    ((y < sample_bounds_min) ? sample_bounds_min : y));
@@ -353,7 +383,6 @@ static resample_t resample_none(sample_t *src, splen_t ofs, resample_rec_t *rec)
 /*
  */
 
-typedef resample_t (*resampler_t)(sample_t*, splen_t, resample_rec_t *);
 static resampler_t resamplers[] = {
     resample_cspline,
     resample_lagrange,
@@ -369,11 +398,96 @@ static resampler_t resamplers[] = {
  * hope the compiler will optimize the overhead of function calls in this case.
  */
 #define cur_resample DEFAULT_RESAMPLATION
+#define voice_resample(rs) DEFAULT_RESAMPLATION
 #else
 static resampler_t cur_resample = DEFAULT_RESAMPLATION;
+/* the algorithm for the voice being mixed, see resample_voice() */
+#define voice_resample(rs) ((rs)->resampler)
 #endif
 
-#define RESAMPLATION *dest++ = cur_resample(src, ofs, &resrc);
+#define RESAMPLATION *dest++ = voice_resample(rs)(src, ofs, &resrc);
+
+/* Block versions of the resamplers: n output samples from ofs on, stepping
+   by incr, in a single call, so the inner loops below don't go through a
+   function pointer for every sample.  They compute the very same values as
+   the per-sample functions and return the new offset.
+
+   Only linear and lagrange have one, for the samples at unity pitch,
+   which they do in a straight loop over the data that the compiler can
+   vectorize.  Gauss and cspline spend their time in the arithmetic, not
+   in the call, so at any other increment a block version gains nothing
+   over calling them in a loop. */
+
+/* Lagrange falls back to linear within a sample of the loop points */
+static splen_t resample_lagrange_block(resample_t *dest, sample_t *src,
+				       splen_t ofs, int32 incr, int32 count,
+				       resample_rec_t *rec)
+{
+  int32 j = 0, n;
+
+  if (incr == (1 << FRACTION_BITS)) {
+    for (; j < count && ofs < rec->loop_start + (1L << FRACTION_BITS);
+	 j++, ofs += incr)
+      *dest++ = resample_lagrange(src, ofs, rec);
+    if (j < count && ofs + (2L << FRACTION_BITS) <= rec->loop_end) {
+      sample_t *sp = src + (ofs >> FRACTION_BITS);
+      int32 k, ofsf = ofs & FRACTION_MASK;
+      n = ((rec->loop_end - (2L << FRACTION_BITS) - ofs) >> FRACTION_BITS) + 1;
+      if (n > count - j)
+	n = count - j;
+      for (k = 0; k < n; k++)
+	dest[k] = lagrange_interp(sp[k - 1], sp[k], sp[k + 1], sp[k + 2], ofsf);
+      dest += n;
+      j += n;
+      ofs += (splen_t)n << FRACTION_BITS;
+    }
+  }
+  for (; j < count; j++, ofs += incr)
+    *dest++ = resample_lagrange(src, ofs, rec);
+  return ofs;
+}
+
+static splen_t resample_linear_block(resample_t *dest, sample_t *src,
+				     splen_t ofs, int32 incr, int32 count,
+				     resample_rec_t *rec)
+{
+  int32 j;
+
+#if !defined(LOOKUP_HACK) || !defined(LOOKUP_INTERPOLATION)
+  if (incr == (1 << FRACTION_BITS)) {
+    sample_t *sp = src + (ofs >> FRACTION_BITS);
+    splen_t ofsf = ofs & FRACTION_MASK;
+    for (j = 0; j < count; j++)
+      dest[j] = sp[j] + ((resample_t)((sp[j + 1] - sp[j]) * ofsf) >> FRACTION_BITS);
+    return ofs + ((splen_t)count << FRACTION_BITS);
+  }
+#endif
+  for (j = 0; j < count; j++, ofs += incr)
+    dest[j] = resample_linear(src, ofs, rec);
+  return ofs;
+}
+
+static splen_t resample_block(resampler_t resampler, resample_t *dest,
+			      sample_t *src, splen_t ofs, int32 incr,
+			      int32 count, resample_rec_t *rec)
+{
+  int32 j;
+
+  if (count <= 0)
+    return ofs;
+  if (resampler == resample_linear)
+    return resample_linear_block(dest, src, ofs, incr, count, rec);
+  if (resampler == resample_lagrange)
+    return resample_lagrange_block(dest, src, ofs, incr, count, rec);
+  for (j = 0; j < count; j++, ofs += incr)
+    dest[j] = resampler(src, ofs, rec);
+  return ofs;
+}
+
+/* RESAMPLATION for i samples in a row */
+#define RESAMPLATION_BLOCK(i) \
+  ofs = resample_block(voice_resample(rs), dest, src, ofs, incr, i, &resrc); \
+  if (i > 0) dest += i;
 
 /* exported for recache.c */
 resample_t do_resamplation(sample_t *src, splen_t ofs, resample_rec_t *rec)
@@ -408,10 +522,8 @@ int set_current_resampler(int type)
 #define FINALINTERP /* Nothing to do after TiMidity++ 2.9.0 */
 /* So it isn't interpolation. At least it's final. */
 
-static resample_t resample_buffer[AUDIO_BUFFER_SIZE];
-static int resample_buffer_offset;
-static resample_t *vib_resample_voice(int, int32 *, int);
-static resample_t *normal_resample_voice(int, int32 *, int);
+static resample_t *vib_resample_voice(int, int32 *, int, resample_scratch_t *);
+static resample_t *normal_resample_voice(int, int32 *, int, resample_scratch_t *);
 
 #ifdef PRECALC_LOOPS
 #if SAMPLE_LENGTH_BITS == 32 && TIMIDITY_HAVE_INT64
@@ -548,12 +660,22 @@ int set_resampler_parm(int val)
     return 0;
 }
 
+/* the parameter of the current algorithm, 0 if it has none */
+int get_resampler_parm(void)
+{
+    if (cur_resample == resample_gauss)
+	return gauss_n;
+    if (cur_resample == resample_newton)
+	return newt_n;
+    return 0;
+}
+
 /*************** resampling with fixed increment *****************/
 
-static resample_t *rs_plain_c(int v, int32 *countptr)
+static resample_t *rs_plain_c(int v, int32 *countptr, resample_scratch_t *rs)
 {
     Voice *vp = &voice[v];
-    resample_t *dest = resample_buffer + resample_buffer_offset;
+    resample_t *dest = rs->buffer + rs->buffer_offset;
 	sample_t *src = vp->sample->data;
     int32 ofs, count = *countptr, i, le;
 
@@ -576,14 +698,14 @@ static resample_t *rs_plain_c(int v, int32 *countptr)
 	*countptr = count;
     }
     vp->sample_offset = ((splen_t)ofs << FRACTION_BITS);
-    return resample_buffer + resample_buffer_offset;
+    return rs->buffer + rs->buffer_offset;
 }
 
-static resample_t *rs_plain(int v, int32 *countptr)
+static resample_t *rs_plain(int v, int32 *countptr, resample_scratch_t *rs)
 {
   /* Play sample until end, then free the voice. */
   Voice *vp = &voice[v];
-  resample_t *dest = resample_buffer + resample_buffer_offset;
+  resample_t *dest = rs->buffer + rs->buffer_offset;
   sample_t *src = vp->sample->data;
   splen_t
     ofs = vp->sample_offset,
@@ -592,15 +714,16 @@ static resample_t *rs_plain(int v, int32 *countptr)
   resample_rec_t resrc;
   int32 count = *countptr, incr = vp->sample_increment;
 #ifdef PRECALC_LOOPS
-  int32 i, j;
+  int32 i;
 #endif
 
   if(vp->cache && incr == (1 << FRACTION_BITS))
-      return rs_plain_c(v, countptr);
+      return rs_plain_c(v, countptr, rs);
 
   resrc.loop_start = ls;
   resrc.loop_end = le;
   resrc.data_length = vp->sample->data_length;
+  resrc.newt = &rs->newt;
 #ifdef PRECALC_LOOPS
   if (incr < 0) incr = -incr; /* In case we're coming out of a bidir loop */
 
@@ -615,11 +738,7 @@ static resample_t *rs_plain(int v, int32 *countptr)
     }
   else count -= i;
 
-  for(j = 0; j < i; j++)
-    {
-      RESAMPLATION;
-      ofs += incr;
-    }
+  RESAMPLATION_BLOCK(i);
 
   if (ofs >= le)
     {
@@ -643,16 +762,16 @@ static resample_t *rs_plain(int v, int32 *countptr)
 #endif /* PRECALC_LOOPS */
 
   vp->sample_offset = ofs; /* Update offset */
-  return resample_buffer + resample_buffer_offset;
+  return rs->buffer + rs->buffer_offset;
 }
 
-static resample_t *rs_loop_c(Voice *vp, int32 count)
+static resample_t *rs_loop_c(Voice *vp, int32 count, resample_scratch_t *rs)
 {
   int32
     ofs = (int32)(vp->sample_offset >> FRACTION_BITS),
     le = (int32)(vp->sample->loop_end >> FRACTION_BITS),
     ll = le - (int32)(vp->sample->loop_start >> FRACTION_BITS);
-  resample_t *dest = resample_buffer + resample_buffer_offset;
+  resample_t *dest = rs->buffer + rs->buffer_offset;
   sample_t *src = vp->sample->data;
   int32 i, j;
 
@@ -672,30 +791,31 @@ static resample_t *rs_loop_c(Voice *vp, int32 count)
       ofs += i;
   }
   vp->sample_offset = ((splen_t)ofs << FRACTION_BITS);
-  return resample_buffer + resample_buffer_offset;
+  return rs->buffer + rs->buffer_offset;
 }
 
-static resample_t *rs_loop(Voice *vp, int32 count)
+static resample_t *rs_loop(Voice *vp, int32 count, resample_scratch_t *rs)
 {
   /* Play sample until end-of-loop, skip back and continue. */
   splen_t
     ofs = vp->sample_offset,
     ls, le, ll;
   resample_rec_t resrc;
-  resample_t *dest = resample_buffer + resample_buffer_offset;
+  resample_t *dest = rs->buffer + rs->buffer_offset;
   sample_t *src = vp->sample->data;
 #ifdef PRECALC_LOOPS
-  int32 i, j;
+  int32 i;
 #endif
   int32 incr = vp->sample_increment;
 
   if(vp->cache && incr == (1 << FRACTION_BITS))
-      return rs_loop_c(vp, count);
+      return rs_loop_c(vp, count, rs);
 
   resrc.loop_start = ls = vp->sample->loop_start;
   resrc.loop_end = le = vp->sample->loop_end;
   ll = le - ls;
   resrc.data_length = vp->sample->data_length;
+  resrc.newt = &rs->newt;
 
 #ifdef PRECALC_LOOPS
   while (count)
@@ -707,10 +827,7 @@ static resample_t *rs_loop(Voice *vp, int32 count)
 		  i = count;
 		  count = 0;
 	  } else {count -= i;}
-      for(j = 0; j < i; j++) {
-		  RESAMPLATION;
-		  ofs += incr;
-	  }
+      RESAMPLATION_BLOCK(i);
     }
 #else
   while (count--)
@@ -723,10 +840,10 @@ static resample_t *rs_loop(Voice *vp, int32 count)
 #endif
 
   vp->sample_offset = ofs; /* Update offset */
-  return resample_buffer + resample_buffer_offset;
+  return rs->buffer + rs->buffer_offset;
 }
 
-static resample_t *rs_bidir(Voice *vp, int32 count)
+static resample_t *rs_bidir(Voice *vp, int32 count, resample_scratch_t *rs)
 {
 #if SAMPLE_LENGTH_BITS == 32
   int32
@@ -736,7 +853,7 @@ static resample_t *rs_bidir(Voice *vp, int32 count)
     ofs = vp->sample_offset,
     le = vp->sample->loop_end,
     ls = vp->sample->loop_start;
-  resample_t *dest = resample_buffer + resample_buffer_offset;
+  resample_t *dest = rs->buffer + rs->buffer_offset;
   sample_t *src = vp->sample->data;
   int32 incr = vp->sample_increment;
   resample_rec_t resrc;
@@ -749,12 +866,13 @@ static resample_t *rs_bidir(Voice *vp, int32 count)
 #endif
     le2 = le << 1,
     ls2 = ls << 1;
-  int32 i, j;
+  int32 i;
   /* Play normally until inside the loop region */
 
   resrc.loop_start = ls;
   resrc.loop_end = le;
   resrc.data_length = vp->sample->data_length;
+  resrc.newt = &rs->newt;
 
   if (incr > 0 && ofs < ls)
     {
@@ -768,11 +886,7 @@ static resample_t *rs_bidir(Voice *vp, int32 count)
 	  count = 0;
 	}
       else count -= i;
-      for(j = 0; j < i; j++)
-	{
-	  RESAMPLATION;
-	  ofs += incr;
-	}
+      RESAMPLATION_BLOCK(i);
     }
 
   /* Then do the bidirectional looping */
@@ -787,11 +901,7 @@ static resample_t *rs_bidir(Voice *vp, int32 count)
 	  count = 0;
 	}
       else count -= i;
-      for(j = 0; j < i; j++)
-	{
-	  RESAMPLATION;
-	  ofs += incr;
-	}
+      RESAMPLATION_BLOCK(i);
       if(ofs >= 0 && ofs >= le)
 	{
 	  /* fold the overshoot back in */
@@ -841,7 +951,7 @@ static resample_t *rs_bidir(Voice *vp, int32 count)
 #endif /* PRECALC_LOOPS */
   vp->sample_increment = incr;
   vp->sample_offset = ofs; /* Update offset */
-  return resample_buffer + resample_buffer_offset;
+  return rs->buffer + rs->buffer_offset;
 }
 
 /*********************** vibrato versions ***************************/
@@ -937,11 +1047,11 @@ static int32 update_vibrato(Voice *vp, int sign)
   return (int32) a;
 }
 
-static resample_t *rs_vib_plain(int v, int32 *countptr)
+static resample_t *rs_vib_plain(int v, int32 *countptr, resample_scratch_t *rs)
 {
   /* Play sample until end, then free the voice. */
   Voice *vp = &voice[v];
-  resample_t *dest = resample_buffer + resample_buffer_offset;
+  resample_t *dest = rs->buffer + rs->buffer_offset;
   sample_t *src = vp->sample->data;
   splen_t
     ls = 0,
@@ -955,6 +1065,7 @@ static resample_t *rs_vib_plain(int v, int32 *countptr)
   resrc.loop_start = ls;
   resrc.loop_end = le;
   resrc.data_length = vp->sample->data_length;
+  resrc.newt = &rs->newt;
   /* This has never been tested */
 
   if (incr < 0) incr = -incr; /* In case we're coming out of a bidir loop */
@@ -980,10 +1091,10 @@ static resample_t *rs_vib_plain(int v, int32 *countptr)
   vp->vibrato_control_counter = cc;
   vp->sample_increment = incr;
   vp->sample_offset = ofs; /* Update offset */
-  return resample_buffer + resample_buffer_offset;
+  return rs->buffer + rs->buffer_offset;
 }
 
-static resample_t *rs_vib_loop(Voice *vp, int32 count)
+static resample_t *rs_vib_loop(Voice *vp, int32 count, resample_scratch_t *rs)
 {
   /* Play sample until end-of-loop, skip back and continue. */
   splen_t
@@ -991,19 +1102,20 @@ static resample_t *rs_vib_loop(Voice *vp, int32 count)
     ls = vp->sample->loop_start,
     le = vp->sample->loop_end,
     ll = le - vp->sample->loop_start;
-  resample_t *dest = resample_buffer + resample_buffer_offset;
+  resample_t *dest = rs->buffer + rs->buffer_offset;
   sample_t *src = vp->sample->data;
   int cc = vp->vibrato_control_counter;
   int32 incr = vp->sample_increment;
   resample_rec_t resrc;
 #ifdef PRECALC_LOOPS
-  int32 i, j;
+  int32 i;
   int vibflag=0;
 #endif
 
   resrc.loop_start = ls;
   resrc.loop_end = le;
   resrc.data_length =vp->sample->data_length;
+  resrc.newt = &rs->newt;
 
 #ifdef PRECALC_LOOPS
   while (count)
@@ -1026,10 +1138,7 @@ static resample_t *rs_vib_loop(Voice *vp, int32 count)
 		  incr = update_vibrato(vp, 0);
 		  vibflag = 0;
 	  }
-      for(j = 0; j < i; j++) {
-		  RESAMPLATION;
-		  ofs += incr;
-	  }
+      RESAMPLATION_BLOCK(i);
     }
 #else /* PRECALC_LOOPS */
   while (count--)
@@ -1049,10 +1158,10 @@ static resample_t *rs_vib_loop(Voice *vp, int32 count)
   vp->vibrato_control_counter = cc;
   vp->sample_increment = incr;
   vp->sample_offset = ofs; /* Update offset */
-  return resample_buffer + resample_buffer_offset;
+  return rs->buffer + rs->buffer_offset;
 }
 
-static resample_t *rs_vib_bidir(Voice *vp, int32 count)
+static resample_t *rs_vib_bidir(Voice *vp, int32 count, resample_scratch_t *rs)
 {
 #if SAMPLE_LENGTH_BITS == 32
   int32
@@ -1062,7 +1171,7 @@ static resample_t *rs_vib_bidir(Voice *vp, int32 count)
     ofs = vp->sample_offset,
     le = vp->sample->loop_end,
     ls = vp->sample->loop_start;
-  resample_t *dest = resample_buffer + resample_buffer_offset;
+  resample_t *dest = rs->buffer + rs->buffer_offset;
   sample_t *src = vp->sample->data;
   int cc=vp->vibrato_control_counter;
   int32 incr = vp->sample_increment;
@@ -1082,6 +1191,7 @@ static resample_t *rs_vib_bidir(Voice *vp, int32 count)
   resrc.loop_start = ls;
   resrc.loop_end = le;
   resrc.data_length = vp->sample->data_length;
+  resrc.newt = &rs->newt;
   /* Play normally until inside the loop region */
   while (count && incr > 0 && ofs < ls)
     {
@@ -1150,6 +1260,7 @@ static resample_t *rs_vib_bidir(Voice *vp, int32 count)
   resrc.loop_start = ls;
   resrc.loop_end = le;
   resrc.data_length = vp->sample->data_length;
+  resrc.newt = &rs->newt;
   /* Play normally until inside the loop region */
 
   if (ofs < ls)
@@ -1198,7 +1309,7 @@ static resample_t *rs_vib_bidir(Voice *vp, int32 count)
   vp->vibrato_control_counter = cc;
   vp->sample_increment = incr;
   vp->sample_offset = ofs;
-  return resample_buffer + resample_buffer_offset;
+  return rs->buffer + rs->buffer_offset;
 }
 
 /*********************** portamento versions ***************************/
@@ -1232,11 +1343,12 @@ static int rs_update_porta(int v)
     return vp->porta_control_ratio;
 }
 
-static resample_t *porta_resample_voice(int v, int32 *countptr, int mode)
+static resample_t *porta_resample_voice(int v, int32 *countptr, int mode,
+					resample_scratch_t *rs)
 {
     Voice *vp = &voice[v];
     int32 n = *countptr, i;
-    resample_t *(* resampler)(int, int32 *, int);
+    resample_t *(* resampler)(int, int32 *, int, resample_scratch_t *);
     int cc = vp->porta_control_counter;
     int loop;
 
@@ -1250,67 +1362,68 @@ static resample_t *porta_resample_voice(int v, int32 *countptr, int mode)
 	loop = 0;
 
     vp->cache = NULL;
-    resample_buffer_offset = 0;
-    while(resample_buffer_offset < n)
+    rs->buffer_offset = 0;
+    while(rs->buffer_offset < n)
     {
 	if(cc == 0)
 	{
 	    if((cc = rs_update_porta(v)) == 0)
 	    {
-		i = n - resample_buffer_offset;
-		resampler(v, &i, mode);
-		resample_buffer_offset += i;
+		i = n - rs->buffer_offset;
+		resampler(v, &i, mode, rs);
+		rs->buffer_offset += i;
 		break;
 	    }
 	}
 
-	i = n - resample_buffer_offset;
+	i = n - rs->buffer_offset;
 	if(i > cc)
 	    i = cc;
-	resampler(v, &i, mode);
-	resample_buffer_offset += i;
+	resampler(v, &i, mode, rs);
+	rs->buffer_offset += i;
 
 	if(!loop && (i == 0 || vp->status == VOICE_FREE))
 	    break;
 	cc -= i;
     }
-    *countptr = resample_buffer_offset;
-    resample_buffer_offset = 0;
+    *countptr = rs->buffer_offset;
+    rs->buffer_offset = 0;
     vp->porta_control_counter = cc;
-    return resample_buffer;
+    return rs->buffer;
 }
 
 /* interface function */
-static resample_t *vib_resample_voice(int v, int32 *countptr, int mode)
+static resample_t *vib_resample_voice(int v, int32 *countptr, int mode,
+					resample_scratch_t *rs)
 {
     Voice *vp = &voice[v];
 
     vp->cache = NULL;
     if(mode == 0)
-	return rs_vib_loop(vp, *countptr);
+	return rs_vib_loop(vp, *countptr, rs);
     if(mode == 1)
-	return rs_vib_plain(v, countptr);
-    return rs_vib_bidir(vp, *countptr);
+	return rs_vib_plain(v, countptr, rs);
+    return rs_vib_bidir(vp, *countptr, rs);
 }
 
 /* interface function */
-static resample_t *normal_resample_voice(int v, int32 *countptr, int mode)
+static resample_t *normal_resample_voice(int v, int32 *countptr, int mode,
+					resample_scratch_t *rs)
 {
     Voice *vp = &voice[v];
     if(mode == 0)
-	return rs_loop(vp, *countptr);
+	return rs_loop(vp, *countptr, rs);
     if(mode == 1)
-	return rs_plain(v, countptr);
-    return rs_bidir(vp, *countptr);
+	return rs_plain(v, countptr, rs);
+    return rs_bidir(vp, *countptr, rs);
 }
 
 /* interface function */
-resample_t *resample_voice(int v, int32 *countptr)
+resample_t *resample_voice(int v, int32 *countptr, resample_scratch_t *rs)
 {
     Voice *vp = &voice[v];
     int mode;
     resample_t *result;
-    resampler_t saved_resample;
 	int32 i;
 
     if(vp->sample->sample_rate == play_mode->rate &&
@@ -1335,9 +1448,9 @@ resample_t *resample_voice(int v, int32 *countptr)
 	    vp->sample_offset += *countptr << FRACTION_BITS;
 
 	for (i = 0; i < *countptr; i++) {
-		resample_buffer[i] = vp->sample->data[i + ofs];
+		rs->buffer[i] = vp->sample->data[i + ofs];
 	}
-	return resample_buffer;
+	return rs->buffer;
     }
 
     mode = vp->sample->modes;
@@ -1356,21 +1469,21 @@ resample_t *resample_voice(int v, int32 *countptr)
     else
 	mode = 1;	/* no loop */
 
-    saved_resample = cur_resample;
 #ifndef FIXED_RESAMPLATION
+    rs->resampler = cur_resample;
     if (reduce_quality_flag && cur_resample != resample_none)
-	cur_resample = resample_linear;
+	rs->resampler = resample_linear;
 #endif
+    /* Don't let the Newton cache carry over from another voice, so the
+       result doesn't depend on the order (or thread) the voices are mixed in */
+    rs->newt.old_src = NULL;
     if(vp->porta_control_ratio)
-	result = porta_resample_voice(v, countptr, mode);
+	result = porta_resample_voice(v, countptr, mode, rs);
     else if(vp->vibrato_control_ratio)
-	result = vib_resample_voice(v, countptr, mode);
+	result = vib_resample_voice(v, countptr, mode, rs);
     else
-	result = normal_resample_voice(v, countptr, mode);
+	result = normal_resample_voice(v, countptr, mode, rs);
 
-#ifndef FIXED_RESAMPLATION
-    cur_resample = saved_resample; /* get back */
-#endif
     return result;
 }
 
@@ -1416,6 +1529,7 @@ void pre_resample(Sample * sp)
   resrc.loop_start = 0;
   resrc.loop_end = sp->data_length;
   resrc.data_length = sp->data_length;
+  resrc.newt = NULL;
 
   /* Since we're pre-processing and this doesn't have to be done in
      real-time, we go ahead and do the higher order interpolation. */
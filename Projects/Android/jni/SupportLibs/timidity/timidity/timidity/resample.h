@@ -42,17 +42,39 @@ extern int get_current_resampler(void);
 extern int set_current_resampler(int type);
 extern void initialize_resampler_coeffs(void);
 extern int set_resampler_parm(int val);
+extern int get_resampler_parm(void);
 extern void free_gauss_table(void);
 
+/* what the Newton resampler keeps from one sample to the next */
+typedef struct newton_cache {
+	int32 old_trunc_x;
+	int grow;
+	sample_t *old_src;
+	double divd[60][60];
+} newton_cache_t;
+
 typedef struct resample_rec {
 	splen_t loop_start;
 	splen_t loop_end;
 	splen_t data_length;
+	newton_cache_t *newt;	/* NULL to use a shared one */
 } resample_rec_t;
 
+typedef resample_t (*resampler_t)(sample_t*, splen_t, resample_rec_t *);
+
+/* Scratch state of resample_voice().  Voices may be mixed on several
+   threads at once (see mix_voices() in playmidi.c), each thread passes
+   its own. */
+typedef struct resample_scratch {
+	resample_t buffer[AUDIO_BUFFER_SIZE];
+	int32 buffer_offset;
+	resampler_t resampler;	/* for the voice being mixed */
+	newton_cache_t newt;
+} resample_scratch_t;
+
 extern resample_t do_resamplation(sample_t *src, splen_t ofs, resample_rec_t *rec);
 
-extern resample_t *resample_voice(int v, int32 *countptr);
+extern resample_t *resample_voice(int v, int32 *countptr, resample_scratch_t *rs);
 extern void pre_resample(Sample *sp);
 
 #endif /* ___RESAMPLE_H_ */
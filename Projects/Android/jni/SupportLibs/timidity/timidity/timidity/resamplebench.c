@@ -0,0 +1,226 @@
+/*
+    TiMidity++ -- MIDI to WAVE converter and player
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    resamplebench.c
+
+    Checks the block resamplers of resample.c against the per-sample
+    functions they replace, over random offsets, increments and lengths,
+    then times both.  Also reports how far the 4 partial sums of the gauss
+    kernel are from the plain sequential sum it used to do.  Exits 1 if a
+    block resampler gives a different sample or end offset.
+
+    Not part of the Android build; resample.c is compiled in, the rest of
+    the player is stubbed out.  On a host, from this directory:
+
+	cc -O2 -DHAVE_CONFIG_H -I. -I.. -I../utils -I../libarc \
+	    -o resamplebench resamplebench.c -lm
+	./resamplebench
+*/
+
+#include "resample.c"
+#include <sys/time.h>
+
+/* the parts of the player resample.c refers to */
+static PlayMode bench_play_mode;
+PlayMode *play_mode = &bench_play_mode;
+ControlMode *ctl = NULL;
+Voice *voice = NULL;
+Channel channel[MAX_CHANNELS];
+int reduce_quality_flag = 0;
+int32 freq_table[128];
+FLOAT_T bend_fine[1], bend_coarse[1];
+const char *note_name[] = {"C", "C#", "D", "D#", "E", "F",
+			   "F#", "G", "G#", "A", "A#", "B"};
+void recompute_freq(int v) {}
+int32 get_note_freq(Sample *sp, int note) { return 0; }
+#ifndef lookup_sine
+FLOAT_T lookup_sine(int x) { return 0; }
+#endif
+FLOAT_T lookup_triangular(int x) { return 0; }
+void *safe_malloc(size_t count) { return malloc(count ? count : 1); }
+void *safe_realloc(void *p, size_t n) { return realloc(p, n ? n : 1); }
+
+#define DATA_LEN 20000
+#define TRIALS 20000
+#define TIMED_RUNS 3000
+
+static sample_t data[DATA_LEN + 8];
+static resample_t per_sample[AUDIO_BUFFER_SIZE], block[AUDIO_BUFFER_SIZE];
+
+static struct {
+    const char *name;
+    resampler_t resampler;
+} kinds[] = {
+    {"cspline", resample_cspline},
+    {"lagrange", resample_lagrange},
+    {"gauss", resample_gauss},
+    {"newton", resample_newton},
+    {"linear", resample_linear},
+    {"none", resample_none},
+};
+#define NKINDS (int)(sizeof(kinds) / sizeof(kinds[0]))
+
+static double now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/* the gauss kernel as it was, summing the taps in order */
+static resample_t sequential_gauss(sample_t *src, splen_t ofs,
+				   resample_rec_t *rec)
+{
+    int32 left = ofs >> FRACTION_BITS,
+	right = (rec->data_length >> FRACTION_BITS) - left - 1,
+	temp_n = (right << 1) - 1;
+    sample_t *sptr;
+    float *gptr, y = 0;
+    int j;
+
+    if (temp_n > (left << 1) + 1)
+	temp_n = (left << 1) + 1;
+    if (temp_n < gauss_n)
+	return resample_gauss(src, ofs, rec);
+    sptr = src + left - (gauss_n >> 1);
+    gptr = gauss_table[ofs & FRACTION_MASK];
+    for (j = 0; j <= gauss_n; j++)
+	y += sptr[j] * gptr[j];
+    return ((y > sample_bounds_max) ? sample_bounds_max :
+	    ((y < sample_bounds_min) ? sample_bounds_min : y));
+}
+
+/* the Newton cache carries over between calls, start both runs afresh */
+static void reset_newton(resample_rec_t *rec)
+{
+    rec->newt->old_src = NULL;
+    rec->newt->grow = -1;
+}
+
+/* per-sample loop the way rs_* used to run it */
+static splen_t run_per_sample(resampler_t resampler, resample_t *dest,
+			      splen_t ofs, int32 incr, int32 count,
+			      resample_rec_t *rec)
+{
+    int32 i;
+
+    for (i = 0; i < count; i++, ofs += incr)
+	dest[i] = resampler(data, ofs, rec);
+    return ofs;
+}
+
+int main(int argc, char *argv[])
+{
+    static newton_cache_t newt;
+    resample_rec_t rec;
+    int k, t, u, mismatches = 0, gauss_diff = 0, gauss_max = 0;
+    long gauss_total = 0;
+    int32 i, incr, count;
+    splen_t ofs, end_ps, end_blk;
+    double t0, t1, t2;
+
+    sample_bounds_min = -32768;
+    sample_bounds_max = 32767;
+    initialize_gauss_table(gauss_n);
+    srand(1);
+    for (i = 0; i < DATA_LEN; i++)
+	data[i] = (sample_t)(sin(i * 0.05) * 20000 + (rand() % 8000 - 4000));
+    rec.loop_start = (splen_t)1000 << FRACTION_BITS;
+    rec.loop_end = (splen_t)(DATA_LEN - 2000) << FRACTION_BITS;
+    rec.data_length = (splen_t)DATA_LEN << FRACTION_BITS;
+    rec.newt = &newt;
+
+    /* accuracy: unity pitch on every other trial, since the block versions
+       have a separate path for it, and every 7th close to the start of the
+       data, where the kernels run short of samples on the left */
+    for (k = 0; k < NKINDS; k++) {
+	int bad = 0;
+
+	for (t = 0; t < TRIALS; t++) {
+	    incr = (t & 1) ? (1 << FRACTION_BITS) : 500 + rand() % 12000;
+	    count = rand() % 1024;
+	    ofs = (splen_t)(rand() % ((DATA_LEN - 2)
+			- (int32)((int64)count * incr >> FRACTION_BITS) - 4))
+		<< FRACTION_BITS | (rand() & FRACTION_MASK);
+	    if (t % 7 == 0)
+		ofs &= ((splen_t)40 << FRACTION_BITS) - 1;
+
+	    reset_newton(&rec);
+	    end_ps = run_per_sample(kinds[k].resampler, per_sample,
+				    ofs, incr, count, &rec);
+	    reset_newton(&rec);
+	    end_blk = resample_block(kinds[k].resampler, block, data,
+				     ofs, incr, count, &rec);
+	    if (end_ps != end_blk)
+		bad++;
+	    for (i = 0; i < count; i++)
+		if (per_sample[i] != block[i]) {
+		    if (bad++ < 5)
+			printf("%s: trial %d sample %d incr %d: %d != %d\n",
+			       kinds[k].name, t, i, incr,
+			       per_sample[i], block[i]);
+		}
+
+	    if (kinds[k].resampler == resample_gauss)
+		for (i = 0; i < count; i++) {
+		    int d = abs(sequential_gauss(data, ofs + i * incr, &rec)
+				- per_sample[i]);
+
+		    gauss_total++;
+		    if (d != 0) {
+			gauss_diff++;
+			if (d > gauss_max)
+			    gauss_max = d;
+		    }
+		}
+	}
+	printf("%-8s %s\n", kinds[k].name, bad ? "MISMATCH" : "identical");
+	mismatches += bad;
+    }
+    printf("gauss vs sequential sum: %d of %ld samples differ, by at most %d\n",
+	   gauss_diff, gauss_total, gauss_max);
+
+    /* speed, ns per output sample */
+    printf("\n%-9s %6s %12s %12s\n", "", "incr", "per-sample", "block");
+    for (k = 0; k < NKINDS; k++)
+	for (u = 0; u < 2; u++) {
+	    incr = u ? (1 << FRACTION_BITS) : 3571;
+	    ofs = (splen_t)20 << FRACTION_BITS;
+	    t0 = now();
+	    for (t = 0; t < TIMED_RUNS; t++)
+		run_per_sample(kinds[k].resampler, per_sample,
+			       ofs, incr, AUDIO_BUFFER_SIZE, &rec);
+	    t1 = now();
+	    for (t = 0; t < TIMED_RUNS; t++)
+		resample_block(kinds[k].resampler, block, data,
+			       ofs, incr, AUDIO_BUFFER_SIZE, &rec);
+	    t2 = now();
+	    printf("%-9s %6s %12.2f %12.2f\n", kinds[k].name,
+		   u ? "unity" : "3571",
+		   (t1 - t0) / TIMED_RUNS / AUDIO_BUFFER_SIZE * 1e9,
+		   (t2 - t1) / TIMED_RUNS / AUDIO_BUFFER_SIZE * 1e9);
+	}
+    for (u = 0; u < 2; u++) {
+	incr = u ? (1 << FRACTION_BITS) : 3571;
+	ofs = (splen_t)20 << FRACTION_BITS;
+	t0 = now();
+	for (t = 0; t < TIMED_RUNS; t++)
+	    run_per_sample(sequential_gauss, per_sample,
+			   ofs, incr, AUDIO_BUFFER_SIZE, &rec);
+	t1 = now();
+	printf("%-9s %6s %12.2f %12s\n", "gauss/seq", u ? "unity" : "3571",
+	       (t1 - t0) / TIMED_RUNS / AUDIO_BUFFER_SIZE * 1e9, "-");
+    }
+    return mismatches ? 1 : 0;
+}
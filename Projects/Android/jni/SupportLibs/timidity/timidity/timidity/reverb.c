@@ -44,6 +44,7 @@
 #define REVERB_PRIVATE 1
 #include "reverb.h"
 #include "mt19937ar.h"
+#include "timer.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -57,10 +58,96 @@
 
 FLOAT_T reverb_predelay_factor = 1.0;
 
+/* Run the GS system effects (Freeverb, stereo chorus, delay, EQ)
+   in floating-point instead of fixed-point.  The output is close to
+   the fixed-point one, not the same: within 0.1 LSB of 16-bit output
+   for Freeverb, chorus and delay, and up to 1.4 LSB for the EQ at
+   full boost, mostly from the truncation in the fixed-point filters.
+   effecttest.c measures it. */
+int opt_float_effect = 0;
+
 static double REV_INP_LEV = 1.0;
 #define MASTER_CHORUS_LEVEL 1.7
 #define MASTER_DELAY_LEVEL 3.25
 
+/* 4-wide float vectors for the floating-point Freeverb, through the
+   GCC/clang vector extensions, which become NEON on ARM and SSE on x86 */
+#if defined(__GNUC__) && numcombs == 8 && \
+    (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__SSE2__))
+#define REVERB_SIMD
+typedef float rv_v4sf __attribute__((vector_size(16)));
+
+/* the stretches of the delay lines aren't aligned */
+static inline rv_v4sf rv_v4sf_load(const float *p)
+{
+	rv_v4sf v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline void rv_v4sf_store(float *p, rv_v4sf v)
+{
+	memcpy(p, &v, sizeof(v));
+}
+
+static inline rv_v4sf rv_v4sf_splat(float f)
+{
+	rv_v4sf v = {f, f, f, f};
+	return v;
+}
+#endif /* REVERB_SIMD */
+
+/* Added to the input of the floating-point effects, so that their
+   decaying tails level off instead of running into denormals */
+#define ANTI_DENORMAL 1.0e-18f
+
+/*                      */
+/*  System Effect Cost  */
+/*                      */
+enum {
+	EFFECT_COST_EQ,
+	EFFECT_COST_CHORUS,
+	EFFECT_COST_DELAY,
+	EFFECT_COST_REVERB,
+	EFFECT_COST_MAX
+};
+
+static struct {
+	double time;	/* in seconds */
+	int64 count;	/* in samples */
+} effect_cost[EFFECT_COST_MAX];
+
+/* The system effects are only timed when the result will be shown */
+static inline double effect_cost_start(void)
+{
+	return (ctl->verbosity >= VERB_VERBOSE) ? get_current_calender_time() : 0;
+}
+
+static inline void effect_cost_end(int type, double start, int32 count)
+{
+	if (start == 0) {return;}
+	effect_cost[type].time += get_current_calender_time() - start;
+	effect_cost[type].count += count;
+}
+
+/*! print the time spent in each system effect since the last call */
+void report_effect_cost(void)
+{
+	static const char *name[EFFECT_COST_MAX] = {"EQ", "Chorus", "Delay", "Reverb"};
+	int i;
+	double sec;
+
+	for (i = 0; i < EFFECT_COST_MAX; i++) {
+		if (effect_cost[i].count == 0) {continue;}
+		sec = (double)effect_cost[i].count / 2 / play_mode->rate;
+		ctl->cmsg(CMSG_INFO, VERB_VERBOSE,
+			"%s effect (%s): %.3f sec, %.2f%% of %.1f sec",
+			name[i], opt_float_effect ? "float" : "fixed",
+			effect_cost[i].time, effect_cost[i].time * 100.0 / sec, sec);
+	}
+	memset(effect_cost, 0, sizeof(effect_cost));
+}
+
 /*              */
 /*  Dry Signal  */
 /*              */
@@ -211,6 +298,10 @@ static void free_delay(simple_delay *delay)
 		free(delay->buf);
 		delay->buf = NULL;
 	}
+	if(delay->fbuf != NULL) {
+		free(delay->fbuf);
+		delay->fbuf = NULL;
+	}
 }
 
 static void set_delay(simple_delay *delay, int32 size)
@@ -224,6 +315,18 @@ static void set_delay(simple_delay *delay, int32 size)
 	memset(delay->buf, 0, sizeof(int32) * delay->size);
 }
 
+/*! the delay line of the opt_float_effect versions */
+static void set_delay_float(simple_delay *delay, int32 size)
+{
+	if(size < 1) {size = 1;}
+	free_delay(delay);
+	delay->fbuf = (float *)safe_malloc(sizeof(float) * size);
+	if(delay->fbuf == NULL) {return;}
+	delay->index = 0;
+	delay->size = size;
+	memset(delay->fbuf, 0, sizeof(float) * delay->size);
+}
+
 static inline void do_delay(int32 *stream, int32 *buf, int32 size, int32 *index)
 {
 	int32 output;
@@ -705,6 +808,8 @@ void init_filter_shelving(filter_shelving *p)
 {
 	p->x1l = 0, p->x2l = 0, p->y1l = 0, p->y2l = 0, p->x1r = 0,
 		p->x2r = 0, p->y1r = 0, p->y2r = 0;
+	p->fx1l = 0, p->fx2l = 0, p->fy1l = 0, p->fy2l = 0, p->fx1r = 0,
+		p->fx2r = 0, p->fy1r = 0, p->fy2r = 0;
 }
 
 /*! shelving filter */
@@ -1320,39 +1425,74 @@ void reverb_rc_event(int rc, int32 val)
 /*             */
 /*  Freeverb   */
 /*             */
-static void set_freeverb_allpass(allpass *allpass, int32 size)
+static void free_freeverb_allpass(allpass *allpass)
 {
 	if(allpass->buf != NULL) {
 		free(allpass->buf);
 		allpass->buf = NULL;
 	}
-	allpass->buf = (int32 *)safe_malloc(sizeof(int32) * size);
-	if(allpass->buf == NULL) {return;}
+	if(allpass->fbuf != NULL) {
+		free(allpass->fbuf);
+		allpass->fbuf = NULL;
+	}
+}
+
+static void set_freeverb_allpass(allpass *allpass, int32 size)
+{
+	free_freeverb_allpass(allpass);
+	if(opt_float_effect) {
+		allpass->fbuf = (float *)safe_malloc(sizeof(float) * size);
+		if(allpass->fbuf == NULL) {return;}
+	} else {
+		allpass->buf = (int32 *)safe_malloc(sizeof(int32) * size);
+		if(allpass->buf == NULL) {return;}
+	}
 	allpass->index = 0;
 	allpass->size = size;
 }
 
 static void init_freeverb_allpass(allpass *allpass)
 {
-	memset(allpass->buf, 0, sizeof(int32) * allpass->size);
+	if(allpass->fbuf != NULL)
+		memset(allpass->fbuf, 0, sizeof(float) * allpass->size);
+	else
+		memset(allpass->buf, 0, sizeof(int32) * allpass->size);
 }
 
-static void set_freeverb_comb(comb *comb, int32 size)
+static void free_freeverb_comb(comb *comb)
 {
 	if(comb->buf != NULL) {
 		free(comb->buf);
 		comb->buf = NULL;
 	}
-	comb->buf = (int32 *)safe_malloc(sizeof(int32) * size);
-	if(comb->buf == NULL) {return;}
+	if(comb->fbuf != NULL) {
+		free(comb->fbuf);
+		comb->fbuf = NULL;
+	}
+}
+
+static void set_freeverb_comb(comb *comb, int32 size)
+{
+	free_freeverb_comb(comb);
+	if(opt_float_effect) {
+		comb->fbuf = (float *)safe_malloc(sizeof(float) * size);
+		if(comb->fbuf == NULL) {return;}
+	} else {
+		comb->buf = (int32 *)safe_malloc(sizeof(int32) * size);
+		if(comb->buf == NULL) {return;}
+	}
 	comb->index = 0;
 	comb->size = size;
 	comb->filterstore = 0;
+	comb->filterstoref = 0;
 }
 
 static void init_freeverb_comb(comb *comb)
 {
-	memset(comb->buf, 0, sizeof(int32) * comb->size);
+	if(comb->fbuf != NULL)
+		memset(comb->fbuf, 0, sizeof(float) * comb->size);
+	else
+		memset(comb->buf, 0, sizeof(int32) * comb->size);
 }
 
 FLOAT_T freeverb_scaleroom = 0.28;
@@ -1503,25 +1643,13 @@ static void free_freeverb_buf(InfoFreeverb *rev)
 	
 	for(i = 0; i < numcombs; i++)
 	{
-		if(rev->combL[i].buf != NULL) {
-			free(rev->combL[i].buf);
-			rev->combL[i].buf = NULL;
-		}
-		if(rev->combR[i].buf != NULL) {
-			free(rev->combR[i].buf);
-			rev->combR[i].buf = NULL;
-		}
+		free_freeverb_comb(&rev->combL[i]);
+		free_freeverb_comb(&rev->combR[i]);
 	}
 	for(i = 0; i < numallpasses; i++)
 	{
-		if(rev->allpassL[i].buf != NULL) {
-			free(rev->allpassL[i].buf);
-			rev->allpassL[i].buf = NULL;
-		}
-		if(rev->allpassR[i].buf != NULL) {
-			free(rev->allpassR[i].buf);
-			rev->allpassR[i].buf = NULL;
-		}
+		free_freeverb_allpass(&rev->allpassL[i]);
+		free_freeverb_allpass(&rev->allpassR[i]);
 	}
 	free_delay(&(rev->pdelay));
 }
@@ -1547,6 +1675,167 @@ static inline void do_freeverb_comb(int32 input, int32 *stream, int32 *buf, int3
 	*stream += output;
 }
 
+/*! Freeverb in floating-point.  Each comb and allpass runs over the whole
+    block at once, in stretches that don't wrap around its delay line, so
+    the inner loops are free of index checks. */
+static float freeverb_input[AUDIO_BUFFER_SIZE],
+	freeverb_outl[AUDIO_BUFFER_SIZE], freeverb_outr[AUDIO_BUFFER_SIZE];
+
+/* longest stretch of up to n samples in which none of the num delay lines
+   wraps around */
+static inline int32 freeverb_comb_stretch(comb *c, int32 num, int32 n)
+{
+	int32 k;
+	for (k = 0; k < num; k++) {
+		if (c[k].size - c[k].index < n) {n = c[k].size - c[k].index;}
+	}
+	return n;
+}
+
+static inline void freeverb_comb_advance(comb *c, int32 num, int32 m)
+{
+	int32 k;
+	for (k = 0; k < num; k++) {
+		if ((c[k].index += m) == c[k].size) {c[k].index = 0;}
+	}
+}
+
+#ifdef REVERB_SIMD
+/* all eight combs of a channel side by side in two vectors, one lane each */
+static void do_freeverb_combs_float(const float *input, float *output, int32 n, comb *c)
+{
+	int32 i, j, m;
+	float *p0, *p1, *p2, *p3, *p4, *p5, *p6, *p7, x;
+	rv_v4sf fs0 = {c[0].filterstoref, c[1].filterstoref, c[2].filterstoref, c[3].filterstoref},
+		fs1 = {c[4].filterstoref, c[5].filterstoref, c[6].filterstoref, c[7].filterstoref},
+		fb0 = {c[0].feedback, c[1].feedback, c[2].feedback, c[3].feedback},
+		fb1 = {c[4].feedback, c[5].feedback, c[6].feedback, c[7].feedback},
+		damp1 = rv_v4sf_splat(c[0].damp1), damp2 = rv_v4sf_splat(c[0].damp2),
+		o0, o1, w0, w1;
+
+	for (i = 0; i < n; i += m) {
+		m = freeverb_comb_stretch(c, 8, n - i);
+		p0 = c[0].fbuf + c[0].index, p1 = c[1].fbuf + c[1].index,
+		p2 = c[2].fbuf + c[2].index, p3 = c[3].fbuf + c[3].index,
+		p4 = c[4].fbuf + c[4].index, p5 = c[5].fbuf + c[5].index,
+		p6 = c[6].fbuf + c[6].index, p7 = c[7].fbuf + c[7].index;
+		for (j = 0; j < m; j++) {
+			x = input[i + j];
+			o0 = (rv_v4sf){p0[j], p1[j], p2[j], p3[j]};
+			o1 = (rv_v4sf){p4[j], p5[j], p6[j], p7[j]};
+			fs0 = o0 * damp2 + fs0 * damp1;
+			fs1 = o1 * damp2 + fs1 * damp1;
+			w0 = x + fs0 * fb0;
+			w1 = x + fs1 * fb1;
+			p0[j] = w0[0], p1[j] = w0[1], p2[j] = w0[2], p3[j] = w0[3];
+			p4[j] = w1[0], p5[j] = w1[1], p6[j] = w1[2], p7[j] = w1[3];
+			o0 += o1;
+			output[i + j] = (o0[0] + o0[1]) + (o0[2] + o0[3]);
+		}
+		freeverb_comb_advance(c, 8, m);
+	}
+	c[0].filterstoref = fs0[0], c[1].filterstoref = fs0[1],
+		c[2].filterstoref = fs0[2], c[3].filterstoref = fs0[3];
+	c[4].filterstoref = fs1[0], c[5].filterstoref = fs1[1],
+		c[6].filterstoref = fs1[2], c[7].filterstoref = fs1[3];
+}
+#else
+/* four combs at a time (numcombs is a multiple of four), their filter
+   states are independent */
+static void do_freeverb_combs_float(const float *input, float *output, int32 n, comb *c)
+{
+	int32 i, j, k, m;
+	float *p0, *p1, *p2, *p3, o0, o1, o2, o3, x, fs0, fs1, fs2, fs3,
+		fb0, fb1, fb2, fb3, damp1 = c[0].damp1, damp2 = c[0].damp2;
+
+	memset(output, 0, sizeof(float) * n);
+	for (k = 0; k < numcombs; k += 4, c += 4) {
+		fs0 = c[0].filterstoref, fs1 = c[1].filterstoref,
+			fs2 = c[2].filterstoref, fs3 = c[3].filterstoref;
+		fb0 = c[0].feedback, fb1 = c[1].feedback,
+			fb2 = c[2].feedback, fb3 = c[3].feedback;
+		for (i = 0; i < n; i += m) {
+			m = freeverb_comb_stretch(c, 4, n - i);
+			p0 = c[0].fbuf + c[0].index, p1 = c[1].fbuf + c[1].index,
+			p2 = c[2].fbuf + c[2].index, p3 = c[3].fbuf + c[3].index;
+			for (j = 0; j < m; j++) {
+				x = input[i + j];
+				o0 = p0[j], o1 = p1[j], o2 = p2[j], o3 = p3[j];
+				fs0 = o0 * damp2 + fs0 * damp1;
+				fs1 = o1 * damp2 + fs1 * damp1;
+				fs2 = o2 * damp2 + fs2 * damp1;
+				fs3 = o3 * damp2 + fs3 * damp1;
+				p0[j] = x + fs0 * fb0;
+				p1[j] = x + fs1 * fb1;
+				p2[j] = x + fs2 * fb2;
+				p3[j] = x + fs3 * fb3;
+				output[i + j] += (o0 + o1) + (o2 + o3);
+			}
+			freeverb_comb_advance(c, 4, m);
+		}
+		c[0].filterstoref = fs0, c[1].filterstoref = fs1,
+			c[2].filterstoref = fs2, c[3].filterstoref = fs3;
+	}
+}
+#endif /* REVERB_SIMD */
+
+static void do_freeverb_allpass_float(float *stream, int32 n, allpass *a)
+{
+	int32 i, j, m;
+	float *p, *s, bufout, feedback = a->feedback;
+#ifdef REVERB_SIMD
+	rv_v4sf vfeedback = rv_v4sf_splat(feedback), vbufout, vin;
+#endif
+
+	for (i = 0; i < n; i += m) {
+		m = a->size - a->index;
+		if (m > n - i) {m = n - i;}
+		p = a->fbuf + a->index;
+		s = stream + i;
+		j = 0;
+#ifdef REVERB_SIMD
+		for (; j + 4 <= m; j += 4) {
+			vbufout = rv_v4sf_load(p + j);
+			vin = rv_v4sf_load(s + j);
+			rv_v4sf_store(p + j, vin + vbufout * vfeedback);
+			rv_v4sf_store(s + j, vbufout - vin);
+		}
+#endif
+		for (; j < m; j++) {
+			bufout = p[j];
+			p[j] = s[j] + bufout * feedback;
+			s[j] = bufout - s[j];
+		}
+		if ((a->index += m) == a->size) {a->index = 0;}
+	}
+}
+
+static void do_ch_freeverb_float(int32 *buf, int32 count, InfoFreeverb *rev)
+{
+	int32 i, n = count / 2, input;
+	float *in = freeverb_input, *outl = freeverb_outl, *outr = freeverb_outr;
+	float wet1 = rev->wet1, wet2 = rev->wet2;
+	simple_delay *pdelay = &(rev->pdelay);
+
+	for (i = 0; i < n; i++) {
+		input = reverb_effect_buffer[2 * i] + reverb_effect_buffer[2 * i + 1];
+		do_delay(&input, pdelay->buf, pdelay->size, &pdelay->index);
+		in[i] = (float)input + ANTI_DENORMAL;
+	}
+	memset(reverb_effect_buffer, 0, sizeof(int32) * count);
+
+	do_freeverb_combs_float(in, outl, n, rev->combL);
+	do_freeverb_combs_float(in, outr, n, rev->combR);
+	for (i = 0; i < numallpasses; i++) {
+		do_freeverb_allpass_float(outl, n, &rev->allpassL[i]);
+		do_freeverb_allpass_float(outr, n, &rev->allpassR[i]);
+	}
+	for (i = 0; i < n; i++) {
+		buf[2 * i] += (int32)(outl[i] * wet1 + outr[i] * wet2);
+		buf[2 * i + 1] += (int32)(outr[i] * wet1 + outl[i] * wet2);
+	}
+}
+
 static void do_ch_freeverb(int32 *buf, int32 count, InfoFreeverb *rev)
 {
 	int32 i, k = 0;
@@ -1563,6 +1852,9 @@ static void do_ch_freeverb(int32 *buf, int32 count, InfoFreeverb *rev)
 	} else if(count == MAGIC_FREE_EFFECT_INFO) {
 		free_freeverb_buf(rev);
 		return;
+	} else if(opt_float_effect) {
+		do_ch_freeverb_float(buf, count, rev);
+		return;
 	}
 
 	for (k = 0; k < count; k++)
@@ -1900,6 +2192,8 @@ void init_reverb(void)
 
 void do_ch_reverb(int32 *buf, int32 count)
 {
+	double start = effect_cost_start();
+
 #ifdef SYS_EFFECT_PRE_LPF
 	if ((opt_reverb_control == 3 || opt_reverb_control == 4
 			|| (opt_reverb_control < 0 && ! (opt_reverb_control & 0x100))) && reverb_status_gs.pre_lpf)
@@ -1928,6 +2222,7 @@ void do_ch_reverb(int32 *buf, int32 count)
 	} else {	/* Old Reverb */
 		do_ch_standard_reverb(buf, count, &(reverb_status_gs.info_standard_reverb));
 	}
+	effect_cost_end(EFFECT_COST_REVERB, start, count);
 }
 
 void do_mono_reverb(int32 *buf, int32 count)
@@ -1952,6 +2247,8 @@ void init_ch_delay(void)
 
 void do_ch_delay(int32 *buf, int32 count)
 {
+	double start = effect_cost_start();
+
 #ifdef SYS_EFFECT_PRE_LPF
 	if ((opt_reverb_control == 3 || opt_reverb_control == 4
 			|| (opt_reverb_control < 0 && ! (opt_reverb_control & 0x100))) && delay_status_gs.pre_lpf)
@@ -1968,6 +2265,7 @@ void do_ch_delay(int32 *buf, int32 count)
 		do_ch_normal_delay(buf, count, &(delay_status_gs.info_delay));
 		break;
 	}
+	effect_cost_end(EFFECT_COST_DELAY, start, count);
 }
 
 #if OPT_MODE != 0
@@ -2038,8 +2336,13 @@ static void init_ch_3tap_delay(InfoDelay3 *info)
 		if (info->size[i] > x) {x = info->size[i];}
 	}
 	x += 1;	/* allowance */
-	set_delay(&(info->delayL), x);
-	set_delay(&(info->delayR), x);
+	if (opt_float_effect) {
+		set_delay_float(&(info->delayL), x);
+		set_delay_float(&(info->delayR), x);
+	} else {
+		set_delay(&(info->delayL), x);
+		set_delay(&(info->delayR), x);
+	}
 	for (i = 0; i < 3; i++) {
 		info->index[i] = (x - info->size[i]) % x;	/* set start-point */
 		info->level[i] = delay_status_gs.level_ratio[i] * MASTER_DELAY_LEVEL;
@@ -2057,6 +2360,101 @@ static void free_ch_3tap_delay(InfoDelay3 *info)
 	free_delay(&(info->delayR));
 }
 
+/*! 3-Tap Stereo Delay Effect in floating-point */
+static void do_ch_3tap_delay_float(int32 *buf, int32 count, InfoDelay3 *info)
+{
+	int32 i;
+	simple_delay *delayL = &(info->delayL), *delayR = &(info->delayR);
+	float *bufL = delayL->fbuf, *bufR = delayR->fbuf;
+	int32 buf_index = delayL->index, buf_size = delayL->size;
+	int32 index0 = info->index[0], index1 = info->index[1], index2 = info->index[2];
+	float level0 = info->level[0], level1 = info->level[1], level2 = info->level[2],
+		feedback = info->feedback, send_reverb = info->send_reverb, x;
+
+	for (i = 0; i < count; i++)
+	{
+		bufL[buf_index] = (float)delay_effect_buffer[i] + ANTI_DENORMAL + bufL[index0] * feedback;
+		x = bufL[index0] * level0 + (bufL[index1] + bufR[index1]) * level1;
+		buf[i] += (int32)x;
+		reverb_effect_buffer[i] += (int32)(x * send_reverb);
+
+		bufR[buf_index] = (float)delay_effect_buffer[++i] + ANTI_DENORMAL + bufR[index0] * feedback;
+		x = bufR[index0] * level0 + (bufL[index2] + bufR[index2]) * level2;
+		buf[i] += (int32)x;
+		reverb_effect_buffer[i] += (int32)(x * send_reverb);
+
+		if (++index0 == buf_size) {index0 = 0;}
+		if (++index1 == buf_size) {index1 = 0;}
+		if (++index2 == buf_size) {index2 = 0;}
+		if (++buf_index == buf_size) {buf_index = 0;}
+	}
+	memset(delay_effect_buffer, 0, sizeof(int32) * count);
+	info->index[0] = index0, info->index[1] = index1, info->index[2] = index2;
+	delayL->index = delayR->index = buf_index;
+}
+
+/*! Cross Delay Effect in floating-point */
+static void do_ch_cross_delay_float(int32 *buf, int32 count, InfoDelay3 *info)
+{
+	int32 i;
+	simple_delay *delayL = &(info->delayL), *delayR = &(info->delayR);
+	float *bufL = delayL->fbuf, *bufR = delayR->fbuf;
+	int32 buf_index = delayL->index, buf_size = delayL->size;
+	int32 index0 = info->index[0];
+	float level0 = info->level[0], feedback = info->feedback,
+		send_reverb = info->send_reverb, l, r;
+
+	for (i = 0; i < count; i++)
+	{
+		bufL[buf_index] = (float)delay_effect_buffer[i] + ANTI_DENORMAL + bufR[index0] * feedback;
+		l = bufL[index0] * level0;
+		bufR[buf_index] = (float)delay_effect_buffer[i + 1] + ANTI_DENORMAL + bufL[index0] * feedback;
+		r = bufR[index0] * level0;
+
+		buf[i] += (int32)r;
+		reverb_effect_buffer[i] += (int32)(r * send_reverb);
+		buf[++i] += (int32)l;
+		reverb_effect_buffer[i] += (int32)(l * send_reverb);
+
+		if (++index0 == buf_size) {index0 = 0;}
+		if (++buf_index == buf_size) {buf_index = 0;}
+	}
+	memset(delay_effect_buffer, 0, sizeof(int32) * count);
+	info->index[0] = index0;
+	delayL->index = delayR->index = buf_index;
+}
+
+/*! Normal Delay Effect in floating-point */
+static void do_ch_normal_delay_float(int32 *buf, int32 count, InfoDelay3 *info)
+{
+	int32 i;
+	simple_delay *delayL = &(info->delayL), *delayR = &(info->delayR);
+	float *bufL = delayL->fbuf, *bufR = delayR->fbuf;
+	int32 buf_index = delayL->index, buf_size = delayL->size;
+	int32 index0 = info->index[0];
+	float level0 = info->level[0], feedback = info->feedback,
+		send_reverb = info->send_reverb, x;
+
+	for (i = 0; i < count; i++)
+	{
+		bufL[buf_index] = (float)delay_effect_buffer[i] + ANTI_DENORMAL + bufL[index0] * feedback;
+		x = bufL[index0] * level0;
+		buf[i] += (int32)x;
+		reverb_effect_buffer[i] += (int32)(x * send_reverb);
+
+		bufR[buf_index] = (float)delay_effect_buffer[++i] + ANTI_DENORMAL + bufR[index0] * feedback;
+		x = bufR[index0] * level0;
+		buf[i] += (int32)x;
+		reverb_effect_buffer[i] += (int32)(x * send_reverb);
+
+		if (++index0 == buf_size) {index0 = 0;}
+		if (++buf_index == buf_size) {buf_index = 0;}
+	}
+	memset(delay_effect_buffer, 0, sizeof(int32) * count);
+	info->index[0] = index0;
+	delayL->index = delayR->index = buf_index;
+}
+
 /*! 3-Tap Stereo Delay Effect; this implementation is specialized for system effect. */
 static void do_ch_3tap_delay(int32 *buf, int32 count, InfoDelay3 *info)
 {
@@ -2074,6 +2472,9 @@ static void do_ch_3tap_delay(int32 *buf, int32 count, InfoDelay3 *info)
 	} else if(count == MAGIC_FREE_EFFECT_INFO) {
 		free_ch_3tap_delay(info);
 		return;
+	} else if(opt_float_effect) {
+		do_ch_3tap_delay_float(buf, count, info);
+		return;
 	}
 
 	for (i = 0; i < count; i++)
@@ -2114,6 +2515,9 @@ static void do_ch_cross_delay(int32 *buf, int32 count, InfoDelay3 *info)
 	} else if(count == MAGIC_FREE_EFFECT_INFO) {
 		free_ch_3tap_delay(info);
 		return;
+	} else if(opt_float_effect) {
+		do_ch_cross_delay_float(buf, count, info);
+		return;
 	}
 
 	for (i = 0; i < count; i++)
@@ -2152,6 +2556,9 @@ static void do_ch_normal_delay(int32 *buf, int32 count, InfoDelay3 *info)
 	} else if(count == MAGIC_FREE_EFFECT_INFO) {
 		free_ch_3tap_delay(info);
 		return;
+	} else if(opt_float_effect) {
+		do_ch_normal_delay_float(buf, count, info);
+		return;
 	}
 
 	for (i = 0; i < count; i++)
@@ -2179,6 +2586,73 @@ static void do_ch_normal_delay(int32 *buf, int32 count, InfoDelay3 *info)
 /*                             */
 static int32 chorus_effect_buffer[AUDIO_BUFFER_SIZE * 2];
 
+/*! Stereo Chorus in floating-point; the LFO is the same as in the
+    fixed-point version. */
+static void do_ch_stereo_chorus_float(int32 *buf, int32 count, InfoStereoChorus *info)
+{
+	int32 i, f0, f1;
+	float *bufL = info->delayL.fbuf, *bufR = info->delayR.fbuf;
+	int32 *lfobufL = info->lfoL.buf, *lfobufR = info->lfoR.buf,
+		icycle = info->lfoL.icycle, cycle = info->lfoL.cycle,
+		depth = info->depth, pdelay = info->pdelay, rpt0 = info->rpt0;
+	int32 wpt0 = info->wpt0, spt0 = info->spt0, spt1 = info->spt1,
+		lfocnt = info->lfoL.count;
+	float level = info->level, feedback = info->feedback,
+		send_reverb = info->send_reverb, send_delay = info->send_delay;
+	float hist0 = info->histf0, hist1 = info->histf1, v0, v1, output;
+
+	/* LFO */
+	f0 = imuldiv24(lfobufL[imuldiv24(lfocnt, icycle)], depth);
+	spt0 = wpt0 - pdelay - (f0 >> 8);	/* integral part of delay */
+	f0 = 0xFF - (f0 & 0xFF);	/* (1 - frac) * 256 */
+	if(spt0 < 0) {spt0 += rpt0;}
+	f1 = imuldiv24(lfobufR[imuldiv24(lfocnt, icycle)], depth);
+	spt1 = wpt0 - pdelay - (f1 >> 8);	/* integral part of delay */
+	f1 = 0xFF - (f1 & 0xFF);	/* (1 - frac) * 256 */
+	if(spt1 < 0) {spt1 += rpt0;}
+
+	for(i = 0; i < count; i++) {
+		v0 = bufL[spt0];
+		v1 = bufR[spt1];
+
+		/* LFO */
+		if(++wpt0 == rpt0) {wpt0 = 0;}
+		f0 = imuldiv24(lfobufL[imuldiv24(lfocnt, icycle)], depth);
+		spt0 = wpt0 - pdelay - (f0 >> 8);	/* integral part of delay */
+		f0 = 0xFF - (f0 & 0xFF);	/* (1 - frac) * 256 */
+		if(spt0 < 0) {spt0 += rpt0;}
+		f1 = imuldiv24(lfobufR[imuldiv24(lfocnt, icycle)], depth);
+		spt1 = wpt0 - pdelay - (f1 >> 8);	/* integral part of delay */
+		f1 = 0xFF - (f1 & 0xFF);	/* (1 - frac) * 256 */
+		if(spt1 < 0) {spt1 += rpt0;}
+		if(++lfocnt == cycle) {lfocnt = 0;}
+
+		/* left */
+		/* delay with all-pass interpolation */
+		output = hist0 = v0 + (bufL[spt0] - hist0) * (float)f0 * (1.0f / 256.0f);
+		bufL[wpt0] = (float)chorus_effect_buffer[i] + ANTI_DENORMAL + output * feedback;
+		output *= level;
+		buf[i] += (int32)output;
+		/* send to other system effects (it's peculiar to GS) */
+		reverb_effect_buffer[i] += (int32)(output * send_reverb);
+		delay_effect_buffer[i] += (int32)(output * send_delay);
+
+		/* right */
+		/* delay with all-pass interpolation */
+		output = hist1 = v1 + (bufR[spt1] - hist1) * (float)f1 * (1.0f / 256.0f);
+		bufR[wpt0] = (float)chorus_effect_buffer[++i] + ANTI_DENORMAL + output * feedback;
+		output *= level;
+		buf[i] += (int32)output;
+		/* send to other system effects (it's peculiar to GS) */
+		reverb_effect_buffer[i] += (int32)(output * send_reverb);
+		delay_effect_buffer[i] += (int32)(output * send_delay);
+	}
+	memset(chorus_effect_buffer, 0, sizeof(int32) * count);
+	info->wpt0 = wpt0, info->spt0 = spt0, info->spt1 = spt1,
+		info->histf0 = hist0, info->histf1 = hist1;
+	info->lfoL.count = info->lfoR.count = lfocnt;
+}
+
 /*! Stereo Chorus; this implementation is specialized for system effect. */
 static void do_ch_stereo_chorus(int32 *buf, int32 count, InfoStereoChorus *info)
 {
@@ -2200,8 +2674,13 @@ static void do_ch_stereo_chorus(int32 *buf, int32 count, InfoStereoChorus *info)
 		info->pdelay -= info->depth / 2;	/* NOMINAL_DELAY to delay */
 		if (info->pdelay < 1) {info->pdelay = 1;}
 		info->rpt0 = info->pdelay + info->depth + 2;	/* allowance */
-		set_delay(&(info->delayL), info->rpt0);
-		set_delay(&(info->delayR), info->rpt0);
+		if (opt_float_effect) {
+			set_delay_float(&(info->delayL), info->rpt0);
+			set_delay_float(&(info->delayR), info->rpt0);
+		} else {
+			set_delay(&(info->delayL), info->rpt0);
+			set_delay(&(info->delayR), info->rpt0);
+		}
 		info->feedback = (double)chorus_status_gs.feedback * 0.763 / 100.0;
 		info->level = (double)chorus_status_gs.level / 127.0 * MASTER_CHORUS_LEVEL;
 		info->send_reverb = (double)chorus_status_gs.send_reverb * 0.787 / 100.0 * REV_INP_LEV;
@@ -2211,11 +2690,15 @@ static void do_ch_stereo_chorus(int32 *buf, int32 count, InfoStereoChorus *info)
 		info->send_reverbi = TIM_FSCALE(info->send_reverb, 24);
 		info->send_delayi = TIM_FSCALE(info->send_delay, 24);
 		info->wpt0 = info->spt0 = info->spt1 = info->hist0 = info->hist1 = 0;
+		info->histf0 = info->histf1 = 0;
 		return;
 	} else if(count == MAGIC_FREE_EFFECT_INFO) {
 		free_delay(&(info->delayL));
 		free_delay(&(info->delayR));
 		return;
+	} else if(opt_float_effect) {
+		do_ch_stereo_chorus_float(buf, count, info);
+		return;
 	}
 
 	/* LFO */
@@ -2336,6 +2819,8 @@ void set_ch_chorus(register int32 *sbuffer,int32 n, int32 level)
 
 void do_ch_chorus(int32 *buf, int32 count)
 {
+	double start = effect_cost_start();
+
 #ifdef SYS_EFFECT_PRE_LPF
 	if ((opt_reverb_control == 3 || opt_reverb_control == 4
 			|| (opt_reverb_control < 0 && ! (opt_reverb_control & 0x100))) && chorus_status_gs.pre_lpf)
@@ -2343,6 +2828,7 @@ void do_ch_chorus(int32 *buf, int32 count)
 #endif /* SYS_EFFECT_PRE_LPF */
 
 	do_ch_stereo_chorus(buf, count, &(chorus_status_gs.info_stereo_chorus));
+	effect_cost_end(EFFECT_COST_CHORUS, start, count);
 }
 
 /*                             */
@@ -2357,17 +2843,63 @@ void init_eq_gs()
 	calc_filter_shelving_high(&(eq_status_gs.hsf));
 }
 
+/*! GS EQ in floating-point; both shelving filters in one pass */
+static void do_ch_eq_gs_float(int32* buf, int32 count)
+{
+	int32 i;
+	filter_shelving *lsf = &(eq_status_gs.lsf), *hsf = &(eq_status_gs.hsf);
+	const float scale = 1.0f / (1L << 24);
+	float la1 = lsf->a1 * scale, la2 = lsf->a2 * scale, lb0 = lsf->b0 * scale,
+		lb1 = lsf->b1 * scale, lb2 = lsf->b2 * scale;
+	float ha1 = hsf->a1 * scale, ha2 = hsf->a2 * scale, hb0 = hsf->b0 * scale,
+		hb1 = hsf->b1 * scale, hb2 = hsf->b2 * scale;
+	float lx1l = lsf->fx1l, lx2l = lsf->fx2l, ly1l = lsf->fy1l, ly2l = lsf->fy2l,
+		lx1r = lsf->fx1r, lx2r = lsf->fx2r, ly1r = lsf->fy1r, ly2r = lsf->fy2r;
+	float hx1l = hsf->fx1l, hx2l = hsf->fx2l, hy1l = hsf->fy1l, hy2l = hsf->fy2l,
+		hx1r = hsf->fx1r, hx2r = hsf->fx2r, hy1r = hsf->fy1r, hy2r = hsf->fy2r;
+	float x, y;
+
+	for(i = 0; i < count; i++) {
+		x = (float)eq_buffer[i] + ANTI_DENORMAL;
+		y = x * lb0 + lx1l * lb1 + lx2l * lb2 + ly1l * la1 + ly2l * la2;
+		lx2l = lx1l, lx1l = x, ly2l = ly1l, ly1l = y;
+		x = y;
+		y = x * hb0 + hx1l * hb1 + hx2l * hb2 + hy1l * ha1 + hy2l * ha2;
+		hx2l = hx1l, hx1l = x, hy2l = hy1l, hy1l = y;
+		buf[i] += (int32)y;
+
+		x = (float)eq_buffer[++i] + ANTI_DENORMAL;
+		y = x * lb0 + lx1r * lb1 + lx2r * lb2 + ly1r * la1 + ly2r * la2;
+		lx2r = lx1r, lx1r = x, ly2r = ly1r, ly1r = y;
+		x = y;
+		y = x * hb0 + hx1r * hb1 + hx2r * hb2 + hy1r * ha1 + hy2r * ha2;
+		hx2r = hx1r, hx1r = x, hy2r = hy1r, hy1r = y;
+		buf[i] += (int32)y;
+	}
+	memset(eq_buffer, 0, sizeof(int32) * count);
+	lsf->fx1l = lx1l, lsf->fx2l = lx2l, lsf->fy1l = ly1l, lsf->fy2l = ly2l,
+		lsf->fx1r = lx1r, lsf->fx2r = lx2r, lsf->fy1r = ly1r, lsf->fy2r = ly2r;
+	hsf->fx1l = hx1l, hsf->fx2l = hx2l, hsf->fy1l = hy1l, hsf->fy2l = hy2l,
+		hsf->fx1r = hx1r, hsf->fx2r = hx2r, hsf->fy1r = hy1r, hsf->fy2r = hy2r;
+}
+
 void do_ch_eq_gs(int32* buf, int32 count)
 {
 	register int32 i;
+	double start = effect_cost_start();
 
-	do_shelving_filter_stereo(eq_buffer, count, &(eq_status_gs.lsf));
-	do_shelving_filter_stereo(eq_buffer, count, &(eq_status_gs.hsf));
+	if (opt_float_effect) {
+		do_ch_eq_gs_float(buf, count);
+	} else {
+		do_shelving_filter_stereo(eq_buffer, count, &(eq_status_gs.lsf));
+		do_shelving_filter_stereo(eq_buffer, count, &(eq_status_gs.hsf));
 
-	for(i = 0; i < count; i++) {
-		buf[i] += eq_buffer[i];
-		eq_buffer[i] = 0;
+		for(i = 0; i < count; i++) {
+			buf[i] += eq_buffer[i];
+			eq_buffer[i] = 0;
+		}
 	}
+	effect_cost_end(EFFECT_COST_EQ, start, count);
 }
 
 void do_ch_eq_xg(int32* buf, int32 count, struct part_eq_xg *p)
@@ -39,6 +39,7 @@
 #define DEFAULT_REVERB_SEND_LEVEL 40
 
 extern int opt_reverb_control;
+extern int opt_float_effect;
 extern FLOAT_T reverb_predelay_factor;
 extern FLOAT_T freeverb_scaleroom;
 extern FLOAT_T freeverb_offsetroom;
@@ -47,13 +48,15 @@ extern void set_dry_signal(int32 *, int32);
 extern void set_dry_signal_xg(int32 *, int32, int32);
 extern void mix_dry_signal(int32 *, int32);
 extern void free_effect_buffers(void);
+extern void report_effect_cost(void);
 
 /*                    */
 /*  Effect Utitities  */
 /*                    */
-/*! simple delay */
+/*! simple delay; the opt_float_effect versions use fbuf instead of buf */
 typedef struct {
 	int32 *buf, size, index;
+	float *fbuf;
 } simple_delay;
 
 /*! Pink Noise Generator */
@@ -143,6 +146,7 @@ typedef struct {
 	double freq, gain, q;
 	int32 x1l, x2l, y1l, y2l, x1r, x2r, y1r, y2r;
 	int32 a1, a2, b0, b1, b2;
+	float fx1l, fx2l, fy1l, fy2l, fx1r, fx2r, fy1r, fy2r;	/* opt_float_effect */
 } filter_shelving;
 
 struct part_eq_xg {
@@ -164,18 +168,21 @@ typedef struct {
 
 extern void calc_filter_peaking(filter_peaking *);
 
-/*! allpass filter */
+/*! allpass filter; Freeverb uses fbuf instead of buf with opt_float_effect */
 typedef struct _allpass {
 	int32 *buf, size, index;
+	float *fbuf;
 	double feedback;
 	int32 feedbacki;
 } allpass;
 
-/*! comb filter */
+/*! comb filter; fbuf instead of buf with opt_float_effect */
 typedef struct _comb {
 	int32 *buf, filterstore, size, index;
+	float *fbuf;
 	double feedback, damp1, damp2;
 	int32 feedbacki, damp1i, damp2i;
+	float filterstoref;
 } comb;
 
 /*                                  */
@@ -403,6 +410,7 @@ typedef struct {
 	int32 rpt0, depth, pdelay;
 	double level, feedback, send_reverb, send_delay;
 	int32 leveli, feedbacki, send_reverbi, send_delayi;
+	float histf0, histf1;	/* opt_float_effect */
 } InfoStereoChorus;
 
 /*! Chorus */
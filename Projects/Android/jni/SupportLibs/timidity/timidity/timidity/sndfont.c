@@ -58,6 +58,7 @@
 #include "filter.h"
 #include "freq.h"
 #include "resample.h"
+#include "instcache.h"
 #include "interface.h"
 
 #define FILENAME_NORMALIZE(fname) url_expand_home_dir(fname)
@@ -151,6 +152,7 @@ typedef struct _SFOrder {
 typedef struct _SFInsts {
 	struct timidity_file *tf;
 	char *fname;
+	char *cache_path;	/* the file found by open_file(), for instcache */
 	int8 def_order, def_cutoff_allowed, def_resonance_allowed;
 	uint16 version, minorversion;
 	int32 samplepos, samplesize;
@@ -347,6 +349,7 @@ static void init_sf(SFInsts *rec)
 		end_soundfont(rec);
 		return;
 	}
+	rec->cache_path = SFStrdup(rec, url_expand_home_dir(current_filename));
 
 	if(load_soundfont(&sfinfo, rec->tf))
 	{
@@ -410,6 +413,7 @@ static void end_soundfont(SFInsts *rec)
 	}
 
 	rec->fname = NULL;
+	rec->cache_path = NULL;
 	rec->inst_namebuf = NULL;
 	rec->sfexclude = NULL;
 	rec->sforder = NULL;
@@ -596,6 +600,8 @@ static Instrument *load_from_file(SFInsts *rec, InstList *ip)
 {
 	SampleList *sp;
 	Instrument *inst;
+	InstCacheKey key;
+	int32 *lens = NULL;
 	int i;
 	int32 len;
 
@@ -609,6 +615,22 @@ static Instrument *load_from_file(SFInsts *rec, InstList *ip)
 		      "Loading SF Tonebank %d %d: %s",
 		      ip->pat.bank, ip->pat.preset + progbase,
 		      rec->inst_namebuf[ip->pr_idx]);
+	if (inst_cache_file_key(&key, rec->cache_path) == 0) {
+		inst_cache_key_add(&key, &ip->pat, sizeof(ip->pat));
+		for (i = 0, sp = ip->slist; i < ip->samples && sp;
+		     i++, sp = sp->next) {
+			inst_cache_key_add(&key, &sp->v, sizeof(sp->v));
+			inst_cache_key_add(&key, &sp->start, sizeof(sp->start));
+			inst_cache_key_add(&key, &sp->len, sizeof(sp->len));
+		}
+		if ((inst = inst_cache_load(&key)) != NULL) {
+			ctl->cmsg(CMSG_INFO, VERB_DEBUG,
+				  " * Mapped from the instrument cache");
+			inst->instname = rec->inst_namebuf[ip->pr_idx];
+			return inst;
+		}
+		lens = (int32 *)safe_malloc(sizeof(int32) * ip->samples);
+	}
 	inst = (Instrument *)safe_malloc(sizeof(Instrument));
 	inst->instname = rec->inst_namebuf[ip->pr_idx];
 	inst->type = INST_SF2;
@@ -663,6 +685,8 @@ static Instrument *load_from_file(SFInsts *rec, InstList *ip)
 		    {
 			sample->data = found->data;
 			sample->data_alloced = 0;
+			if (lens)
+			    lens[i] = lens[j];
 			ctl->cmsg(CMSG_INFO, VERB_DEBUG, " * Cached");
 			continue;
 		    }
@@ -685,6 +709,8 @@ static Instrument *load_from_file(SFInsts *rec, InstList *ip)
 		/* set a small blank loop at the tail for avoiding abnormal loop. */
 		len = sp->len / 2;
 		sample->data[len] = sample->data[len + 1] = sample->data[len + 2] = 0;
+		if (lens)
+		    lens[i] = len + 3;
 
 		if (antialiasing_allowed)
 		    antialiasing((int16 *)sample->data,
@@ -694,7 +720,12 @@ static Instrument *load_from_file(SFInsts *rec, InstList *ip)
 
 		/* resample it if possible */
 		if (sample->note_to_use && !(sample->modes & MODES_LOOPING))
+		{
+			sample_t *data = sample->data;
 			pre_resample(sample);
+			if (lens && sample->data != data)
+			    lens[i] = (sample->data_length >> FRACTION_BITS) + 1;
+		}
 
 		/* do pitch detection on drums if surround chorus is used */
 		if (ip->pat.bank == 128 && opt_surround_chorus)
@@ -712,6 +743,10 @@ static Instrument *load_from_file(SFInsts *rec, InstList *ip)
 #endif
 	}
 
+	if (lens) {
+		inst_cache_store(&key, inst, lens);
+		free(lens);
+	}
 	return inst;
 }
 
@@ -84,6 +84,7 @@
 #endif /* SUPPORT_SOUNDSPEC */
 #include "resample.h"
 #include "recache.h"
+#include "instcache.h"
 #include "arc.h"
 #include "strtab.h"
 #include "wrd.h"
@@ -150,6 +151,7 @@ enum {
 	TIM_OPT_DELAY,
 	TIM_OPT_CHORUS,
 	TIM_OPT_REVERB,
+	TIM_OPT_FLOAT_EFFECT,
 	TIM_OPT_VOICE_LPF,
 	TIM_OPT_NS,
 	TIM_OPT_RESAMPLE,
@@ -198,11 +200,14 @@ enum {
 	TIM_OPT_PATCH_FILE,
 	TIM_OPT_POLYPHONY,
 	TIM_OPT_POLY_REDUCE,
+	TIM_OPT_MIX_THREADS,
 	TIM_OPT_MUTE,
 	TIM_OPT_TEMPER_MUTE,
 	TIM_OPT_PRESERVE_SILENCE,
 	TIM_OPT_AUDIO_BUFFER,
 	TIM_OPT_CACHE_SIZE,
+	TIM_OPT_INST_CACHE,
+	TIM_OPT_INST_CACHE_SIZE,
 	TIM_OPT_SAMPLE_FREQ,
 	TIM_OPT_ADJUST_TEMPO,
 	TIM_OPT_CHARSET,
@@ -272,6 +277,8 @@ static const struct option longopts[] = {
 	{ "delay",                  required_argument, NULL, TIM_OPT_DELAY },
 	{ "chorus",                 required_argument, NULL, TIM_OPT_CHORUS },
 	{ "reverb",                 required_argument, NULL, TIM_OPT_REVERB },
+	{ "no-float-effect",        no_argument,       NULL, TIM_OPT_FLOAT_EFFECT },
+	{ "float-effect",           optional_argument, NULL, TIM_OPT_FLOAT_EFFECT },
 	{ "voice-lpf",              required_argument, NULL, TIM_OPT_VOICE_LPF },
 	{ "noise-shaping",          required_argument, NULL, TIM_OPT_NS },
 #ifndef FIXED_RESAMPLATION
@@ -348,11 +355,14 @@ static const struct option longopts[] = {
 	{ "polyphony",              required_argument, NULL, TIM_OPT_POLYPHONY },
 	{ "no-polyphony-reduction", no_argument,       NULL, TIM_OPT_POLY_REDUCE },
 	{ "polyphony-reduction",    optional_argument, NULL, TIM_OPT_POLY_REDUCE },
+	{ "mix-threads",            required_argument, NULL, TIM_OPT_MIX_THREADS },
 	{ "mute",                   required_argument, NULL, TIM_OPT_MUTE },
 	{ "temper-mute",            required_argument, NULL, TIM_OPT_TEMPER_MUTE },
 	{ "preserve-silence",       no_argument,       NULL, TIM_OPT_PRESERVE_SILENCE },
 	{ "audio-buffer",           required_argument, NULL, TIM_OPT_AUDIO_BUFFER },
 	{ "cache-size",             required_argument, NULL, TIM_OPT_CACHE_SIZE },
+	{ "instrument-cache",       required_argument, NULL, TIM_OPT_INST_CACHE },
+	{ "instrument-cache-size",  required_argument, NULL, TIM_OPT_INST_CACHE_SIZE },
 	{ "sampling-freq",          required_argument, NULL, TIM_OPT_SAMPLE_FREQ },
 	{ "adjust-tempo",           required_argument, NULL, TIM_OPT_ADJUST_TEMPO },
 	{ "output-charset",         required_argument, NULL, TIM_OPT_CHARSET },
@@ -431,6 +441,7 @@ static inline int set_default_program(int);
 static inline int parse_opt_delay(const char *);
 static inline int parse_opt_chorus(const char *);
 static inline int parse_opt_reverb(const char *);
+static inline int parse_opt_float_effect(const char *);
 static int parse_opt_reverb_freeverb(const char *arg, char type);
 static inline int parse_opt_voice_lpf(const char *);
 static inline int parse_opt_noise_shaping(const char *);
@@ -498,12 +509,15 @@ static inline int parse_opt_o(char *);
 static inline int parse_opt_P(const char *);
 static inline int parse_opt_p(const char *);
 static inline int parse_opt_p1(const char *);
+static inline int parse_opt_mix_threads(const char *);
 static inline int parse_opt_Q(const char *);
 static inline int parse_opt_Q1(const char *);
 static inline int parse_opt_preserve_silence(const char *);
 static inline int parse_opt_q(const char *);
 static inline int parse_opt_R(const char *);
 static inline int parse_opt_S(const char *);
+static inline int parse_opt_instrument_cache(const char *);
+static inline int parse_opt_instrument_cache_size(const char *);
 static inline int parse_opt_s(const char *);
 static inline int parse_opt_T(const char *);
 static inline int parse_opt_t(const char *);
@@ -2784,6 +2798,8 @@ MAIN_INTERFACE int set_tim_opt_long(int c, char *optarg, int index)
 		return parse_opt_chorus(arg);
 	case TIM_OPT_REVERB:
 		return parse_opt_reverb(arg);
+	case TIM_OPT_FLOAT_EFFECT:
+		return parse_opt_float_effect(arg);
 	case TIM_OPT_VOICE_LPF:
 		return parse_opt_voice_lpf(arg);
 	case TIM_OPT_NS:
@@ -2910,6 +2926,8 @@ MAIN_INTERFACE int set_tim_opt_long(int c, char *optarg, int index)
 		return parse_opt_p(arg);
 	case TIM_OPT_POLY_REDUCE:
 		return parse_opt_p1(arg);
+	case TIM_OPT_MIX_THREADS:
+		return parse_opt_mix_threads(arg);
 	case TIM_OPT_MUTE:
 		return parse_opt_Q(arg);
 	case TIM_OPT_TEMPER_MUTE:
@@ -2920,6 +2938,10 @@ MAIN_INTERFACE int set_tim_opt_long(int c, char *optarg, int index)
 		return parse_opt_q(arg);
 	case TIM_OPT_CACHE_SIZE:
 		return parse_opt_S(arg);
+	case TIM_OPT_INST_CACHE:
+		return parse_opt_instrument_cache(arg);
+	case TIM_OPT_INST_CACHE_SIZE:
+		return parse_opt_instrument_cache_size(arg);
 	case TIM_OPT_SAMPLE_FREQ:
 		return parse_opt_s(arg);
 	case TIM_OPT_ADJUST_TEMPO:
@@ -3516,6 +3538,13 @@ static int parse_opt_reverb_freeverb(const char *arg, char type)
 	return 0;
 }
 
+static inline int parse_opt_float_effect(const char *arg)
+{
+	/* --[no-]float-effect */
+	opt_float_effect = y_or_n_p(arg);
+	return 0;
+}
+
 static inline int parse_opt_voice_lpf(const char *arg)
 {
 	/* --voice-lpf */
@@ -3841,6 +3870,8 @@ static int parse_opt_h(const char *arg)
 "               Allow n-voice polyphony.  Optional auto polyphony reduction",
 "     (a)     --[no-]polyphony-reduction",
 "               Toggle automatic polyphony reduction.  Enabled by default",
+"             --mix-threads=n",
+"               Mix the voices on n threads (default is 1)",
 "  -Q n[,...] --mute=n[,...]",
 "               Ignore channel n (0: ignore all, -n: resume channel n)",
 "     (t)     --temper-mute=n[,...]",
@@ -3855,6 +3886,11 @@ static int parse_opt_h(const char *arg)
 "                 if n=0, n is set to 800",
 "  -S n       --cache-size=n",
 "               Cache size (0 means no cache)",
+"             --instrument-cache=dir",
+"               Keep converted instruments in cache files in dir",
+"             --instrument-cache-size=n",
+"               Delete the least recently used cache files beyond n bytes",
+"                 (default is 256M)",
 "  -s freq    --sampling-freq=freq",
 "               Set sampling frequency to freq (Hz or kHz)",
 "  -T n       --adjust-tempo=n",
@@ -4010,6 +4046,7 @@ static int parse_opt_h(const char *arg)
 "  --delay=(d|l|r|b)[,msec]" NLS
 "  --chorus=(d|n|s)[,level]" NLS
 "  --reverb=(d|n|g|f|G)[,level]" NLS
+"  --[no-]float-effect" NLS
 "  --voice-lpf=(d|c|m)" NLS
 "  --noise-shaping=n" NLS, fp);
 #ifndef FIXED_RESAMPLATION
@@ -4667,6 +4704,13 @@ static inline int parse_opt_p1(const char *arg)
 	return 0;
 }
 
+static inline int parse_opt_mix_threads(const char *arg)
+{
+	/* --mix-threads */
+	return set_value(&opt_mix_threads, atoi(arg), 1, MAX_MIX_THREADS,
+			"Number of mixing threads");
+}
+
 static inline int parse_opt_Q(const char *arg)
 {
 	const char *p = arg;
@@ -4764,6 +4808,43 @@ static inline int parse_opt_S(const char *arg)
 	return 0;
 }
 
+static inline int parse_opt_instrument_cache(const char *arg)
+{
+	/* --instrument-cache */
+	if (opt_inst_cache_dir != NULL)
+		free(opt_inst_cache_dir);
+	opt_inst_cache_dir = safe_strdup(arg);
+	return 0;
+}
+
+static inline int parse_opt_instrument_cache_size(const char *arg)
+{
+	/* --instrument-cache-size */
+	int suffix = arg[strlen(arg) - 1];
+	int32 figure;
+	
+	switch (suffix) {
+	case 'M':
+	case 'm':
+		figure = 1 << 20;
+		break;
+	case 'K':
+	case 'k':
+		figure = 1 << 10;
+		break;
+	default:
+		figure = 1;
+		break;
+	}
+	if (atof(arg) * figure < 1 || atof(arg) * figure > 0x7fffffff) {
+		ctl->cmsg(CMSG_ERROR, VERB_NORMAL,
+				"Instrument cache size out of range: %s", arg);
+		return 1;
+	}
+	opt_inst_cache_size = atof(arg) * figure;
+	return 0;
+}
+
 static inline int parse_opt_s(const char *arg)
 {
 	/* sampling rate */
@@ -6054,11 +6135,13 @@ int main(int argc, char **argv)
 	free_instruments(0);
 	free_soundfonts();
 	free_cache_data();
+	inst_cache_close();
 	free_wrd();
 	free_readmidi();
 	free_global_mblock();
 	tmdy_free_config();
 	free_reverb_buffer();
+	free_voice_mixer();
 	free_effect_buffers();
 	free(voice);
 	free_gauss_table();
@@ -386,6 +386,14 @@ typedef double FLOAT_T;
 #define TEMPER_CONTROL_ALLOW
 
 
+/* Define if you want to mix the voices on several threads.
+ * There is a command line option to set the number of threads.
+ */
+#if !defined(__W32__) && defined(__GNUC__)
+#define ENABLE_MIX_THREADS
+#endif
+
+
 
 /*****************************************************************************\
  section 2: some important definitions